@@ -0,0 +1,102 @@
+/// \file benchmarkTimer.h
+/// Defines the micro-benchmarks timer and their output record.\n
+/// A benchmark is a function called on consecutive indexes. The calls are timed in samples
+/// of a fixed number of calls, after one warm-up sample that is not recorded.
+/// Each benchmark is reported as one JSON line on stdout, with the
+/// minimum, median, mean and maximum time per call over the samples.\n
+/// The checksum is the sum of the values returned by the calls: it keeps
+/// the compiler from dropping the calls and changes if the results change.\n
+
+#ifndef BENCHMARK_TIMER_H
+#define BENCHMARK_TIMER_H 1
+
+// C++ headers
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+using namespace std;
+
+
+/// \class benchmarkResult
+/// <b> benchmarkResult </b>\n\n
+/// Times are in ns per call.
+class benchmarkResult
+{
+public:
+	benchmarkResult(string b, string c) : benchmark(b), bcase(c), status("ok"), calls(0), samples(0), items(1),
+	minNs(0), medianNs(0), meanNs(0), maxNs(0), checksum(0) {;}
+
+	string benchmark;   ///< function benchmarked
+	string bcase;       ///< input case
+	string status;      ///< "ok", or "skipped" with the reason in note
+	string note;
+	long   calls;       ///< calls per sample
+	int    samples;     ///< recorded samples
+	int    items;       ///< items (hits, points) processed by each call
+	double minNs, medianNs, meanNs, maxNs;
+	double checksum;
+
+	/// writes the record as one JSON line on stdout
+	void print() const
+	{
+		if(status != "ok") {
+			printf("{\"benchmark\":\"%s\",\"case\":\"%s\",\"status\":\"%s\",\"note\":\"%s\"}\n",
+					 benchmark.c_str(), bcase.c_str(), status.c_str(), note.c_str());
+		} else {
+			printf("{\"benchmark\":\"%s\",\"case\":\"%s\",\"status\":\"ok\",\"calls\":%ld,\"samples\":%d,\"items\":%d,"
+					 "\"min_ns\":%.3f,\"median_ns\":%.3f,\"mean_ns\":%.3f,\"max_ns\":%.3f,\"checksum\":%.9g}\n",
+					 benchmark.c_str(), bcase.c_str(), calls, samples, items, minNs, medianNs, meanNs, maxNs, checksum);
+		}
+		fflush(stdout);
+	}
+};
+
+
+/// times samples of ncalls calls of call(i), i going from 0 to ncalls - 1 in each sample.
+/// call returns a double, added to the checksum
+template<class CALL> benchmarkResult timeCalls(string benchmark, string bcase, long ncalls, int nsamples, CALL call)
+{
+	benchmarkResult result(benchmark, bcase);
+	result.calls   = ncalls;
+	result.samples = nsamples;
+
+	vector<double> perCall;
+
+	// the first sample is the warm-up
+	for(int s=0; s<=nsamples; s++) {
+		double sum = 0;
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		for(long i=0; i<ncalls; i++) {
+			sum += call(i);
+		}
+		chrono::steady_clock::time_point stop = chrono::steady_clock::now();
+
+		result.checksum += sum;
+		if(s > 0) perCall.push_back(chrono::duration<double, nano>(stop - start).count()/ncalls);
+	}
+
+	if(perCall.empty()) return result;
+
+	sort(perCall.begin(), perCall.end());
+	result.minNs    = perCall.front();
+	result.maxNs    = perCall.back();
+	result.medianNs = perCall.size() % 2 ? perCall[perCall.size()/2] : 0.5*(perCall[perCall.size()/2 - 1] + perCall[perCall.size()/2]);
+	for(double t : perCall) result.meanNs += t;
+	result.meanNs /= perCall.size();
+
+	return result;
+}
+
+/// record of a benchmark that could not run
+inline benchmarkResult skipped(string benchmark, string bcase, string reason)
+{
+	benchmarkResult result(benchmark, bcase);
+	result.status = "skipped";
+	result.note   = reason;
+	return result;
+}
+
+
+#endif
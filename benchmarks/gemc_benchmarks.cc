@@ -0,0 +1,373 @@
+/// \file gemc_benchmarks.cc
+/// Micro-benchmarks of the gemc components called at every step or hit:
+/// - fields: gMappedField::GetFieldValue on synthetic ASCII maps, gclas12BinaryMappedField::GetFieldValue on the cmag maps if available
+/// - hits:   the sensitiveDetector::ProcessHits lookups: hit index and process ID
+/// - dgt:    dc_HitProcess::integrateDgt with synthetic CCDB tables
+/// - output: hipo_output::writeG4DgtIntegrated for the DC::tdc bank\n
+/// No geometry, run manager or database is needed. Options are given as -NAME=value:
+/// - CALLS: calls per sample (default 100000)
+/// - SAMPLES: recorded samples (default 10)
+/// - HITS: hits in the event (default 500)
+/// - STEPS: steps per DC hit (default 4)
+/// - ONLY: comma separated groups to run (default fields,hits,dgt,output)
+/// - FIELD_DIR: directory of the cmag binary maps (default the FIELD_DIR environment variable)
+/// - BINARY_MAPS: solenoid:torus cmag maps names\n
+/// The results are written on stdout, one JSON line per benchmark. The components log goes to stderr.\n
+
+// gemc headers
+#include "benchmarkTimer.h"
+#include "syntheticInputs.h"
+#include "gemcOptions.h"
+#include "asciiField.h"
+#include "clas12BinField.h"
+#include "sensitiveDetector.h"
+#include "clas12/dc_hitprocess.h"
+#include "hipo_output.h"
+
+// geant4
+#include "G4VDiscreteProcess.hh"
+#include "Randomize.hh"
+
+// CLHEP units
+#include "CLHEP/Units/PhysicalConstants.h"
+using namespace CLHEP;
+
+// C++ headers
+#include <cfloat>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+using namespace std;
+
+// system headers
+#include <sys/stat.h>
+
+// defined in gemc.cc, used by the gui infos linked with the gemc sources
+const char *GEMC_VERSION = "gemc 2.12";
+
+namespace {
+
+	/// \class benchmarkSettings
+	/// <b> benchmarkSettings </b>\n\n
+	/// Command line options
+	class benchmarkSettings
+	{
+	public:
+		long     calls      = 100000;
+		int      samples    = 10;
+		int      hits       = 500;
+		int      steps      = 4;
+		unsigned seed       = 1;
+		string   only       = "fields,hits,dgt,output";
+		string   fieldDir   = getenv("FIELD_DIR") != nullptr ? getenv("FIELD_DIR") : "";
+		string   binaryMaps = "Symm_solenoid_r601_phi1_z1201_13June2018:Full_torus_r251_phi181_z251_25Jan2021";
+
+		bool parse(int argc, char **argv)
+		{
+			for(int i=1; i<argc; i++) {
+				string arg = argv[i];
+				size_t equal = arg.find("=");
+				if(arg.find("-") != 0 || equal == string::npos) return false;
+
+				string name  = arg.substr(1, equal - 1);
+				string value = arg.substr(equal + 1);
+
+				if(name == "CALLS")            calls      = atol(value.c_str());
+				else if(name == "SAMPLES")     samples    = atoi(value.c_str());
+				else if(name == "HITS")        hits       = atoi(value.c_str());
+				else if(name == "STEPS")       steps      = atoi(value.c_str());
+				else if(name == "SEED")        seed       = strtoul(value.c_str(), nullptr, 10);
+				else if(name == "ONLY")        only       = value;
+				else if(name == "FIELD_DIR")   fieldDir   = value;
+				else if(name == "BINARY_MAPS") binaryMaps = value;
+				else return false;
+			}
+			return calls > 0 && samples > 0 && hits > 0 && steps > 0;
+		}
+
+		bool run(string group) const
+		{
+			stringstream groups(only);
+			string g;
+			while(getline(groups, g, ',')) {
+				if(g == group) return true;
+			}
+			return false;
+		}
+	};
+
+	void usage()
+	{
+		cerr << " Usage: gemc_benchmarks [-CALLS=100000] [-SAMPLES=10] [-HITS=500] [-STEPS=4] [-SEED=1]" << endl;
+		cerr << "                        [-ONLY=fields,hits,dgt,output] [-FIELD_DIR=dir] [-BINARY_MAPS=solenoid:torus]" << endl;
+	}
+
+	bool fileExists(string filename)
+	{
+		struct stat buffer;
+		return stat(filename.c_str(), &buffer) == 0;
+	}
+
+	// the creator process of the tracks, as seen by sensitiveDetector::processID
+	class benchmarkProcess : public G4VDiscreteProcess
+	{
+	public:
+		benchmarkProcess(const G4String &name) : G4VDiscreteProcess(name) {;}
+		G4double GetMeanFreePath(const G4Track&, G4double, G4ForceCondition*) {return DBL_MAX;}
+	};
+
+	double fieldSum(const double *B)
+	{
+		return (B[0] + B[1] + B[2])/tesla;
+	}
+
+
+	// gMappedField::GetFieldValue with the linear and the nearest point evaluators
+	void benchmarkAsciiFields(const benchmarkSettings &settings, goptions gemcOpt, string directory)
+	{
+		struct fieldCase {
+			string         name;
+			string         filename;
+			vector<double> points;
+		};
+
+		vector<fieldCase> cases = {
+			{"cylindrical-z", writeSolenoidMap(directory, 301, 601),  fieldQueryPoints(4096, 3.0*m, -3.5*m, 3.5*m, settings.seed)},
+			{"phi-segmented", writeTorusMap(directory, 31, 101, 101), fieldQueryPoints(4096, 5.0*m,  0.5*m, 6.5*m, settings.seed)}
+		};
+
+		for(auto &fcase : cases) {
+			asciiField af;
+			gfield gf = af.loadField(fcase.filename, gemcOpt);
+			af.loadFieldMap(gf.map, 0);
+
+			gMappedField *map = gf.map;
+			const vector<double> &points = fcase.points;
+			long npoints = points.size()/3;
+
+			gMappedField::fieldEvaluator linear = map->evaluator;
+			gMappedField::fieldEvaluator nearest = fcase.name == "phi-segmented" ? map->phiSegmentedEvaluator(false) : map->cylindricalEvaluator(2, false);
+
+			for(int interpolation=0; interpolation<2; interpolation++) {
+				map->evaluator = interpolation == 0 ? linear : nearest;
+
+				benchmarkResult result = timeCalls("gMappedField::GetFieldValue", fcase.name + (interpolation == 0 ? "/linear" : "/none"),
+															  settings.calls, settings.samples, [&](long i) {
+																  double B[3];
+																  map->GetFieldValue(&points[3*(i % npoints)], B);
+																  return fieldSum(B);
+															  });
+				result.print();
+			}
+			map->evaluator = linear;
+		}
+	}
+
+
+	// gclas12BinaryMappedField::GetFieldValue on the cmag maps in FIELD_DIR. Binary maps can't be generated: skipped without them
+	void benchmarkBinaryField(const benchmarkSettings &settings, goptions gemcOpt)
+	{
+		string benchmark = "gclas12BinaryMappedField::GetFieldValue";
+
+		stringstream names(settings.binaryMaps);
+		string solenoid, torus;
+		getline(names, solenoid, ':');
+		getline(names, torus, ':');
+
+		if(settings.fieldDir.empty()) {
+			skipped(benchmark, "cmag", "FIELD_DIR not set").print();
+			return;
+		}
+		for(auto &mapName : {solenoid, torus}) {
+			if(!fileExists(settings.fieldDir + "/" + mapName + ".dat")) {
+				skipped(benchmark, "cmag", mapName + ".dat not found in " + settings.fieldDir).print();
+				return;
+			}
+		}
+
+		// clas12BinField reads the maps directory from the environment
+		setenv("FIELD_DIR", settings.fieldDir.c_str(), 1);
+
+		clas12BinField bf;
+		gfield gf = bf.loadField(settings.binaryMaps, gemcOpt);
+		bf.loadFieldMap(gf.bc12map, 0);
+
+		const gclas12BinaryMappedField *map = gf.bc12map;
+		vector<double> points = fieldQueryPoints(4096, 4.0*m, -1.0*m, 6.0*m, settings.seed);
+		long npoints = points.size()/3;
+
+		benchmarkResult result = timeCalls(benchmark, "cmag/" + gf.bc12map->interpolation, settings.calls, settings.samples, [&](long i) {
+			double B[3];
+			map->GetFieldValue(&points[3*(i % npoints)], B);
+			return fieldSum(B);
+		});
+		result.print();
+	}
+
+
+	// the lookups of each ProcessHits step: the existing hit of the step identity, and the creator process ID.
+	// The event has settings.hits hits. 3 steps out of 4 belong to an existing hit
+	void benchmarkHitLookups(const benchmarkSettings &settings, goptions gemcOpt, const vector<detector> &superlayers)
+	{
+		sensitiveDetector sd("dc", gemcOpt, sensitiveID());
+
+		vector<MHit*> hits = dcHits(superlayers, settings.hits, 1, settings.seed);
+		for(auto hit : hits) {
+			sd.hitIndex[hitIndexKey(hit->GetId())].push_back(hit);
+		}
+
+		syntheticRandom random(settings.seed);
+		vector<vector<identifier> > queries;
+		for(int q=0; q<4096; q++) {
+			if(q % 4 != 3) {
+				vector<identifier> identity = hits[random.integer(0, (int) hits.size() - 1)]->GetId();
+				for(auto &iden : identity) iden.time += random.uniform(0, 100)*ns;
+				queries.push_back(identity);
+			} else {
+				queries.push_back(dcIdentity(random.integer(1, 6), random.integer(1, 6), random.integer(1, 6), random.integer(1, 112), random.uniform(10, 200)*ns));
+			}
+		}
+
+		benchmarkResult found = timeCalls("sensitiveDetector::find_existing_hit", "dc/" + to_string(settings.hits) + " hits",
+													 settings.calls, settings.samples, [&](long i) {
+														 return sd.find_existing_hit(queries[i % queries.size()]) != nullptr ? 1.0 : 0.0;
+													 });
+		found.print();
+
+		// the last name is not in the catalog
+		vector<string> processNames = {"eIoni", "compt", "eBrem", "phot", "conv", "msc", "Decay", "hadElastic", "benchmarkProcess"};
+		vector<unique_ptr<benchmarkProcess> > processes;
+		for(auto &name : processNames) {
+			processes.push_back(unique_ptr<benchmarkProcess>(new benchmarkProcess(name)));
+		}
+
+		benchmarkResult byProcess = timeCalls("sensitiveDetector::processID", "process pointer",
+														  settings.calls, settings.samples, [&](long i) {
+															  return (double) sd.processID(processes[i % processes.size()].get());
+														  });
+		byProcess.print();
+
+		benchmarkResult byName = timeCalls("sensitiveDetector::processID", "process name",
+													  settings.calls, settings.samples, [&](long i) {
+														  return (double) sd.processID(processNames[i % processNames.size()]);
+													  });
+		byName.print();
+
+		sd.hitIndex.clear();
+		for(auto hit : hits) delete hit;
+	}
+
+
+	// one call is the digitization of one hit
+	void benchmarkDCDigitization(const benchmarkSettings &settings, HitProcess *dcHitProcess, const vector<MHit*> &hits)
+	{
+		benchmarkResult result = timeCalls("dc_HitProcess::integrateDgt", "dc/" + to_string(settings.steps) + " steps",
+													  settings.calls, settings.samples, [&](long i) {
+														  map<string, double> dgtz = dcHitProcess->integrateDgt(hits[i % hits.size()], (int) (i % hits.size()) + 1);
+														  auto tdc = dgtz.find("TDC_TDC");
+														  return tdc != dgtz.end() ? tdc->second : 0.0;
+													  });
+		result.print();
+	}
+
+
+	// one call writes the DC::tdc bank of all the event hits
+	void benchmarkHipoOutput(const benchmarkSettings &settings, goptions gemcOpt, string directory, HitProcess *dcHitProcess, const vector<MHit*> &hits)
+	{
+		gemcOpt.optMap["OUTPUT"].args = "hipo, " + directory + "/benchmark.hipo";
+
+		outputContainer output(gemcOpt);
+		output.initializeHipo(true);
+
+		hipo_output hipoOut;
+		hipoOut.writeHeader(&output, {{"runNo", gemcOpt.optMap["RUNNO"].arg}, {"evn", 1}}, gBank());
+
+		gBank dcBank(1000, "dc", "synthetic dc bank");
+		dcBank.load_variable("sector",    1, "Di", "sector");
+		dcBank.load_variable("layer",     2, "Di", "layer");
+		dcBank.load_variable("component", 3, "Di", "wire");
+		dcBank.load_variable("TDC_order", 4, "Di", "tdc order");
+		dcBank.load_variable("TDC_TDC",   5, "Di", "tdc");
+		dcBank.load_variable("hitn",     99, "Di", "hit number");
+		dcBank.orderNames();
+
+		map<string, gBank> banksMap;
+		banksMap["dc"] = dcBank;
+
+		vector<hitOutput> hitsOutput(hits.size());
+		for(unsigned h=0; h<hits.size(); h++) {
+			hitsOutput[h].setDgtz(dcBank.compile(dcHitProcess->integrateDgt(hits[h], h + 1)));
+		}
+
+		benchmarkResult result = timeCalls("hipo_output::writeG4DgtIntegrated", "dc/" + to_string(hits.size()) + " hits",
+													  settings.calls, settings.samples, [&](long i) {
+														  hipoOut.outEvent->reset();
+														  hipoOut.writeG4DgtIntegrated(&output, hitsOutput, "dc", &banksMap);
+														  return (double) hipoOut.outEvent->getSize();
+													  });
+		result.items = hits.size();
+		result.print();
+	}
+}
+
+
+int main(int argc, char **argv)
+{
+	benchmarkSettings settings;
+	if(!settings.parse(argc, argv)) {
+		usage();
+		return 1;
+	}
+
+	// the components log on cout: stdout only has the benchmark records
+	cout.rdbuf(cerr.rdbuf());
+
+	goptions gemcOpt;
+	gemcOpt.setGoptions();
+	gemcOpt.optMap["FIELD_MAP_CACHE"].args  = "no";
+	gemcOpt.optMap["FIELD_VERBOSITY"].arg   = 0;
+	gemcOpt.optMap["HIT_VERBOSITY"].arg     = 0;
+	gemcOpt.optMap["BANK_VERBOSITY"].arg    = 0;
+	gemcOpt.optMap["OUTPUT_QUEUE"].arg      = 0;
+	gemcOpt.optMap["RUNNO"].arg             = 11;
+
+	string directory = makeBenchmarkDirectory();
+
+	// the digitization and the hipo header read their tables through the constants cache
+	string connection = syntheticConnection(directory);
+	setenv("CCDB_CONNECTION", connection.c_str(), 1);
+	preloadSyntheticCalibration(connection, gemcOpt.optMap["RUNNO"].arg, gemcOpt.optMap["DIGITIZATION_VARIATION"].args);
+
+	G4Random::setTheSeed(settings.seed);
+
+	vector<detector> superlayers = dcSuperlayers();
+
+	if(settings.run("fields")) {
+		benchmarkAsciiFields(settings, gemcOpt, directory);
+		benchmarkBinaryField(settings, gemcOpt);
+	}
+
+	if(settings.run("hits")) {
+		benchmarkHitLookups(settings, gemcOpt, superlayers);
+	}
+
+	if(settings.run("dgt") || settings.run("output")) {
+		HitProcess *dcHitProcess = dc_HitProcess::createHitClass();
+		dcHitProcess->init("dc", gemcOpt, map<string, double>());
+		dcHitProcess->initWithRunNumber(gemcOpt.optMap["RUNNO"].arg);
+
+		vector<MHit*> hits = dcHits(superlayers, settings.hits, settings.steps, settings.seed);
+
+		if(settings.run("dgt"))    benchmarkDCDigitization(settings, dcHitProcess, hits);
+		if(settings.run("output")) benchmarkHipoOutput(settings, gemcOpt, directory, dcHitProcess, hits);
+
+		for(auto hit : hits) delete hit;
+		delete dcHitProcess;
+	}
+
+	removeBenchmarkDirectory(directory);
+
+	return 0;
+}
@@ -0,0 +1,282 @@
+// gemc headers
+#include "syntheticInputs.h"
+#include "ccdbCache.h"
+
+// CLHEP units
+#include "CLHEP/Units/PhysicalConstants.h"
+using namespace CLHEP;
+
+// C++ headers
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+using namespace std;
+
+// system headers
+#include <dirent.h>
+#include <unistd.h>
+
+namespace {
+	// superlayers cell size, in cm, as in the /geometry/dc/superlayer table
+	const double dcCellSize[6] = {0.3861, 0.4042, 0.6219, 0.6586, 0.9351, 0.9780};
+
+	// maximum drift time per superlayer, ns
+	const double dcTmax[6] = {155, 165, 300, 320, 600, 630};
+
+	FILE *openMap(string filename)
+	{
+		FILE *fp = fopen(filename.c_str(), "w");
+		if(fp == nullptr) {
+			cout << "  !! Error: field map " << filename << " can't be written." << endl;
+			exit(1);
+		}
+		return fp;
+	}
+}
+
+string makeBenchmarkDirectory()
+{
+	string base = getenv("TMPDIR") != nullptr ? getenv("TMPDIR") : "/tmp";
+	string pattern = base + "/gemc_benchmarks.XXXXXX";
+
+	vector<char> path(pattern.begin(), pattern.end());
+	path.push_back('\0');
+
+	if(mkdtemp(path.data()) == nullptr) {
+		cout << "  !! Error: benchmarks directory " << pattern << " can't be created." << endl;
+		exit(1);
+	}
+	return string(path.data());
+}
+
+void removeBenchmarkDirectory(string directory)
+{
+	DIR *dir = opendir(directory.c_str());
+	if(dir == nullptr) return;
+
+	while(dirent *entry = readdir(dir)) {
+		string name = entry->d_name;
+		if(name == "." || name == "..") continue;
+		unlink((directory + "/" + name).c_str());
+	}
+	closedir(dir);
+	rmdir(directory.c_str());
+}
+
+// solenoid-like field: longitudinal core, transverse component growing with r*z
+string writeSolenoidMap(string directory, int ntransverse, int nlongitudinal)
+{
+	string filename = directory + "/synthetic-solenoid.dat";
+	FILE *fp = openMap(filename);
+
+	fprintf(fp, "<mfield>\n");
+	fprintf(fp, "<description name=\"synthetic-solenoid\" factory=\"ASCII\" comment=\"benchmark solenoid\"/>\n");
+	fprintf(fp, "<symmetry type=\"cylindrical-z\" format=\"map\"/>\n");
+	fprintf(fp, "<map>\n");
+	fprintf(fp, "<coordinate>\n");
+	fprintf(fp, "<first  name=\"transverse\"    npoints=\"%d\" min=\"0\"  max=\"3\" units=\"m\"/>\n", ntransverse);
+	fprintf(fp, "<second name=\"longitudinal\"  npoints=\"%d\" min=\"-3\" max=\"3\" units=\"m\"/>\n", nlongitudinal);
+	fprintf(fp, "</coordinate>\n");
+	fprintf(fp, "<field unit=\"T\"/>\n");
+	fprintf(fp, "</map>\n");
+	fprintf(fp, "</mfield>\n");
+
+	double cellr = 3.0/(ntransverse - 1);
+	double cellz = 6.0/(nlongitudinal - 1);
+
+	for(int ir=0; ir<ntransverse; ir++) {
+		double r = ir*cellr;
+		for(int iz=0; iz<nlongitudinal; iz++) {
+			double z = -3 + iz*cellz;
+			double core = exp(-z*z/2)/(1 + r*r);
+			fprintf(fp, "%.6g %.6g %.6g %.6g\n", r, z, 0.5*r*z*core, 5*core);
+		}
+	}
+	fclose(fp);
+
+	return filename;
+}
+
+// torus-like field: mostly azimuthal, with a sector modulation
+string writeTorusMap(string directory, int nazimuthal, int ntransverse, int nlongitudinal)
+{
+	string filename = directory + "/synthetic-torus.dat";
+	FILE *fp = openMap(filename);
+
+	fprintf(fp, "<mfield>\n");
+	fprintf(fp, "<description name=\"synthetic-torus\" factory=\"ASCII\" comment=\"benchmark torus\"/>\n");
+	fprintf(fp, "<symmetry type=\"phi-segmented\" format=\"map\"/>\n");
+	fprintf(fp, "<map>\n");
+	fprintf(fp, "<coordinate>\n");
+	fprintf(fp, "<first  name=\"azimuthal\"     npoints=\"%d\" min=\"0\"   max=\"30\"  units=\"deg\"/>\n", nazimuthal);
+	fprintf(fp, "<second name=\"transverse\"    npoints=\"%d\" min=\"0\"   max=\"500\" units=\"cm\"/>\n", ntransverse);
+	fprintf(fp, "<third  name=\"longitudinal\"  npoints=\"%d\" min=\"100\" max=\"600\" units=\"cm\"/>\n", nlongitudinal);
+	fprintf(fp, "</coordinate>\n");
+	fprintf(fp, "<field unit=\"kilogauss\"/>\n");
+	fprintf(fp, "</map>\n");
+	fprintf(fp, "</mfield>\n");
+
+	double cellphi = 30.0/(nazimuthal - 1);
+	double cellr   = 500.0/(ntransverse - 1);
+	double cellz   = 500.0/(nlongitudinal - 1);
+
+	for(int ip=0; ip<nazimuthal; ip++) {
+		double phi = ip*cellphi;
+		double modulation = cos(phi*deg);
+		for(int ir=0; ir<ntransverse; ir++) {
+			double r = ir*cellr;
+			for(int iz=0; iz<nlongitudinal; iz++) {
+				double z = 100 + iz*cellz;
+				double core = 30*exp(-(z - 350)*(z - 350)/20000)*r/(r + 50);
+				fprintf(fp, "%.6g %.6g %.6g %.6g %.6g %.6g\n", phi, r, z, 0.1*core*sin(phi*deg), core*modulation, 0.05*core);
+			}
+		}
+	}
+	fclose(fp);
+
+	return filename;
+}
+
+vector<double> fieldQueryPoints(int npoints, double rmax, double zmin, double zmax, unsigned seed)
+{
+	syntheticRandom random(seed);
+	vector<double> points;
+	points.reserve(3*npoints);
+
+	for(int p=0; p<npoints; p++) {
+		double r   = rmax*sqrt(random.uniform(0, 1));
+		double phi = random.uniform(0, 2*pi);
+		points.push_back(r*cos(phi));
+		points.push_back(r*sin(phi));
+		points.push_back(random.uniform(zmin, zmax));
+	}
+	return points;
+}
+
+// the file is never opened: all the tables are in the constants cache.
+// A missing table would fail on the local file instead of reaching a remote database
+string syntheticConnection(string directory)
+{
+	return "sqlite:///" + directory + "/synthetic_ccdb.sqlite";
+}
+
+void preloadSyntheticCalibration(string connection, int runno, string variation)
+{
+	string suffix = ":" + to_string(runno) + ":" + variation;
+
+	vector<vector<double> > inefficiency, smearing, time2dist, t0, superlayers, raster;
+
+	for(int sec=1; sec<=6; sec++) {
+		for(int sl=1; sl<=6; sl++) {
+			inefficiency.push_back({(double) sec, (double) sl, 0, 1, 0.0001, 0.04, 0.0001, 0.05});
+			smearing.push_back({(double) sec, (double) sl, 0, 0.025, -0.02, 0.03, 0.01, 0.005});
+			time2dist.push_back({(double) sec, (double) sl, 0, 0.0053, 1.5, dcTmax[sl-1], 0, 0.16, 0.4, -1.0, 1.5, -0.6, 0, 0.6, 0.004});
+			for(int slot=1; slot<=7; slot++) {
+				for(int cable=1; cable<=6; cable++) {
+					t0.push_back({(double) sec, (double) sl, (double) slot, (double) cable, 0.1*slot + 0.01*cable});
+				}
+			}
+		}
+	}
+	for(int sl=1; sl<=6; sl++) {
+		superlayers.push_back({(double) sl, 0, 0, 0, 0, 0, dcCellSize[sl-1]});
+	}
+	raster.push_back({0, 0, 0, 0.01, 0.2});
+	raster.push_back({0, 0, 1, -0.01, 0.2});
+
+	cachedCalibration::preload(connection, "/calibration/dc/signal_generation/inefficiency"  + suffix, inefficiency);
+	cachedCalibration::preload(connection, "/calibration/dc/signal_generation/doca_smearing" + suffix, smearing);
+	cachedCalibration::preload(connection, "/calibration/dc/time_to_distance/time2dist"      + suffix, time2dist);
+	cachedCalibration::preload(connection, "/calibration/dc/time_corrections/T0Corrections"  + suffix, t0);
+	cachedCalibration::preload(connection, "/geometry/dc/superlayer"                         + suffix, superlayers);
+	cachedCalibration::preload(connection, "/calibration/raster/adc_to_position"             + suffix, raster);
+}
+
+// the digitization reads dimensions[0], the half thickness, and dimensions[3], the half height.
+// The 6 sense wire planes are sqrt(3) cells apart, the 112 wires 2 cells apart
+vector<detector> dcSuperlayers()
+{
+	vector<detector> superlayers(6);
+
+	for(int sl=0; sl<6; sl++) {
+		double cell = dcCellSize[sl]*cm;
+		detector &det = superlayers[sl];
+		det.name        = "sl" + to_string(sl + 1);
+		det.type        = "G4Trap";
+		det.sensitivity = "dc";
+		det.hitType     = "dc";
+		det.dimensions  = {3.5*sqrt(3.0)*cell, 0, 0, 113*cell, 100*cm, 200*cm, 0, 113*cell, 100*cm, 200*cm, 0};
+	}
+	return superlayers;
+}
+
+vector<identifier> dcIdentity(int sector, int superlayer, int layer, int wire, double time)
+{
+	const char *names[4] = {"sector", "superlayer", "layer", "wire"};
+	int ids[4] = {sector, superlayer, layer, wire};
+
+	vector<identifier> identity(4);
+	for(int i=0; i<4; i++) {
+		identity[i].name       = names[i];
+		identity[i].rule       = "manual";
+		identity[i].id         = ids[i];
+		identity[i].time       = time;
+		identity[i].TimeWindow = 500*ns;
+		identity[i].TrackId    = 0;
+	}
+	return identity;
+}
+
+// the steps are within one cell of the wire, as the hits of a track crossing the cell
+vector<MHit*> dcHits(const vector<detector> &superlayers, int nhits, int nsteps, unsigned seed)
+{
+	syntheticRandom random(seed);
+	vector<MHit*> hits;
+
+	for(int h=0; h<nhits; h++) {
+		int sector = random.integer(1, 6);
+		int sl     = random.integer(1, 6);
+		int layer  = random.integer(1, 6);
+		int wire   = random.integer(1, 112);
+
+		const detector &det = superlayers[sl-1];
+		double zlength = det.dimensions[0];
+		double ylength = det.dimensions[3];
+		double deltaz  = 2.0*zlength/7;
+		double deltay  = 2.0*ylength/113;
+		double cell    = dcCellSize[sl-1]*cm;
+
+		double wireY = deltay*(wire + 0.5*(layer%2)) - ylength;
+		double wireZ = deltaz*layer - zlength;
+
+		double time = random.uniform(10, 200)*ns;
+		double p    = random.uniform(0.5, 5)*GeV;
+		double m    = 139.57*MeV;
+		G4ThreeVector direction(random.uniform(-0.2, 0.2), random.uniform(-0.2, 0.2), 1);
+		direction = direction.unit();
+
+		MHit *hit = new MHit();
+		hit->SetId(dcIdentity(sector, sl, layer, wire, time));
+		hit->SetDetector(det);
+
+		for(int s=0; s<nsteps; s++) {
+			G4ThreeVector lpos(random.uniform(-100, 100)*cm, wireY + random.uniform(-cell, cell), wireZ + random.uniform(-cell, cell));
+			hit->SetPos(G4ThreeVector(lpos.x(), lpos.y(), lpos.z() + 500*cm));
+			hit->SetLPos(lpos);
+			hit->SetVert(G4ThreeVector(0, 0, 0));
+			hit->SetEdep(random.uniform(0, 2)*keV);
+			hit->SetDx(random.uniform(0.1, 2)*mm);
+			hit->SetMgnf(random.uniform(0, 1.5)*tesla);
+			hit->SetTime(time + s*0.1*ns);
+			hit->SetMom(p*direction);
+			hit->SetE(sqrt(p*p + m*m));
+			hit->SetTrackId(1 + (s % 2));
+			hit->SetPID(211);
+			hit->SetCharge(1);
+			hit->SetProcID(0);
+		}
+		hits.push_back(hit);
+	}
+	return hits;
+}
@@ -0,0 +1,80 @@
+/// \file syntheticInputs.h
+/// Defines the synthetic inputs of the micro-benchmarks:
+/// - ASCII field maps with the clas12 solenoid (cylindrical-z) and torus (phi-segmented) layouts
+/// - query points for the field maps
+/// - drift chambers superlayers volumes and hits, with their steps
+/// - drift chambers and raster CCDB tables, served from the constants cache
+///   under a local sqlite connection, so no database is ever opened.\n
+/// All inputs are generated from a fixed seed: the checksums of two runs with the same
+/// arguments are the same.\n
+
+#ifndef SYNTHETIC_INPUTS_H
+#define SYNTHETIC_INPUTS_H 1
+
+// gemc headers
+#include "detector.h"
+#include "identifier.h"
+#include "Hit.h"
+
+// C++ headers
+#include <random>
+#include <string>
+#include <vector>
+using namespace std;
+
+
+/// \class syntheticRandom
+/// <b> syntheticRandom </b>\n\n
+/// mt19937 with explicit scaling: the sequence is the same on all platforms,
+/// unlike the standard distributions.
+class syntheticRandom
+{
+public:
+	syntheticRandom(unsigned seed) : engine(seed) {;}
+
+	/// uniform in [min, max)
+	double uniform(double min, double max) { return min + (max - min)*(engine()/4294967296.0); }
+
+	/// uniform integer in [min, max]
+	int integer(int min, int max) { return min + (int) (engine() % (unsigned) (max - min + 1)); }
+
+private:
+	mt19937 engine;
+};
+
+
+/// creates a temporary directory for the generated files and returns its path
+string makeBenchmarkDirectory();
+
+/// removes the generated files and the directory
+void removeBenchmarkDirectory(string directory);
+
+/// writes a cylindrical-z map of ntransverse x nlongitudinal points, r in [0, 3] m, z in [-3, 3] m. Returns the file name
+string writeSolenoidMap(string directory, int ntransverse, int nlongitudinal);
+
+/// writes a phi-segmented map of nazimuthal x ntransverse x nlongitudinal points, phi in [0, 30] deg,
+/// r in [0, 500] cm, z in [100, 600] cm. Returns the file name
+string writeTorusMap(string directory, int nazimuthal, int ntransverse, int nlongitudinal);
+
+/// npoints (x, y, z) points, in mm, uniform in a cylinder of radius rmax around the z axis,
+/// between zmin and zmax. Returned as 3*npoints consecutive coordinates
+vector<double> fieldQueryPoints(int npoints, double rmax, double zmin, double zmax, unsigned seed);
+
+/// the CCDB connection of the synthetic tables
+string syntheticConnection(string directory);
+
+/// stores in the constants cache the tables read by the dc digitization
+/// and by the hipo header for the run number and variation
+void preloadSyntheticCalibration(string connection, int runno, string variation);
+
+/// the 6 drift chambers superlayers volumes, with the G4Trap dimensions read by the digitization
+vector<detector> dcSuperlayers();
+
+/// drift chambers identity: sector, superlayer, layer, wire
+vector<identifier> dcIdentity(int sector, int superlayer, int layer, int wire, double time);
+
+/// nhits drift chambers hits with nsteps steps each, close to their wire
+vector<MHit*> dcHits(const vector<detector> &superlayers, int nhits, int nsteps, unsigned seed);
+
+
+#endif
@@ -117,8 +117,8 @@ class detector
 		void setSensitivity(G4VSensitiveDetector *SD){LogicV->SetSensitiveDetector(SD);} ///< Assign the sensitive detector to the Logical Volume
 		
 		G4VSolid          *GetSolid()   { return SolidV;}                                ///< Returns G4 Solid pointer
-		G4LogicalVolume   *GetLogical() { return LogicV;}                                ///< Returns Logical Volume pointer
-		G4VPhysicalVolume *GetPhysical(){ return PhysicalV;}                             ///< Returns Physical Volume pointer
+		G4LogicalVolume   *GetLogical() const { return LogicV;}                          ///< Returns Logical Volume pointer
+		G4VPhysicalVolume *GetPhysical() const { return PhysicalV;}                    ///< Returns Physical Volume pointer
 		void SetLogical(G4LogicalVolume *LV){LogicV = LV;}                               ///< Sets Logical Volume pointer
 		void SetPhysical(G4VPhysicalVolume *PV){PhysicalV = PV;}                         ///< Sets Physical Volume pointer
 		void SetTranslation(G4ThreeVector TR){PhysicalV->SetTranslation(TR);}            ///< Sets Physical Volume Position
@@ -172,6 +172,9 @@ gfield asciiField::loadField(string file, goptions opts)
 // load field map, called by create_MFM
 void asciiField::loadFieldMap(gMappedField* map, double v)
 {
+	// a valid binary cache replaces parsing the map
+	if(map->loadCache()) return;
+
 	cout << "  > Loading field map from " << map->identifier << " with symmetry: " << map->symmetry << endl;
 	
 	// dipole field
@@ -189,6 +192,8 @@ void asciiField::loadFieldMap(gMappedField* map, double v)
 	} else {
 		cout << "can't recognize the field symmetry "<< map->symmetry << endl; exit(1);
 	}
+
+	map->writeCache();
 }
 
 
@@ -9,7 +9,7 @@ using namespace CLHEP;
 
 void gclas12BinaryMappedField::GetFieldValue(const double x[3], double *bField) const
 {
-	static int FIRST_ONLY;
+	static thread_local int FIRST_ONLY;
 	bField[0] = bField[1] = bField[2] = 0;
 
 	if ( isnan(x[0]) ||  isnan(x[1]) ||  isnan(x[2]) ) {
@@ -20,11 +20,13 @@ void gclas12BinaryMappedField::GetFieldValue(const double x[3], double *bField)
 	double rpoint[3] = {(x[0] - mapOrigin[0])/cm, (x[1] - mapOrigin[1])/cm, (x[2] - mapOrigin[2])/cm};
 		
 
-	getCompositeFieldValue(combinedValuePtr, rpoint[0], rpoint[1], rpoint[2], torusPtr, solenoidPtr);
+	// local result so that the map can be shared among threads
+	FieldValue combinedValue;
+	getCompositeFieldValue(&combinedValue, rpoint[0], rpoint[1], rpoint[2], torusPtr, solenoidPtr);
 
-	bField[0] = combinedValuePtr->b1*kilogauss;
-	bField[1] = combinedValuePtr->b2*kilogauss;
-	bField[2] = combinedValuePtr->b3*kilogauss;
+	bField[0] = combinedValue.b1*kilogauss;
+	bField[1] = combinedValue.b2*kilogauss;
+	bField[2] = combinedValue.b3*kilogauss;
 
 	RotateField(bField);
 
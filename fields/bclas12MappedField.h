@@ -69,10 +69,6 @@ public:
 	MagneticFieldPtr solenoidPtr;
 	MagneticFieldPtr torusPtr;
 
-	// map pointers
-	// Uses David's routine to return the BX BY BZ components
-	FieldValuePtr combinedValuePtr;
-
 	// precalculating values of the rotation angles so we don't do it at GetFieldValue time
 	double sinAlpha, cosAlhpa;
 	double sinBeta, cosBeta;
@@ -106,8 +106,6 @@ void clas12BinField::loadFieldMap(gclas12BinaryMappedField* b12map, double v) {
 	}
 
 	// initialize map pointers
-	b12map->combinedValuePtr = (FieldValuePtr) malloc(sizeof (FieldValue));
-
 	b12map->solenoidPtr = initializeSolenoid(b12map->solenoidMapFileName.c_str());
 	b12map->torusPtr    = initializeTorus(b12map->torusMapFileName.c_str());
 
@@ -22,6 +22,55 @@ using namespace gstring;
 #include "G4SimpleRunge.hh"
 #include "G4NystromRK4.hh"
 #include "G4CachedMagneticField.hh"
+#include "G4AutoLock.hh"
+
+namespace {
+	G4Mutex fieldManagerMutex = G4MUTEX_INITIALIZER;
+}
+
+G4FieldManager* gfield::get_MFM()
+{
+	G4AutoLock lock(&fieldManagerMutex);
+	
+	int thread = G4Threading::G4GetThreadId();
+	if(MFMs.find(thread) == MFMs.end()) {
+		MFMs[thread] = create_MFM();
+	}
+	return MFMs[thread];
+}
+
+// called by create_MFM, with fieldManagerMutex locked
+// the cache is per thread since each thread has its own field manager.
+// It is built once per thread and used by the field manager only, as the G4CachedMagneticField of the mapped fields.
+// It is also used by sensitiveDetector::ProcessHits, through the detector field
+G4MagneticField* gfield::cachedField(G4MagneticField *field)
+{
+	if(g4fieldCacheSize <= 0) return field;
+
+	G4CachedMagneticField *cached = new G4CachedMagneticField(field, g4fieldCacheSize);
+	cachedFields[G4Threading::G4GetThreadId()] = cached;
+
+	return cached;
+}
+
+void gfield::reportCacheStatistics()
+{
+	G4AutoLock lock(&fieldManagerMutex);
+
+	if(cachedFields.empty()) return;
+
+	long int calls = 0;
+	long int evaluations = 0;
+	for(auto &cached: cachedFields) {
+		calls       += cached.second->GetCountCalls();
+		evaluations += cached.second->GetCountEvaluations();
+	}
+
+	if(calls == 0) return;
+
+	cout << " > Field " << name << " cache (" << g4fieldCacheSize/mm << " mm, " << cachedFields.size() << " threads): "
+	<< calls << " calls, " << evaluations << " evaluations, hit rate: " << 100.0*(calls - evaluations)/calls << "%" << endl;
+}
 
 // this class serves as a dispatcher for the
 // various format of magnetic fields
@@ -30,25 +79,29 @@ using namespace gstring;
 // - map
 // - bc12map (binary format map)
 // would be nice to have a MFM verbosity
-void gfield::create_MFM()
+G4FieldManager* gfield::create_MFM()
 {
+	G4FieldManager *MFM = nullptr;
+	
 	// fields can be uniform, mapped
 	if(format == "simple" && symmetry == "uniform") {
-		create_simple_MFM();
+		MFM = create_simple_MFM();
 	} else if(format == "simple" && symmetry == "multipole") {
 		// fields can be multipole, mapped
-		create_simple_multipole_MFM();
+		MFM = create_simple_multipole_MFM();
 	} else if(format == "map") {
-		fFactory->loadFieldMap(map, verbosity);
+		// the map is loaded by the first thread only
+		if(MFMs.empty()) {
+			fFactory->loadFieldMap(map, verbosity);
+		}
 		
+		// the stepper equation and the chord finder integrate the map itself:
+		// only the field manager uses the thread cached field
 		G4Mag_UsualEqRhs*       iEquation    = new G4Mag_UsualEqRhs(map);
 		G4MagIntegratorStepper* iStepper     = createStepper(integration, 	iEquation);
 		G4ChordFinder*          iChordFinder = new G4ChordFinder(map, minStep, iStepper);
 		
-		// caching does not seem to help for dipole-y
-		// will it help for other field maps?
-		G4MagneticField *pCachedMagField = new G4CachedMagneticField(map, g4fieldCacheSize);
-		MFM = new G4FieldManager(pCachedMagField, iChordFinder);
+		MFM = new G4FieldManager(cachedField(map), iChordFinder);
 		
 		G4double minEps = 0.1;  //   Minimum & value for smallest steps
 		G4double maxEps = 1.0;  //   Maximum & value for largest steps
@@ -59,16 +112,17 @@ void gfield::create_MFM()
 		MFM->SetDeltaIntersection(0.01 * mm);
 	} else if(format == "bc12map") {
 		
-		fFactory->loadFieldMap(bc12map, verbosity);
+		if(MFMs.empty()) {
+			fFactory->loadFieldMap(bc12map, verbosity);
+		}
 		
+		// the stepper equation and the chord finder integrate the map itself:
+		// only the field manager uses the thread cached field
 		G4Mag_UsualEqRhs*       iEquation    = new G4Mag_UsualEqRhs(bc12map);
 		G4MagIntegratorStepper* iStepper     = createStepper(integration, 	iEquation);
 		G4ChordFinder*          iChordFinder = new G4ChordFinder(bc12map, minStep, iStepper);
 		
-		// caching does not seem to help for dipole-y
-		// will it help for other field maps?
-		G4MagneticField *pCachedMagField = new G4CachedMagneticField(bc12map, g4fieldCacheSize);
-		MFM = new G4FieldManager(pCachedMagField, iChordFinder);
+		MFM = new G4FieldManager(cachedField(bc12map), iChordFinder);
 		
 		G4double minEps = 0.1;  //   Minimum & value for smallest steps
 		G4double maxEps = 1.0;  //   Maximum & value for largest steps
@@ -79,9 +133,10 @@ void gfield::create_MFM()
 		MFM->SetDeltaIntersection(0.01 * mm);
 	}
 	
+	return MFM;
 }
 
-void gfield::create_simple_MFM()
+G4FieldManager* gfield::create_simple_MFM()
 {
 	vector < string > dim = getStringVectorFromString(dimensions);
 	
@@ -97,14 +152,16 @@ void gfield::create_simple_MFM()
 	G4MagIntegratorStepper* iStepper     = createStepper(integration, iEquation);
 	G4ChordFinder*          iChordFinder = new G4ChordFinder(magField, minStep,	iStepper);
 	
-	MFM = new G4FieldManager(magField, iChordFinder);
+	G4FieldManager *MFM = new G4FieldManager(magField, iChordFinder);
 	
 	if (verbosity > 1) {
 		cout << "  >  <" << name << ">: uniform magnetic field is built." << endl;
 	}
+	
+	return MFM;
 }
 
-void gfield::create_simple_multipole_MFM()
+G4FieldManager* gfield::create_simple_multipole_MFM()
 {
 	vector < string > dim = getStringVectorFromString(dimensions);
 	
@@ -121,12 +178,14 @@ void gfield::create_simple_multipole_MFM()
 	G4MagIntegratorStepper* iStepper = createStepper(integration, iEquation);
 	G4ChordFinder* iChordFinder      = new G4ChordFinder(magField, minStep, iStepper);
 	
-	MFM = new G4FieldManager(magField, iChordFinder);
+	G4FieldManager *MFM = new G4FieldManager(magField, iChordFinder);
 	
 	if (verbosity > 1) {
 		cout << "  >  <" << name << ">: multipole magnetic field is built with "
 		<< dimensions << endl;
 	}
+	
+	return MFM;
 }
 
 G4MagIntegratorStepper *createStepper(string sname, G4Mag_UsualEqRhs* ie)
@@ -235,6 +294,15 @@ void gfield::initialize(goptions Opt)
 	}
 	
 	if(map) {
+		// binary cache of the map values
+		string cacheOption = trimSpacesFromString(Opt.optMap["FIELD_MAP_CACHE"].args);
+		if(cacheOption == "yes") {
+			map->cachePath = map->identifier + ".gcache";
+		} else if(cacheOption != "no") {
+			string mapFile = map->identifier.substr(map->identifier.find_last_of("/") + 1);
+			map->cachePath = cacheOption + "/" + mapFile + ".gcache";
+		}
+
 		map->scaleFactor = scaleFactor;
 		map->initializeMap();
 		map->verbosity = verbosity;
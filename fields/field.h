@@ -40,6 +40,7 @@ using namespace std;
 #include "G4FieldManager.hh"
 #include "G4MagIntegratorStepper.hh"
 #include "G4Mag_UsualEqRhs.hh"
+#include "G4CachedMagneticField.hh"
 
 // CLHEP units
 #include "CLHEP/Units/PhysicalConstants.h"
@@ -58,8 +59,7 @@ public:
 	format("na"),
 	dimensions("na"),
 	map(nullptr),
-	bc12map(nullptr),
-	MFM(nullptr) {
+	bc12map(nullptr) {
 		// initialize Magnetic Field Manager and Mapped field to nullptr
 		scaleFactor	     = 1;
 		minStep          = 1*mm;
@@ -87,8 +87,8 @@ public:
 	void initialize(goptions);
 	
 	// creates simple magnetic field manager (uniform fields, etc)
-	void create_simple_MFM();
-	void create_simple_multipole_MFM();
+	G4FieldManager* create_simple_MFM();
+	G4FieldManager* create_simple_multipole_MFM();
 	
 	// mapped Field. We need to factory to load the map
 	gMappedField *map;                   ///< Mapped Field
@@ -96,18 +96,25 @@ public:
 	fieldFactory *fFactory;              ///< fieldFactory that created the field
 	
 private:
-	G4FieldManager *MFM;             	///< G4 Magnetic Field Manager
-	void create_MFM();                ///< Creates the G4 Magnetic Field Manager
+	std::map<int, G4FieldManager*> MFMs;	///< G4 Magnetic Field Managers, one per thread id (the master thread id is -1)
+	G4FieldManager* create_MFM();        ///< Creates the G4 Magnetic Field Manager
+
+	// G4CachedMagneticField wrappers, one per thread id, to report the cache statistics
+	std::map<int, G4CachedMagneticField*> cachedFields;
+
+	// wraps the field in a G4CachedMagneticField for this thread
+	// returns the field itself if G4FIELDCACHESIZE is 0
+	G4MagneticField* cachedField(G4MagneticField *field);
 	
 public:
-	// Returns Magnetic Field Manager Pointer
+	// Returns this thread Magnetic Field Manager Pointer
 	// creates one if it doesn't exist
-	G4FieldManager* get_MFM() {
-		if(MFM == nullptr) {
-			create_MFM();
-		}
-		return MFM;
-	}
+	// the field map itself is loaded only once and shared among threads
+	G4FieldManager* get_MFM();
+
+	// prints the field cache calls and hit rate, summed over the threads
+	// called at the end of the run
+	void reportCacheStatistics();
 	
 	///< Overloaded "<<" for gfield class. Dumps infos on screen.
 	friend ostream &operator<<(ostream &stream, gfield gf);
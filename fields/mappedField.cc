@@ -5,6 +5,42 @@
 #include "CLHEP/Units/PhysicalConstants.h"
 using namespace CLHEP;
 
+// C++ headers
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// field map binary cache
+// the header is followed, at FIELD_CACHE_OFFSET (page aligned), by the nvalues floats of fieldValues
+// the values are in the native byte order: the cache is meant for the machines sharing the map
+#define FIELD_CACHE_VERSION 2
+#define FIELD_CACHE_OFFSET  4096
+
+struct fieldMapCacheHeader
+{
+	char     magic[8];       // "GFMCACHE"
+	uint32_t version;
+	uint32_t ncomponents;
+	uint32_t ndims;
+	uint32_t np[3];
+	uint64_t nvalues;
+	int64_t  sourceSize;     // map file size and modification time
+	int64_t  sourceMTime;
+	double   scaleFactor;    // the values are scaled when loading
+	char     unit[32];
+	char     symmetry[32];
+	struct {                 // coordinates, in the map order
+		char   name[16];
+		char   unit[8];
+		double min, max;
+		int32_t speed;
+	} axes[3];
+};
+
 ostream &operator<<(ostream &stream, gcoord gc)
 {
 	cout << gc.name  << ": np="    << gc.np ;
@@ -23,27 +59,18 @@ ostream &operator<<(ostream &stream, gcoord gc)
 
 void gMappedField::GetFieldValue(const double point[3], double *bField) const
 {
-	static int FIRST_ONLY;
+	static thread_local int FIRST_ONLY;
 		
 	bField[0] = bField[1] = bField[2] = 0;
 
+	// unknown symmetry or interpolation: no field
+	if(evaluator == nullptr) return;
+
 	// displacement point
 	double rpoint[3] = {point[0] - mapOrigin[0], point[1] - mapOrigin[1], point[2] - mapOrigin[2]};
 
-	// dipole field
-	if(symmetry == "dipole-z" || symmetry == "dipole-y" || symmetry == "dipole-x") {
-		GetFieldValue_Dipole(rpoint, bField, FIRST_ONLY);
-	}
-	// phi-symmetric cylindrical field
-	else if(symmetry == "cylindrical-z" || symmetry == "cylindrical-y" || symmetry == "cylindrical-x") {
-		GetFieldValue_Cylindrical(rpoint, bField, FIRST_ONLY);
-	// phi-segmented
-	} else 	if(symmetry == "phi-segmented") {
-		GetFieldValue_phiSegmented(rpoint, bField, FIRST_ONLY);
-	// cartesian_3D
-	} else 	if(symmetry == "cartesian_3D" || symmetry == "cartesian_3D_quadrant"){
-		GetFieldValue_cartesian3d(rpoint, bField, FIRST_ONLY);
-	}
+	// symmetry, axis and interpolation are resolved in initializeMap
+	(this->*evaluator)(rpoint, bField, FIRST_ONLY);
 
 	if(verbosity == 99) FIRST_ONLY = 99;
 	
@@ -51,30 +78,141 @@ void gMappedField::GetFieldValue(const double point[3], double *bField) const
 
 void gMappedField::RotateField( double *Bfield) const  {
 
+	if(!hasRotation) return;
+
 	// rotating the fields 
-	if(mapRotation[0] != 0) {
-		double yPrime = yRotX(Bfield);
-		double zPrime = zRotX(Bfield);
-		Bfield[1] = yPrime;
-		Bfield[2] = zPrime;
+	double B[3] = {Bfield[0], Bfield[1], Bfield[2]};
+
+	for(int i=0; i<3; i++)
+		Bfield[i] = rotationMatrix[i][0]*B[0] + rotationMatrix[i][1]*B[1] + rotationMatrix[i][2]*B[2];
+}
+
+
+
+
+gMappedField::~gMappedField()
+{
+	if(memoryMapped) {
+		munmap(mappedBase, mappedSize);
+	} else if(fieldValues) {
+		delete [] fieldValues;
+	}
+}
+
+void gMappedField::allocateValues(unsigned int ncomp)
+{
+	ncomponents = ncomp;
+	nvalues     = ncomp;
+	for(unsigned int d=0; d<ndims; d++) nvalues *= np[d];
+
+	fieldValues = new float[nvalues]();
+}
+
+// fills the cache header for the current map. Returns false if the map file can't be found
+static bool fillCacheHeader(const gMappedField *map, fieldMapCacheHeader *header)
+{
+	struct stat source;
+	if(stat(map->identifier.c_str(), &source) != 0) return false;
+
+	memset(header, 0, sizeof(fieldMapCacheHeader));
+	memcpy(header->magic, "GFMCACHE", 8);
+	header->version     = FIELD_CACHE_VERSION;
+	header->ncomponents = map->ncomponents;
+	header->ndims       = map->ndims;
+	for(unsigned int d=0; d<map->ndims; d++) header->np[d] = map->np[d];
+	header->nvalues     = map->nvalues;
+	header->sourceSize  = source.st_size;
+	header->sourceMTime = source.st_mtime;
+	header->scaleFactor = map->scaleFactor;
+	strncpy(header->unit, map->unit.c_str(), sizeof(header->unit) - 1);
+	strncpy(header->symmetry, map->symmetry.c_str(), sizeof(header->symmetry) - 1);
+	for(unsigned int c=0; c<map->coordinates.size() && c<3; c++) {
+		const gcoord &axis = map->coordinates[c];
+		strncpy(header->axes[c].name, axis.name.c_str(), sizeof(header->axes[c].name) - 1);
+		strncpy(header->axes[c].unit, axis.unit.c_str(), sizeof(header->axes[c].unit) - 1);
+		header->axes[c].min   = axis.min;
+		header->axes[c].max   = axis.max;
+		header->axes[c].speed = axis.speed;
 	}
 
-	if(mapRotation[1] != 0) {
-		double xPrime = xRotY(Bfield);
-		double zPrime = zRotY(Bfield);
-		Bfield[0] = xPrime;
-		Bfield[2] = zPrime;
+	return true;
+}
+
+bool gMappedField::loadCache()
+{
+	if(cachePath == "") return false;
+
+	fieldMapCacheHeader expected;
+	if(!fillCacheHeader(this, &expected)) return false;
+
+	int fd = open(cachePath.c_str(), O_RDONLY);
+	if(fd < 0) return false;
+
+	fieldMapCacheHeader header;
+	struct stat cache;
+	bool valid = read(fd, &header, sizeof(header)) == (ssize_t) sizeof(header) && fstat(fd, &cache) == 0;
+
+	// the number of components is set by the cache, all other entries must match the map
+	if(valid) {
+		expected.ncomponents = header.ncomponents;
+		expected.nvalues     = header.nvalues;
+		valid = memcmp(&header, &expected, sizeof(header)) == 0
+		     && (size_t) cache.st_size == FIELD_CACHE_OFFSET + header.nvalues*sizeof(float);
 	}
 
-	if(mapRotation[2] != 0) {
-		double xPrime = xRotZ(Bfield);
-		double yPrime = yRotZ(Bfield);
-		Bfield[0] = xPrime;
-		Bfield[1] = yPrime;
+	if(!valid) {
+		close(fd);
+		return false;
 	}
+
+	// shared read only mapping: the jobs on a node share the page cache copy
+	void *base = mmap(nullptr, cache.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if(base == MAP_FAILED) return false;
+
+	mappedBase   = base;
+	mappedSize   = cache.st_size;
+	memoryMapped = true;
+	ncomponents  = header.ncomponents;
+	nvalues      = header.nvalues;
+	fieldValues  = (float*) ((char*) base + FIELD_CACHE_OFFSET);
+
+	cout << "  > Field map " << identifier << " memory mapped from cache " << cachePath << endl;
+
+	return true;
 }
 
+void gMappedField::writeCache() const
+{
+	if(cachePath == "" || fieldValues == nullptr) return;
+
+	fieldMapCacheHeader header;
+	if(!fillCacheHeader(this, &header)) return;
+
+	// written to a temporary file and renamed, so concurrent jobs never see a partial cache
+	string tmpPath = cachePath + ".tmp." + to_string(getpid());
+	FILE *fp = fopen(tmpPath.c_str(), "wb");
+	if(fp == nullptr) {
+		cout << "  !! Warning: field map cache " << cachePath << " can't be written." << endl;
+		return;
+	}
+
+	char padding[FIELD_CACHE_OFFSET];
+	memset(padding, 0, FIELD_CACHE_OFFSET);
+	memcpy(padding, &header, sizeof(header));
+
+	bool written = fwrite(padding, 1, FIELD_CACHE_OFFSET, fp) == FIELD_CACHE_OFFSET
+	            && fwrite(fieldValues, sizeof(float), nvalues, fp) == nvalues;
+	written = (fclose(fp) == 0) && written;
 
+	if(!written || rename(tmpPath.c_str(), cachePath.c_str()) != 0) {
+		cout << "  !! Warning: field map cache " << cachePath << " can't be written." << endl;
+		remove(tmpPath.c_str());
+		return;
+	}
+
+	cout << "  > Field map " << identifier << " cached in " << cachePath << endl;
+}
 
 
 gcoord gMappedField::getCoordinateWithSpeed(int speed)
@@ -112,6 +250,7 @@ void gMappedField::initializeMap()
 		endMap = new double[2];		
 		cellSize = new double[2];
 		np       = new unsigned int[2];
+		ndims    = 2;
 
 		np[0]       = getCoordinateWithName("longitudinal").np;
 		np[1]       = getCoordinateWithName("transverse").np;
@@ -130,6 +269,7 @@ void gMappedField::initializeMap()
 		endMap = new double[2];				
 		cellSize = new double[2];
 		np       = new unsigned int[2];
+		ndims    = 2;
 		
 		np[0]       = getCoordinateWithName("transverse").np;
 		np[1]       = getCoordinateWithName("longitudinal").np;
@@ -148,6 +288,7 @@ void gMappedField::initializeMap()
 		endMap = new double[3];				
 		cellSize = new double[3];
 		np       = new unsigned int[3];
+		ndims    = 3;
 		
 		np[0]       = getCoordinateWithName("azimuthal").np;
 		np[1]       = getCoordinateWithName("transverse").np;
@@ -169,6 +310,7 @@ void gMappedField::initializeMap()
 		endMap = new double[3];				
 		cellSize = new double[3];
 		np       = new unsigned int[3];
+		ndims    = 3;
 		
 		np[0]       = getCoordinateWithName("X").np;
 		np[1]       = getCoordinateWithName("Y").np;
@@ -191,7 +333,56 @@ void gMappedField::initializeMap()
 	cosBeta = cos(mapRotation[1]);
 	sinGamma = sin(mapRotation[2]);
 	cosGamma = cos(mapRotation[2]);
-	
+
+	// combined rotation matrix: the rotations around x, then y, then z
+	// are applied to each axis unit vector, giving the matrix columns
+	hasRotation = mapRotation[0] != 0 || mapRotation[1] != 0 || mapRotation[2] != 0;
+	for(int j=0; j<3; j++) {
+		double axis[3] = {0, 0, 0};
+		axis[j] = 1;
+
+		if(mapRotation[0] != 0) {
+			double yPrime = yRotX(axis);
+			double zPrime = zRotX(axis);
+			axis[1] = yPrime;
+			axis[2] = zPrime;
+		}
+		if(mapRotation[1] != 0) {
+			double xPrime = xRotY(axis);
+			double zPrime = zRotY(axis);
+			axis[0] = xPrime;
+			axis[2] = zPrime;
+		}
+		if(mapRotation[2] != 0) {
+			double xPrime = xRotZ(axis);
+			double yPrime = yRotZ(axis);
+			axis[0] = xPrime;
+			axis[1] = yPrime;
+		}
+
+		for(int i=0; i<3; i++)
+			rotationMatrix[i][j] = axis[i];
+	}
+
+	// selecting the evaluator once, so GetFieldValue does not compare strings
+	// the scale factor is already applied to the map values when loading
+	evaluator = nullptr;
+
+	bool linear = interpolation == "linear";
+	if(interpolation != "linear" && interpolation != "none") {
+		cout << "  !! Unkown field interpolation method >" << interpolation << "< for map " << identifier << ". The field will be zero." << endl;
+		return;
+	}
+
+	     if(symmetry == "dipole-x")              evaluator = dipoleEvaluator(0, linear);
+	else if(symmetry == "dipole-y")              evaluator = dipoleEvaluator(1, linear);
+	else if(symmetry == "dipole-z")              evaluator = dipoleEvaluator(2, linear);
+	else if(symmetry == "cylindrical-x")         evaluator = cylindricalEvaluator(0, linear);
+	else if(symmetry == "cylindrical-y")         evaluator = cylindricalEvaluator(1, linear);
+	else if(symmetry == "cylindrical-z")         evaluator = cylindricalEvaluator(2, linear);
+	else if(symmetry == "phi-segmented")         evaluator = phiSegmentedEvaluator(linear);
+	else if(symmetry == "cartesian_3D")          evaluator = cartesian3dEvaluator(false, linear);
+	else if(symmetry == "cartesian_3D_quadrant") evaluator = cartesian3dEvaluator(true,  linear);
 }
 
 
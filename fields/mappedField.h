@@ -65,8 +65,9 @@ public:
 		unit          = "gauss";
 		interpolation = "linear";
 		verbosity     = 0;
+		ndims         = 0;
 	}
-	~gMappedField(){;}
+	~gMappedField();
 	
 	string identifier;          ///< Pointer to map in factory (for example, hostname / filename with path / date)
 	string symmetry;            ///< map symmetry
@@ -81,14 +82,32 @@ public:
 	string interpolation;       ///< map interpolation technique. Choices are "none", "linear", "quadratic"
 	int verbosity;              ///< map verbosity
 	
-	// field depending on 3D map
-	float ***B1_3D;
-    float ***B2_3D;
-    float ***B3_3D;
-	
-	// field depending on 2D map
-    float **B1_2D;
-    float **B2_2D;
+	// field values: one contiguous array for the whole map
+	// the ncomponents values of each map point are next to each other
+	// (B1, B2) for 2D maps, (B1, B2, B3) for 3D maps
+	float *fieldValues = nullptr;
+	unsigned int ncomponents = 0;   ///< field components stored for each map point
+	size_t nvalues = 0;             ///< size of fieldValues
+	bool memoryMapped = false;      ///< fieldValues points to the memory mapped cache file
+	void *mappedBase  = nullptr;    ///< start of the memory mapped cache file
+	size_t mappedSize = 0;          ///< size of the memory mapped cache file
+
+	// first component of the map point. The indexes follow the np order
+	inline float *B2D(unsigned int i, unsigned int j) const {
+		return fieldValues + ((size_t) i*np[1] + j)*ncomponents;
+	}
+	inline float *B3D(unsigned int i, unsigned int j, unsigned int k) const {
+		return fieldValues + (((size_t) i*np[1] + j)*np[2] + k)*ncomponents;
+	}
+
+	// allocates fieldValues for the map points, ncomp values each
+	void allocateValues(unsigned int ncomp);
+
+	// binary cache of the loaded map, see FIELD_MAP_CACHE
+	// empty: no cache
+	string cachePath;
+	bool loadCache();         ///< memory maps the cache if it matches the map file. Returns false otherwise
+	void writeCache() const;  ///< writes the loaded values to the cache
 	
 	// these are initialized based on the map
 	// symmetry and coordinates
@@ -98,23 +117,40 @@ public:
 	double *endMap;	
 	double *cellSize;
 	unsigned int *np;
+	unsigned int ndims;         ///< number of coordinates: size of the arrays above
 	void initializeMap();
 	
 	gcoord getCoordinateWithSpeed(int speed);   ///< return coordinate based on speed
 	gcoord getCoordinateWithName(string name);  ///< return coordinate based on type
 	
-	// returns the field at point x. This is a dispatcher for the various symmetries below
+	// returns the field at point x. Calls the evaluator selected by initializeMap
 	void GetFieldValue( const double x[3], double *Bfield) const;
-	
-	void GetFieldValue_Dipole( const double x[3], double *Bfield, int FIRST_ONLY) const;
-	void GetFieldValue_Cylindrical( const double x[3], double *Bfield, int FIRST_ONLY) const;
-	void GetFieldValue_phiSegmented( const double x[3], double *Bfield, int FIRST_ONLY) const;
-	void GetFieldValue_cartesian3d( const double x[3], double *Bfield, int FIRST_ONLY) const;
-	
+
+	// evaluators, specialized for the map axis and the interpolation
+	// AXIS: 0, 1, 2 for x, y, z
+	typedef void (gMappedField::*fieldEvaluator)( const double x[3], double *Bfield, int FIRST_ONLY) const;
+	fieldEvaluator evaluator = nullptr;   ///< set by initializeMap. nullptr: no field
+
+	template<int AXIS, bool LINEAR> void GetFieldValue_Dipole( const double x[3], double *Bfield, int FIRST_ONLY) const;
+	template<int AXIS, bool LINEAR> void GetFieldValue_Cylindrical( const double x[3], double *Bfield, int FIRST_ONLY) const;
+	template<bool LINEAR>           void GetFieldValue_phiSegmented( const double x[3], double *Bfield, int FIRST_ONLY) const;
+	template<bool QUADRANT, bool LINEAR> void GetFieldValue_cartesian3d( const double x[3], double *Bfield, int FIRST_ONLY) const;
+
+	// return the evaluator for the symmetry and interpolation
+	// defined with the evaluators so that they are instantiated there
+	fieldEvaluator dipoleEvaluator(int axis, bool linear) const;
+	fieldEvaluator cylindricalEvaluator(int axis, bool linear) const;
+	fieldEvaluator phiSegmentedEvaluator(bool linear) const;
+	fieldEvaluator cartesian3dEvaluator(bool quadrant, bool linear) const;
+
 	// precalculating values of the rotation angles so we don't do it at GetFieldValue time
 	double sinAlpha, cosAlhpa;
 	double sinBeta, cosBeta;
 	double sinGamma, cosGamma;
+
+	// the rotations around x, y, z combined in one matrix by initializeMap
+	bool   hasRotation = false;
+	double rotationMatrix[3][3];
 	void RotateField( double *Bfield) const;
 
 	// we want to rotate the field (axes), not the point
@@ -8,7 +8,7 @@
 // 3D field in cartesian coordinates. Field itself is in cartesian coordinates.
 // Dependent on 3 cartesian coordinates (Y, X, Z) 
 // The values can be loaded from the map in any order as long as their speed is ordered.
-// The values are indexed as B1_3D[X][Y][Z],B2_3D[X][Y][Z],B3_3D[X][Y][Z]
+// The values are indexed as B3D(X, Y, Z), with the three components next to each other
 // The field is three dimensional, ordered in the class as B1=Bx, B2=By, B3=Bz
 
 // symmetry "cartesian_3D" is for full 3D map
@@ -33,20 +33,7 @@ void asciiField::loadFieldMap_cartesian3d(gMappedField* map, double verbosity)
 
 	// Allocate memory. [AZI][TRANSVERSE][LONGI]
 	// as initialized in the map
-	map->B1_3D = new float**[map->np[0]];
-	map->B2_3D = new float**[map->np[0]];
-	map->B3_3D = new float**[map->np[0]];
-	for (unsigned i = 0; i < map->np[0]; ++i) {
-		map->B1_3D[i] = new float*[map->np[1]];
-		map->B2_3D[i] = new float*[map->np[1]];
-		map->B3_3D[i] = new float*[map->np[1]];
-		for (unsigned j = 0; j < map->np[1]; ++j) {
-			map->B1_3D[i][j] = new float[map->np[2]];
-			map->B2_3D[i][j] = new float[map->np[2]];
-			map->B3_3D[i][j] = new float[map->np[2]];
-
-		}
-	}
+	map->allocateValues(3);
 
 	double unit1 = get_number("1*" + map->getCoordinateWithSpeed(0).unit);
 	double unit2 = get_number("1*" + map->getCoordinateWithSpeed(1).unit);
@@ -108,13 +95,13 @@ void asciiField::loadFieldMap_cartesian3d(gMappedField* map, double verbosity)
 					unsigned t2 = (unsigned) floor( ( d2 - min2 + cell2/2 ) / ( cell2 ) ) ;
 					unsigned t3 = (unsigned) floor( ( d3 - min3 + cell3/2 ) / ( cell3 ) ) ;
 
-					// The values are indexed as B1_3D[X][Y][Z]
+					// The values are indexed as B3D(X, Y, Z)
 					if(   map->getCoordinateWithSpeed(0).name == "X"
 					   && map->getCoordinateWithSpeed(1).name == "Y"
 					   && map->getCoordinateWithSpeed(2).name == "Z" ) {
-						map->B1_3D[t1][t2][t3] = b1;
-						map->B2_3D[t1][t2][t3] = b2;
-						map->B3_3D[t1][t2][t3] = b3;
+						map->B3D(t1, t2, t3)[0] = b1;
+						map->B3D(t1, t2, t3)[1] = b2;
+						map->B3D(t1, t2, t3)[2] = b3;
 					} else if(   map->getCoordinateWithSpeed(0).name == "X"
 							  && map->getCoordinateWithSpeed(1).name == "Z"
 							  && map->getCoordinateWithSpeed(2).name == "Y" ) {
@@ -122,9 +109,9 @@ void asciiField::loadFieldMap_cartesian3d(gMappedField* map, double verbosity)
 						t2 = (unsigned) floor( ( d3 - min3 + cell3/2 ) / ( cell3 ) ) ;
 						t3 = (unsigned) floor( ( d2 - min2 + cell2/2 ) / ( cell2 ) ) ;
 
-						map->B1_3D[t1][t3][t2] = b1;
-						map->B2_3D[t1][t3][t2] = b2;
-						map->B3_3D[t1][t3][t2] = b3;
+						map->B3D(t1, t3, t2)[0] = b1;
+						map->B3D(t1, t3, t2)[1] = b2;
+						map->B3D(t1, t3, t2)[2] = b3;
 					} else if(   map->getCoordinateWithSpeed(0).name == "Z"
 							  && map->getCoordinateWithSpeed(1).name == "X"
 							  && map->getCoordinateWithSpeed(2).name == "Y" ) {
@@ -132,9 +119,9 @@ void asciiField::loadFieldMap_cartesian3d(gMappedField* map, double verbosity)
 						t2 = (unsigned) floor( ( d1 - min1 + cell1/2 ) / ( cell1 ) ) ;
 						t3 = (unsigned) floor( ( d2 - min2 + cell2/2 ) / ( cell2 ) ) ;
 
-						map->B1_3D[t3][t1][t2] = b1;
-						map->B2_3D[t3][t1][t2] = b2;
-						map->B3_3D[t3][t1][t2] = b3;
+						map->B3D(t3, t1, t2)[0] = b1;
+						map->B3D(t3, t1, t2)[1] = b2;
+						map->B3D(t3, t1, t2)[2] = b3;
 					} else if(   map->getCoordinateWithSpeed(0).name == "Z"
 							  && map->getCoordinateWithSpeed(1).name == "Y"
 							  && map->getCoordinateWithSpeed(2).name == "X" ) {
@@ -142,9 +129,9 @@ void asciiField::loadFieldMap_cartesian3d(gMappedField* map, double verbosity)
 						t2 = (unsigned) floor( ( d2 - min2 + cell2/2 ) / ( cell2 ) ) ;
 						t3 = (unsigned) floor( ( d1 - min1 + cell1/2 ) / ( cell1 ) ) ;
 
-						map->B1_3D[t3][t2][t1] = b1;
-						map->B2_3D[t3][t2][t1] = b2;
-						map->B3_3D[t3][t2][t1] = b3;
+						map->B3D(t3, t2, t1)[0] = b1;
+						map->B3D(t3, t2, t1)[1] = b2;
+						map->B3D(t3, t2, t1)[2] = b3;
 					} else if(   map->getCoordinateWithSpeed(0).name == "Y"
 							  && map->getCoordinateWithSpeed(1).name == "Z"
 							  && map->getCoordinateWithSpeed(2).name == "X" ) {
@@ -152,9 +139,9 @@ void asciiField::loadFieldMap_cartesian3d(gMappedField* map, double verbosity)
 						t2 = (unsigned) floor( ( d3 - min3 + cell3/2 ) / ( cell3 ) ) ;
 						t3 = (unsigned) floor( ( d1 - min1 + cell1/2 ) / ( cell1 ) ) ;
 
-						map->B1_3D[t2][t3][t1] = b1;
-						map->B2_3D[t2][t3][t1] = b2;
-						map->B3_3D[t2][t3][t1] = b3;
+						map->B3D(t2, t3, t1)[0] = b1;
+						map->B3D(t2, t3, t1)[1] = b2;
+						map->B3D(t2, t3, t1)[2] = b3;
 					} else if(   map->getCoordinateWithSpeed(0).name == "Y"
 							  && map->getCoordinateWithSpeed(1).name == "X"
 							  && map->getCoordinateWithSpeed(2).name == "Z" ) {
@@ -162,9 +149,9 @@ void asciiField::loadFieldMap_cartesian3d(gMappedField* map, double verbosity)
 						t2 = (unsigned) floor( ( d1 - min1 + cell1/2 ) / ( cell1 ) ) ;
 						t3 = (unsigned) floor( ( d3 - min3 + cell3/2 ) / ( cell3 ) ) ;
 						
-						map->B1_3D[t2][t1][t3] = b1;
-						map->B2_3D[t2][t1][t3] = b2;
-						map->B3_3D[t2][t1][t3] = b3;
+						map->B3D(t2, t1, t3)[0] = b1;
+						map->B3D(t2, t1, t3)[1] = b2;
+						map->B3D(t2, t1, t3)[2] = b3;
 					}
 
 					if(verbosity>4 && verbosity != 99) {
@@ -196,6 +183,8 @@ void asciiField::loadFieldMap_cartesian3d(gMappedField* map, double verbosity)
 }
 
 // from mappedField:  GetFieldValue
+// QUADRANT: the map covers only the first quadrant (cartesian_3D_quadrant)
+template<bool QUADRANT, bool LINEAR>
 void gMappedField::GetFieldValue_cartesian3d( const double x[3], double *Bfield, int FIRST_ONLY) const
 {
 	double xx = x[0];
@@ -206,9 +195,9 @@ void gMappedField::GetFieldValue_cartesian3d( const double x[3], double *Bfield,
 	double YY = 0;
 	double ZZ = 0;
 	
-	if(symmetry == "cartesian_3D"){
+	if(!QUADRANT){
 		XX = xx; 	  YY = yy; 	  ZZ = zz;
-	}else if (symmetry == "cartesian_3D_quadrant"){
+	}else {
 	  if (xx>=0 && yy>=0)	{ XX = xx; 	  YY = yy; 	  ZZ = zz;}
 	  if (xx>=0 && yy<0)	{ XX = -yy; 	  YY = xx; 	  ZZ = zz;}
 	  if (xx<0 && yy<0)	{ XX = -xx; 	  YY = -yy; 	  ZZ = zz;}
@@ -229,16 +218,16 @@ void gMappedField::GetFieldValue_cartesian3d( const double x[3], double *Bfield,
 	
 	double B1,B2,B3;
 	// no interpolation
-	if(interpolation == "none") {
+	if(!LINEAR) {
 		// checking if the point is closer to the top of the cell
 		if( fabs( startMap[0] + IXX*cellSize[0] - XX) > fabs( startMap[0] + (IXX+1)*cellSize[0] - XX)  ) IXX++;
 		if( fabs( startMap[0] + IYY*cellSize[0] - YY) > fabs( startMap[0] + (IYY+1)*cellSize[0] - YY)  ) IYY++;
 		if( fabs( startMap[0] + IZZ*cellSize[0] - ZZ) > fabs( startMap[0] + (IZZ+1)*cellSize[0] - ZZ)  ) IZZ++;
 		
-		B1 = B1_3D[IXX][IYY][IZZ];
-		B2 = B2_3D[IXX][IYY][IZZ];
-		B3 = B3_3D[IXX][IYY][IZZ];
-	} else if (interpolation == "linear") {
+		B1 = B3D(IXX, IYY, IZZ)[0];
+		B2 = B3D(IXX, IYY, IZZ)[1];
+		B3 = B3D(IXX, IYY, IZZ)[2];
+	} else {
 		
 		// relative positions within cell
 		double Xd = (XX - (startMap[0] + IXX*cellSize[0])) / cellSize[0];
@@ -248,41 +237,36 @@ void gMappedField::GetFieldValue_cartesian3d( const double x[3], double *Bfield,
 		// field component interpolation 
 		// The result of trilinear interpolation is independent of the order of the interpolation steps along the three axe, refer to https://en.wikipedia.org/wiki/Trilinear_interpolation		
 		double c00,c01,c10,c11,c0,c1;
-		c00 = B1_3D[IXX][IYY][IZZ]*(1-Xd) + B1_3D[IXX+1][IYY][IZZ]*Xd;
-		c01 = B1_3D[IXX][IYY][IZZ+1]*(1-Xd) + B1_3D[IXX+1][IYY][IZZ+1]*Xd;
-		c10 = B1_3D[IXX][IYY+1][IZZ]*(1-Xd) + B1_3D[IXX+1][IYY+1][IZZ]*Xd;
-		c11 = B1_3D[IXX][IYY+1][IZZ+1]*(1-Xd) + B1_3D[IXX+1][IYY+1][IZZ+1]*Xd;
+		c00 = B3D(IXX, IYY, IZZ)[0]*(1-Xd) + B3D(IXX+1, IYY, IZZ)[0]*Xd;
+		c01 = B3D(IXX, IYY, IZZ+1)[0]*(1-Xd) + B3D(IXX+1, IYY, IZZ+1)[0]*Xd;
+		c10 = B3D(IXX, IYY+1, IZZ)[0]*(1-Xd) + B3D(IXX+1, IYY+1, IZZ)[0]*Xd;
+		c11 = B3D(IXX, IYY+1, IZZ+1)[0]*(1-Xd) + B3D(IXX+1, IYY+1, IZZ+1)[0]*Xd;
 		c0  = c00*(1-Yd) + c10*Yd;
 		c1  = c01*(1-Yd) + c11*Yd;		
 		B1  = c0*(1-Zd) + c1*Zd;
 		
-		c00 = B2_3D[IXX][IYY][IZZ]*(1-Xd) + B2_3D[IXX+1][IYY][IZZ]*Xd;
-		c01 = B2_3D[IXX][IYY][IZZ+1]*(1-Xd) + B2_3D[IXX+1][IYY][IZZ+1]*Xd;
-		c10 = B2_3D[IXX][IYY+1][IZZ]*(1-Xd) + B2_3D[IXX+1][IYY+1][IZZ]*Xd;
-		c11 = B2_3D[IXX][IYY+1][IZZ+1]*(1-Xd) + B2_3D[IXX+1][IYY+1][IZZ+1]*Xd;
+		c00 = B3D(IXX, IYY, IZZ)[1]*(1-Xd) + B3D(IXX+1, IYY, IZZ)[1]*Xd;
+		c01 = B3D(IXX, IYY, IZZ+1)[1]*(1-Xd) + B3D(IXX+1, IYY, IZZ+1)[1]*Xd;
+		c10 = B3D(IXX, IYY+1, IZZ)[1]*(1-Xd) + B3D(IXX+1, IYY+1, IZZ)[1]*Xd;
+		c11 = B3D(IXX, IYY+1, IZZ+1)[1]*(1-Xd) + B3D(IXX+1, IYY+1, IZZ+1)[1]*Xd;
 		c0  = c00*(1-Yd) + c10*Yd;
 		c1  = c01*(1-Yd) + c11*Yd;		
 		B2  = c0*(1-Zd) + c1*Zd;
 
-		c00 = B3_3D[IXX][IYY][IZZ]*(1-Xd) + B3_3D[IXX+1][IYY][IZZ]*Xd;
-		c01 = B3_3D[IXX][IYY][IZZ+1]*(1-Xd) + B3_3D[IXX+1][IYY][IZZ+1]*Xd;
-		c10 = B3_3D[IXX][IYY+1][IZZ]*(1-Xd) + B3_3D[IXX+1][IYY+1][IZZ]*Xd;
-		c11 = B3_3D[IXX][IYY+1][IZZ+1]*(1-Xd) + B3_3D[IXX+1][IYY+1][IZZ+1]*Xd;
+		c00 = B3D(IXX, IYY, IZZ)[2]*(1-Xd) + B3D(IXX+1, IYY, IZZ)[2]*Xd;
+		c01 = B3D(IXX, IYY, IZZ+1)[2]*(1-Xd) + B3D(IXX+1, IYY, IZZ+1)[2]*Xd;
+		c10 = B3D(IXX, IYY+1, IZZ)[2]*(1-Xd) + B3D(IXX+1, IYY+1, IZZ)[2]*Xd;
+		c11 = B3D(IXX, IYY+1, IZZ+1)[2]*(1-Xd) + B3D(IXX+1, IYY+1, IZZ+1)[2]*Xd;
 		c0  = c00*(1-Yd) + c10*Yd;
 		c1  = c01*(1-Yd) + c11*Yd;		
 		B3  = c0*(1-Zd) + c1*Zd;		
 	}
-	else
-	{
-		cout << "  !! Unkown field interpolation method >" << interpolation << "<" << endl;
-		return;
-	}	
 	
-	if(symmetry == "cartesian_3D"){
+	if(!QUADRANT){
 		Bfield[0] = B1;
 		Bfield[1] = B2;
 		Bfield[2] = B3;
-	}else if (symmetry == "cartesian_3D_quadrant"){
+	}else {
 	  if (xx>=0 && yy>=0)	{ Bfield[0] = B1; Bfield[1] = B2; Bfield[2] = B3;}
 	  if (xx>=0 && yy<0)	{ Bfield[0] = B2; Bfield[1] =-B1; Bfield[2] = B3;}
 	  if (xx<0 && yy<0)	    { Bfield[0] =-B1; Bfield[1] =-B2; Bfield[2] = B3;}
@@ -309,3 +293,14 @@ void gMappedField::GetFieldValue_cartesian3d( const double x[3], double *Bfield,
 		cout << "B = ("   << Bfield[0]/gauss << ",  " << Bfield[1]/gauss << ",  " << Bfield[2]/gauss << ") gauss " << endl;
 	}
 }
+
+// from mappedField:  initializeMap
+gMappedField::fieldEvaluator gMappedField::cartesian3dEvaluator(bool quadrant, bool linear) const
+{
+	if(quadrant) {
+		if(linear) return &gMappedField::GetFieldValue_cartesian3d<true, true>;
+		return &gMappedField::GetFieldValue_cartesian3d<true, false>;
+	}
+	if(linear) return &gMappedField::GetFieldValue_cartesian3d<false, true>;
+	return &gMappedField::GetFieldValue_cartesian3d<false, false>;
+}
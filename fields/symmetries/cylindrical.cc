@@ -11,7 +11,7 @@
 // Expressed in Cylindrical coordinate
 // The values can be loaded from the map in any order
 // as long as their speed is ordered.
-// The values are indexed as B1_2D[transverse][longi]
+// The values are indexed as B2D(transverse, longi)
 // The field is two dimensional, ordered in the class as B1=BT, B2=BL
 
 
@@ -29,13 +29,7 @@ void asciiField::loadFieldMap_Cylindrical(gMappedField* map, double verbosity)
 
 	// Allocate memory. [LONGI][TRANSVERSE]
 	// as initialized in the map
-	map->B1_2D = new float*[map->np[0]];
-	map->B2_2D = new float*[map->np[0]];
-	for (unsigned int i = 0; i < map->np[0]; ++i)
-	{
-		map->B1_2D[i] = new float[map->np[1]];
-		map->B2_2D[i] = new float[map->np[1]];
-	}
+	map->allocateValues(2);
 
 	double unit1 = get_number("1*" + map->getCoordinateWithSpeed(0).unit);
 	double unit2 = get_number("1*" + map->getCoordinateWithSpeed(1).unit);
@@ -88,16 +82,16 @@ void asciiField::loadFieldMap_Cylindrical(gMappedField* map, double verbosity)
 				unsigned t1 = (unsigned) floor( ( d1 - min1 + cell1/2 ) / ( cell1 ) ) ;
 				unsigned t2 = (unsigned) floor( ( d2 - min2 + cell2/2 ) / ( cell2 ) ) ;
 
-				// The values are indexed as B1_2D[transverse][longi]
+				// The values are indexed as B2D(transverse, longi)
 				if(   map->getCoordinateWithSpeed(0).name == "transverse"
 					&& map->getCoordinateWithSpeed(1).name == "longitudinal") {
-					map->B1_2D[t1][t2] = b1;
-					map->B2_2D[t1][t2] = b2;
+					map->B2D(t1, t2)[0] = b1;
+					map->B2D(t1, t2)[1] = b2;
 				}
 				if(   map->getCoordinateWithSpeed(0).name == "longitudinal"
 					&& map->getCoordinateWithSpeed(1).name == "transverse") {
-					map->B1_2D[t2][t1] = b1;
-					map->B2_2D[t2][t1] = b2;
+					map->B2D(t2, t1)[0] = b1;
+					map->B2D(t2, t1)[1] = b2;
 				}
 			}
 		}
@@ -120,6 +114,8 @@ void asciiField::loadFieldMap_Cylindrical(gMappedField* map, double verbosity)
 }
 
 // from mappedField:  GetFieldValue
+// AXIS is the cylinder axis: 0, 1, 2 for cylindrical-x, cylindrical-y, cylindrical-z
+template<int AXIS, bool LINEAR>
 void gMappedField::GetFieldValue_Cylindrical( const double x[3], double *Bfield, int FIRST_ONLY) const
 {
 	double LC  = 0;    // longitudinal
@@ -127,17 +123,17 @@ void gMappedField::GetFieldValue_Cylindrical( const double x[3], double *Bfield,
 	double phi = 0;    // phi angle
 
 	// map plane is in ZX, phi on X axis
-	if(symmetry == "cylindrical-z") {
+	if(AXIS == 2) {
 		LC  = x[2];
 		TC  = sqrt(x[0]*x[0] + x[1]*x[1]);
 		phi = G4ThreeVector(x[0], x[1], x[2]).phi();
 	// map plane is in XY, phi on Y axis
-	} else if(symmetry == "cylindrical-x") {
+	} else if(AXIS == 0) {
 		LC  = x[0];
 		TC  = sqrt(x[1]*x[1] + x[2]*x[2]);
 		phi = G4ThreeVector(x[1], x[2], x[0]).phi();  // right hand rule
 	// map plane is in XZ, phi on Z axis
-	} else if(symmetry == "cylindrical-y") {
+	} else if(AXIS == 1) {
 		LC  = x[1];
 		TC  = sqrt(x[0]*x[0] + x[2]*x[2]);
 		phi = G4ThreeVector(x[2], x[0], x[1]).phi(); // right hand rule
@@ -155,55 +151,52 @@ void gMappedField::GetFieldValue_Cylindrical( const double x[3], double *Bfield,
 	if(IT>=np[0]-1 || IL>=np[1]-1) return;
 
 	// no interpolation
-	if(interpolation == "none") {
+	if(!LINEAR) {
 		// checking if the point is closer to the top of the cell
 		if( fabs( startMap[0] + IT*cellSize[0] - TC) > fabs( startMap[0] + (IT+1)*cellSize[0] - TC)  ) IT++;
 		if( fabs( startMap[1] + IL*cellSize[1] - LC) > fabs( startMap[1] + (IL+1)*cellSize[1] - LC)  ) IL++;
 
-		if(symmetry == "cylindrical-z") {
-			Bfield[0] = B1_2D[IT][IL] * cos(phi);
-			Bfield[1] = B1_2D[IT][IL] * sin(phi);
-			Bfield[2] = B2_2D[IT][IL];
-		} else if(symmetry == "cylindrical-x") {
-			Bfield[0] = B2_2D[IT][IL];
-			Bfield[1] = B1_2D[IT][IL] * cos(phi);
-			Bfield[2] = B1_2D[IT][IL] * sin(phi);
-		} else if(symmetry == "cylindrical-y") {
-			Bfield[1] = B2_2D[IT][IL];
-			Bfield[0] = B1_2D[IT][IL] * sin(phi);
-			Bfield[2] = B1_2D[IT][IL] * cos(phi);
+		if(AXIS == 2) {
+			Bfield[0] = B2D(IT, IL)[0] * cos(phi);
+			Bfield[1] = B2D(IT, IL)[0] * sin(phi);
+			Bfield[2] = B2D(IT, IL)[1];
+		} else if(AXIS == 0) {
+			Bfield[0] = B2D(IT, IL)[1];
+			Bfield[1] = B2D(IT, IL)[0] * cos(phi);
+			Bfield[2] = B2D(IT, IL)[0] * sin(phi);
+		} else if(AXIS == 1) {
+			Bfield[1] = B2D(IT, IL)[1];
+			Bfield[0] = B2D(IT, IL)[0] * sin(phi);
+			Bfield[2] = B2D(IT, IL)[0] * cos(phi);
 		}
-	} else if (interpolation == "linear") {
+	} else {
 		// relative positions within cell
 		double xtr = (TC - (startMap[0] + IT*cellSize[0])) / cellSize[0];
 		double xlr = (LC - (startMap[1] + IL*cellSize[1])) / cellSize[1];
 
 		// first field component interpolation
-		double b10 = B1_2D[IT][IL]   * (1.0 - xtr) + B1_2D[IT+1][IL]   * xtr;
-		double b11 = B1_2D[IT][IL+1] * (1.0 - xtr) + B1_2D[IT+1][IL+1] * xtr;
+		double b10 = B2D(IT, IL)[0]   * (1.0 - xtr) + B2D(IT+1, IL)[0]   * xtr;
+		double b11 = B2D(IT, IL+1)[0] * (1.0 - xtr) + B2D(IT+1, IL+1)[0] * xtr;
 		double b1  = b10 * (1.0 - xlr) + b11 * xlr;
 
 		// second field component interpolation
-		double b20 = B2_2D[IT][IL]   * (1.0 - xtr) + B2_2D[IT+1][IL]   * xtr;
-		double b21 = B2_2D[IT][IL+1] * (1.0 - xtr) + B2_2D[IT+1][IL+1] * xtr;
+		double b20 = B2D(IT, IL)[1]   * (1.0 - xtr) + B2D(IT+1, IL)[1]   * xtr;
+		double b21 = B2D(IT, IL+1)[1] * (1.0 - xtr) + B2D(IT+1, IL+1)[1] * xtr;
 		double b2 = b20 * (1.0 - xlr) + b21 * xlr;
 
-		if(symmetry == "cylindrical-z") {
+		if(AXIS == 2) {
 			Bfield[0] = b1 * cos(phi);
 			Bfield[1] = b1 * sin(phi);
 			Bfield[2] = b2;
-		} else if(symmetry == "cylindrical-x") {
+		} else if(AXIS == 0) {
 			Bfield[0] = b2;
 			Bfield[1] = b1 * cos(phi);
 			Bfield[2] = b1 * sin(phi);
-		} else if(symmetry == "cylindrical-y") {
+		} else if(AXIS == 1) {
 			Bfield[1] = b2;
 			Bfield[0] = b1 * sin(phi);
 			Bfield[2] = b1 * cos(phi);
 		}
-	} else {
-		cout << "  !! Unkown field interpolation method >" << interpolation << "<" << endl;
-		return;
 	}
 
 	// field rotation based on ROTATE_FIELDMAP
@@ -225,3 +218,16 @@ void gMappedField::GetFieldValue_Cylindrical( const double x[3], double *Bfield,
 		cout << "B = ("   << Bfield[0]/gauss << ",  " << Bfield[1]/gauss << ",  " << Bfield[2]/gauss << ") gauss " << endl;
 	}
 }
+
+// from mappedField:  initializeMap
+gMappedField::fieldEvaluator gMappedField::cylindricalEvaluator(int axis, bool linear) const
+{
+	if(linear) {
+		if(axis == 0) return &gMappedField::GetFieldValue_Cylindrical<0, true>;
+		if(axis == 1) return &gMappedField::GetFieldValue_Cylindrical<1, true>;
+		return &gMappedField::GetFieldValue_Cylindrical<2, true>;
+	}
+	if(axis == 0) return &gMappedField::GetFieldValue_Cylindrical<0, false>;
+	if(axis == 1) return &gMappedField::GetFieldValue_Cylindrical<1, false>;
+	return &gMappedField::GetFieldValue_Cylindrical<2, false>;
+}
@@ -10,7 +10,7 @@
 // uniform in the other coordinate
 // The values can be loaded from the map in any order
 // as long as their speed is ordered.
-// The values are indexed as B1_2D[longi][transverse]
+// The values are indexed as B2D(longi, transverse)
 
 
 // from fieldFactory:  load field map
@@ -29,9 +29,7 @@ void asciiField::loadFieldMap_Dipole(gMappedField* map, double verbosity)
 
 	// Allocate memory. [LONGI][TRANSVERSE]
 	// as initialized in the map
-	map->B1_2D = new float*[map->np[0]];
-	for (unsigned int i = 0; i < map->np[0]; ++i)
-		map->B1_2D[i] = new float[map->np[1]];
+	map->allocateValues(1);
 
 
 	double unit1 = get_number("1*" + map->getCoordinateWithSpeed(0).unit);
@@ -90,16 +88,16 @@ void asciiField::loadFieldMap_Dipole(gMappedField* map, double verbosity)
 				unsigned t1 = (unsigned) floor( ( d1 - min1 + cell1/2 ) / ( cell1 ) ) ;
 				unsigned t2 = (unsigned) floor( ( d2 - min2 + cell2/2 ) / ( cell2 ) ) ;
 
-				// The values are indexed as B1_2D[longi][transverse]
+				// The values are indexed as B2D(longi, transverse)
 				if(   map->getCoordinateWithSpeed(0).name == "longitudinal"
 				   && map->getCoordinateWithSpeed(1).name == "transverse") {
-					map->B1_2D[t1][t2] = b;
+					map->B2D(t1, t2)[0] = b;
 				} else if(   map->getCoordinateWithSpeed(0).name == "transverse"
 						  && map->getCoordinateWithSpeed(1).name == "longitudinal") {
 
 					t1 = (unsigned) floor( ( d2 - min2 + cell2/2 ) / ( cell2 ) ) ;
 					t2 = (unsigned) floor( ( d1 - min1 + cell1/2 ) / ( cell1 ) ) ;
-					map->B1_2D[t2][t1] = b;
+					map->B2D(t2, t1)[0] = b;
 				}
 			}
 		}
@@ -122,18 +120,20 @@ void asciiField::loadFieldMap_Dipole(gMappedField* map, double verbosity)
 }
 
 // from mappedField:  GetFieldValue
+// AXIS is the field direction: 0, 1, 2 for dipole-x, dipole-y, dipole-z
+template<int AXIS, bool LINEAR>
 void gMappedField::GetFieldValue_Dipole( const double x[3], double *Bfield, int FIRST_ONLY) const
 {
 	double LC = 0;     	// longitudinal
 	double TC = 0;     	// transverse
 
-	if(symmetry == "dipole-z") {
+	if(AXIS == 2) {
 		TC  = fabs(x[0]);
 		LC  = x[1];
-	} else if(symmetry == "dipole-x") {
+	} else if(AXIS == 0) {
 		TC  = fabs(x[1]);
 		LC  = x[2];
-	} else if(symmetry == "dipole-y") {
+	} else if(AXIS == 1) {
 		TC  = fabs(x[0]);
 		LC  = x[2];
 	}
@@ -155,30 +155,23 @@ void gMappedField::GetFieldValue_Dipole( const double x[3], double *Bfield, int
 	}
 	
 	// no interpolation
-	if(interpolation == "none") {
+	if(!LINEAR) {
 		// checking if the point is closer to the top of the cell
 		if( fabs( startMap[0] + IL*cellSize[0] - LC) > fabs( startMap[0] + (IL+1)*cellSize[0] - LC)  ) IL++;
 		if( fabs( startMap[1] + IT*cellSize[1] - TC) > fabs( startMap[1] + (IT+1)*cellSize[1] - TC)  ) IT++;
 
-			  if(symmetry == "dipole-x") Bfield[0] = B1_2D[IL][IT];
-		else if(symmetry == "dipole-y") Bfield[1] = B1_2D[IL][IT];
-		else if(symmetry == "dipole-z") Bfield[2] = B1_2D[IL][IT];
-	} else if (interpolation == "linear") {
+		Bfield[AXIS] = B2D(IL, IT)[0];
+	} else {
 		// relative positions within cell
 		double xlr = (LC - (startMap[0] + IL*cellSize[0])) / cellSize[0];
 		double xtr = (TC - (startMap[1] + IT*cellSize[1])) / cellSize[1];
 
 		// linear interpolation
-		double b10 = B1_2D[IL][IT]   * (1.0 - xtr) + B1_2D[IL][IT+1]   * xtr;
-		double b11 = B1_2D[IL+1][IT] * (1.0 - xtr) + B1_2D[IL+1][IT+1] * xtr;
+		double b10 = B2D(IL, IT)[0]   * (1.0 - xtr) + B2D(IL, IT+1)[0]   * xtr;
+		double b11 = B2D(IL+1, IT)[0] * (1.0 - xtr) + B2D(IL+1, IT+1)[0] * xtr;
 		double b1  = b10 * (1.0 - xlr) + b11 * xlr;
 
-		     if(symmetry == "dipole-x") Bfield[0] = b1;
-		else if(symmetry == "dipole-y") Bfield[1] = b1;
-		else if(symmetry == "dipole-z") Bfield[2] = b1;
-	} else {
-		cout << "  !! Unkown field interpolation method >" << interpolation << "<" << endl;
-		return;
+		Bfield[AXIS] = b1;
 	}
 
 
@@ -201,3 +194,16 @@ void gMappedField::GetFieldValue_Dipole( const double x[3], double *Bfield, int
 
 	}
 }
+
+// from mappedField:  initializeMap
+gMappedField::fieldEvaluator gMappedField::dipoleEvaluator(int axis, bool linear) const
+{
+	if(linear) {
+		if(axis == 0) return &gMappedField::GetFieldValue_Dipole<0, true>;
+		if(axis == 1) return &gMappedField::GetFieldValue_Dipole<1, true>;
+		return &gMappedField::GetFieldValue_Dipole<2, true>;
+	}
+	if(axis == 0) return &gMappedField::GetFieldValue_Dipole<0, false>;
+	if(axis == 1) return &gMappedField::GetFieldValue_Dipole<1, false>;
+	return &gMappedField::GetFieldValue_Dipole<2, false>;
+}
@@ -10,7 +10,7 @@
 // phi-segmented 3D field in cylindrical coordinates. Field itself is in cartesian coordinates.
 // Dependent on 3 cartesian coordinates (transverse, azimuthal, longitudinal) expressed in cylindrical coordinate
 // The values can be loaded from the map in any order as long as their speed is ordered.
-// The values are indexed as B1_3D[transverse][longi]
+// The values are indexed as B3D(azimuthal, transverse, longi)
 // The field is two dimensional, ordered in the class as B1=BT, B2=BL
 
 
@@ -31,22 +31,7 @@ void asciiField::loadFieldMap_phiSegmented(gMappedField* map, double verbosity)
 
 	// Allocate memory. [AZI][TRANSVERSE][LONGI]
 	// as initialized in the map
-	map->B1_3D = new float**[map->np[0]];
-	map->B2_3D = new float**[map->np[0]];
-	map->B3_3D = new float**[map->np[0]];
-	for (unsigned i = 0; i < map->np[0]; ++i)
-	{
-		map->B1_3D[i] = new float*[map->np[1]];
-		map->B2_3D[i] = new float*[map->np[1]];
-		map->B3_3D[i] = new float*[map->np[1]];
-		for (unsigned j = 0; j < map->np[1]; ++j)
-		{
-			map->B1_3D[i][j] = new float[map->np[2]];
-			map->B2_3D[i][j] = new float[map->np[2]];
-			map->B3_3D[i][j] = new float[map->np[2]];
-
-		}
-	}
+	map->allocateValues(3);
 
 	double unit1 = get_number("1*" + map->getCoordinateWithSpeed(0).unit);
 	double unit2 = get_number("1*" + map->getCoordinateWithSpeed(1).unit);
@@ -106,13 +91,13 @@ void asciiField::loadFieldMap_phiSegmented(gMappedField* map, double verbosity)
 					unsigned t2 = (unsigned) floor( ( d2 - min2 + cell2/2 ) / ( cell2 ) ) ;
 					unsigned t3 = (unsigned) floor( ( d3 - min3 + cell3/2 ) / ( cell3 ) ) ;
 
-					// The values are indexed as B1_3D[AZI][TRANSVERSE][LONGI]
+					// The values are indexed as B3D(AZI, TRANSVERSE, LONGI)
 					if(   map->getCoordinateWithSpeed(0).name == "azimuthal"
 					   && map->getCoordinateWithSpeed(1).name == "transverse"
 					   && map->getCoordinateWithSpeed(2).name == "longitudinal" ) {
-						map->B1_3D[t1][t2][t3] = b1;
-						map->B2_3D[t1][t2][t3] = b2;
-						map->B3_3D[t1][t2][t3] = b3;
+						map->B3D(t1, t2, t3)[0] = b1;
+						map->B3D(t1, t2, t3)[1] = b2;
+						map->B3D(t1, t2, t3)[2] = b3;
 					} else if(   map->getCoordinateWithSpeed(0).name == "azimuthal"
 							    && map->getCoordinateWithSpeed(1).name == "longitudinal"
 							    && map->getCoordinateWithSpeed(2).name == "transverse" ) {
@@ -120,9 +105,9 @@ void asciiField::loadFieldMap_phiSegmented(gMappedField* map, double verbosity)
 						t2 = (unsigned) floor( ( d3 - min3 + cell3/2 ) / ( cell3 ) ) ;
 						t3 = (unsigned) floor( ( d2 - min2 + cell2/2 ) / ( cell2 ) ) ;
 
-						map->B1_3D[t1][t3][t2] = b1;
-						map->B2_3D[t1][t3][t2] = b2;
-						map->B3_3D[t1][t3][t2] = b3;
+						map->B3D(t1, t3, t2)[0] = b1;
+						map->B3D(t1, t3, t2)[1] = b2;
+						map->B3D(t1, t3, t2)[2] = b3;
 					} else if(   map->getCoordinateWithSpeed(0).name == "longitudinal"
 							    && map->getCoordinateWithSpeed(1).name == "azimuthal"
 							    && map->getCoordinateWithSpeed(2).name == "transverse" ) {
@@ -130,9 +115,9 @@ void asciiField::loadFieldMap_phiSegmented(gMappedField* map, double verbosity)
 						t2 = (unsigned) floor( ( d1 - min1 + cell1/2 ) / ( cell1 ) ) ;
 						t3 = (unsigned) floor( ( d2 - min2 + cell2/2 ) / ( cell2 ) ) ;
 
-						map->B1_3D[t3][t1][t2] = b1;
-						map->B2_3D[t3][t1][t2] = b2;
-						map->B3_3D[t3][t1][t2] = b3;
+						map->B3D(t3, t1, t2)[0] = b1;
+						map->B3D(t3, t1, t2)[1] = b2;
+						map->B3D(t3, t1, t2)[2] = b3;
 					} else if(   map->getCoordinateWithSpeed(0).name == "longitudinal"
 							    && map->getCoordinateWithSpeed(1).name == "transverse"
 							    && map->getCoordinateWithSpeed(2).name == "azimuthal" ) {
@@ -140,9 +125,9 @@ void asciiField::loadFieldMap_phiSegmented(gMappedField* map, double verbosity)
 						t2 = (unsigned) floor( ( d2 - min2 + cell2/2 ) / ( cell2 ) ) ;
 						t3 = (unsigned) floor( ( d1 - min1 + cell1/2 ) / ( cell1 ) ) ;
 
-						map->B1_3D[t3][t2][t1] = b1;
-						map->B2_3D[t3][t2][t1] = b2;
-						map->B3_3D[t3][t2][t1] = b3;
+						map->B3D(t3, t2, t1)[0] = b1;
+						map->B3D(t3, t2, t1)[1] = b2;
+						map->B3D(t3, t2, t1)[2] = b3;
 					} else if(   map->getCoordinateWithSpeed(0).name == "transverse"
 								 && map->getCoordinateWithSpeed(1).name == "longitudinal"
 							    && map->getCoordinateWithSpeed(2).name == "azimuthal" ) {
@@ -150,9 +135,9 @@ void asciiField::loadFieldMap_phiSegmented(gMappedField* map, double verbosity)
 						t2 = (unsigned) floor( ( d3 - min3 + cell3/2 ) / ( cell3 ) ) ;
 						t3 = (unsigned) floor( ( d1 - min1 + cell1/2 ) / ( cell1 ) ) ;
 
-						map->B1_3D[t2][t3][t1] = b1;
-						map->B2_3D[t2][t3][t1] = b2;
-						map->B3_3D[t2][t3][t1] = b3;
+						map->B3D(t2, t3, t1)[0] = b1;
+						map->B3D(t2, t3, t1)[1] = b2;
+						map->B3D(t2, t3, t1)[2] = b3;
 					} else if(   map->getCoordinateWithSpeed(0).name == "transverse"
 							    && map->getCoordinateWithSpeed(1).name == "azimuthal"
 							    && map->getCoordinateWithSpeed(2).name == "longitudinal" ) {
@@ -160,9 +145,9 @@ void asciiField::loadFieldMap_phiSegmented(gMappedField* map, double verbosity)
 						t2 = (unsigned) floor( ( d1 - min1 + cell1/2 ) / ( cell1 ) ) ;
 						t3 = (unsigned) floor( ( d3 - min3 + cell3/2 ) / ( cell3 ) ) ;
 						
-						map->B1_3D[t2][t1][t3] = b1;
-						map->B2_3D[t2][t1][t3] = b2;
-						map->B3_3D[t2][t1][t3] = b3;
+						map->B3D(t2, t1, t3)[0] = b1;
+						map->B3D(t2, t1, t3)[1] = b2;
+						map->B3D(t2, t1, t3)[2] = b3;
 					}
 
 					if(verbosity>4 && verbosity != 99) {
@@ -192,6 +177,7 @@ void asciiField::loadFieldMap_phiSegmented(gMappedField* map, double verbosity)
 }
 
 // from mappedField:  GetFieldValue
+template<bool LINEAR>
 void gMappedField::GetFieldValue_phiSegmented( const double x[3], double *Bfield, int FIRST_ONLY) const
 {
 
@@ -246,17 +232,17 @@ void gMappedField::GetFieldValue_phiSegmented( const double x[3], double *Bfield
 	int sign = (aLC >= 0 ? 1 : -1);
 
 	// no interpolation
-	if(interpolation == "none") {
+	if(!LINEAR) {
 		// checking if the point is closer to the top of the cell
 		if( fabs( startMap[0] + aI*cellSize[0] - aaLC) > fabs( startMap[0] + (aI+1)*cellSize[0] - aaLC)  ) aI++;
 		if( fabs( startMap[1] + tI*cellSize[1] - tC)   > fabs( startMap[1] + (tI+1)*cellSize[1] - tC)    ) tI++;
 		if( fabs( startMap[2] + lI*cellSize[2] - lC)   > fabs( startMap[2] + (lI+2)*cellSize[1] - lC)    ) lI++;
 
 		// Field at local point
-		mfield[0] = B1_3D[aI][tI][lI];
-		mfield[1] = B2_3D[aI][tI][lI];
-		mfield[2] = B3_3D[aI][tI][lI];
-	} else if (interpolation == "linear") {
+		mfield[0] = B3D(aI, tI, lI)[0];
+		mfield[1] = B3D(aI, tI, lI)[1];
+		mfield[2] = B3D(aI, tI, lI)[2];
+	} else {
 		// relative positions within cell
 		double xaz = (aaLC - (startMap[0] + aI*cellSize[0])) / cellSize[0];
 		double xtr = (tC   - (startMap[1] + tI*cellSize[1])) / cellSize[1];
@@ -266,10 +252,10 @@ void gMappedField::GetFieldValue_phiSegmented( const double x[3], double *Bfield
 		// -----------------------------------
 
 		// first, interpolate along azimutal
-		double b100 = B1_3D[aI][tI][lI]     * (1-xaz) + B1_3D[aI+1][tI][lI]     * xaz;
-		double b101 = B1_3D[aI][tI][lI+1]   * (1-xaz) + B1_3D[aI+1][tI][lI+1]   * xaz;
-		double b110 = B1_3D[aI][tI+1][lI]   * (1-xaz) + B1_3D[aI+1][tI+1][lI]   * xaz;
-		double b111 = B1_3D[aI][tI+1][lI+1] * (1-xaz) + B1_3D[aI+1][tI+1][lI+1] * xaz;
+		double b100 = B3D(aI, tI, lI)[0]     * (1-xaz) + B3D(aI+1, tI, lI)[0]     * xaz;
+		double b101 = B3D(aI, tI, lI+1)[0]   * (1-xaz) + B3D(aI+1, tI, lI+1)[0]   * xaz;
+		double b110 = B3D(aI, tI+1, lI)[0]   * (1-xaz) + B3D(aI+1, tI+1, lI)[0]   * xaz;
+		double b111 = B3D(aI, tI+1, lI+1)[0] * (1-xaz) + B3D(aI+1, tI+1, lI+1)[0] * xaz;
 
 		// second, interpolate along transverse
 		double b10 = b100 * (1 - xtr) + b110*xtr;
@@ -282,10 +268,10 @@ void gMappedField::GetFieldValue_phiSegmented( const double x[3], double *Bfield
 		// ------------------------------------
 
 		// first, interpolate along azimutal
-		double b200 = B2_3D[aI][tI][lI]     * (1-xaz) + B2_3D[aI+1][tI][lI]     * xaz;
-		double b201 = B2_3D[aI][tI][lI+1]   * (1-xaz) + B2_3D[aI+1][tI][lI+1]   * xaz;
-		double b210 = B2_3D[aI][tI+1][lI]   * (1-xaz) + B2_3D[aI+1][tI+1][lI]   * xaz;
-		double b211 = B2_3D[aI][tI+1][lI+1] * (1-xaz) + B2_3D[aI+1][tI+1][lI+1] * xaz;
+		double b200 = B3D(aI, tI, lI)[1]     * (1-xaz) + B3D(aI+1, tI, lI)[1]     * xaz;
+		double b201 = B3D(aI, tI, lI+1)[1]   * (1-xaz) + B3D(aI+1, tI, lI+1)[1]   * xaz;
+		double b210 = B3D(aI, tI+1, lI)[1]   * (1-xaz) + B3D(aI+1, tI+1, lI)[1]   * xaz;
+		double b211 = B3D(aI, tI+1, lI+1)[1] * (1-xaz) + B3D(aI+1, tI+1, lI+1)[1] * xaz;
 
 		// second, interpolate along transverse
 		double b20 = b200 * (1 - xtr) + b210*xtr;
@@ -298,10 +284,10 @@ void gMappedField::GetFieldValue_phiSegmented( const double x[3], double *Bfield
 		// -----------------------------------
 
 		// first, interpolate along azimutal
-		double b300 = B3_3D[aI][tI][lI]     * (1-xaz) + B3_3D[aI+1][tI][lI]     * xaz;
-		double b301 = B3_3D[aI][tI][lI+1]   * (1-xaz) + B3_3D[aI+1][tI][lI+1]   * xaz;
-		double b310 = B3_3D[aI][tI+1][lI]   * (1-xaz) + B3_3D[aI+1][tI+1][lI]   * xaz;
-		double b311 = B3_3D[aI][tI+1][lI+1] * (1-xaz) + B3_3D[aI+1][tI+1][lI+1] * xaz;
+		double b300 = B3D(aI, tI, lI)[2]     * (1-xaz) + B3D(aI+1, tI, lI)[2]     * xaz;
+		double b301 = B3D(aI, tI, lI+1)[2]   * (1-xaz) + B3D(aI+1, tI, lI+1)[2]   * xaz;
+		double b310 = B3D(aI, tI+1, lI)[2]   * (1-xaz) + B3D(aI+1, tI+1, lI)[2]   * xaz;
+		double b311 = B3D(aI, tI+1, lI+1)[2] * (1-xaz) + B3D(aI+1, tI+1, lI+1)[2] * xaz;
 
 
 		// second, interpolate along transverse
@@ -319,9 +305,6 @@ void gMappedField::GetFieldValue_phiSegmented( const double x[3], double *Bfield
 
 		// finally interpolate along longitudinal
 		mfield[2] = b30 * (1 - xlr) + b31 * xlr;
-	} else {
-		cout << "  !! Unkown field interpolation method >" << interpolation << "<" << endl;
-		return;
 	}
 
 	// Rotating the field back to original point
@@ -368,3 +351,10 @@ void gMappedField::GetFieldValue_phiSegmented( const double x[3], double *Bfield
 	}
 	
 }
+
+// from mappedField:  initializeMap
+gMappedField::fieldEvaluator gMappedField::phiSegmentedEvaluator(bool linear) const
+{
+	if(linear) return &gMappedField::GetFieldValue_phiSegmented<true>;
+	return &gMappedField::GetFieldValue_phiSegmented<false>;
+}
@@ -32,6 +32,9 @@ const char *GEMC_VERSION = "gemc 2.12";
 
 // G4 headers
 #include "G4RunManager.hh"
+#ifdef G4MULTITHREADED
+#include "G4MTRunManager.hh"
+#endif
 #include "G4UImanager.hh"
 #include "G4UIterminal.hh"
 #include "G4VisExecutive.hh"
@@ -53,6 +56,7 @@ const char *GEMC_VERSION = "gemc 2.12";
 #include "MDetectorConstruction.h"
 #include "outputFactory.h"
 #include "HitProcess.h"
+#include "sensitiveDetector.h"
 #include "PhysicsList.h"
 #include "gemcOptions.h"
 #include "dmesg_init.h"
@@ -64,6 +68,9 @@ const char *GEMC_VERSION = "gemc 2.12";
 #include "string_utilities.h"
 #include "gemcUtils.h"
 #include "ActionInitialization.h"
+#include "ccdbCache.h"
+#include "detectorProfile.h"
+#include "geometrySnapshot.h"
 
 // c++ headers
 #include <unistd.h>  // needed for get_pid
@@ -102,6 +109,46 @@ QCoreApplication *createApplication(int &argc, char *argv[], double use_gui) {
     return new QApplication(argc, argv);
 }
 
+// number of event processing threads
+// multithreaded mode is only available in batch mode
+// and for options that do not rely on a single sequential event stream
+int numberOfThreads(goptions gemcOpt, double use_gui) {
+    int nthreads = (int) gemcOpt.optMap["NTHREADS"].arg;
+
+    if (nthreads <= 1) {
+        return 1;
+    }
+
+#ifndef G4MULTITHREADED
+    cout << "  !!! Warning: NTHREADS=" << nthreads << " requested but Geant4 is not built with multithreading. Running sequentially." << endl;
+    return 1;
+#else
+    string input_gen = gemcOpt.optMap["INPUT_GEN_FILE"].args;
+    string sequentialReason = "";
+
+    if (use_gui) {
+        sequentialReason = "USE_GUI";
+    } else if (input_gen != "gemc_internal" && input_gen.compare(0, 4, "LUND") != 0 && input_gen.compare(0, 4, "lund") != 0) {
+        sequentialReason = "INPUT_GEN_FILE format";
+    } else if (gemcOpt.optMap["MERGE_LUND_BG"].args != "no") {
+        sequentialReason = "MERGE_LUND_BG";
+    } else if (gemcOpt.optMap["SAVE_SELECTED"].args != "" && gemcOpt.optMap["SAVE_SELECTED"].args != "no") {
+        sequentialReason = "SAVE_SELECTED";
+    } else if (gemcOpt.optMap["RERUN_SELECTED"].args != "" && gemcOpt.optMap["RERUN_SELECTED"].args != "no") {
+        sequentialReason = "RERUN_SELECTED";
+    } else if (gemcOpt.optMap["SAVE_ALL_MOTHERS"].arg > 1) {
+        sequentialReason = "SAVE_ALL_MOTHERS";
+    }
+
+    if (sequentialReason != "") {
+        cout << "  !!! Warning: NTHREADS=" << nthreads << " is not supported with " << sequentialReason << ". Running sequentially." << endl;
+        return 1;
+    }
+
+    return nthreads;
+#endif
+}
+
 
 int main(int argc, char **argv) {
     clock_t startTime = clock();
@@ -146,44 +193,108 @@ int main(int argc, char **argv) {
     CLHEP::HepRandom::setTheSeed(seed);
     gemc_splash.message(" Seed initialized to: " + stringify(seed));
 
-    // Construct the default G4 run manager
-    gemc_splash.message(" Instantiating Run Manager...");
-    G4RunManager *runManager = new G4RunManager;
+    // Construct the G4 run manager
+    // the multithreaded run manager seeds the worker threads from the master engine
+    int nthreads = numberOfThreads(gemcOpt, use_gui);
+    G4RunManager *runManager = nullptr;
+#ifdef G4MULTITHREADED
+    if (nthreads > 1) {
+        gemc_splash.message(" Instantiating Multithreaded Run Manager with " + stringify(nthreads) + " threads...");
+        G4MTRunManager *mtRunManager = new G4MTRunManager;
+        mtRunManager->SetNumberOfThreads(nthreads);
+        runManager = mtRunManager;
+    }
+#endif
+    if (runManager == nullptr) {
+        gemc_splash.message(" Instantiating Run Manager...");
+        runManager = new G4RunManager;
+    }
 
     // Initializing run_condition class
     gemc_splash.message(" Instantiating Run Conditions...");
     runConditions runConds(gemcOpt);
 
-    // GEMC Detector Map
-    gemc_splash.message(" Registering Detectors Factories...");
-    // Initializing Detector Factory
-    map <string, detectorFactoryInMap> detectorFactoryMap = registerDetectorFactory();
+    // geometry snapshot: detectors, materials, mirrors, parameters and banks
+    // are loaded from a file instead of running the factories
+    geometrySnapshot snapshot(gemcOpt, runConds);
+    string loadSnapshot = gemcOpt.optMap["LOAD_GEOMETRY_SNAPSHOT"].args;
+    string saveSnapshot = gemcOpt.optMap["SAVE_GEOMETRY_SNAPSHOT"].args;
+    bool fromSnapshot = loadSnapshot != "no" && snapshot.load(loadSnapshot);
 
-    // Building detector with factories
-    map <string, detector> hallMap = buildDetector(detectorFactoryMap, gemcOpt, runConds);
+    map <string, detector> hallMap;
+    map < string, G4Material * > mats;
+    map < string, mirror * > mirs;
+    map<string, double> gParameters;
 
     // Initialize Materials Map Factory
     gemc_splash.message(" Initializing Material Factories...");
     map <string, materialFactory> materialFactoriesMap = registerMaterialFactories();
-    // Build all materials
-    map < string, G4Material * > mats = buildMaterials(materialFactoriesMap, gemcOpt, runConds);
-
-    // Initialize Mirrors Map Factory
-    gemc_splash.message(" Initializing Mirrors Factories...");
-    map <string, mirrorFactory> mirrorFactoriesMap = registerMirrorFactories();
-    // Build all mirrors
-    map < string, mirror * > mirs = buildMirrors(mirrorFactoriesMap, gemcOpt, runConds);
 
-    // Initialize Parameters Map Factory
-    gemc_splash.message(" Registering Parameters Factories...");
-    map <string, parameterFactoryInMap> parameterFactoriesMap = registerParameterFactories();
-    // All Parameters with factories
-    map<string, double> gParameters = loadAllParameters(parameterFactoriesMap, gemcOpt, runConds);
+    if (fromSnapshot) {
+        gemc_splash.message(" Loading Geometry Snapshot...");
+        hallMap = std::move(snapshot.hallMap);
+        mats = buildMaterialsFromRecords(materialFactoriesMap, gemcOpt, runConds, snapshot.materialRecords);
+        mirs = snapshot.mirrors;
+        gParameters = snapshot.parameters;
+    } else {
+        // GEMC Detector Map
+        gemc_splash.message(" Registering Detectors Factories...");
+        // Initializing Detector Factory
+        map <string, detectorFactoryInMap> detectorFactoryMap = registerDetectorFactory();
+
+        // Building detector with factories
+        hallMap = buildDetector(detectorFactoryMap, gemcOpt, runConds);
+
+        // Build all materials
+        mats = buildMaterials(materialFactoriesMap, gemcOpt, runConds, &snapshot.materialRecords);
+
+        // Initialize Mirrors Map Factory
+        gemc_splash.message(" Initializing Mirrors Factories...");
+        map <string, mirrorFactory> mirrorFactoriesMap = registerMirrorFactories();
+        // Build all mirrors
+        mirs = buildMirrors(mirrorFactoriesMap, gemcOpt, runConds);
+
+        // Initialize Parameters Map Factory
+        gemc_splash.message(" Registering Parameters Factories...");
+        map <string, parameterFactoryInMap> parameterFactoriesMap = registerParameterFactories();
+        // All Parameters with factories
+        gParameters = loadAllParameters(parameterFactoriesMap, gemcOpt, runConds);
+
+        // the hall map is modified by the geometry construction: the snapshot keeps the factories output
+        if (saveSnapshot != "no") {
+            snapshot.hallMap = hallMap;
+            snapshot.mirrors = mirs;
+            snapshot.parameters = gParameters;
+        }
+    }
 
     // Process Hit Map
     gemc_splash.message(" Building gemc Process Hit Factory...");
     map <string, HitProcess_Factory> hitProcessMap = HitProcess_Map(gemcOpt.optMap["HIT_PROCESS_LIST"].args);
 
+    // CCDB constants cache
+    cachedCalibration::setCacheDirectory(gemcOpt.optMap["CCDB_CACHE"].args);
+
+    // prefetch mode: the constants of the sensitive detectors are cached for the run list, then gemc exits
+    if (gemcOpt.optMap["CCDB_PREFETCH"].args != "no") {
+        set <string> hitTypes;
+        for (auto &det: hallMap) {
+            if (det.second.sensitivity != "no") {
+                hitTypes.insert(det.second.hitType);
+            }
+        }
+        vector<int> runs;
+        for (auto &run: getStringVectorFromStringWithDelimiter(gemcOpt.optMap["CCDB_PREFETCH"].args, ",")) {
+            runs.push_back(stoi(run));
+        }
+        if (gemcOpt.optMap["CCDB_CACHE"].args == "no") {
+            cout << "  !!! Warning: CCDB_PREFETCH without CCDB_CACHE: the constants are not saved." << endl;
+        }
+        prefetchHitProcessConstants(&hitProcessMap, hitTypes, runs, gemcOpt, gParameters);
+        cachedCalibration::reportStatistics();
+        return 0;
+    }
+
     ///< magnetic Field Map
     gemc_splash.message(" Creating fields Map...");
     map <string, fieldFactoryInMap> fieldFactoryMap = registerFieldFactories();
@@ -196,6 +307,7 @@ int main(int argc, char **argv) {
     ExpHall->mirs = &mirs;
     ExpHall->mats = &mats;
     ExpHall->fieldsMap = &fieldsMap;
+    ExpHall->hitProcessMap = &hitProcessMap;
     // this is what calls Construct inside MDetectorConstruction
     runManager->SetUserInitialization(ExpHall);
 
@@ -219,11 +331,6 @@ int main(int argc, char **argv) {
         G4TransportationManager::GetTransportationManager()->GetPropagatorInField()->SetLargestAcceptableStep(max_step);
     }
 
-    // User action initialization
-    gemc_splash.message(" Initializing User Actions...");
-    ActionInitialization *gActions = new ActionInitialization(&gemcOpt, &gParameters);
-    runManager->SetUserInitialization(gActions);
-
     ///< User Interface manager
     gemc_splash.message(" Initializing User Interface...");
 
@@ -247,11 +354,28 @@ int main(int argc, char **argv) {
     outputContainer outContainer(gemcOpt);
     map <string, outputFactoryInMap> outputFactoryMap = registerOutputFactories();
 
+    // Bank Map is filled after the run manager initialization
+    map <string, gBank> banksMap;
+
+    // User action initialization
+    // in multithreaded mode each worker thread builds its own actions
+    // from these shared maps during the run manager initialization
+    gemc_splash.message(" Initializing User Actions...");
+    ActionInitialization *gActions = new ActionInitialization(&gemcOpt, &gParameters);
+    gActions->outContainer = &outContainer;
+    gActions->outputFactoryMap = &outputFactoryMap;
+    gActions->hitProcessMap = &hitProcessMap;
+    gActions->banksMap = &banksMap;
+    runManager->SetUserInitialization(gActions);
+
     // Initialize G4 kernel
     gemc_splash.message(" Initializing Run Manager...\n");
     // physical volumes, sensitive detectors are built here
     runManager->Initialize();
 
+    // the process IDs not catalogued by gemc are assigned once the physics is built
+    catalogueProcesses();
+
     // registering activated field in the option so they're written out
     if (ExpHall->activeFields.size()) {
         gemcOpt.optMap["ACTIVEFIELDS"].args = "";
@@ -263,7 +387,16 @@ int main(int argc, char **argv) {
 
     // Bank Map, derived from sensitive detector map
     gemc_splash.message(" Creating gemc Banks Map...");
-    map <string, gBank> banksMap = read_banks(gemcOpt, runConds.get_systems());
+    if (fromSnapshot) {
+        banksMap = snapshot.banks;
+    } else {
+        banksMap = read_banks(gemcOpt, runConds.get_systems());
+
+        if (saveSnapshot != "no") {
+            snapshot.banks = banksMap;
+            snapshot.save(saveSnapshot);
+        }
+    }
 
     // Getting UI manager, restoring G4Out to cout
     G4UImanager *UImanager = G4UImanager::GetUIpointer();
@@ -286,25 +419,21 @@ int main(int argc, char **argv) {
         sim_condition["JSON"] = gemcOpt.jSonOptions();
 
         outputFactory *processOutputFactory = getOutputFactory(&outputFactoryMap, outContainer.outType);
+        processOutputFactory->writeProcessDictionary(&outContainer, uncataloguedProcesses());
+
+        // the hipo profile bank detector column is the index of these names, written in the file header
+        if (gemcOpt.optMap["PROFILE"].arg > 1) {
+            outContainer.profileDetectors.push_back("event");
+            for (auto &sd: ExpHall->SeDe_Map) {
+                outContainer.profileDetectors.push_back(sd.first);
+            }
+        }
         processOutputFactory->recordSimConditions(&outContainer, sim_condition);
 
         // then deleting process output pointer, not needed anymore
         delete processOutputFactory;
     }
 
-    gActions->evtAction->outContainer = &outContainer;
-    gActions->evtAction->outputFactoryMap = &outputFactoryMap;
-    gActions->evtAction->hitProcessMap = &hitProcessMap;
-    gActions->evtAction->SeDe_Map = ExpHall->SeDe_Map;
-    gActions->evtAction->banksMap = &banksMap;
-    gActions->evtAction->gen_action = gActions->genAction;
-
-    ///< passing output process factory to sensitive detectors
-    map<string, sensitiveDetector *>::iterator it;
-    for (it = ExpHall->SeDe_Map.begin(); it != ExpHall->SeDe_Map.end(); it++) {
-        it->second->hitProcessMap = &hitProcessMap;
-    }
-
     gemc_splash.message(" Executing initial directives...\n");
     vector <string> init_commands = init_dmesg(gemcOpt);
     for (unsigned int i = 0; i < init_commands.size(); i++)
@@ -373,7 +502,8 @@ int main(int argc, char **argv) {
             start_events = clock();
             char command[100];
             // starting clock after the first event is much more precise
-            if (nEventsToProcess > 10) {
+            // in multithreaded mode events are numbered by their ID within a single run
+            if (nEventsToProcess > 10 && nthreads == 1) {
                 snprintf(command, 100, "/run/beamOn 1");
                 UImanager->ApplyCommand(command);
                 start_events = clock();
@@ -388,13 +518,34 @@ int main(int argc, char **argv) {
     clock_t clockAllTaken = endTime - startTime;
     clock_t clockEventTaken = endTime - start_events;
 
-    if (nEventsToProcess > 10) {
+    if (nEventsToProcess > 10 && nthreads == 1) {
         clockEventTaken = clockEventTaken * (nEventsToProcess + 1) / nEventsToProcess;
     }
 
     cout << " > Total gemc time: " << clockAllTaken / (double) CLOCKS_PER_SEC << " seconds. "
          << " Events only time: " << clockEventTaken / (double) CLOCKS_PER_SEC << " seconds. " << endl;
 
+    // field cache hit rates, to tune G4FIELDCACHESIZE
+    for (auto &field: fieldsMap) {
+        field.second.reportCacheStatistics();
+    }
+    cachedCalibration::reportStatistics();
+
+    // optical photon map accumulated by all threads
+    if (gemcOpt.optMap["OPTICAL_MAP_CALIBRATION"].args != "no") {
+        opticalPhotonMap::writeCalibration(gemcOpt.optMap["OPTICAL_MAP_CALIBRATION"].args);
+    }
+
+    // pileup library written by all threads
+    if (gemcOpt.optMap["PILEUP_LIBRARY_OUTPUT"].args != "no") {
+        pileupLibrary::closeOutput();
+    }
+
+    // per-detector profile accumulated by all threads
+    if (gemcOpt.optMap["PROFILE"].arg > 0) {
+        detectorProfile::printRunSummary();
+    }
+
     // closing db connection
     closeGdb();
 
@@ -230,7 +230,7 @@ void gsignal::createSignalsTree()
 						
 						newHit->setText(0, QString(SD.c_str()));
 						
-						vector<double>        ene = aHit->GetEs();
+						const vector<double>& ene = aHit->GetEs();
 						vector<double>       time = aHit->GetTime();
 						vector<int>           pid = aHit->GetPIDs();
 						
@@ -388,7 +388,7 @@ void gsignal::createSignalsTree()
 						
 						if(signalChoice == "Mom")
 						{
-							vector<G4ThreeVector> mom = aHit->GetMoms();
+							const vector<G4ThreeVector>& mom = aHit->GetMoms();
 							for(unsigned int i=0; i<mom.size(); i++)
 								signal.push_back(mom[i].mag());
 						}
@@ -121,7 +121,7 @@ void gtrigger::createGraphs()
 					title += identi[i].name + " " + stringify(identi[i].id) + "   " ;
 				
 				vector<int> time = aHit->getQuantumT();
-				vector<int> qadc = aHit->getQuantumQ();
+				const vector<int>& qadc = aHit->getQuantumQ();
 				vector<int> trig = aHit->getQuantumTR();
 				
 				// pid needed to differentiate colors
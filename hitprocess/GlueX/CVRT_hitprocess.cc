@@ -8,12 +8,12 @@ map<string, double> CVRT_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 	rejectHitConditions = false;
 	writeHit = true;
 
-	vector<identifier> identity = aHit->GetId();
+	const vector<identifier>& identity = aHit->GetId();
 	
 	return dgtz;
 }
 
-vector<identifier>  CVRT_HitProcess :: processID(vector<identifier> id, G4Step* aStep, detector Detector)
+vector<identifier>  CVRT_HitProcess :: processID(vector<identifier> id, G4Step* aStep, const detector &Detector)
 {
 	return id;
 }
@@ -26,7 +26,7 @@ public:
 	
 	// The pure virtual method processID returns a (new) identifier
 	// containing hit sharing information
-	vector<identifier> processID(vector<identifier>, G4Step*, detector);
+	vector<identifier> processID(vector<identifier>, G4Step*, const detector&);
 
 	// creates the HitProcess
 	static HitProcess *createHitClass() {return new CVRT_HitProcess;}
@@ -16,7 +16,7 @@ map<string, double> ECAL_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 	rejectHitConditions = false;
 	writeHit = true;
 
-	vector<identifier> identity = aHit->GetId();
+	const vector<identifier>& identity = aHit->GetId();
 	trueInfos tInfos(aHit);
 
 	
@@ -52,9 +52,9 @@ map<string, double> ECAL_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 	
 	
 	double Tmin = 99999.;
-	vector<G4double> times = aHit->GetTime();
-	vector<G4ThreeVector> Lpos = aHit->GetLPos();
-	vector<G4double>      Edep = aHit->GetEdep();
+	const vector<G4double>&      times = aHit->GetTime();
+	const vector<G4ThreeVector>& Lpos = aHit->GetLPos();
+	const vector<G4double>&      Edep = aHit->GetEdep();
 	if(tInfos.eTot>0)
 	{
 		for(unsigned int s=0; s<tInfos.nsteps; s++)
@@ -95,7 +95,7 @@ map<string, double> ECAL_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 	return dgtz;
 }
 
-vector<identifier>  ECAL_HitProcess :: processID(vector<identifier> id, G4Step* aStep, detector Detector)
+vector<identifier>  ECAL_HitProcess :: processID(vector<identifier> id, G4Step* aStep, const detector &Detector)
 {
 	id[id.size()-1].id_sharing = 1;
 	return id;
@@ -7,7 +7,7 @@ map<string, double> SVT_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 {
 	map<string, double> dgtz;
 	if(aHit->isBackgroundHit == 1) return dgtz;
-	vector<identifier> identity = aHit->GetId();
+	const vector<identifier>& identity = aHit->GetId();
 	rejectHitConditions = false;
 	writeHit = true;
 
@@ -52,7 +52,7 @@ map<string, double> SVT_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 
 #define ABS_(x) (x < 0 ? -x : x)
 
-vector<identifier> SVT_HitProcess :: processID(vector<identifier> id, G4Step* aStep, detector Detector)
+vector<identifier> SVT_HitProcess :: processID(vector<identifier> id, G4Step* aStep, const detector &Detector)
 {
 	vector<identifier> yid = id;
 	
@@ -9,7 +9,7 @@ map<string, double> muon_hodo_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 {
 	map<string, double> dgtz;
 	if(aHit->isBackgroundHit == 1) return dgtz;
-	vector<identifier> identity = aHit->GetId();
+	const vector<identifier>& identity = aHit->GetId();
 	rejectHitConditions = false;
 	writeHit = true;
 
@@ -50,7 +50,7 @@ map<string, double> muon_hodo_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 	return dgtz;
 }
 
-vector<identifier>  muon_hodo_HitProcess :: processID(vector<identifier> id, G4Step* aStep, detector Detector)
+vector<identifier>  muon_hodo_HitProcess :: processID(vector<identifier> id, G4Step* aStep, const detector &Detector)
 {
 	id[id.size()-1].id_sharing = 1;
 	return id;
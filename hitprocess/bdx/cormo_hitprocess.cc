@@ -13,7 +13,7 @@ map<string, double> cormo_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 { 
 	map<string, double> dgtz;
 	if(aHit->isBackgroundHit == 1) return dgtz;
-	vector<identifier> identity = aHit->GetId();
+	const vector<identifier>& identity = aHit->GetId();
 	rejectHitConditions = false;
 	writeHit = true;
 
@@ -68,12 +68,12 @@ map<string, double> cormo_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 	
 	double time_min[4] = {0,0,0,0};
 	
-	vector<G4ThreeVector> Lpos = aHit->GetLPos();
+	const vector<G4ThreeVector>& Lpos = aHit->GetLPos();
 	vector<G4double>      Edep = aHit->GetEdep();
-	vector<G4double>      Dx   = aHit->GetDx();
+	const vector<G4double>& Dx   = aHit->GetDx();
 	// Charge for each step
 	vector<int> charge = aHit->GetCharges();
-	vector<G4double> times = aHit->GetTime();
+	const vector<G4double>& times = aHit->GetTime();
 	
 	unsigned int nsteps = Edep.size();
 	double       Etot   = 0;
@@ -208,7 +208,7 @@ map<string, double> cormo_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 }
 
 
-vector<identifier>  cormo_HitProcess :: processID(vector<identifier> id, G4Step *step, detector Detector)
+vector<identifier>  cormo_HitProcess :: processID(vector<identifier> id, G4Step *step, const detector &Detector)
 {
 	id[id.size()-1].id_sharing = 1;
 	return id;
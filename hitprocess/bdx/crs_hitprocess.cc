@@ -13,7 +13,7 @@ map<string, double> crs_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 {
 	map<string, double> dgtz;
 	if(aHit->isBackgroundHit == 1) return dgtz;
-	vector<identifier> identity = aHit->GetId();
+	const vector<identifier>& identity = aHit->GetId();
 	rejectHitConditions = false;
 	writeHit = true;
 
@@ -99,15 +99,15 @@ map<string, double> crs_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 //	double time_min[4] = {0,0,0,0};
     double time_min_crs[4] = {0,0,0,0};
 	
-	vector<G4ThreeVector> Lpos = aHit->GetLPos();
+	const vector<G4ThreeVector>& Lpos = aHit->GetLPos();
 	vector<G4double>      Edep = aHit->GetEdep();
-	vector<G4double>      Dx   = aHit->GetDx();
+	const vector<G4double>& Dx   = aHit->GetDx();
     length_crs = aHit->GetDetector().dimensions[4];
     //cout<<length_crs<< endl;
     
 	// Charge for each step
 	vector<int> charge = aHit->GetCharges();
-	vector<G4double> times = aHit->GetTime();
+	const vector<G4double>& times = aHit->GetTime();
     //vector<string> theseMats = aHit->GetMaterials();
 	
 	unsigned int nsteps = Edep.size();
@@ -344,7 +344,7 @@ map<string, double> crs_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 }
 
 
-vector<identifier>  crs_HitProcess :: processID(vector<identifier> id, G4Step *step, detector Detector)
+vector<identifier>  crs_HitProcess :: processID(vector<identifier> id, G4Step *step, const detector &Detector)
 {
 	id[id.size()-1].id_sharing = 1;
 	return id;
@@ -405,7 +405,7 @@ double* crs_HitProcess::WaveForm(double npe, double* time)
     double rr;
     int it;
     int Nch_digi=800; //Number of cjannel for the digitizer
-    static double WFsample[1000]; //Needs to be >  Nch_digi+size of the response to the single pe
+    static thread_local double WFsample[1000]; //Needs to be >  Nch_digi+size of the response to the single pe
     double smp_t=4./1000. ;// Assuming fADC sampling at 250 MHz 1sample every 4ns
 
     // double p[6] = {0.14,-3.5,2.5,-2.,0.5,-1.2};
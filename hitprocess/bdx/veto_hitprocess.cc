@@ -14,7 +14,7 @@ map<string, double> veto_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 {
 	map<string, double> dgtz;
 	if(aHit->isBackgroundHit == 1) return dgtz;
-	vector<identifier> identity = aHit->GetId();
+	const vector<identifier>& identity = aHit->GetId();
 
 	int sector  = identity[0].id;
 	int veto_id = identity[1].id;
@@ -840,7 +840,7 @@ map<string, double> veto_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 }
 
 
-vector<identifier>  veto_HitProcess :: processID(vector<identifier> id, G4Step *step, detector Detector)
+vector<identifier>  veto_HitProcess :: processID(vector<identifier> id, G4Step *step, const detector &Detector)
 {
 	id[id.size()-1].id_sharing = 1;
 	return id;
@@ -854,7 +854,7 @@ double* veto_HitProcess::IVresponse(int channel, double xx, double yy,double zz)
     // ch
     //
     //
-    static double response[4];
+    static thread_local double response[4];
 
     for(unsigned int s=0; s<4; s++)response[s] = 0.;
     
@@ -974,7 +974,7 @@ double* veto_HitProcess::IVresponseProposal(int channel, double xx, double yy,do
     // ch
     //
     //
-    static double response[4];
+    static thread_local double response[4];
     
     for(unsigned int s=0; s<4; s++)response[s] = 0.;
     
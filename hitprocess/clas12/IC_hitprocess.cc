@@ -10,7 +10,7 @@ map<string, double> IC_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 	map<string, double> dgtz;
 	if(aHit->isBackgroundHit == 1) return dgtz;
 	
-	vector<identifier> identity = aHit->GetId();
+	const vector<identifier>& identity = aHit->GetId();
 	rejectHitConditions = false;
 	writeHit = true;
 
@@ -47,9 +47,9 @@ map<string, double> IC_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 	
 	
 	double Tmin = 99999.;
-	vector<G4double> times = aHit->GetTime();
-	vector<G4ThreeVector> Lpos = aHit->GetLPos();
-	vector<G4double>      Edep = aHit->GetEdep();
+	const vector<G4double>&      times = aHit->GetTime();
+	const vector<G4ThreeVector>& Lpos = aHit->GetLPos();
+	const vector<G4double>&      Edep = aHit->GetEdep();
 	if(Etot>0)
 	{
 		for(unsigned int s=0; s<nsteps; s++)
@@ -90,7 +90,7 @@ map<string, double> IC_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 	return dgtz;
 }
 
-vector<identifier>  IC_HitProcess :: processID(vector<identifier> id, G4Step* aStep, detector Detector)
+vector<identifier>  IC_HitProcess :: processID(vector<identifier> id, G4Step* aStep, const detector &Detector)
 {
 	id[id.size()-1].id_sharing = 1;
 	return id;
@@ -3,7 +3,6 @@
 #include "Randomize.hh"
 
 #include <math.h>
-#include <random>
 
 #include <CCDB/Calibration.h>
 #include <CCDB/Model/Assignment.h>
@@ -46,7 +45,7 @@ map<string, double> ahdc_HitProcess::integrateDgt(MHit* aHit, int hitn) {
 	
 	// digitized output
 	map<string, double> dgtz;
-	vector<identifier> identity = aHit->GetId();
+	const vector<identifier>& identity = aHit->GetId();
 	rejectHitConditions = false;
 	writeHit = true;
 
@@ -76,7 +75,11 @@ map<string, double> ahdc_HitProcess::integrateDgt(MHit* aHit, int hitn) {
 
 	}
 
-	ahdcSignal *Signal = new ahdcSignal(aHit,hitn,0,6000,1000,44,240);
+	// the Landau pulse is tabulated once per thread for the window below:
+	// the steps start at timeOffset or later, so the pulse is needed up to tmax - timeOffset
+	static thread_local pulseShape landauPulse = ahdcSignal::LandauPulse(240, 44, -8*240, 6000 - 1000);
+
+	ahdcSignal *Signal = new ahdcSignal(aHit,hitn,0,6000,1000,44,240,&landauPulse);
 	Signal->SetElectronYield(50000);
 	Signal->Digitize();
 	std::map<std::string,double> output = Signal->Extract();
@@ -124,7 +127,7 @@ map<string, double> ahdc_HitProcess::integrateDgt(MHit* aHit, int hitn) {
 
 
 
-vector<identifier> ahdc_HitProcess::processID(vector<identifier> id, G4Step* aStep, detector Detector) {
+vector<identifier> ahdc_HitProcess::processID(vector<identifier> id, G4Step* aStep, const detector &Detector) {
 
 	id[id.size()-1].id_sharing = 1;
 	return id;
@@ -183,7 +186,7 @@ void ahdc_HitProcess::initWithRunNumber(int runno)
 }
 
 // this static function will be loaded first thing by the executable
-ahdcConstants ahdc_HitProcess::atc = initializeAHDCConstants(-1);
+thread_local ahdcConstants ahdc_HitProcess::atc = initializeAHDCConstants(-1);
 
 
 // -------------
@@ -191,7 +194,7 @@ ahdcConstants ahdc_HitProcess::atc = initializeAHDCConstants(-1);
 // -------------
 
 void ahdcSignal::ComputeDocaAndTime(MHit * aHit){
-	vector<G4ThreeVector> Lpos        = aHit->GetLPos();
+	const vector<G4ThreeVector>& Lpos        = aHit->GetLPos();
 	int nsteps = Lpos.size();
 	double LposX, LposY, LposZ;
 	
@@ -262,21 +265,26 @@ void ahdcSignal::ComputeDocaAndTime(MHit * aHit){
 		// Add a resolution on doca
 		double docasig = 337.3-210.3*H_abh+34.7*pow(H_abh,2); // um // fit sigma vs distance // Fig 4.14 (right), L. Causse's thesis
 		docasig = docasig/1000; // mm
-		std::default_random_engine dseed(time(0)); //seed
-		std::normal_distribution<double> docadist(H_abh, docasig);
 		// Compute time
 		double driftTime = 7*H_abh + 7*pow(H_abh,2) + 4*pow(H_abh,3); // fit t vs distance //  Fig 4.12 (right), L. Causse's thesis
 		DriftTime.push_back(driftTime);
 	}
 }
 
+pulseShape ahdcSignal::LandauPulse(double Landau_width, double samplingTime, double tlow, double thigh){
+	using namespace Genfun;
+	Landau L;
+	L.peak() = Parameter("Peak",0,tlow,thigh);
+	L.width() = Parameter("Width",Landau_width,0,400);
+	return pulseShape([&L](double t) {return L(t);}, tlow, thigh, samplingTime);
+}
+
+// the noise is drawn from the geant4 engine, so it's reproducible with the event seeds
 void ahdcSignal::GenerateNoise(double mean, double stdev){
 	int Npts = (int) floor( (tmax-tmin)/samplingTime );
-	std::random_device rd;      // Create a random device to seed the generator
-	std::mt19937 gen(rd());     // Create a random number engine (e.g., Mersenne Twister)
+	Noise.reserve(Npts);
 	for (int i=0;i<Npts;i++){
-		std::normal_distribution<double> draw(mean,stdev);
-		double value = draw(gen);
+		double value = G4RandGauss::shoot(mean,stdev);
 		if (value < 0) value = 0;
 		Noise.push_back(value);
 	}
@@ -285,9 +293,22 @@ void ahdcSignal::GenerateNoise(double mean, double stdev){
 void ahdcSignal::Digitize(){
 	this->GenerateNoise(300,30);
 	int Npts = (int) floor( (tmax-tmin)/samplingTime );
+
+	// signal in keV/ns
+	std::vector<double> signal(Npts, 0);
+	if (pulse != nullptr) {
+		for (int s=0; s<nsteps; s++){
+			pulse->accumulate(Edep.at(s), DriftTime.at(s) + timeOffset, signal.data(), Npts, tmin);
+		}
+	} else {
+		for (int i=0;i<Npts;i++) {
+			signal[i] = this->operator()(tmin + i*samplingTime);
+		}
+	}
+
+	Dgtz.reserve(Npts);
 	for (int i=0;i<Npts;i++) {
-		double value = this->operator()(tmin + i*samplingTime); //in keV/ns
-		value = (int) floor(electronYield*value + Noise.at(i)); //convert in ADC +  noise
+		double value = (int) floor(electronYield*signal[i] + Noise.at(i)); //convert in ADC +  noise
 		short adc = (value < ADC_LIMIT) ? value : ADC_LIMIT; // saturation effect 
 		Dgtz.push_back(adc);
 	}
@@ -31,7 +31,7 @@ public:
 	~ahdc_HitProcess(){;}
 	
 	// constants initialized with initWithRunNumber
-	static ahdcConstants atc;
+	static thread_local ahdcConstants atc;
 	
 	void initWithRunNumber(int runno);
 	
@@ -49,7 +49,7 @@ public:
 	
 	// The pure virtual method processID returns a (new) identifier
 	// containing hit sharing information
-	vector<identifier> processID(vector<identifier>, G4Step*, detector);
+	vector<identifier> processID(vector<identifier>, G4Step*, const detector&);
 	
 	// creates the HitProcess
 	static HitProcess *createHitClass() {return new ahdc_HitProcess;}
@@ -86,6 +86,7 @@ public:
 
 #include <string>
 #include "CLHEP/GenericFunctions/Landau.hh"
+#include "pulseShape.h"
 
 /**
  * @class ahdcSignal
@@ -124,6 +125,7 @@ class ahdcSignal {
 		void ComputeDocaAndTime(MHit * aHit);
 		std::vector<short> Dgtz; ///< Array containing the samples of the simulated signal
 		std::vector<short> Noise; ///< Array containing the samples of the simulated noise
+		const pulseShape *pulse = nullptr; ///< tabulated Landau pulse, nullptr to evaluate the Landau at every sample
 	// setting parameters for digitization
 	private : 
 		const double tmin; ///< lower limit of the simulated time window
@@ -138,9 +140,13 @@ class ahdcSignal {
 		/** @brief Default constructor */
 		ahdcSignal() = default;
 		
-		/** @brief Constructor */
-		ahdcSignal(MHit * aHit, int _hitn, double _tmin, double _tmax, double _timeOffset, double _samplingTime, double _Landau_width) 
-		: tmin(_tmin), tmax(_tmax), timeOffset(_timeOffset), samplingTime(_samplingTime), Landau_width(_Landau_width) {
+		/**
+		 * @brief Constructor
+		 *
+		 * @param _pulse Landau of width `_Landau_width` tabulated with `LandauPulse` for `_samplingTime`
+		 */
+		ahdcSignal(MHit * aHit, int _hitn, double _tmin, double _tmax, double _timeOffset, double _samplingTime, double _Landau_width, const pulseShape *_pulse = nullptr) 
+		: pulse(_pulse), tmin(_tmin), tmax(_tmax), timeOffset(_timeOffset), samplingTime(_samplingTime), Landau_width(_Landau_width) {
 			// read identifiers
 			hitn = _hitn;
 			vector<identifier> identity = aHit->GetId();
@@ -177,7 +183,7 @@ class ahdcSignal {
 		std::vector<short>                     GetNoise()              {return Noise;}
 		
 		/** @brief Return the content of the attribut `Dgtz` */
-		std::vector<short> 			GetDgtz()		{return Dgtz;}
+		const std::vector<short>&		GetDgtz()		{return Dgtz;}
 		
 		/**
 		 * @brief Set the electron yield. 
@@ -196,21 +202,31 @@ class ahdcSignal {
 		double operator()(double timePoint){
 			using namespace Genfun;
 			double signalValue = 0;
+			Landau L;
+			L.width() = Parameter("Width",Landau_width,0,400); 
 			for (int s=0; s<nsteps; s++){
-				// setting Landau's parameters
-				Landau L;
+				// setting Landau's peak
 				L.peak() = Parameter("Peak",DriftTime.at(s),tmin,tmax); 
-				L.width() = Parameter("Width",Landau_width,0,400); 
 				signalValue += Edep.at(s)*L(timePoint-timeOffset);
 			}
 			return signalValue;
 		}
 		
+		/**
+		 * @brief Tabulate a Landau of peak 0 for the sampling time
+		 *
+		 * The pulse of a step is the table shifted by its drift time, see `Digitize`
+		 *
+		 * @param tlow, thigh Range of the table, the Landau is zero outside
+		 */
+		static pulseShape LandauPulse(double Landau_width, double samplingTime, double tlow, double thigh);
+		
 		/**
 		 * @brief Digitize the simulated signal
 		 *
 		 * This method perfoms several steps
-		 * - step 1 : it produces samples from the simulated signal (using `samplingTime`)
+		 * - step 1 : it produces samples from the simulated signal (using `samplingTime`),
+		 *   adding the tabulated pulse of each step to the samples if `pulse` is set
 		 * - step 2 : it converts keV/ns in ADC units (using `electronYield`)
 		 * - step 3 : it adds noise
 		 *
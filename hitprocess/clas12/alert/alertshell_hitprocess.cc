@@ -47,7 +47,7 @@ map<string, double> alertshell_HitProcess::integrateDgt(MHit* aHit, int hitn) {
 	
 	// digitized output
 	map<string, double> dgtz;
-	vector<identifier> identity = aHit->GetId();
+	const vector<identifier>& identity = aHit->GetId();
 	rejectHitConditions = false;
 	writeHit = true;
 
@@ -81,19 +81,19 @@ map<string, double> alertshell_HitProcess::integrateDgt(MHit* aHit, int hitn) {
 	
 	trueInfos tInfos(aHit);
 	
-	vector<int>           stepTrackId = aHit->GetTIds();
+	const vector<int>&    stepTrackId = aHit->GetTIds();
 	vector<double>        stepTime    = aHit->GetTime();
-	vector<double>        mgnf        = aHit->GetMgnf();
+	const vector<double>& mgnf        = aHit->GetMgnf();
 	// energy at each step
 	// for example tInfos.eTot is total energy deposited
 	// tInfos.eTot is the sum of all steps s of Edep[s]
-	vector<G4double>      Edep        = aHit->GetEdep();
-	vector<G4ThreeVector> pos         = aHit->GetPos();
+	const vector<G4double>&      Edep        = aHit->GetEdep();
+	const vector<G4ThreeVector>& pos         = aHit->GetPos();
 	// local variable for each step
-	vector<G4ThreeVector> Lpos        = aHit->GetLPos();
+	const vector<G4ThreeVector>& Lpos        = aHit->GetLPos();
 	// take momentum for each step
-	vector<G4ThreeVector> mom         = aHit->GetMoms();
-	vector<double>        E           = aHit->GetEs();
+	const vector<G4ThreeVector>& mom         = aHit->GetMoms();
+	const vector<double>&        E           = aHit->GetEs();
 	
 	// unsigned nsteps = Edep.size();
 	
@@ -159,7 +159,7 @@ map<string, double> alertshell_HitProcess::integrateDgt(MHit* aHit, int hitn) {
 
 
 // this method is to locate the hit event, it returns a hitted wire or paddle; this is also the one that needs to be implemented at first.
-vector<identifier> alertshell_HitProcess::processID(vector<identifier> id, G4Step* aStep, detector Detector) {
+vector<identifier> alertshell_HitProcess::processID(vector<identifier> id, G4Step* aStep, const detector &Detector) {
 	
 	//id[id.size()-1].id_sharing = 1;
 	//return id;
@@ -252,7 +252,7 @@ void alertshell_HitProcess::initWithRunNumber(int runno)
 }
 
 // this static function will be loaded first thing by the executable
-alertshellConstants alertshell_HitProcess::atc = initializeALERTSHELLConstants(-1);
+thread_local alertshellConstants alertshell_HitProcess::atc = initializeALERTSHELLConstants(-1);
 
 
 
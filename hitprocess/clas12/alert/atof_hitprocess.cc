@@ -36,7 +36,7 @@ map<string, double> atof_HitProcess::integrateDgt(MHit* aHit, int hitn) {
 	
 	// digitized output
 	map<string, double> dgtz;
-	vector<identifier> identity = aHit->GetId();
+	const vector<identifier>& identity = aHit->GetId();
 	rejectHitConditions = false;
 	writeHit = true;
 
@@ -76,9 +76,9 @@ map<string, double> atof_HitProcess::integrateDgt(MHit* aHit, int hitn) {
 	
 	l_topXY = sqrt( pow((dim_3 - dim_5),2) + pow((dim_4 - dim_6),2) );
 	
-	vector<G4double>      Edep  = aHit->GetEdep();
-	vector<G4ThreeVector> Lpos  = aHit->GetLPos(); // local position at each step
-	vector<double>        times = aHit->GetTime();
+	const vector<G4double>&      Edep  = aHit->GetEdep();
+	const vector<G4ThreeVector>& Lpos  = aHit->GetLPos(); // local position at each step
+	const vector<double>&        times = aHit->GetTime();
 	
 	double adc_CC_front, adc_CC_back, adc_CC_top, tdc_CC_front, tdc_CC_back, tdc_CC_top;
 	
@@ -341,7 +341,7 @@ map<string, double> atof_HitProcess::integrateDgt(MHit* aHit, int hitn) {
 // paddle     = identity[3].id;
 // order      = identity[4].id;
 
-vector<identifier> atof_HitProcess::processID(vector<identifier> id, G4Step* aStep, detector Detector) {
+vector<identifier> atof_HitProcess::processID(vector<identifier> id, G4Step* aStep, const detector &Detector) {
 	
 	vector<identifier> yid = id;
 	
@@ -428,7 +428,7 @@ void atof_HitProcess::initWithRunNumber(int runno)
 }
 
 // this static function will be loaded first thing by the executable
-atofConstants atof_HitProcess::atc = initializeATOFConstants(-1);
+thread_local atofConstants atof_HitProcess::atc = initializeATOFConstants(-1);
 
 
 
@@ -31,7 +31,7 @@ public:
 	~atof_HitProcess(){;}
 	
 	// constants initialized with initWithRunNumber
-	static atofConstants atc;
+	static thread_local atofConstants atc;
 	
 	void initWithRunNumber(int runno);
 	
@@ -49,7 +49,7 @@ public:
 	
 	// The pure virtual method processID returns a (new) identifier
 	// containing hit sharing information
-	vector<identifier> processID(vector<identifier>, G4Step*, detector);
+	vector<identifier> processID(vector<identifier>, G4Step*, const detector&);
 	
 	// creates the HitProcess
 	static HitProcess *createHitClass() {return new atof_HitProcess;}
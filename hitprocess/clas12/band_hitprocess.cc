@@ -14,6 +14,7 @@ using namespace CLHEP;
 #include <CCDB/Calibration.h>
 #include <CCDB/Model/Assignment.h>
 #include <CCDB/CalibrationGenerator.h>
+#include "ccdbCache.h"
 using namespace ccdb;
 
 double BARLENGTHS[]  = {163.7,201.9,51.2,51.2,201.9};
@@ -45,7 +46,7 @@ static bandHitConstants initializeBANDHitConstants(int runno, string digiVariati
 	else
 		bhc.connection = "mysql://clas12reader@clasdb.jlab.org/clas12";
 	
-	unique_ptr<Calibration> calib(CalibrationGenerator::CreateCalibration(bhc.connection));
+	unique_ptr<cachedCalibration> calib(new cachedCalibration(bhc.connection));
 	
 	vector<vector<double> > data;
 	int isector, ilayer, icomp;
@@ -171,12 +172,12 @@ map<string, double> band_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 	birks_constant = 0.126; // mm/MeV
 	
 	vector<G4ThreeVector> Lpos   = aHit->GetLPos();   	// local position wrt centre of the detector piece (ie: paddle): in mm
-	vector<G4ThreeVector> pos 	  = aHit->GetPos();   	// global position, in mm
+	const vector<G4ThreeVector>& pos 	  = aHit->GetPos();   	// global position, in mm
 	vector<double>        Edep   = aHit->GetEdep();    // deposited energy in the hit, in MeV
-	vector<int>           charge = aHit->GetCharges(); // charge for each step
-	vector<int>           pid	  = aHit->GetPIDs();	   // PIDs for each step
-	vector<double>        times  = aHit->GetTime();
-	vector<double>        dx 	  = aHit->GetDx();      // step length
+	const vector<int>&    charge = aHit->GetCharges(); // charge for each step
+	const vector<int>&    pid	  = aHit->GetPIDs();	   // PIDs for each step
+	const vector<double>& times  = aHit->GetTime();
+	const vector<double>& dx 	  = aHit->GetDx();      // step length
 	unsigned              nsteps = times.size();       // total number of steps in the hit
 
 
@@ -351,7 +352,7 @@ map<string, double> band_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 	return dgtz;
 }
 
-vector<identifier>  band_HitProcess :: processID(vector<identifier> id, G4Step* aStep, detector Detector)
+vector<identifier>  band_HitProcess :: processID(vector<identifier> id, G4Step* aStep, const detector &Detector)
 {
 	vector<identifier> yid = id;
 	yid[0].id_sharing = 1; // sector (paddle number)
@@ -503,6 +504,8 @@ map< string, vector <int> >  band_HitProcess :: multiDgt(MHit* aHit, int hitn)
 
 void band_HitProcess::initWithRunNumber(int runno)
 {
+	pulseShapePars = bhc.vpar;
+
 	string digiVariation    = gemcOpt.optMap["DIGITIZATION_VARIATION"].args;
 	string digiSnapshotTime = gemcOpt.optMap["DIGITIZATION_TIMESTAMP"].args;
 	
@@ -516,7 +519,7 @@ void band_HitProcess::initWithRunNumber(int runno)
 
 
 // this static function will be loaded first thing by the executable
-bandHitConstants band_HitProcess::bhc = initializeBANDHitConstants(-1);
+thread_local bandHitConstants band_HitProcess::bhc = initializeBANDHitConstants(-1);
 
 
 double band_HitProcess::MeVtoMeVee(int PID, int Z, double E_MeV ){
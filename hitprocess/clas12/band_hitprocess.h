@@ -59,7 +59,7 @@ public:
 	
 	// The pure virtual method processID returns a (new) identifier
 	// containing hit sharing information
-	vector<identifier> processID(vector<identifier>, G4Step*, detector);
+	vector<identifier> processID(vector<identifier>, G4Step*, const detector&);
 	
 	// creates the HitProcess
 	static HitProcess *createHitClass() {return new band_HitProcess;}
@@ -70,7 +70,7 @@ public:
 private:
 	
 	// constants initialized with initWithRunNumber
-	static bandHitConstants bhc;
+	static thread_local bandHitConstants bhc;
 	
 	void initWithRunNumber(int runno);
 	
@@ -13,6 +13,7 @@ using namespace CLHEP;
 #include <CCDB/Calibration.h>
 #include <CCDB/Model/Assignment.h>
 #include <CCDB/CalibrationGenerator.h>
+#include "ccdbCache.h"
 using namespace ccdb;
 
 static cndConstants initializeCNDConstants(int runno, string digiVariation = "default", string digiSnapshotTime = "no", bool accountForHardwareStatus = false)
@@ -38,7 +39,7 @@ static cndConstants initializeCNDConstants(int runno, string digiVariation = "de
 	
 	vector<vector<double> > data;
 	
-	unique_ptr<Calibration> calib(CalibrationGenerator::CreateCalibration(cndc.connection));
+	unique_ptr<cachedCalibration> calib(new cachedCalibration(cndc.connection));
 	cout<<"Connecting to " << cndc.connection << "/calibration/cnd"<<endl;
 	
 	if(accountForHardwareStatus) {
@@ -205,11 +206,11 @@ map<string, double> cnd_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 	// Get info about detector material to eveluate Birks effect
 	double birks_constant=aHit->GetDetector().GetLogical()->GetMaterial()->GetIonisation()->GetBirksConstant();
 	
-	vector<G4ThreeVector> Lpos   = aHit->GetLPos();   // local position wrt centre of the detector piece (ie: paddle): in mm
+	const vector<G4ThreeVector>& Lpos   = aHit->GetLPos();   // local position wrt centre of the detector piece (ie: paddle): in mm
 	vector<double>        Edep   = aHit->GetEdep();     // deposited energy in the hit, in MeV
-	vector<int>           charge = aHit->GetCharges();        // charge for each step
-	vector<double>        times  = aHit->GetTime();
-	vector<double>        dx     = aHit->GetDx();              // step length
+	const vector<int>&    charge = aHit->GetCharges();        // charge for each step
+	const vector<double>& times  = aHit->GetTime();
+	const vector<double>& dx     = aHit->GetDx();              // step length
 	
 	unsigned nsteps = times.size();                 // total number of steps in the hit
 	
@@ -615,7 +616,7 @@ map<string, double> cnd_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 // side   = identity[2].id; // side: 1 = left, 2 = right
 // direct = identity[3].id; // direct = 0, indirect = 1  << what we need to duplcate to 1 here
 
-vector<identifier>  cnd_HitProcess :: processID(vector<identifier> id, G4Step *step, detector Detector)
+vector<identifier>  cnd_HitProcess :: processID(vector<identifier> id, G4Step *step, const detector &Detector)
 {
 	vector<identifier> yid = id;
 	yid[0].id_sharing = 1; // sector (paddle number)
@@ -713,4 +714,4 @@ vector<MHit*> cnd_HitProcess :: electronicNoise()
 }
 
 // this static function will be loaded first thing by the executable
-cndConstants cnd_HitProcess::cndc = initializeCNDConstants(-1);
+thread_local cndConstants cnd_HitProcess::cndc = initializeCNDConstants(-1);
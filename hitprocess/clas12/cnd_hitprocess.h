@@ -74,7 +74,7 @@ public:
 	
 	~cnd_HitProcess(){;}
 	
-	static cndConstants cndc;
+	static thread_local cndConstants cndc;
 	
 	void initWithRunNumber(int runno);
 	
@@ -92,7 +92,7 @@ public:
 	
 	// The pure virtual method processID returns a (new) identifier
 	// containing hit sharing information
-	vector<identifier> processID(vector<identifier>, G4Step*, detector);
+	vector<identifier> processID(vector<identifier>, G4Step*, const detector&);
 	
 	// creates the HitProcess
 	static HitProcess *createHitClass() {return new cnd_HitProcess;}
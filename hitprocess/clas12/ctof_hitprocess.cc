@@ -6,6 +6,7 @@
 #include <CCDB/Calibration.h>
 #include <CCDB/Model/Assignment.h>
 #include <CCDB/CalibrationGenerator.h>
+#include "ccdbCache.h"
 using namespace ccdb;
 
 // gemc headers
@@ -48,7 +49,7 @@ static ctofConstants initializeCTOFConstants(int runno, string digiVariation = "
 	
 	vector<vector<double> > data;
 	
-	unique_ptr<Calibration> calib(CalibrationGenerator::CreateCalibration(ctc.connection));
+	unique_ptr<cachedCalibration> calib(new cachedCalibration(ctc.connection));
 	cout << "Connecting to " << ctc.connection << "/calibration/ctof" << endl;
 	
 	snprintf(ctc.database, sizeof(ctc.database),  "/calibration/ctof/attenuation:%d:%s%s", ctc.runNo, digiVariation.c_str(), timestamp.c_str());
@@ -421,7 +422,7 @@ map<string, double> ctof_HitProcess::integrateDgt(MHit* aHit, int hitn)
 	return dgtz;
 }
 
-vector<identifier> ctof_HitProcess::processID(vector<identifier> id, G4Step* aStep, detector Detector) {	
+vector<identifier> ctof_HitProcess::processID(vector<identifier> id, G4Step* aStep, const detector &Detector) {	
 	
 	vector<identifier> yid = id;
 	
@@ -539,11 +540,11 @@ map< int, vector <double> > ctof_HitProcess::chargeTime(MHit* aHit, int hitn) {
 	double attlen_otherside = ctc.attlen[sector - 1][layer - 1][1 - side].at(paddle - 1);
 	
 	
-	vector<G4ThreeVector> Pos = aHit->GetPos();
+	const vector<G4ThreeVector>& Pos = aHit->GetPos();
 	
 	// Vector of Edep and time of the hit in each step
-	vector<G4double> Edep = aHit->GetEdep();
-	vector<G4double> time = aHit->GetTime();
+	const vector<G4double>& Edep = aHit->GetEdep();
+	const vector<G4double>& time = aHit->GetTime();
 	
 	
 	for (unsigned int s = 0; s < tInfos.nsteps; s++) {
@@ -620,6 +621,7 @@ double ctof_HitProcess::voltage(double charge, double time, double forTime) {
 }
 
 void ctof_HitProcess::initWithRunNumber(int runno) {
+	pulseShapePars = ctc.vpar;
 	
 	string digiVariation    = gemcOpt.optMap["DIGITIZATION_VARIATION"].args;
 	string digiSnapshotTime = gemcOpt.optMap["DIGITIZATION_TIMESTAMP"].args;
@@ -633,4 +635,4 @@ void ctof_HitProcess::initWithRunNumber(int runno) {
 
 
 // this static function will be loaded first thing by the executable
-ctofConstants ctof_HitProcess::ctc = initializeCTOFConstants(-1);
+thread_local ctofConstants ctof_HitProcess::ctc = initializeCTOFConstants(-1);
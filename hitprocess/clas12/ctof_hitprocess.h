@@ -115,14 +115,14 @@ public:
 	
 	// The pure virtual method processID returns a (new) identifier
 	// containing hit sharing information
-	vector<identifier> processID(vector<identifier>, G4Step*, detector);
+	vector<identifier> processID(vector<identifier>, G4Step*, const detector&);
 	
 	// creates the HitProcess
 	static HitProcess *createHitClass() {return new ctof_HitProcess;}
 	
 private:
 	// constants initialized with initWithRunNumber
-	static ctofConstants ctc;
+	static thread_local ctofConstants ctc;
 	
 	void initWithRunNumber(int runno);
 	
@@ -10,6 +10,7 @@ using namespace CLHEP;
 #include <CCDB/Calibration.h>
 #include <CCDB/Model/Assignment.h>
 #include <CCDB/CalibrationGenerator.h>
+#include "ccdbCache.h"
 using namespace ccdb;
 
 // geant4
@@ -42,7 +43,7 @@ static dcConstants initializeDCConstants(int runno, string digiVariation = "defa
 	else
 		dcc.connection = "mysql://clas12reader@clasdb.jlab.org/clas12";
 	
-	unique_ptr<Calibration> calib(CalibrationGenerator::CreateCalibration(dcc.connection));
+	unique_ptr<cachedCalibration> calib(new cachedCalibration(dcc.connection));
 	
 	
 	// reading efficiency parameters
@@ -119,9 +120,9 @@ static dcConstants initializeDCConstants(int runno, string digiVariation = "defa
 	
 	// reading DC core parameters
 	snprintf(dcc.database, sizeof(dcc.database),  "/geometry/dc/superlayer:%d:%s%s", dcc.runNo, digiVariation.c_str(), timestamp.c_str());
-	unique_ptr<Assignment> dcCoreModel(calib->GetAssignment(dcc.database));
-	for(size_t rowI = 0; rowI < dcCoreModel->GetRowsCount(); rowI++){
-		dcc.dLayer[rowI] = dcCoreModel->GetValueDouble(rowI, 6);
+	data.clear(); calib->GetCalib(data, dcc.database);
+	for(size_t rowI = 0; rowI < data.size(); rowI++){
+		dcc.dLayer[rowI] = data[rowI][6];
 	}
 	
 	dcc.dmaxsuperlayer[0] = 2*dcc.dLayer[0];
@@ -160,7 +161,7 @@ static dcConstants initializeDCConstants(int runno, string digiVariation = "defa
 map<string, double> dc_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 {
 	map<string, double> dgtz;
-	vector<identifier> identity = aHit->GetId();
+	const vector<identifier>& identity = aHit->GetId();
 	rejectHitConditions = false;
 	writeHit = true;
 	
@@ -205,12 +206,12 @@ map<string, double> dc_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 	
 	vector<int>           stepTrackId = aHit->GetTIds();
 	vector<double>        stepTime    = aHit->GetTime();
-	vector<double>        mgnf        = aHit->GetMgnf();
-	vector<G4double>      Edep        = aHit->GetEdep();
-	vector<G4ThreeVector> pos         = aHit->GetPos();
-	vector<G4ThreeVector> Lpos        = aHit->GetLPos();
-	vector<G4ThreeVector> mom         = aHit->GetMoms();
-	vector<double>        E           = aHit->GetEs();
+	const vector<double>&        mgnf        = aHit->GetMgnf();
+	const vector<G4double>&      Edep        = aHit->GetEdep();
+	const vector<G4ThreeVector>& pos         = aHit->GetPos();
+	const vector<G4ThreeVector>& Lpos        = aHit->GetLPos();
+	const vector<G4ThreeVector>& mom         = aHit->GetMoms();
+	const vector<double>&        E           = aHit->GetEs();
 	
 	unsigned nsteps = Edep.size();
 	
@@ -373,7 +374,7 @@ map<string, double> dc_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 }
 
 // routine to determine the wire number based on the hit position
-vector<identifier>  dc_HitProcess :: processID(vector<identifier> id, G4Step* aStep, detector Detector)
+vector<identifier>  dc_HitProcess :: processID(vector<identifier> id, G4Step* aStep, const detector &Detector)
 {
 	vector<identifier> yid = id;
 	
@@ -670,4 +671,4 @@ void dc_HitProcess::initWithRunNumber(int runno)
 }
 
 // this static function will be loaded first thing by the executable
-dcConstants dc_HitProcess::dcc = initializeDCConstants(-1);
+thread_local dcConstants dc_HitProcess::dcc = initializeDCConstants(-1);
@@ -102,7 +102,7 @@ public:
 	
 	// The pure virtual method processID returns a (new) identifier
 	// containing hit sharing information
-	vector<identifier> processID(vector<identifier>, G4Step*, detector);
+	vector<identifier> processID(vector<identifier>, G4Step*, const detector&);
 	
 	// creates the HitProcess
 	static HitProcess *createHitClass() {return new dc_HitProcess;}
@@ -125,7 +125,7 @@ public:
 private:
 	
 	// constants initialized with initWithRunNumber
-	static dcConstants dcc;
+	static thread_local dcConstants dcc;
 	
 	void initWithRunNumber(int runno);
 	
@@ -5,6 +5,7 @@
 #include <CCDB/Calibration.h>
 #include <CCDB/Model/Assignment.h>
 #include <CCDB/CalibrationGenerator.h>
+#include "ccdbCache.h"
 using namespace ccdb;
 
 // gemc headers
@@ -45,7 +46,7 @@ static ecConstants initializeECConstants(int runno, string digiVariation = "defa
 	
 	// The calibration data will be filled in this vector data
 	vector<vector<double> > data;
-	unique_ptr<Calibration> calib(CalibrationGenerator::CreateCalibration(ecc.connection));
+	unique_ptr<cachedCalibration> calib(new cachedCalibration(ecc.connection));
 
 	
 	// ======== Initialization of EC gains ===========
@@ -499,7 +500,7 @@ map<string, double> ecal_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 	return dgtz;
 }
 
-vector<identifier>  ecal_HitProcess :: processID(vector<identifier> id, G4Step* aStep, detector Detector)
+vector<identifier>  ecal_HitProcess :: processID(vector<identifier> id, G4Step* aStep, const detector &Detector)
 {
 	id[id.size()-1].id_sharing = 1;
 	return id;
@@ -600,7 +601,7 @@ map< int, vector <double> > ecal_HitProcess :: chargeTime(MHit* aHit, int hitn)
 	// Get scintillator mother volume dimensions (mm)
 	double pDx2 = aHit->GetDetector().dimensions[5];  ///< G4Trap Semilength.
 	
-	vector<G4ThreeVector> pos  = aHit->GetPos();
+	const vector<G4ThreeVector>& pos  = aHit->GetPos();
 	vector<G4ThreeVector> Lpos = aHit->GetLPos();
 	
 	
@@ -681,6 +682,8 @@ double ecal_HitProcess :: voltage(double charge, double time, double forTime)
 
 void ecal_HitProcess::initWithRunNumber(int runno)
 {
+	pulseShapePars = ecc.vpar;
+
 	string digiVariation    = gemcOpt.optMap["DIGITIZATION_VARIATION"].args;
 	string digiSnapshotTime = gemcOpt.optMap["DIGITIZATION_TIMESTAMP"].args;
 	
@@ -692,4 +695,4 @@ void ecal_HitProcess::initWithRunNumber(int runno)
 }
 
 // this static function will be loaded first thing by the executable
-ecConstants ecal_HitProcess::ecc = initializeECConstants(-1);
+thread_local ecConstants ecal_HitProcess::ecc = initializeECConstants(-1);
@@ -89,7 +89,7 @@ public:
 	~ecal_HitProcess(){;}
 	
 	// constants initialized with initWithRunNumber
-	static ecConstants ecc;
+	static thread_local ecConstants ecc;
 	
 	void initWithRunNumber(int runno);
 	
@@ -107,7 +107,7 @@ public:
 	
 	// The pure virtual method processID returns a (new) identifier
 	// containing hit sharing information
-	vector<identifier> processID(vector<identifier>, G4Step*, detector);
+	vector<identifier> processID(vector<identifier>, G4Step*, const detector&);
 	
 	// creates the HitProcess
 	static HitProcess *createHitClass() {return new ecal_HitProcess;}
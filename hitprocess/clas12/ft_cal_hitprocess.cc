@@ -13,6 +13,7 @@ using namespace CLHEP;
 #include <CCDB/Calibration.h>
 #include <CCDB/Model/Assignment.h>
 #include <CCDB/CalibrationGenerator.h>
+#include "ccdbCache.h"
 using namespace ccdb;
 
 
@@ -41,7 +42,7 @@ static ftCalConstants initializeFTCALConstants(int runno, string digiVariation =
 	
 	vector<vector<double> > data;
 	
-	unique_ptr<Calibration> calib(CalibrationGenerator::CreateCalibration(ftcc.connection));
+	unique_ptr<cachedCalibration> calib(new cachedCalibration(ftcc.connection));
 	cout<<"Connecting to "<<ftcc.connection<<"/calibration/ft/ftcal"<<endl;
 	
 	if(accountForHardwareStatus) {
@@ -287,7 +288,7 @@ map<string, double> ft_cal_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 	return dgtz;
 }
 
-vector<identifier>  ft_cal_HitProcess :: processID(vector<identifier> id, G4Step* aStep, detector Detector)
+vector<identifier>  ft_cal_HitProcess :: processID(vector<identifier> id, G4Step* aStep, const detector &Detector)
 {
 	id[id.size()-1].id_sharing = 1;
 	return id;
@@ -367,9 +368,9 @@ map< int, vector <double> > ft_cal_HitProcess :: chargeTime(MHit* aHit, int hitn
 	// Get the crystal length: in the FT crystal are BOXes and the half-length is the 3rd element
 	double length = 2 * aHit->GetDetector().dimensions[2];
 	
-	vector<G4ThreeVector> Lpos = aHit->GetLPos();
+	const vector<G4ThreeVector>& Lpos = aHit->GetLPos();
 	
-	vector<G4double> Edep = aHit->GetEdep();
+	const vector<G4double>& Edep = aHit->GetEdep();
 	vector<G4double> time = aHit->GetTime();
 	
 	for (unsigned int s = 0; s < tInfos.nsteps; s++) {
@@ -449,6 +450,8 @@ double ft_cal_HitProcess :: voltage(double charge, double time, double forTime)
 
 void ft_cal_HitProcess::initWithRunNumber(int runno)
 {
+	pulseShapePars = ftcc.vpar;
+
 	string digiVariation    = gemcOpt.optMap["DIGITIZATION_VARIATION"].args;
 	string digiSnapshotTime = gemcOpt.optMap["DIGITIZATION_TIMESTAMP"].args;
 	
@@ -460,7 +463,7 @@ void ft_cal_HitProcess::initWithRunNumber(int runno)
 }
 
 // this static function will be loaded first thing by the executable
-ftCalConstants ft_cal_HitProcess::ftcc = initializeFTCALConstants(-1);
+thread_local ftCalConstants ft_cal_HitProcess::ftcc = initializeFTCALConstants(-1);
 
 
 
@@ -89,7 +89,7 @@ public:
 	
 	// The pure virtual method processID returns a (new) identifier
 	// containing hit sharing information
-	vector<identifier> processID(vector<identifier>, G4Step*, detector);
+	vector<identifier> processID(vector<identifier>, G4Step*, const detector&);
 	
 	// creates the HitProcess
 	static HitProcess *createHitClass() {return new ft_cal_HitProcess;}
@@ -97,7 +97,7 @@ public:
 private:
 	
 	// constants initialized with initWithRunNumber
-	static ftCalConstants ftcc;
+	static thread_local ftCalConstants ftcc;
 	
 	void initWithRunNumber(int runno);
 	
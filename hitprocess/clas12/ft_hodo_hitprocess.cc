@@ -13,6 +13,7 @@ using namespace CLHEP;
 #include <CCDB/Calibration.h>
 #include <CCDB/Model/Assignment.h>
 #include <CCDB/CalibrationGenerator.h>
+#include "ccdbCache.h"
 using namespace ccdb;
 
 static ftHodoConstants initializeFTHODOConstants(int runno, string digiVariation = "default", string digiSnapshotTime = "no", bool accountForHardwareStatus = false)
@@ -38,7 +39,7 @@ static ftHodoConstants initializeFTHODOConstants(int runno, string digiVariation
 		fthc.connection = "mysql://clas12reader@clasdb.jlab.org/clas12";
 	
 	fthc.variation  = "default";
-	unique_ptr<Calibration> calib(CalibrationGenerator::CreateCalibration(fthc.connection));
+	unique_ptr<cachedCalibration> calib(new cachedCalibration(fthc.connection));
 	
 	
 	int isector,ilayer;
@@ -235,7 +236,7 @@ map<string, double> ft_hodo_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 	return dgtz;
 }
 
-vector<identifier>  ft_hodo_HitProcess :: processID(vector<identifier> id, G4Step* aStep, detector Detector)
+vector<identifier>  ft_hodo_HitProcess :: processID(vector<identifier> id, G4Step* aStep, const detector &Detector)
 {
 	id[id.size()-1].id_sharing = 1;
 	return id;
@@ -311,9 +312,9 @@ map< int, vector <double> > ft_hodo_HitProcess :: chargeTime(MHit* aHit, int hit
 	
 	trueInfos tInfos(aHit);
 	
-	vector<G4ThreeVector> Lpos = aHit->GetLPos();
+	const vector<G4ThreeVector>& Lpos = aHit->GetLPos();
 	
-	vector<G4double> Edep = aHit->GetEdep();
+	const vector<G4double>& Edep = aHit->GetEdep();
 	vector<G4double> time = aHit->GetTime();
 	
 	
@@ -356,6 +357,8 @@ double ft_hodo_HitProcess :: voltage(double charge, double time, double forTime)
 
 void ft_hodo_HitProcess::initWithRunNumber(int runno)
 {
+	pulseShapePars = fthc.vpar;
+
 	string digiVariation    = gemcOpt.optMap["DIGITIZATION_VARIATION"].args;
 	string digiSnapshotTime = gemcOpt.optMap["DIGITIZATION_TIMESTAMP"].args;
 	
@@ -368,7 +371,7 @@ void ft_hodo_HitProcess::initWithRunNumber(int runno)
 
 
 // this static function will be loaded first thing by the executable
-ftHodoConstants ft_hodo_HitProcess::fthc = initializeFTHODOConstants(-1);
+thread_local ftHodoConstants ft_hodo_HitProcess::fthc = initializeFTHODOConstants(-1);
 
 
 
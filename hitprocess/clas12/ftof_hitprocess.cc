@@ -5,6 +5,7 @@
 #include <CCDB/Calibration.h>
 #include <CCDB/Model/Assignment.h>
 #include <CCDB/CalibrationGenerator.h>
+#include "ccdbCache.h"
 using namespace ccdb;
 
 // gemc headers
@@ -52,7 +53,7 @@ static ftofConstants initializeFTOFConstants(int runno, string digiVariation = "
 	
 	vector<vector<double> > data;
 	
-	unique_ptr<Calibration> calib(CalibrationGenerator::CreateCalibration(ftc.connection));
+	unique_ptr<cachedCalibration> calib(new cachedCalibration(ftc.connection));
 	cout << "Connecting to " << ftc.connection << "/calibration/ftof" << endl;
 	
 	cout << "FTOF:Getting attenuation" << endl;
@@ -443,7 +444,7 @@ map<string, double> ftof_HitProcess::integrateDgt(MHit* aHit, int hitn) {
 
 
 
-vector<identifier> ftof_HitProcess::processID(vector<identifier> id, G4Step* aStep, detector Detector) {
+vector<identifier> ftof_HitProcess::processID(vector<identifier> id, G4Step* aStep, const detector &Detector) {
 	
 	vector<identifier> yid = id;
 	yid[0].id_sharing = 1; // sector
@@ -539,11 +540,11 @@ map< int, vector <double> > ftof_HitProcess::chargeTime(MHit* aHit, int hitn) {
 	double length = aHit->GetDetector().dimensions[0];
 	
 	// Vector of positions of the hit in each step
-	vector<G4ThreeVector> Lpos = aHit->GetLPos();
+	const vector<G4ThreeVector>& Lpos = aHit->GetLPos();
 	
 	// Vector of Edep and time of the hit in each step
-	vector<G4double> Edep = aHit->GetEdep();
-	vector<G4double> time = aHit->GetTime();
+	const vector<G4double>& Edep = aHit->GetEdep();
+	const vector<G4double>& time = aHit->GetTime();
 	
 	for (unsigned int s = 0; s < tInfos.nsteps; s++) {
 		// Distances from left, right
@@ -657,6 +658,8 @@ double ftof_HitProcess::voltage(double charge, double time, double forTime) {
 
 void ftof_HitProcess::initWithRunNumber(int runno)
 {
+	pulseShapePars = ftc.vpar;
+
 	string digiVariation    = gemcOpt.optMap["DIGITIZATION_VARIATION"].args;
 	string digiSnapshotTime = gemcOpt.optMap["DIGITIZATION_TIMESTAMP"].args;
 	
@@ -668,4 +671,4 @@ void ftof_HitProcess::initWithRunNumber(int runno)
 }
 
 // this static function will be loaded first thing by the executable
-ftofConstants ftof_HitProcess::ftc = initializeFTOFConstants(-1);
+thread_local ftofConstants ftof_HitProcess::ftc = initializeFTOFConstants(-1);
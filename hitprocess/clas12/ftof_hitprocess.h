@@ -94,7 +94,7 @@ public:
 	~ftof_HitProcess(){;}
 	
 	// constants initialized with initWithRunNumber
-	static ftofConstants ftc;
+	static thread_local ftofConstants ftc;
 	
 	void initWithRunNumber(int runno);
 	
@@ -112,7 +112,7 @@ public:
 	
 	// The pure virtual method processID returns a (new) identifier
 	// containing hit sharing information
-	vector<identifier> processID(vector<identifier>, G4Step*, detector);
+	vector<identifier> processID(vector<identifier>, G4Step*, const detector&);
 	
 	// creates the HitProcess
 	static HitProcess *createHitClass() {return new ftof_HitProcess;}
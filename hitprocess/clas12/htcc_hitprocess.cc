@@ -15,6 +15,7 @@ using namespace CLHEP;
 #include <CCDB/Calibration.h>
 #include <CCDB/Model/Assignment.h>
 #include <CCDB/CalibrationGenerator.h>
+#include "ccdbCache.h"
 using namespace ccdb;
 
 static htccConstants initializeHTCCConstants(int runno, string digiVariation = "default", string digiSnapshotTime = "no", bool accountForHardwareStatus = false)
@@ -41,7 +42,7 @@ static htccConstants initializeHTCCConstants(int runno, string digiVariation = "
 	
 	vector<vector<double> > data;
 	
-	unique_ptr<Calibration> calib(CalibrationGenerator::CreateCalibration(htccc.connection));
+	unique_ptr<cachedCalibration> calib(new cachedCalibration(htccc.connection));
 	
 	if(accountForHardwareStatus) {
 		
@@ -317,7 +318,7 @@ map<string, double> htcc_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 }
 
 
-vector<identifier>  htcc_HitProcess :: processID(vector<identifier> id, G4Step *step, detector Detector)
+vector<identifier>  htcc_HitProcess :: processID(vector<identifier> id, G4Step *step, const detector &Detector)
 {
 	id[id.size()-1].id_sharing = 1;
 	return id;
@@ -510,6 +511,8 @@ double htcc_HitProcess :: voltage(double charge, double time, double forTime)
 
 void htcc_HitProcess::initWithRunNumber(int runno)
 {
+	pulseShapePars = htccc.vpar;
+
 	string digiVariation    = gemcOpt.optMap["DIGITIZATION_VARIATION"].args;
 	string digiSnapshotTime = gemcOpt.optMap["DIGITIZATION_TIMESTAMP"].args;
 	
@@ -521,4 +524,4 @@ void htcc_HitProcess::initWithRunNumber(int runno)
 }
 
 // this static function will be loaded first thing by the executable
-htccConstants htcc_HitProcess::htccc = initializeHTCCConstants(-1);
+thread_local htccConstants htcc_HitProcess::htccc = initializeHTCCConstants(-1);
@@ -79,7 +79,7 @@ public:
 	
 	// The pure virtual method processID returns a (new) identifier
 	// containing hit sharing information
-	vector<identifier> processID(vector<identifier>, G4Step*, detector);
+	vector<identifier> processID(vector<identifier>, G4Step*, const detector&);
 	
 	// creates the HitProcess
 	static HitProcess *createHitClass() {return new htcc_HitProcess;}
@@ -87,7 +87,7 @@ public:
 private:
 	
 	// constants initialized with initWithRunNumber
-	static htccConstants htccc;
+	static thread_local htccConstants htccc;
 	
 	void initWithRunNumber(int runno);
 	
@@ -12,6 +12,7 @@
 #include <CCDB/Calibration.h>
 #include <CCDB/Model/Assignment.h>
 #include <CCDB/CalibrationGenerator.h>
+#include "ccdbCache.h"
 using namespace ccdb;
 
 static ltccConstants initializeLTCCConstants(int runno, string digiVariation = "default", string digiSnapshotTime = "no", bool accountForHardwareStatus = false)
@@ -34,7 +35,7 @@ static ltccConstants initializeLTCCConstants(int runno, string digiVariation = "
 	else
 		ltccc.connection = "mysql://clas12reader@clasdb.jlab.org/clas12";
 	
-	unique_ptr<Calibration> calib(CalibrationGenerator::CreateCalibration(ltccc.connection));
+	unique_ptr<cachedCalibration> calib(new cachedCalibration(ltccc.connection));
 	
 	vector<vector<double> > data;
 	// layer = left or right side
@@ -93,7 +94,7 @@ static ltccConstants initializeLTCCConstants(int runno, string digiVariation = "
 map<string, double> ltcc_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 {
 	map<string, double> dgtz;
-	vector<identifier> identity = aHit->GetId();
+	const vector<identifier>& identity = aHit->GetId();
 	rejectHitConditions = false;
 	writeHit = true;
 
@@ -145,9 +146,9 @@ map<string, double> ltcc_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 		return dgtz;
 	}
 	
-	vector<int> tids = aHit->GetTIds();      // track ID at EACH STEP
-	vector<int> pids = aHit->GetPIDs();      // particle ID at EACH STEP
-	vector<double> Energies = aHit->GetEs(); // energy of the photon as it reach the pmt
+	const vector<int>&    tids = aHit->GetTIds();      // track ID at EACH STEP
+	const vector<int>&    pids = aHit->GetPIDs();      // particle ID at EACH STEP
+	const vector<double>& Energies = aHit->GetEs(); // energy of the photon as it reach the pmt
 	
 	
 	map<int, double> penergy;  // key is track id
@@ -228,7 +229,7 @@ map<string, double> ltcc_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 }
 
 
-vector<identifier>  ltcc_HitProcess :: processID(vector<identifier> id, G4Step *step, detector Detector)
+vector<identifier>  ltcc_HitProcess :: processID(vector<identifier> id, G4Step *step, const detector &Detector)
 {
 	id[id.size()-1].id_sharing = 1;
 	return id;
@@ -289,4 +290,4 @@ void ltcc_HitProcess::initWithRunNumber(int runno)
 }
 
 // this static function will be loaded first thing by the executable
-ltccConstants ltcc_HitProcess::ltccc = initializeLTCCConstants(-1);
+thread_local ltccConstants ltcc_HitProcess::ltccc = initializeLTCCConstants(-1);
@@ -52,7 +52,7 @@ public:
 	
 	// The pure virtual method processID returns a (new) identifier
 	// containing hit sharing information
-	vector<identifier> processID(vector<identifier>, G4Step*, detector);
+	vector<identifier> processID(vector<identifier>, G4Step*, const detector&);
 	
 	// creates the HitProcess
 	static HitProcess *createHitClass() {return new ltcc_HitProcess;}
@@ -60,7 +60,7 @@ public:
 private:
 	
 	// constants initialized with initWithRunNumber
-	static ltccConstants ltccc;
+	static thread_local ltccConstants ltccc;
 	
 	void initWithRunNumber(int runno);
 	
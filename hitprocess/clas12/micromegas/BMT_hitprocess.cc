@@ -12,6 +12,7 @@
 #include <CCDB/Calibration.h>
 #include <CCDB/Model/Assignment.h>
 #include <CCDB/CalibrationGenerator.h>
+#include "ccdbCache.h"
 using namespace ccdb;
 
 
@@ -38,7 +39,7 @@ static bmtConstants initializeBMTConstants(int runno, string digiVariation = "de
 	}
 	
 	vector<vector<double> > data;
-	unique_ptr<Calibration> calib(CalibrationGenerator::CreateCalibration(bmtc.connection));
+	unique_ptr<cachedCalibration> calib(new cachedCalibration(bmtc.connection));
 	
 	// Load the geometrical constant for each layer
     snprintf(bmtc.database, sizeof(bmtc.database), "/geometry/cvt/mvt/bmt_layer_noshim:%d:%s%s", bmtc.runNo, digiVariation.c_str(), timestamp.c_str());
@@ -115,7 +116,7 @@ static bmtConstants initializeBMTConstants(int runno, string digiVariation = "de
 map<string, double>  BMT_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 {
 	map<string, double>  dgtz;
-	vector<identifier> identity = aHit->GetId();
+	const vector<identifier>& identity = aHit->GetId();
 	rejectHitConditions = false;
 	writeHit = true;
 
@@ -185,7 +186,7 @@ map<string, double>  BMT_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 
 
 
-vector<identifier>  BMT_HitProcess :: processID(vector<identifier> id, G4Step* aStep, detector Detector)
+vector<identifier>  BMT_HitProcess :: processID(vector<identifier> id, G4Step* aStep, const detector &Detector)
 {
 	vector<identifier> yid = id;
 	class bmt_strip bmts;
@@ -354,7 +355,7 @@ void BMT_HitProcess::initWithRunNumber(int runno)
 
 
 // this static function will be loaded first thing by the executable
-bmtConstants BMT_HitProcess::bmtc = initializeBMTConstants(-1);
+thread_local bmtConstants BMT_HitProcess::bmtc = initializeBMTConstants(-1);
 
 
 
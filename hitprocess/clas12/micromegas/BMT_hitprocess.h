@@ -64,7 +64,7 @@ public:
 	
 	// The pure virtual method processID returns a (new) identifier
 	// containing hit sharing information
-	vector<identifier> processID(vector<identifier>, G4Step*, detector);
+	vector<identifier> processID(vector<identifier>, G4Step*, const detector&);
 	
 	// creates the HitProcess
 	static HitProcess *createHitClass() {return new BMT_HitProcess;}
@@ -73,7 +73,7 @@ public:
 private:
 	
 	// constants initialized with initWithRunNumber
-	static bmtConstants bmtc;
+	static thread_local bmtConstants bmtc;
 	
 	double fieldScale;
 	
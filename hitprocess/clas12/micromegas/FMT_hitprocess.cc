@@ -17,6 +17,7 @@ using namespace CLHEP;
 #include <CCDB/Calibration.h>
 #include <CCDB/Model/Assignment.h>
 #include <CCDB/CalibrationGenerator.h>
+#include "ccdbCache.h"
 using namespace ccdb;
 
 //static fmtConstants initializeFMTConstants(int runno)
@@ -38,7 +39,7 @@ static fmtConstants initializeFMTConstants(int runno, string digiVariation = "de
 	else
 		fmtc.connection = "mysql://clas12reader@clasdb.jlab.org/clas12";
 	
-	unique_ptr<Calibration> calib(CalibrationGenerator::CreateCalibration(fmtc.connection));
+	unique_ptr<cachedCalibration> calib(new cachedCalibration(fmtc.connection));
 	vector<vector<double> > data;
 	//Load the geometrical constant for all layers
 	snprintf(fmtc.database, sizeof(fmtc.database), "/geometry/fmt/fmt_global:%d:%s%s", fmtc.runNo, digiVariation.c_str(), timestamp.c_str());
@@ -91,7 +92,7 @@ static fmtConstants initializeFMTConstants(int runno, string digiVariation = "de
 map<string, double>FMT_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 {
 	map<string, double> dgtz;
-	vector<identifier> identity = aHit->GetId();
+	const vector<identifier>& identity = aHit->GetId();
 	rejectHitConditions = false;
 	writeHit = true;
 
@@ -151,7 +152,7 @@ map<string, double>FMT_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 
 
 
-vector<identifier>  FMT_HitProcess :: processID(vector<identifier> id, G4Step* aStep, detector Detector)
+vector<identifier>  FMT_HitProcess :: processID(vector<identifier> id, G4Step* aStep, const detector &Detector)
 {
 	G4ThreeVector   xyz    = aStep->GetPostStepPoint()->GetPosition();
 	G4ThreeVector  lxyz    = aStep->GetPreStepPoint()->GetTouchableHandle()->GetHistory()->GetTopTransform().TransformPoint(xyz); ///< Local Coordinates of interaction
@@ -292,7 +293,7 @@ void FMT_HitProcess::initWithRunNumber(int runno)
 
 
 // this static function will be loaded first thing by the executable
-fmtConstants FMT_HitProcess::fmtc = initializeFMTConstants(-1);
+thread_local fmtConstants FMT_HitProcess::fmtc = initializeFMTConstants(-1);
 
 
 
@@ -51,7 +51,7 @@ public:
 	
 	// The pure virtual method processID returns a (new) identifier
 	// containing hit sharing information
-	vector<identifier> processID(vector<identifier>, G4Step*, detector);
+	vector<identifier> processID(vector<identifier>, G4Step*, const detector&);
 	
 	// creates the HitProcess
 	static HitProcess *createHitClass() {return new FMT_HitProcess;}
@@ -59,7 +59,7 @@ public:
 private:
 	
 	// constants initialized with initWithRunNumber
-	static fmtConstants fmtc;
+	static thread_local fmtConstants fmtc;
 	
 	void initWithRunNumber(int runno);
 	
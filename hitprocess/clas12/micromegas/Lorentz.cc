@@ -2,6 +2,7 @@
 #include <CCDB/Calibration.h>
 #include <CCDB/Model/Assignment.h>
 #include <CCDB/CalibrationGenerator.h>
+#include "ccdbCache.h"
 
 #include <cmath>
 #include <iostream>
@@ -25,7 +26,7 @@ void Lorentz::Initialize(int runno){
 	
 	variation  = "default";
 	vector<vector<double> > data;
-	unique_ptr<Calibration> calib(CalibrationGenerator::CreateCalibration(connection));
+	unique_ptr<cachedCalibration> calib(new cachedCalibration(connection));
 	
 	snprintf(database, 80, "/calibration/mvt/lorentz");
 	data.clear(); calib->GetCalib(data,database);
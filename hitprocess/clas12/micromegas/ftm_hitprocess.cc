@@ -34,7 +34,7 @@ map<string, double> ftm_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 	rejectHitConditions = false;
 	writeHit = true;
 
-	vector<identifier> identity = aHit->GetId();
+	const vector<identifier>& identity = aHit->GetId();
 	
 	// FTM ID:
 	// layer, type, sector, strip
@@ -70,7 +70,7 @@ map<string, double> ftm_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 
 
 
-vector<identifier> ftm_HitProcess :: processID(vector<identifier> id, G4Step* aStep, detector Detector)
+vector<identifier> ftm_HitProcess :: processID(vector<identifier> id, G4Step* aStep, const detector &Detector)
 {
 	double x, y, z;
 	G4ThreeVector  xyz = aStep->GetPostStepPoint()->GetPosition(); //< Global Coordinates of interaction
@@ -177,7 +177,7 @@ vector<MHit*> ftm_HitProcess :: electronicNoise()
 }
 
 // this static function will be loaded first thing by the executable
-ftmConstants ftm_HitProcess::ftmcc = initializeFTMConstants(-1);
+thread_local ftmConstants ftm_HitProcess::ftmcc = initializeFTMConstants(-1);
 
 
 void ftm_HitProcess::initWithRunNumber(int runno)
@@ -49,7 +49,7 @@ public:
 	
 	// The pure virtual method processID returns a (new) identifier
 	// containing hit sharing information
-	vector<identifier> processID(vector<identifier>, G4Step*, detector);
+	vector<identifier> processID(vector<identifier>, G4Step*, const detector&);
 	
 	// creates the HitProcess
 	static HitProcess *createHitClass() {return new ftm_HitProcess;}
@@ -60,7 +60,7 @@ public:
 private:
 	
 	// constants initialized with initWithRunNumber
-	static ftmConstants ftmcc;
+	static thread_local ftmConstants ftmcc;
 	
 	void initWithRunNumber(int runno);
 	
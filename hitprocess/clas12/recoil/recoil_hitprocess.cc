@@ -18,6 +18,7 @@ using namespace CLHEP;
 #include <CCDB/Calibration.h>
 #include <CCDB/Model/Assignment.h>
 #include <CCDB/CalibrationGenerator.h>
+#include "ccdbCache.h"
 using namespace ccdb;
 
 static recoilConstants initializerecoilConstants(int runno, string digiVariation = "default", string digiSnapshotTime = "no", bool accountForHardwareStatus = false)
@@ -42,7 +43,7 @@ static recoilConstants initializerecoilConstants(int runno, string digiVariation
 	recoil.connection = "mysql://clas12reader@clasdb.jlab.org/clas12";*/
 	
 	/*
-	 unique_ptr<Calibration> calib(CalibrationGenerator::CreateCalibration(fmtc.connection));
+	 unique_ptr<cachedCalibration> calib(new cachedCalibration(fmtc.connection));
 	 vector<vector<double> > data;
 	 //Load the geometrical constant for all layers
 	 sprintf(fmtc.database,"/geometry/recoil/recoil_global:%d:%s%s", fmtc.runNo, digiVariation.c_str(), timestamp.c_str());
@@ -93,7 +94,7 @@ static recoilConstants initializerecoilConstants(int runno, string digiVariation
 map<string, double>recoil_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 {
 	map<string, double> dgtz;
-	vector<identifier> identity = aHit->GetId();
+	const vector<identifier>& identity = aHit->GetId();
 	rejectHitConditions = false;
 	writeHit = true;
 
@@ -124,7 +125,7 @@ map<string, double>recoil_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 	
 }
 
-vector<identifier> recoil_HitProcess :: processID(vector<identifier> id, G4Step* aStep, detector Detector)
+vector<identifier> recoil_HitProcess :: processID(vector<identifier> id, G4Step* aStep, const detector &Detector)
 {
 	
 	//recoilConstants recoilC;
@@ -278,7 +279,7 @@ void recoil_HitProcess::initWithRunNumber(int runno)
 }
 
 // this static function will be loaded first thing by the executable
-recoilConstants recoil_HitProcess::recoilC = initializerecoilConstants(1);
+thread_local recoilConstants recoil_HitProcess::recoilC = initializerecoilConstants(1);
 
 
 
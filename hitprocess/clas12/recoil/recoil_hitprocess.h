@@ -51,7 +51,7 @@ public:
 	
 	// The pure virtual method processID returns a (new) identifier
 	// containing hit sharing information
-	vector<identifier> processID(vector<identifier>, G4Step*, detector);
+	vector<identifier> processID(vector<identifier>, G4Step*, const detector&);
 	
 	// creates the HitProcess
 	static HitProcess *createHitClass() {return new recoil_HitProcess;}
@@ -59,7 +59,7 @@ public:
 private:
 	
 	// constants initialized with initWithRunNumber
-	static recoilConstants recoilC;
+	static thread_local recoilConstants recoilC;
 	
 	void initWithRunNumber(int runno);
 	
@@ -6,6 +6,7 @@
 #include <CCDB/Calibration.h>
 #include <CCDB/Model/Assignment.h>
 #include <CCDB/CalibrationGenerator.h>
+#include "ccdbCache.h"
 
 using namespace ccdb;
 
@@ -38,7 +39,7 @@ initializeRICHConstants(int runno, string digiVariation = "default", string digi
     richc.connection = "mysql://clas12reader@clasdb.jlab.org/clas12";
   
   richc.variation  = "main";
-  unique_ptr<Calibration> calib(CalibrationGenerator::CreateCalibration(richc.connection));
+  unique_ptr<cachedCalibration> calib(new cachedCalibration(richc.connection));
   
   return richc;
 }
@@ -53,7 +54,7 @@ map<string, double> rich_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 
 	trueInfos tInfos(aHit);
 
-        vector<identifier> identity = aHit->GetId();
+        const vector<identifier>& identity = aHit->GetId();
 	vector<double> time = aHit->GetTime();
         int idsector = identity[0].id;
 	
@@ -61,6 +62,25 @@ map<string, double> rich_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 	int idpmt = identity[1].id;
 	int tile = richc.pmtToTile[idpmt-1];
 
+	// background and optical photon map hits: the pixel is in the identifier id.
+	// The map photoelectrons include the quantum efficiency, see photonEfficiency.
+	// Only the leading edge is produced
+	if(aHit->isBackgroundHit == 1) {
+		int bgpixel = identity[2].id;
+		int bgMarocChannel = richc.anodeToMaroc[bgpixel-1];
+
+		writeHit = true;
+		rejectHitConditions = false;
+
+		dgtz["hitn"]      = hitn;
+		dgtz["sector"]    = idsector;
+		dgtz["layer"]     = tile;
+		dgtz["component"] = bgMarocChannel + (richc.pmtToTilePosition[idpmt-1]-1)*64;
+		dgtz["TDC_TDC"]   = convert_to_precision(time[0]);
+		dgtz["TDC_order"] = 1;
+		return dgtz;
+	}
+
 	// tdc bank: readout channel number
 	// pixel, order, tdc already set in processID
         int idpixel = identity[2].userInfos[2];
@@ -74,12 +94,29 @@ map<string, double> rich_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 	writeHit = true;
 	rejectHitConditions = false;
 
+	double energy = aHit->GetEs()[0]/electronvolt;
+	double qeff = quantumEfficiency(idsector, idpmt, energy);
+	
+	// applying quantum efficiency from thrown random value set in integrateDgt
+	if( identity[2].userInfos[3] > qeff && !aHit->isElectronicNoise) {
+	  writeHit = false;
+	}
+	dgtz["hitn"]   = hitn;
+	dgtz["sector"] = idsector; 
+	dgtz["layer"] = tile;
+	dgtz["component"] = tileChannel;
+	dgtz["TDC_TDC"] = convert_to_precision(tdc);
+	dgtz["TDC_order"] = order;
+	return dgtz;
+}
+
+double rich_HitProcess :: quantumEfficiency(int sector, int pmt, double energy)
+{
 	int pmtType = 12700;
 	// sector 4: mix of H12700 and H8500
-	if(idsector == 4){
-	  pmtType = richc.pmtType[idpmt-1];
+	if(sector == 4){
+	  pmtType = richc.pmtType[pmt-1];
 	}
-	double energy = aHit->GetEs()[0]/electronvolt;
 	double qeff = 0;
 	
 	if(pmtType == 8500){
@@ -110,17 +147,15 @@ map<string, double> rich_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 	}
 	
 	
-	// applying quantum efficiency from thrown random value set in integrateDgt
-	if( identity[2].userInfos[3] > qeff && !aHit->isElectronicNoise) {
-	  writeHit = false;
-	}
-	dgtz["hitn"]   = hitn;
-	dgtz["sector"] = idsector; 
-	dgtz["layer"] = tile;
-	dgtz["component"] = tileChannel;
-	dgtz["TDC_TDC"] = convert_to_precision(tdc);
-	dgtz["TDC_order"] = order;
-	return dgtz;
+	return qeff;
+}
+
+// the optical photon map calibration weights each photon with the quantum efficiency of its pmt
+double rich_HitProcess :: photonEfficiency(MHit* aHit, unsigned step)
+{
+	const vector<identifier>& identity = aHit->GetId();
+	
+	return quantumEfficiency(identity[0].id, identity[1].id, aHit->GetEs()[step]/electronvolt);
 }
 
 #include "G4VVisManager.hh"
@@ -128,7 +163,7 @@ map<string, double> rich_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 #include "G4VisAttributes.hh"
 #include "G4ParticleTable.hh"
 
-vector<identifier> rich_HitProcess :: processID(vector<identifier> id, G4Step* aStep, detector Detector)
+vector<identifier> rich_HitProcess :: processID(vector<identifier> id, G4Step* aStep, const detector &Detector)
 {
         vector<identifier> yid = id;
         // id[0]: sector
@@ -272,7 +307,7 @@ double rich_HitProcess::voltage(double charge, double time, double forTime) {
 
 
 // this static function will be loaded first thing by the executable
-richConstants rich_HitProcess::richc = initializeRICHConstants(-1);
+thread_local richConstants rich_HitProcess::richc = initializeRICHConstants(-1);
 
 
 // PMT local position to pixel number
@@ -343,7 +343,10 @@ public:
 	
 	// The pure virtual method processID returns a (new) identifier
 	// containing hit sharing information
-	vector<identifier> processID(vector<identifier>, G4Step*, detector);
+	vector<identifier> processID(vector<identifier>, G4Step*, const detector&);
+	
+	// - photonEfficiency: the PMT quantum efficiency, so that the optical photon map includes it
+	double photonEfficiency(MHit*, unsigned step);
 	
 	// creates the HitProcess
 	static HitProcess *createHitClass() {return new rich_HitProcess;}
@@ -351,7 +354,7 @@ public:
 private:
 	
 	// constants initialized with initWithRunNumber
-	static richConstants richc;
+	static thread_local richConstants richc;
 	
 	void initWithRunNumber(int runno);
 	
@@ -362,6 +365,9 @@ private:
         int getPixelNumber(G4ThreeVector  Lxyz);
         G4ThreeVector getPixelCenter(int pixel);
 
+        // quantum efficiency of the pmt for a photon energy in eV. Sector 4 has a mix of H8500 and H12700
+        double quantumEfficiency(int sector, int pmt, double energy);
+
         // just converting double tdc to int for 1ns tdc precision
 	double tdc_precision = 1.; 
         int convert_to_precision(double time) {
@@ -12,6 +12,7 @@ using namespace CLHEP;
 #include <CCDB/Calibration.h>
 #include <CCDB/Model/Assignment.h>
 #include <CCDB/CalibrationGenerator.h>
+#include "ccdbCache.h"
 using namespace ccdb;
 
 // gemc headers
@@ -41,7 +42,7 @@ static rtpcConstants initializeRTPCConstants(int runno, string digiVariation = "
 	else
 		rtpcc.connection = "mysql://clas12reader@clasdb.jlab.org/clas12";
 	
-	unique_ptr<Calibration> calib(CalibrationGenerator::CreateCalibration(rtpcc.connection));
+	unique_ptr<cachedCalibration> calib(new cachedCalibration(rtpcc.connection));
 	cout << "Connecting to " << rtpcc.connection << "/calibration/rtpc" << endl;
 	
 	
@@ -174,21 +175,21 @@ map<string, double> rtpc_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 	TPC_TZERO = 0.0;
 	
 	map<string, double> dgtz;
-	vector<identifier> identity = aHit->GetId();
+	const vector<identifier>& identity = aHit->GetId();
 	
 	// true information
 	// for example tInfos.eTot is total energy deposited
 	trueInfos tInfos(aHit);
 	
 	// local variable for each step
-	vector<G4ThreeVector> Lpos = aHit->GetLPos();
+	const vector<G4ThreeVector>& Lpos = aHit->GetLPos();
 	
 	// take momentum for each step
-	vector<G4ThreeVector> Lmom = aHit->GetMoms();
+	const vector<G4ThreeVector>& Lmom = aHit->GetMoms();
 	
 	// energy at each step
 	// so tInfos.eTot is the sum of all steps s of Edep[s]
-	vector<double>      Edep = aHit->GetEdep();
+	const vector<double>& Edep = aHit->GetEdep();
 	
 	// -------------------------- TIME SHIFT for non-primary tracks ---------------------------
 	//M. U.: map.find(Key) tries to find an entry with that key, if it doesn't find it, it will return map.end()
@@ -202,10 +203,10 @@ map<string, double> rtpc_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 	}
 	
 	//cout<<"kp: aHit->GetTId(): "<<aHit->GetTId()<<endl;
-	vector<int> tids = aHit->GetTIds();
-	vector<int> mtids = aHit->GetmTrackIds();  
+	const vector<int>& tids = aHit->GetTIds();
+	const vector<int>& mtids = aHit->GetmTrackIds();  
 	//raws["otid"]    = (double) aHit->GetoTrackId(); 
-	vector<int>    otids = aHit->GetoTrackIds();
+	const vector<int>& otids = aHit->GetoTrackIds();
 	/*
 	cout<<"kp: tInfos.nsteps = "<<tInfos.nsteps<<" aHit->GetTIds().size() = "<<tids.size()
 	    <<" aHit->GetmTrackIds().size() = "<<mtids.size()<<" aHit->GetoTrackIDs().size() = "<<otids.size()<<endl; 
@@ -342,7 +343,7 @@ map<string, double> rtpc_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 
 
 
-vector<identifier>  rtpc_HitProcess :: processID(vector<identifier> id, G4Step* aStep, detector Detector)
+vector<identifier>  rtpc_HitProcess :: processID(vector<identifier> id, G4Step* aStep, const detector &Detector)
 {
 	//cout << " In processID ***************" << endl;
 	
@@ -517,7 +518,7 @@ void rtpc_HitProcess::initWithRunNumber(int runno)
 
 // this static function will be loaded first thing by the executable
 // setup 11 instead of -1 (in the clas12Tags) because z0, z2, z4 are also used in processID, they need to be loaded first. Moreover, only run 11 in CCDB has appropricate parameters for simulation. 
-rtpcConstants rtpc_HitProcess::rtpcc = initializeRTPCConstants(-1);
+thread_local rtpcConstants rtpc_HitProcess::rtpcc = initializeRTPCConstants(-1);
 
 // add class and member function which can read constants from ccdb in rtpc_hitprocess.X files for the future needed, but comment out them for now (2023.10.03)
 // 
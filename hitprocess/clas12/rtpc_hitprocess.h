@@ -39,7 +39,7 @@ public:
 	~rtpc_HitProcess(){;}
 	
 	// constants initialized with initWithRunNumber
-	static rtpcConstants rtpcc;
+	static thread_local rtpcConstants rtpcc;
 	
 	void initWithRunNumber(int runno);
 	
@@ -58,7 +58,7 @@ public:
 	
 	// The pure virtual method processID returns a (new) identifier
 	// containing hit sharing information
-	vector<identifier> processID(vector<identifier>, G4Step*, detector);
+	vector<identifier> processID(vector<identifier>, G4Step*, const detector&);
 	
 	// creates the HitProcess
 	static HitProcess *createHitClass() {return new rtpc_HitProcess;}
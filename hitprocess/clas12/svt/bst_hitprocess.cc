@@ -29,7 +29,7 @@ static bstConstants initializeBSTConstants(int runno, string digiVariation = "de
 map<string, double> bst_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 {
 	map<string, double> dgtz;
-	vector<identifier> identity = aHit->GetId();
+	const vector<identifier>& identity = aHit->GetId();
 	rejectHitConditions = false;
 	writeHit = true;
 
@@ -133,7 +133,7 @@ map<string, double> bst_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 
 
 
-vector<identifier> bst_HitProcess :: processID(vector<identifier> id, G4Step* aStep, detector Detector)
+vector<identifier> bst_HitProcess :: processID(vector<identifier> id, G4Step* aStep, const detector &Detector)
 {
 	// yid is the current strip identifier.
 	// it has 5 dimensions:
@@ -325,4 +325,4 @@ void bst_HitProcess::initWithRunNumber(int runno)
 }
 
 // this static function will be loaded first thing by the executable
-bstConstants bst_HitProcess::bstc = initializeBSTConstants(-1);
+thread_local bstConstants bst_HitProcess::bstc = initializeBSTConstants(-1);
@@ -56,7 +56,7 @@ public:
 	
 	// The pure virtual method processID returns a (new) identifier
 	// containing hit sharing information
-	vector<identifier> processID(vector<identifier>, G4Step*, detector);
+	vector<identifier> processID(vector<identifier>, G4Step*, const detector&);
 	
 	// creates the HitProcess
 	static HitProcess *createHitClass() {return new bst_HitProcess;}
@@ -64,7 +64,7 @@ public:
 private:
 	
 	// constants initialized with initWithRunNumber
-	static bstConstants bstc;
+	static thread_local bstConstants bstc;
 	
 	void initWithRunNumber(int runno);
 	
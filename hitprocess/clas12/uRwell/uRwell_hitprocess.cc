@@ -18,6 +18,7 @@ using namespace CLHEP;
 #include <CCDB/Calibration.h>
 #include <CCDB/Model/Assignment.h>
 #include <CCDB/CalibrationGenerator.h>
+#include "ccdbCache.h"
 using namespace ccdb;
 
 static uRwellConstants initializeuRwellConstants(int runno, string digiVariation = "default", string digiSnapshotTime = "no", bool accountForHardwareStatus = false)
@@ -42,7 +43,7 @@ static uRwellConstants initializeuRwellConstants(int runno, string digiVariation
 		urwellC.connection = "mysql://clas12reader@clasdb.jlab.org/clas12";
 	
 	/*
-	 unique_ptr<Calibration> calib(CalibrationGenerator::CreateCalibration(fmtc.connection));
+	 unique_ptr<cachedCalibration> calib(new cachedCalibration(fmtc.connection));
 	 vector<vector<double> > data;
 	 //Load the geometrical constant for all layers
 	 sprintf(fmtc.database,"/geometry/uRwell/uRwell_global:%d:%s%s", fmtc.runNo, digiVariation.c_str(), timestamp.c_str());
@@ -99,7 +100,7 @@ static uRwellConstants initializeuRwellConstants(int runno, string digiVariation
 map<string, double>uRwell_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 {
 	map<string, double> dgtz;
-	vector<identifier> identity = aHit->GetId();
+	const vector<identifier>& identity = aHit->GetId();
 	rejectHitConditions = false;
 	writeHit = true;
 
@@ -133,7 +134,7 @@ map<string, double>uRwell_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 
 
 
-vector<identifier> uRwell_HitProcess :: processID(vector<identifier> id, G4Step* aStep, detector Detector)
+vector<identifier> uRwell_HitProcess :: processID(vector<identifier> id, G4Step* aStep, const detector &Detector)
 {
 	
 	//uRwellConstants uRwellC;
@@ -330,7 +331,7 @@ void uRwell_HitProcess::initWithRunNumber(int runno)
 
 
 // this static function will be loaded first thing by the executable
-uRwellConstants uRwell_HitProcess::uRwellC = initializeuRwellConstants(1);
+thread_local uRwellConstants uRwell_HitProcess::uRwellC = initializeuRwellConstants(1);
 
 
 
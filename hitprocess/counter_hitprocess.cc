@@ -4,7 +4,7 @@
 map<string, double> counter_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 {
 	map<string, double> dgtz;
-	vector<identifier> identity = aHit->GetId();
+	const vector<identifier>& identity = aHit->GetId();
 	
 	int id  = identity[0].id;
 	
@@ -16,8 +16,8 @@ map<string, double> counter_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 	
 	
 	// now counting the particles
-	vector<int> pids = aHit->GetPIDs();
-	vector<int> tids = aHit->GetTIds();
+	const vector<int>& pids = aHit->GetPIDs();
+	const vector<int>& tids = aHit->GetTIds();
 	
 	int ngamma, nep, nem, npip, npim, npi0, nkp, nkm, nk0, nproton, nneutron, noptphoton;
 	ngamma     = 0;
@@ -75,7 +75,7 @@ map<string, double> counter_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 	return dgtz;
 }
 
-vector<identifier>  counter_HitProcess :: processID(vector<identifier> id, G4Step* aStep, detector Detector)
+vector<identifier>  counter_HitProcess :: processID(vector<identifier> id, G4Step* aStep, const detector &Detector)
 {
 	id[id.size()-1].id_sharing = 1;
 	return id;
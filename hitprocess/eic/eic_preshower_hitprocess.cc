@@ -15,7 +15,7 @@ using namespace ccdb;
 map<string, double> eic_preshower_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 {
 	map<string, double> dgtz;	
-	vector<identifier> identity = aHit->GetId();
+	const vector<identifier>& identity = aHit->GetId();
 
 	trueInfos tInfos(aHit);
 
@@ -51,7 +51,7 @@ map<string, double> eic_preshower_HitProcess :: integrateDgt(MHit* aHit, int hit
 	return dgtz;
 }
 
-vector<identifier>  eic_preshower_HitProcess :: processID(vector<identifier> id, G4Step* aStep, detector Detector)
+vector<identifier>  eic_preshower_HitProcess :: processID(vector<identifier> id, G4Step* aStep, const detector &Detector)
 {
 	id[id.size()-1].id_sharing = 1;
 	return id;
@@ -15,17 +15,17 @@ using namespace ccdb;
 map<string, double> eic_rich_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 {
 	map<string, double> dgtz;
-	vector<identifier> identity = aHit->GetId();
+	const vector<identifier>& identity = aHit->GetId();
 
 	trueInfos tInfos(aHit);
 //	predefined variable Etot, x, y, z, lx, ly, lz, time
 	
 	int nsteps = aHit->GetPos().size();
 		
-	vector<G4ThreeVector> pos  = aHit->GetPos();
-	vector<G4ThreeVector> Lpos = aHit->GetLPos();
-	vector<G4double> times = aHit->GetTime();
-	vector<G4ThreeVector> p = aHit->GetMoms();	
+	const vector<G4ThreeVector>& pos  = aHit->GetPos();
+	const vector<G4ThreeVector>& Lpos = aHit->GetLPos();
+	const vector<G4double>&      times = aHit->GetTime();
+	const vector<G4ThreeVector>& p = aHit->GetMoms();	
 
 	dgtz["nsteps"] = nsteps;	
 	dgtz["in_px"] = p[0].x();
@@ -74,7 +74,7 @@ map<string, double> eic_rich_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 	return dgtz;  
 }
 
-vector<identifier>  eic_rich_HitProcess :: processID(vector<identifier> id, G4Step* aStep, detector Detector)
+vector<identifier>  eic_rich_HitProcess :: processID(vector<identifier> id, G4Step* aStep, const detector &Detector)
 {
 	id[id.size()-1].id_sharing = 1;
 	return id;
@@ -12,7 +12,7 @@ map<string, double> bubble_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 	rejectHitConditions = false;
 	writeHit = true;
 
-	vector<identifier> identity = aHit->GetId();
+	const vector<identifier>& identity = aHit->GetId();
 	int thisPid = aHit->GetPID();
 	double totEnergy = aHit->GetE();
 	
@@ -31,7 +31,7 @@ map<string, double> bubble_HitProcess :: integrateDgt(MHit* aHit, int hitn)
 	return dgtz;
 }
 
-vector<identifier>  bubble_HitProcess :: processID(vector<identifier> id, G4Step* aStep, detector Detector)
+vector<identifier>  bubble_HitProcess :: processID(vector<identifier> id, G4Step* aStep, const detector &Detector)
 {
 	id[id.size()-1].id_sharing = 1;
 	return id;
@@ -164,7 +164,7 @@ void material::opticalsFromString(string property, string what) {
 // Then load the MYSQL, TEXT and GDML
 // When all the detectors materials are moved to TEXT/MYSQL/GDML
 // the CPP factory should be empty
-map<string, G4Material *> buildMaterials(map <string, materialFactory> materialFactoryMap, goptions go, runConditions rc) {
+map<string, G4Material *> buildMaterials(map <string, materialFactory> materialFactoryMap, goptions go, runConditions rc, map <string, map<string, material> > *records) {
     // Loading CPP def
     materials *materialSelectedFactory = getMaterialFactory(&materialFactoryMap, "CPP");
     map < string, G4Material * > mats = materialSelectedFactory->initMaterials(rc, go);
@@ -188,10 +188,35 @@ map<string, G4Material *> buildMaterials(map <string, materialFactory> materialF
         mats[it->first] = it->second;
     }
 
+    if (records != nullptr) {
+        (*records)["MYSQL"] = mysqlFactory->records;
+        (*records)["TEXT"] = textFactory->records;
+        (*records)["SQLITE"] = sqliteFactory->records;
+    }
+
+    return mats;
+}
+
+// same order as buildMaterials: later factories overwrite materials with the same name
+map<string, G4Material *> buildMaterialsFromRecords(map <string, materialFactory> materialFactoryMap, goptions go, runConditions rc, map <string, map<string, material> > records) {
+    // Loading CPP def
+    materials *materialSelectedFactory = getMaterialFactory(&materialFactoryMap, "CPP");
+    map < string, G4Material * > mats = materialSelectedFactory->initMaterials(rc, go);
+
+    vector <string> dbFactories = {"MYSQL", "TEXT", "SQLITE"};
+    for (auto &f: dbFactories) {
+        materials *dbFactory = getMaterialFactory(&materialFactoryMap, f);
+        map < string, G4Material * > dbMats = dbFactory->materialsFromMap(records[f]);
+        for (map<string, G4Material *>::iterator it = dbMats.begin(); it != dbMats.end(); it++)
+            mats[it->first] = it->second;
+    }
+
     return mats;
 }
 
 map<string, G4Material *> materials::materialsFromMap(map <string, material> mmap) {
+    records = mmap;
+
     G4NistManager *matman = G4NistManager::Instance();   // material G4 Manager
     set <string> nistMap;
 
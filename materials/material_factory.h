@@ -66,6 +66,7 @@ class materials
 		// Pure Virtual Method to initialize G4 Materials
 		virtual map<string, G4Material*> initMaterials(runConditions, goptions) = 0;
 		map<string, G4Material*> materialsFromMap(map<string, material>);
+		map<string, material> records;   ///< material records passed to materialsFromMap
 		virtual ~materials(){}
 };
 
@@ -75,7 +76,11 @@ materials *getMaterialFactory(map<string, materialFactory> *, string);  // retur
 
 map<string, materialFactory> registerMaterialFactories();               // Registers materialFactory in Factory Map
 
-map<string, G4Material*> buildMaterials(map<string, materialFactory> materialFactoryMap, goptions go, runConditions rc);
+// if records is given, it is filled with the material records of each database factory
+map<string, G4Material*> buildMaterials(map<string, materialFactory> materialFactoryMap, goptions go, runConditions rc, map<string, map<string, material> > *records = nullptr);
+
+// build materials from the records filled by buildMaterials, without accessing the databases
+map<string, G4Material*> buildMaterialsFromRecords(map<string, materialFactory> materialFactoryMap, goptions go, runConditions rc, map<string, map<string, material> > records);
 
 // build material with standard isotopes.
 map<string, G4Material*> materialsWithIsotopes();
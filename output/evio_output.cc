@@ -3,6 +3,7 @@
 #include "gemcUtils.h"
 
 // C++ headers
+#include <array>
 #include <fstream>
 
 // CLHEP units
@@ -113,6 +114,50 @@ void evio_output :: writeUserInfoseHeader(outputContainer* output, map<string, d
 	*event << userHeaderBank;
 }
 
+// process dictionary: one string "id: name" for each process, in its own record as the simulation conditions
+void evio_output :: writeProcessDictionary(outputContainer* output, const map<int, string>& processes)
+{
+	vector<string> data;
+	for(auto &process : processes) {
+		data.push_back(to_string(process.first) + ":  " + process.second);
+	}
+
+	evioDOMTree *processBank = new evioDOMTree(PROCESS_DICTIONARY_BANK_TAG, 0);
+	*processBank << evioDOMNode::createEvioDOMNode(PROCESS_DICTIONARY_BANK_TAG, 1, data);
+	output->pchan->write(*processBank);
+	delete processBank;
+}
+
+// profile: NUM 1 has the detector names, 2 and 3 the steps and hits,
+// 10 + stage and 20 + stage the CPU and wall times in ms, 30 the peak resident memory in kB
+void evio_output :: writeProfile(outputContainer* output, const map<string, detectorProfile>& profiles, long peakRSS)
+{
+	vector<string> names;
+	vector<int> steps, hits;
+	vector<double> cpu[PROFILE_NSTAGES], wall[PROFILE_NSTAGES];
+	for(auto &profile : profiles) {
+		names.push_back(profile.first);
+		steps.push_back(profile.second.steps);
+		hits.push_back(profile.second.hits);
+		for(int s=0; s<PROFILE_NSTAGES; s++) {
+			cpu[s].push_back(1000*profile.second.cpu[s]);
+			wall[s].push_back(1000*profile.second.wall[s]);
+		}
+	}
+
+	evioDOMNodeP profileBank = evioDOMNode::createEvioDOMNode(PROFILE_BANK_TAG, 0);
+	*profileBank << evioDOMNode::createEvioDOMNode(PROFILE_BANK_TAG, 1, names);
+	*profileBank << evioDOMNode::createEvioDOMNode(PROFILE_BANK_TAG, 2, steps);
+	*profileBank << evioDOMNode::createEvioDOMNode(PROFILE_BANK_TAG, 3, hits);
+	for(int s=0; s<PROFILE_NSTAGES; s++) {
+		*profileBank << evioDOMNode::createEvioDOMNode(PROFILE_BANK_TAG, 10 + s, cpu[s]);
+		*profileBank << evioDOMNode::createEvioDOMNode(PROFILE_BANK_TAG, 20 + s, wall[s]);
+	}
+	*profileBank << evioDOMNode::createEvioDOMNode(PROFILE_BANK_TAG, 30, vector<int>(1, (int) peakRSS));
+
+	*event << profileBank;
+}
+
 
 void evio_output :: writeRFSignal(outputContainer* output, FrequencySyncSignal rfsignals, gBank bank)
 {
@@ -330,14 +375,13 @@ void evio_output :: writeAncestors (outputContainer* output, vector<ancestorInfo
 void evio_output :: initBank(outputContainer* output, gBank thisHitBank, int what)
 {
 
-	static int oldEvn;
-
 	// new event, initialize everything
 	if(oldEvn != evn) {
 		insideBank.clear();
 		insideRawIntBank.clear();
 		insideDgtIntBank.clear();
 		insideRawAllBank.clear();
+		insideChargeTimeBank.clear();
 		oldEvn = evn;
 	}
 
@@ -380,63 +424,56 @@ void evio_output :: initBank(outputContainer* output, gBank thisHitBank, int wha
 }
 
 
-void evio_output :: writeG4RawIntegrated(outputContainer* output, vector<hitOutput> HO, string hitType, map<string, gBank> *banksMap)
+void evio_output :: writeG4RawIntegrated(outputContainer* output, const vector<hitOutput>& HO, string hitType, map<string, gBank> *banksMap)
 {
 	if(HO.size() == 0) return;
 
-	gBank thisHitBank = getBankFromMap(hitType, banksMap);
-	gBank rawBank = getBankFromMap("raws", banksMap);
+	const gBank &thisHitBank = getBankFromMap(hitType, banksMap);
+	const gBank &rawBank = getBankFromMap("raws", banksMap);
 
 	initBank(output, thisHitBank, RAWINT_ID);
 
-	for(map<int, string>::iterator it =  rawBank.orderedNames.begin(); it != rawBank.orderedNames.end(); it++) {
-		int bankId   = rawBank.getVarId(it->second);
-		int bankType = rawBank.getVarBankType(it->second);
+	// we only need the first hit to get the definitions
+	const hitColumns &raws = HO[0].getRaws();
 
-		// we only need the first hit to get the definitions
-		map<string, double> raws = HO[0].getRaws();
-
-		if(raws.find(it->second) != raws.end() && bankId > 0 && bankType == RAWINT_ID) {
-			vector<double> thisVar;
+	for(unsigned c=0; c<rawBank.columns.size(); c++) {
+		const gBankColumn &column = rawBank.columns[c];
+		if(raws.has(c) && column.gid > 0 && column.bankType == RAWINT_ID) {
+			vector<double> thisVar(HO.size());
 			for(unsigned int nh=0; nh<HO.size(); nh++)
 			{
-				map<string, double> theseRaws = HO[nh].getRaws();
-				thisVar.push_back(theseRaws[it->second]);
+				thisVar[nh] = HO[nh].getRaws().get(c);
 			}
-			*(detectorRawIntBank[thisHitBank.bankName]) << addVector(rawBank.idtag + thisHitBank.idtag, bankId, rawBank.getVarType(it->second), thisVar);
+			*(detectorRawIntBank[thisHitBank.bankName]) << addVector(rawBank.idtag + thisHitBank.idtag, column.gid, column.varType, thisVar);
 		}
 	}
 }
 
 
-void evio_output :: writeG4DgtIntegrated(outputContainer* output, vector<hitOutput> HO, string hitType, map<string, gBank> *banksMap)
+void evio_output :: writeG4DgtIntegrated(outputContainer* output, const vector<hitOutput>& HO, string hitType, map<string, gBank> *banksMap)
 {
 	if(HO.size() == 0) return;
 	
-	gBank thisHitBank = getBankFromMap(hitType, banksMap);
-	gBank dgtBank = getDgtBankFromMap(hitType, banksMap);
+	const gBank &thisHitBank = getBankFromMap(hitType, banksMap);
 
 	initBank(output, thisHitBank, DGTINT_ID);
 
-	for(map<int, string>::iterator it =  dgtBank.orderedNames.begin(); it != dgtBank.orderedNames.end(); it++) {
-		int bankId   = dgtBank.getVarId(it->second);
-		int bankType = dgtBank.getVarBankType(it->second);
-
-		// we only need the first hit to get the definitions
-		map<string, double> dgts = HO[0].getDgtz();
+	// we only need the first hit to get the definitions
+	const hitColumns &dgts = HO[0].getDgtz();
 
-		if(dgts.find(it->second) != dgts.end() && bankId > 0 && bankType == DGTINT_ID) {
-			vector<double> thisVar;
+	// the detector bank may have definitions other than DGT: only the DGT columns are written
+	for(unsigned c=0; c<thisHitBank.columns.size(); c++) {
+		const gBankColumn &column = thisHitBank.columns[c];
+		if(dgts.has(c) && column.gid > 0 && column.bankType == DGTINT_ID) {
+			vector<double> thisVar(HO.size());
 			for(unsigned int nh=0; nh<HO.size(); nh++) {
-				map<string, double> theseDgts = HO[nh].getDgtz();
-				thisVar.push_back(theseDgts[it->second]);
+				thisVar[nh] = HO[nh].getDgtz().get(c);
 			}
-			*(detectorDgtIntBank[thisHitBank.bankName]) << addVector(dgtBank.idtag + thisHitBank.idtag, bankId, dgtBank.getVarType(it->second), thisVar);
+			*(detectorDgtIntBank[thisHitBank.bankName]) << addVector(DGTINT_ID + thisHitBank.idtag, column.gid, column.varType, thisVar);
 		}
 	}
 }
 
-
 // index 0: hit number
 // index 1: step index
 // index 2: charge at electronics
@@ -536,7 +573,7 @@ void evio_output :: writeG4RawAll(outputContainer* output, vector<hitOutput> HO,
 	}
 }
 
-void evio_output :: writeFADCMode1( map<int,  vector<hitOutput> > HO , int ev_number){
+void evio_output :: writeFADCMode1(const map<int, vector<hitOutput> > &HO, int ev_number){
 
 	if(HO.size() == 0) return;
 
@@ -550,61 +587,36 @@ void evio_output :: writeFADCMode1( map<int,  vector<hitOutput> > HO , int ev_nu
 	unsigned int *buf_crate_begin = nullptr; //
 
 	// The map of hardware data, The Key is the crate/slot/channel combination,
-	// and the value is a map of FADC counts as a function of sample number.
+	// and the value is the quantized signal of the hit.
 	// Note: 1st three counts represents actually the hardware identification info, i.e. crate/slot/channel, and other elements starting
 	// from 3 up to nsamples+3 represent FADC counts
-	map<string, map<int, int> > hardwareData;
+	map<array<int, 3>, const vector<int>* > hardwareData;
 
 	// map that counts how many channels are in the crate
-	map<string, int> numberOfChannelsPerCrate;
+	map<int, int> numberOfChannelsPerCrate;
 
-	//for(unsigned int nh=0; nh<HO.size(); nh++) {
-	for (std::map<int, vector<hitOutput> >::iterator it_crate=HO.begin(); it_crate!=HO.end(); ++it_crate){
-		// QuantumS is a map, KEY is an FADC sample number, and value is the FADC counts
-		// NOTE 1st three elements of it (KEY = 0, 1, 2) represent crate/slot/chann, and KEYs (3, 4, ... nsampes+2 ) represent FADC counts
+	for(auto &crateHits : HO) {
 
-		for( unsigned int i_hit = 0; i_hit < it_crate->second.size(); i_hit++ ){
+		for(auto &hit : crateHits.second) {
 
-			map<int, int> quantumS = (it_crate->second).at(i_hit).getQuantumS();
-
-			// Let's get hardware identifiers
-			string crate = fillDigits(to_string((int) quantumS[0]), "#", 5);
-			string slot  = fillDigits(to_string((int) quantumS[1]), "#", 5);
-			string chann = fillDigits(to_string((int) quantumS[2]), "#", 5);
+			const vector<int> &quantumS = hit.getQuantumS();
 
 			// crate-slot-channel key
-			string hardwareKey = crate + "-" + slot + "-" + chann;
+			array<int, 3> hardwareKey = {quantumS[0], quantumS[1], quantumS[2]};
 
 			// only fill hardware if it's not present already
 			// the time window of a detector could be smaller than
 			// the electronic time window
 			// Make sure also the vector of step times is not empty,
-			if(hardwareData.find(hardwareKey) == hardwareData.end() && (it_crate->second.at(i_hit).getChargeTime()[3]).size() > 0  ) {
-				hardwareData[hardwareKey] = it_crate->second.at(i_hit).getQuantumS();
-			} else {
-				// ======== It was checked, here we have only empty hits, or hits that way off in time, e.g. hit_t = 1200ns
-				//                            cout<<"Warning this hardware is already filled"<<endl;
-				//			    cout<<"hardwareKey is "<<hardwareKey<<"      !!!"<<endl;
-				//                            for( int ii = 0; ii < (it_crate->second.at(i_hit).getChargeTime()[3]).size();ii++ ){
-				//
-				//                               cout<<"       time = " <<(it_crate->second.at(i_hit).getChargeTime()[3]).at(ii)<<"     ";
-				//                            }
-				//                            cout<<endl;
-
+			// otherwise we have only empty hits, or hits that way off in time, e.g. hit_t = 1200ns
+			if(hardwareData.find(hardwareKey) != hardwareData.end() || hit.getChargeTimeVar(3).size() == 0) {
 				continue;
 			}
+			hardwareData[hardwareKey] = &quantumS;
 
 			// We should keep track of number of channels in the crate
 			// With this counter, This counter will show, whether all the channels in that crate are already processed
-
-			string CrateKey = crate;
-
-			if( numberOfChannelsPerCrate.find(CrateKey) == numberOfChannelsPerCrate.end() ){
-				numberOfChannelsPerCrate[CrateKey] = 1;
-			} else {
-				numberOfChannelsPerCrate[CrateKey] ++;
-			}
-
+			numberOfChannelsPerCrate[quantumS[0]]++;
 		}
 	}
 
@@ -626,16 +638,9 @@ void evio_output :: writeFADCMode1( map<int,  vector<hitOutput> > HO , int ev_nu
 
 	for(auto &hd : hardwareData) {
 
-		vector<string> thisHardwareKey = getStringVectorFromStringWithDelimiter(hd.first, "-");
-
-		int crate = stoi(trimSpacesFromString(replaceCharInStringWithChars(thisHardwareKey[0], "#", " ")));
-		int slot  = stoi(trimSpacesFromString(replaceCharInStringWithChars(thisHardwareKey[1], "#", " ")));
-		int chann = stoi(trimSpacesFromString(replaceCharInStringWithChars(thisHardwareKey[2], "#", " ")));
-
-		string scrate = fillDigits(to_string(crate), "#", 5);
-		string sslot  = fillDigits(to_string(slot),  "#", 5);
-		string hardwareKey = scrate + "-" + sslot;
-		string sCrateKey = scrate;
+		int crate = hd.first[0];
+		int slot  = hd.first[1];
+		int chann = hd.first[2];
 
 
 		//  Check, if the crate is new crate, then save the curre
@@ -718,23 +723,19 @@ void evio_output :: writeFADCMode1( map<int,  vector<hitOutput> > HO , int ev_nu
 
 		nsamples = (uint32_t*) b08out; // put multi-hit dinamically: first, save current position
 		PUT32(0); // now reserve space for sample counter
-		for( map<int, int>::iterator it_isample = (hd.second).begin(); it_isample != (hd.second).end(); it_isample++ ) {
-
-			// Remember 1st three elements are crate/slot/chann, therefore we want other elements hd[3], hd[4] ... hd[nsample + 3 -1]
-			if( it_isample->first < 3 ){
-				continue;
-			}
 
-			//cout<<"value = "<<it_isample->second<<endl;
-			PUT16(abs(it_isample->second));
-			*nsamples = *nsamples + 1;
+		// Remember 1st three elements are crate/slot/chann, therefore we want other elements hd[3], hd[4] ... hd[nsample + 3 -1]
+		const vector<int> &quantumS = *hd.second;
+		for(unsigned isample = 3; isample < quantumS.size(); isample++) {
+			PUT16(abs(quantumS[isample]));
 		}
+		*nsamples = *nsamples + (quantumS.size() - 3);
 
 
 
 		// Check if all the data under this crate is processed, if yes, the
 		// data should be dumped into evio
-		if( nchannelThisCrate == numberOfChannelsPerCrate[sCrateKey] && newCrate != nullptr ){
+		if( nchannelThisCrate == numberOfChannelsPerCrate[crate] && newCrate != nullptr ){
 
 			//int finalNumberOfWords = (b08out - (uint8_t*)buf_crate_begin + 3) / 4;
 			//int finalNumberOfWords = (b08out - (uint8_t*)buf_crate_begin + 3) / 4;
@@ -826,19 +827,19 @@ void evio_output :: writeFADCMode1(outputContainer* output, vector<hitOutput> HO
 
 
 	// The map of hardware data, The Key is the crate/slot/channel combination,
-	// and the value is a map of FADC counts as a function of sample number.
+	// and the value is the quantized signal of the hit.
 	// Note: 1st three counts represents actually the hardware identification info, i.e. crate/slot/channel, and other elements starting
 	// from 3 up to nsamples+3 represent FADC counts
-	map<string, map<int, int> > hardwareData;
+	map<string, vector<int> > hardwareData;
 
 	// map that counts how many channels are in the crate
 	map<string, int> numberOfChannelsPerCrate;
 
 	for(unsigned int nh=0; nh<HO.size(); nh++) {
 
-		// QuantumS is a map, KEY is an FADC sample number, and value is the FADC counts
-		// NOTE 1st three elements of it (KEY = 0, 1, 2) represent crate/slot/chann, and KEYs (3, 4, ... nsampes+2 ) represent FADC counts
-		map<int, int> quantumS = HO[nh].getQuantumS();
+		// QuantumS holds the FADC counts as a function of sample number
+		// NOTE 1st three elements of it (0, 1, 2) represent crate/slot/chann, and elements (3, 4, ... nsampes+2 ) represent FADC counts
+		const vector<int> &quantumS = HO[nh].getQuantumS();
 
 		// Let's get hardware identifiers
 		string crate = fillDigits(to_string((int) quantumS[0]), "#", 5);
@@ -989,15 +990,9 @@ void evio_output :: writeFADCMode1(outputContainer* output, vector<hitOutput> HO
 
 		nsamples = (uint32_t*) b08out; // put multi-hit dinamically: first, save current position
 		PUT32(0); // now reserve space for sample counter
-		for( map<int, int>::iterator it_isample = (hd.second).begin(); it_isample != (hd.second).end(); it_isample++ ) {
-
-			// Remember 1st three elements are crate/slot/chann, therefore we want other elements hd[3], hd[4] ... hd[nsample + 3 -1]
-			if( it_isample->first < 3 ){
-				continue;
-			}
-
-			//cout<<"value = "<<it_isample->second<<endl;
-			PUT16(abs(it_isample->second));
+		// Remember 1st three elements are crate/slot/chann, therefore we want other elements hd[3], hd[4] ... hd[nsample + 3 -1]
+		for(unsigned isample = 3; isample < hd.second.size(); isample++) {
+			PUT16(abs(hd.second[isample]));
 			*nsamples = *nsamples + 1;
 		}
 
@@ -1085,7 +1080,7 @@ void evio_output :: writeFADCMode7(outputContainer* output, vector<hitOutput> HO
 
 	int banktag = 0xe102;
 
-	map<string, map<int, int> > hardwareData;
+	map<string, vector<int> > hardwareData;
 
 	// map that counts how many channels are active / slot
 	map<string, int> numberOfChannelsPerSlot;
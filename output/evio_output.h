@@ -17,7 +17,7 @@
 class evio_output : public outputFactory
 {
 public:
-	~evio_output(){;}  ///< event is deleted in WriteEvent routine
+	~evio_output(){;}  ///< event is deleted in WriteEvent routine. The bank flags are reset by initBank at each new event
 	static outputFactory *createOutput() {return new evio_output;}
 	
 	// record the simulation conditions on the file
@@ -29,6 +29,12 @@ public:
 	// write user infos header
 	void writeUserInfoseHeader(outputContainer*, map<string, double>);
 	
+	// write the process dictionary
+	void writeProcessDictionary(outputContainer*, const map<int, string>&);
+	
+	// write the event profile
+	void writeProfile(outputContainer*, const map<string, detectorProfile>&, long peakRSS);
+	
 	// format output and set insideBank
 	void initBank(outputContainer*, gBank, int what);
 	
@@ -42,10 +48,10 @@ public:
 	virtual void writeRFSignal(outputContainer*, FrequencySyncSignal, gBank);
 	
 	// write geant4 raw integrated info
-	void writeG4RawIntegrated(outputContainer*, vector<hitOutput>,  string, map<string, gBank>*);
+	void writeG4RawIntegrated(outputContainer*, const vector<hitOutput>&,  string, map<string, gBank>*);
 	
 	// write geant4 digitized integrated info
-	void writeG4DgtIntegrated(outputContainer*, vector<hitOutput>,  string, map<string, gBank>*);
+	void writeG4DgtIntegrated(outputContainer*, const vector<hitOutput>&,  string, map<string, gBank>*);
 	
 	// write geant4 charge / time (as seen by electronic) info
 	virtual void writeChargeTime(outputContainer*, vector<hitOutput>, string, map<string, gBank>*);
@@ -59,7 +65,7 @@ public:
 	// write fadc mode 1 (full signal shape) - jlab hybrid banks. This uses the translation table to write the crate/slot/channel
 	// This method should be called once at the end of event action, and the 1st argument 
 	// is a map<int crate_id, vector<hitoutput> (vector of all hits from that crate) >
-	virtual void writeFADCMode1( map<int, vector<hitOutput> >, int);
+	virtual void writeFADCMode1(const map<int, vector<hitOutput> >&, int);
 	
 	// write fadc mode 7 (integrated mode) - jlab hybrid banks. This uses the translation table to write the crate/slot/channel
 	virtual void writeFADCMode7(outputContainer*, vector<hitOutput>, int);
@@ -82,6 +88,7 @@ public:
 	map<string, bool> insideChargeTimeBank;
 	
 	int evn;
+	int oldEvn = -1;   ///< event number of the last initBank call
 	
 	
 	//	static bool is_conf_written;
@@ -13,6 +13,9 @@
 #include "string_utilities.h"
 #include "gemcUtils.h"
 
+// C++ headers
+#include <algorithm>
+
 // Variable Type is two chars.
 // The first char:
 //  R for raw integrated
@@ -124,6 +127,20 @@ map <string, gBank> read_banks(goptions gemcOpt, map <string, string> allSystems
     abank.orderNames();
     banks["raws"] = abank;
 
+    // integrateRaw fills the raws columns by slot
+    static const char *rawSlotNames[RAW_NSLOTS] = {
+        "pid", "mpid", "tid", "mtid", "otid", "trackE", "totEdep",
+        "avg_x", "avg_y", "avg_z", "avg_lx", "avg_ly", "avg_lz",
+        "px", "py", "pz", "vx", "vy", "vz", "mvx", "mvy", "mvz",
+        "avg_t", "nsteps", "procID", "hitn"
+    };
+    for (int r = 0; r < RAW_NSLOTS; r++) {
+        if (abank.slot(rawSlotNames[r]) != r) {
+            cout << "   !!! Error: raws bank variable >" << rawSlotNames[r] << "< is not in column slot " << r << ". Exiting." << endl;
+            exit(1);
+        }
+    }
+
 
     // geant4 raw step by step
     // common for all banks
@@ -450,17 +467,59 @@ void gBank::orderNames() {
     }
 
     int j = 0;
+    columns.clear();
     for (int i = minId; i <= maxId; i++) {
         for (unsigned k = 0; k < gid.size(); k++) {
             if (i == gid[k]) {
                 orderedNames[j++] = name[k];
+
+                gBankColumn column;
+                column.name = name[k];
+                column.gid = gid[k];
+                column.varType = getVarType(name[k]);
+                column.bankType = getVarBankType(name[k]);
+                columns.push_back(column);
             }
         }
     }
+
+    slotsByName.clear();
+    for (unsigned c = 0; c < columns.size(); c++) {
+        slotsByName.push_back(make_pair(columns[c].name, (int) c));
+    }
+    sort(slotsByName.begin(), slotsByName.end());
+}
+
+// column slot of a variable, -1 if the bank does not have it
+int gBank::slot(const string &var) const {
+    auto it = lower_bound(slotsByName.begin(), slotsByName.end(), make_pair(var, -1));
+    if (it != slotsByName.end() && it->first == var) return it->second;
+    return -1;
+}
+
+// stores the digitized values of one hit in the column slots
+// both the map and slotsByName are sorted by name: one pass over the two
+hitColumns gBank::compile(const map<string, double> &vars) const {
+    hitColumns compiled(columns.size());
+
+    auto var = vars.begin();
+    auto col = slotsByName.begin();
+    while (var != vars.end() && col != slotsByName.end()) {
+        if (var->first < col->first) {
+            var++;
+        } else if (col->first < var->first) {
+            col++;
+        } else {
+            compiled.set(col->second, var->second);
+            var++;
+            col++;
+        }
+    }
+    return compiled;
 }
 
 // get bank definitions (all)
-gBank getBankFromMap(string name, map <string, gBank> *banksMap) {
+const gBank &getBankFromMap(string name, map <string, gBank> *banksMap) {
     if (banksMap->find(name) == banksMap->end()) {
         cout << "   !!! Error: >" << name << "< bank definitions not found. Exiting." << endl;
         exit(1);
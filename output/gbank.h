@@ -12,6 +12,8 @@
 // C++ headers
 #include <sstream>
 #include <set>
+#include <map>
+#include <vector>
 using namespace std;
 
 
@@ -23,6 +25,12 @@ using namespace std;
 // json format simulation conditions NUM is 0 
 #define SIMULATION_JCONDITIONS_BANK_TAG 6
 
+// process dictionary: IDs of the processes not catalogued by gemc
+#define PROCESS_DICTIONARY_BANK_TAG 7
+
+// per-detector CPU and wall time profile (PROFILE > 1)
+#define PROFILE_BANK_TAG 8
+
 // header bank
 #define HEADER_BANK_TAG 10
 
@@ -105,6 +113,54 @@ using namespace std;
 #define QUANTUM_SIGNAL_ID 6
 
 
+/// \class gBankColumn
+/// <b>gBankColumn </b>\n\n
+/// A bank variable compiled once at startup.\n
+/// The output writers use the resolved id and types
+/// instead of looking them up by name for every hit.\n
+class gBankColumn
+{
+public:
+	string name;       ///< Variable name
+	int    gid;        ///< Output variable identifier
+	string varType;    ///< "i", "l", "d" or "na", as returned by getVarType
+	int    bankType;   ///< RAWINT_ID, DGTINT_ID, etc, as returned by getVarBankType
+};
+
+
+/// \class hitColumns
+/// <b>hitColumns </b>\n\n
+/// The integrated values of one hit, stored by column slot:
+/// the slot is the position of the variable in gBank::columns.\n
+/// Slots that the hit did not set are written as 0.\n
+class hitColumns
+{
+public:
+	hitColumns() {;}
+	hitColumns(unsigned n) : values(n, 0), isSet(n, 0) {;}
+
+	void   set(int slot, double v) {values[slot] = v; isSet[slot] = 1;}
+	bool   has(int slot) const     {return slot >= 0 && slot < (int) isSet.size() && isSet[slot];}
+	double get(int slot) const     {return has(slot) ? values[slot] : 0;}
+	bool   empty() const           {return values.empty();}
+
+private:
+	vector<double> values;
+	vector<char>   isSet;
+};
+
+
+// slots of the "raws" bank columns, in ID order
+// integrateRaw fills them directly, read_banks checks them against the bank definition
+enum rawIntegratedSlot {
+	RAW_PID, RAW_MPID, RAW_TID, RAW_MTID, RAW_OTID, RAW_TRACKE, RAW_TOTEDEP,
+	RAW_AVG_X, RAW_AVG_Y, RAW_AVG_Z, RAW_AVG_LX, RAW_AVG_LY, RAW_AVG_LZ,
+	RAW_PX, RAW_PY, RAW_PZ, RAW_VX, RAW_VY, RAW_VZ, RAW_MVX, RAW_MVY, RAW_MVZ,
+	RAW_AVG_T, RAW_NSTEPS, RAW_PROCID, RAW_HITN,
+	RAW_NSLOTS
+};
+
+
 /// \class gBank
 /// <b>gBank </b>\n\n
 /// This class defines the general bank content.\n
@@ -152,6 +208,19 @@ public:
 	map<int, string> orderedNames;
 	void orderNames();
 
+	// variables ordered by ID, with resolved id and types
+	// compiled by orderNames
+	vector<gBankColumn> columns;
+
+	// column slot of a variable, -1 if the bank does not have it
+	int slot(const string&) const;
+
+	// stores the digitized values of one hit in the column slots
+	// variables that are not bank columns are dropped
+	hitColumns compile(const map<string, double>&) const;
+
+	// (name, slot) sorted by name, compiled by orderNames
+	vector<pair<string, int> > slotsByName;
 
 	friend ostream &operator<<(ostream &stream, gBank);       ///< Overloaded "<<" for the class 'bank'
 
@@ -159,7 +228,7 @@ public:
 
 
 // get bank definitions (all)
-gBank getBankFromMap(string, map<string, gBank>*);
+const gBank& getBankFromMap(string, map<string, gBank>*);
 
 // get dgt bank definitions
 gBank getDgtBankFromMap(string, map<string, gBank>*);
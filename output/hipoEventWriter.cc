@@ -0,0 +1,99 @@
+// gemc headers
+#include "hipoEventWriter.h"
+
+// C++ headers
+#include <iostream>
+using namespace std;
+
+hipoEventWriter::hipoEventWriter(hipo::writer *w, int nBuffers)
+{
+	writer   = w;
+	stopping = false;
+	writing  = false;
+
+	for(int b=0; b<nBuffers; b++) {
+		hipo::event *event = new hipo::event(1024 * 1024 * 2);
+		allEvents.push_back(event);
+		freeEvents.push_back(event);
+	}
+
+	writerThread = thread(&hipoEventWriter::writeLoop, this);
+}
+
+hipoEventWriter::~hipoEventWriter()
+{
+	flush();
+
+	for(auto *event : allEvents)
+		delete event;
+}
+
+hipo::event *hipoEventWriter::acquireEvent()
+{
+	unique_lock<mutex> lock(queueMutex);
+	eventFreed.wait(lock, [this]{ return !freeEvents.empty() || (filledEvents.empty() && !writing); });
+
+	// nothing is in flight: the buffers are held by event threads
+	// that did not complete their events, so the pool grows
+	if(freeEvents.empty()) {
+		hipo::event *event = new hipo::event(1024 * 1024 * 2);
+		allEvents.push_back(event);
+		return event;
+	}
+
+	hipo::event *event = freeEvents.front();
+	freeEvents.pop_front();
+
+	return event;
+}
+
+void hipoEventWriter::queueEvent(hipo::event *event)
+{
+	{
+		lock_guard<mutex> lock(queueMutex);
+		filledEvents.push_back(event);
+	}
+	eventFilled.notify_one();
+}
+
+void hipoEventWriter::flush()
+{
+	{
+		lock_guard<mutex> lock(queueMutex);
+		if(stopping) return;
+		stopping = true;
+	}
+	eventFilled.notify_one();
+
+	if(writerThread.joinable())
+		writerThread.join();
+}
+
+// the record compression and file I/O of hipo::writer::addEvent happen here,
+// outside of the event threads
+void hipoEventWriter::writeLoop()
+{
+	while(true) {
+		hipo::event *event = nullptr;
+		{
+			unique_lock<mutex> lock(queueMutex);
+			eventFilled.wait(lock, [this]{ return stopping || !filledEvents.empty(); });
+
+			// stopping with an empty queue: all events are written
+			if(filledEvents.empty()) return;
+
+			event = filledEvents.front();
+			filledEvents.pop_front();
+			writing = true;
+		}
+
+		writer->addEvent(*event);
+
+		{
+			lock_guard<mutex> lock(queueMutex);
+			freeEvents.push_back(event);
+			writing = false;
+		}
+		eventFreed.notify_one();
+	}
+}
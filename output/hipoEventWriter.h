@@ -0,0 +1,58 @@
+/// \file hipoEventWriter.h
+/// Defines the hipo event writer thread.\n
+/// The event threads fill hipo events taken from a bounded pool
+/// and hand them to a dedicated thread that compresses the records
+/// and writes them to file.\n
+
+#ifndef HIPO_EVENT_WRITER_H
+#define HIPO_EVENT_WRITER_H 1
+
+// Hipo
+#include "hipo4/writer.h"
+
+// C++ headers
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+using namespace std;
+
+/// \class hipoEventWriter
+/// <b> hipoEventWriter </b>\n\n
+/// Owns a pool of nBuffers hipo events (2: double buffering).\n
+/// acquireEvent blocks when all buffers are in flight, so the
+/// memory used by the queue is bounded.
+class hipoEventWriter
+{
+public:
+	hipoEventWriter(hipo::writer *w, int nBuffers);
+	~hipoEventWriter();  ///< writes the queued events and joins the thread
+
+	// returns an empty event to fill. Blocks until one is available
+	hipo::event *acquireEvent();
+
+	// hands a filled event to the writer thread
+	void queueEvent(hipo::event *event);
+
+	// writes the queued events and stops the thread
+	void flush();
+
+private:
+	hipo::writer *writer;
+
+	vector<hipo::event*> allEvents;    ///< events owned by the pool
+	deque<hipo::event*>  freeEvents;   ///< events ready to be filled
+	deque<hipo::event*>  filledEvents; ///< events waiting to be written
+
+	mutex              queueMutex;
+	condition_variable eventFreed;
+	condition_variable eventFilled;
+	thread             writerThread;
+	bool               stopping;
+	bool               writing;      ///< the writer thread is adding an event to the file
+
+	void writeLoop();
+};
+
+#endif
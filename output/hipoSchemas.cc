@@ -25,6 +25,8 @@ HipoSchema::HipoSchema() {
     mcEventHeader = hipo::schema("MC::Event", 40, 1);
     userLund = hipo::schema("MC::User", 40, 5);
     lundParticle = hipo::schema("MC::Lund", 40, 3);
+    // gemc only bank, outside of the coatjava MC group
+    profileSchema = hipo::schema("GEMC::Profile", 32000, 1);
 
     // flux
     fluxADCSchema = hipo::schema("FLUX::adc", 22200, 20);
@@ -91,6 +93,9 @@ HipoSchema::HipoSchema() {
     mcEventHeader.parse("npart/S, atarget/S, ztarget/S, ptarget/F, pbeam/F, btype/S, ebeam/F, targetid/S, processid/S, weight/F");
     userLund.parse("userVar/F");
     lundParticle.parse("index/B, lifetime/F, type/B, pid/I, parent/B, daughter/B, px/F, py/F, pz/F, energy/F, mass/F, vx/F, vy/F, vz/F");
+    profileSchema.parse("detector/S, steps/I, hits/I, "
+                        "cpuTracking/F, cpuSteps/F, cpuMerge/F, cpuRaw/F, cpuDgt/F, cpuVoltage/F, cpuOutput/F, "
+                        "wallTracking/F, wallSteps/F, wallMerge/F, wallRaw/F, wallDgt/F, wallVoltage/F, wallOutput/F, rss/I");
 
     // flux
     fluxADCSchema.parse("sector/B, layer/B, component/S, order/B, ADC/I, amplitude/I, time/F, ped/S");
@@ -165,6 +170,7 @@ HipoSchema::HipoSchema() {
     schemasToLoad["MC::Event"] = mcEventHeader;
     schemasToLoad["MC::User"] = userLund;
     schemasToLoad["MC::Lund"] = lundParticle;
+    schemasToLoad["GEMC::Profile"] = profileSchema;
 
     // flux
     schemasToLoad["FLUX::adc"] = fluxADCSchema;
@@ -279,5 +285,11 @@ void outputContainer::initializeHipo(bool openFile) {
         }
     } else {
         hipoWriter->open(outFile.c_str());
+
+        // record compression and file I/O are moved to a writer thread
+        int nBuffers = (int) gemcOpt.optMap["OUTPUT_QUEUE"].arg;
+        if (nBuffers > 0) {
+            eventWriter = new hipoEventWriter(hipoWriter, nBuffers);
+        }
     }
 }
@@ -15,6 +15,7 @@ public:
 	hipo::schema mcEventHeader;
 	hipo::schema userLund;
 	hipo::schema lundParticle;
+	hipo::schema profileSchema;
 
 	// flux
 	hipo::schema fluxADCSchema;
@@ -3,6 +3,7 @@
 #include "gemcUtils.h"
 
 // C++ headers
+#include <algorithm>
 #include <fstream>
 
 // CLHEP units
@@ -17,6 +18,7 @@ using namespace CLHEP;
 #include <CCDB/Calibration.h>
 #include <CCDB/Model/Assignment.h>
 #include <CCDB/CalibrationGenerator.h>
+#include "ccdbCache.h"
 
 using namespace ccdb;
 
@@ -95,6 +97,15 @@ void hipo_output::recordSimConditions(outputContainer *output, map <string, stri
     // file need to be opened after user configuration is added
     // output->hipoWriter->addUserConfig("GEMC::config",  bigData);
 
+    // the profile bank detector column: one "index: name" line for each detector
+    if (!output->profileDetectors.empty()) {
+        string profileDictionary;
+        for (unsigned d = 0; d < output->profileDetectors.size(); d++) {
+            profileDictionary += to_string(d) + ": " + output->profileDetectors[d] + "\n";
+        }
+        output->hipoWriter->addUserConfig("GEMC::profile", profileDictionary);
+    }
+
     output->initializeHipo(true);
 
 
@@ -131,18 +142,22 @@ void hipo_output::writeHeader(outputContainer *output, map<string, double> data,
     //		cout << ">" << fieldScale.first << "<" << " scaled by: " << fieldScale.second << endl;
     //	}
 
-    // this will never enter the second condition because hipo_output is instantiated every event
+    // hipo_output lives for the whole run: the event buffer is allocated once and reset for each event
+    // with the writer thread the buffer is taken from its pool, and handed back in writeEvent
     if (outEvent == nullptr) {
-        outEvent = new hipo::event(1024 * 1024 * 2);
+        eventWriter = output->eventWriter;
+        if (eventWriter) {
+            outEvent = eventWriter->acquireEvent();
+        } else {
+            outEvent = new hipo::event(1024 * 1024 * 2);
+        }
         //	cout << " Event Size before reset: " << outEvent->getSize() << endl;
-    } else {
-        outEvent->reset();
-        //	cout << " Event Size after reset: " << outEvent->getSize() << endl;
     }
+    outEvent->reset();
 
     // Create runConfigBank with 1 row based on schema
     // second argument is number of hits
-    hipo::bank runConfigBank(output->hipoSchema->runConfigSchema, 1);
+    hipo::bank &runConfigBank = reusableBank(output->hipoSchema->runConfigSchema, 1);
 
     runConfigBank.putInt("run", 0, data["runNo"]);
     runConfigBank.putInt("event", 0, data["evn"]);
@@ -198,7 +213,7 @@ void hipo_output::writeHeader(outputContainer *output, map<string, double> data,
 
         vector <vector<double>> dbdata;
 
-        unique_ptr <Calibration> calib(CalibrationGenerator::CreateCalibration(connection));
+        unique_ptr<cachedCalibration> calib(new cachedCalibration(connection));
         database = database + ":" + to_string(runno) + ":" + digiVariation;
         cout << " Connecting to " << connection << database << " to retrive raster parameters" << endl;
 
@@ -229,8 +244,8 @@ void hipo_output::writeUserInfoseHeader(outputContainer *output, map<string, dou
 
         int userBankSize = data.size() - lundStandardSize;
 
-        hipo::bank mcEventHeaderBank(output->hipoSchema->mcEventHeader, 1);
-        hipo::bank userLundBank(output->hipoSchema->userLund, userBankSize);
+        hipo::bank &mcEventHeaderBank = reusableBank(output->hipoSchema->mcEventHeader, 1);
+        hipo::bank &userLundBank = reusableBank(output->hipoSchema->userLund, userBankSize);
 
         int index = -1;
         for (auto it = data.begin(); it != data.end(); it++) {
@@ -284,6 +299,46 @@ void hipo_output::writeUserInfoseHeader(outputContainer *output, map<string, dou
     }
 }
 
+// hipo banks have no strings: the dictionary is a user configuration string of the file header,
+// one "id: name" line for each process. The file is opened by recordSimConditions
+void hipo_output::writeProcessDictionary(outputContainer *output, const map<int, string> &processes) {
+
+    string dictionary;
+    for (auto &process: processes) {
+        dictionary += to_string(process.first) + ": " + process.second + "\n";
+    }
+
+    output->hipoWriter->addUserConfig("GEMC::processes", dictionary);
+}
+
+// hipo banks have no strings: the detector is the index of its name in the
+// "GEMC::profile" user configuration of the file header. Times are in ms
+void hipo_output::writeProfile(outputContainer *output, const map<string, detectorProfile> &profiles, long peakRSS) {
+
+    static const char *cpuColumns[PROFILE_NSTAGES]  = {"cpuTracking", "cpuSteps", "cpuMerge", "cpuRaw", "cpuDgt", "cpuVoltage", "cpuOutput"};
+    static const char *wallColumns[PROFILE_NSTAGES] = {"wallTracking", "wallSteps", "wallMerge", "wallRaw", "wallDgt", "wallVoltage", "wallOutput"};
+
+    hipo::bank &profileBank = reusableBank(output->hipoSchema->profileSchema, profiles.size());
+
+    const vector <string> &names = output->profileDetectors;
+
+    int row = 0;
+    for (auto &profile: profiles) {
+        int detector = (int) (find(names.begin(), names.end(), profile.first) - names.begin());
+        profileBank.putShort("detector", row, detector < (int) names.size() ? detector : -1);
+        profileBank.putInt("steps", row, profile.second.steps);
+        profileBank.putInt("hits", row, profile.second.hits);
+        for (int s = 0; s < PROFILE_NSTAGES; s++) {
+            profileBank.putFloat(cpuColumns[s], row, 1000 * profile.second.cpu[s]);
+            profileBank.putFloat(wallColumns[s], row, 1000 * profile.second.wall[s]);
+        }
+        profileBank.putInt("rss", row, peakRSS);
+        row++;
+    }
+
+    outEvent->addStructure(profileBank);
+}
+
 
 void hipo_output::writeRFSignal(outputContainer *output, FrequencySyncSignal rfsignals, gBank bank) {
     int verbosity = int(output->gemcOpt.optMap["BANK_VERBOSITY"].arg);
@@ -298,7 +353,7 @@ void hipo_output::writeRFSignal(outputContainer *output, FrequencySyncSignal rfs
     vector<int> ids = rfs.front().getIDs();
     vector<double> times = rfs.front().getValues();
 
-    hipo::bank runRFBank(output->hipoSchema->runRFSchema, ids.size());
+    hipo::bank &runRFBank = reusableBank(output->hipoSchema->runRFSchema, ids.size());
 
     for (unsigned i = 0; i < ids.size(); i++) {
         runRFBank.putShort("id", i, (short) ids[i]);
@@ -351,7 +406,7 @@ void hipo_output::writeGenerated(outputContainer *output, vector <generatedParti
         btime.push_back(MGP[i].time);
     }
 
-    hipo::bank geantParticleBank(output->hipoSchema->geantParticle, pid.size());
+    hipo::bank &geantParticleBank = reusableBank(output->hipoSchema->geantParticle, pid.size());
 
     for (unsigned i = 0; i < pid.size(); i++) {
 
@@ -373,7 +428,7 @@ void hipo_output::writeGenerated(outputContainer *output, vector <generatedParti
     outEvent->addStructure(geantParticleBank);
 
 
-    hipo::bank lundParticleBank(output->hipoSchema->lundParticle, userInfo.size());
+    hipo::bank &lundParticleBank = reusableBank(output->hipoSchema->lundParticle, userInfo.size());
 
     // p is particle index
     for (unsigned p = 0; p < userInfo.size(); p++) {
@@ -453,7 +508,7 @@ void hipo_output::writeGenerated(outputContainer *output, vector <generatedParti
     peds[0] = (short) ((vx[0] / cm - rasterP0[0]) / rasterP1[0]);
     peds[1] = (short) ((vy[0] / cm - rasterP0[1]) / rasterP1[1]);
 
-    hipo::bank rasterBank(output->hipoSchema->rasterADCSchema, 2);
+    hipo::bank &rasterBank = reusableBank(output->hipoSchema->rasterADCSchema, 2);
 
     // zero var infos
     for (int j = 0; j < 2; j++) {
@@ -518,110 +573,197 @@ void hipo_output::prepareEvent(outputContainer *output, map<string, double> *con
         cout << " Total true info bank entries: " << nBankEntries << endl;
     }
 
-    hipo::schema trueInfoSchema = output->hipoSchema->trueInfoSchema;
+    trueInfoBank = &reusableBank(output->hipoSchema->trueInfoSchema, nBankEntries);
+
+}
+
+// zeroes the rows of a reused bank, as in a newly allocated one
+static void clearBankRows(hipo::bank &bank) {
+    hipo::schema &schema = bank.getSchema();
+
+    for (int item = 0; item < schema.getEntries(); item++) {
+        int type = schema.getEntryType(item);
+        for (int row = 0; row < bank.getRows(); row++) {
+            switch (type) {
+                case 1:
+                    bank.putByte(item, row, 0);
+                    break;
+                case 2:
+                    bank.putShort(item, row, 0);
+                    break;
+                case 3:
+                    bank.putInt(item, row, 0);
+                    break;
+                case 4:
+                    bank.putFloat(item, row, 0);
+                    break;
+                case 5:
+                    bank.putDouble(item, row, 0);
+                    break;
+                case 8:
+                    bank.putLong(item, row, 0);
+                    break;
+            }
+        }
+    }
+}
+
+// the bank buffers only grow: after the first events no allocation is needed
+hipo::bank &hipo_output::reusableBank(hipo::schema &schema, int rows, int type) {
+    pair<string, int> key(schema.getName(), type);
 
-    trueInfoBank = new hipo::bank(trueInfoSchema, nBankEntries);
+    auto bank = reusableBanks.find(key);
+    if (bank == reusableBanks.end()) {
+        bank = reusableBanks.emplace(key, hipo::bank(schema, rows)).first;
+    } else {
+        bank->second.setRows(rows);
+        clearBankRows(bank->second);
+    }
 
+    return bank->second;
 }
 
-void hipo_output::writeG4RawIntegrated(outputContainer *output, vector <hitOutput> HO, string hitType, map <string, gBank> *banksMap) {
+void hipo_output::writeG4RawIntegrated(outputContainer *output, const vector <hitOutput> &HO, string hitType, map <string, gBank> *banksMap) {
     if (HO.size() == 0) return;
     int verbosity = int(output->gemcOpt.optMap["BANK_VERBOSITY"].arg);
 
-    gBank thisHitBank = getBankFromMap(hitType, banksMap);
-    gBank rawBank = getBankFromMap("raws", banksMap);
+    const gBank &thisHitBank = getBankFromMap(hitType, banksMap);
+    const gBank &rawBank = getBankFromMap("raws", banksMap);
 
     // perform initializations if necessary
     initBank(output, thisHitBank, RAWINT_ID);
 
     // we only need the first hit to get the definitions
-    map<string, double> raws = HO[0].getRaws();
+    const hitColumns &raws = HO[0].getRaws();
 
     int detectorID = getDetectorID(hitType);
 
-    // looping over the loaded banknames (this to make sure we only publish the ones declared
-    // we actually never used this steps and it's actually cumbersome. To be removed in gemc3
-    for (auto &bankName: rawBank.orderedNames) {
-
-        string bname = bankName.second;
-        int bankId = rawBank.getVarId(bname);       // bankId is num
-        int bankType = rawBank.getVarBankType(bname); // bankType: 1 = raw 2 = dgt
-
-        if (raws.find(bname) != raws.end() && bankId > 0 && bankType == RAWINT_ID) {
-
-            // looping over the hits
-            for (unsigned int nh = 0; nh < HO.size(); nh++) {
+    // the hipo items are resolved once for each bank column, not for every hit
+    hipo::schema &trueInfoSchema = output->hipoSchema->trueInfoSchema;
 
-                int hipoBankIndex = lastHipoTrueInfoBankIndex + nh;
-
-                map<string, double> theseRaws = HO[nh].getRaws();
+    if (!raws.empty()) {
+        int detectorItem = trueInfoSchema.getEntryOrder("detector");
+        for (unsigned int nh = 0; nh < HO.size(); nh++) {
+            trueInfoBank->putByte(detectorItem, lastHipoTrueInfoBankIndex + nh, detectorID);
+        }
+    }
 
-                trueInfoBank->putByte("detector", hipoBankIndex, detectorID);
+    for (unsigned c = 0; c < rawBank.columns.size(); c++) {
+        const gBankColumn &column = rawBank.columns[c];
 
-                for (auto &thisVar: theseRaws) {
+        if (!raws.has(c) || column.gid <= 0 || column.bankType != RAWINT_ID) continue;
 
-                    // found data match to bank definition
-                    if (thisVar.first == bname) {
+        string hipoName = getHipoVariableName(column.name);
+        int hipoItem = trueInfoSchema.getEntryOrder(hipoName.c_str());
 
-                        string varType = rawBank.getVarType(thisVar.first);
+        // looping over the hits
+        for (unsigned int nh = 0; nh < HO.size(); nh++) {
 
-                        string hipoName = getHipoVariableName(bname);
+            int hipoBankIndex = lastHipoTrueInfoBankIndex + nh;
 
-                        if (hipoName == "hitn") {
-                            thisVar.second = nh + 1;
-                        }
+            const hitColumns &theseRaws = HO[nh].getRaws();
+            if (!theseRaws.has(c)) continue;
 
-                        if (varType == "i") {
-                            trueInfoBank->putInt(hipoName.c_str(), hipoBankIndex, thisVar.second);
-                        } else if (varType == "d") {
-                            trueInfoBank->putFloat(hipoName.c_str(), hipoBankIndex, thisVar.second);
-                        }
+            double value = theseRaws.get(c);
+            if (hipoName == "hitn") {
+                value = nh + 1;
+            }
 
-                        if (verbosity > 2) {
-                            cout << " Hit Type: " << hitType << ", detector id: " << detectorID << ", hit index " << nh << ", bank hit index " << hipoBankIndex << ", name " << bname << ", hname "
-                                 << hipoName << ", value: " << thisVar.second << ", raw/dgt: " << bankType << ", type: " << varType << endl;
-                        }
-                    }
-                }
+            if (column.varType == "i") {
+                trueInfoBank->putInt(hipoItem, hipoBankIndex, value);
+            } else if (column.varType == "d") {
+                trueInfoBank->putFloat(hipoItem, hipoBankIndex, value);
             }
 
+            if (verbosity > 2) {
+                cout << " Hit Type: " << hitType << ", detector id: " << detectorID << ", hit index " << nh << ", bank hit index " << hipoBankIndex << ", name " << column.name << ", hname "
+                     << hipoName << ", value: " << value << ", raw/dgt: " << column.bankType << ", type: " << column.varType << endl;
+            }
         }
     }
     lastHipoTrueInfoBankIndex = lastHipoTrueInfoBankIndex + HO.size();
+}
 
 
-    // loop over variable names
-    for (map<int, string>::iterator it = rawBank.orderedNames.begin(); it != rawBank.orderedNames.end(); it++) {
-
-        int bankId = rawBank.getVarId(it->second);
-        int bankType = rawBank.getVarBankType(it->second);
-
-        // we only need the first hit to get the definitions
-        map<string, double> raws = HO[0].getRaws();
-
-        if (raws.find(it->second) != raws.end() && bankId > 0 && bankType == RAWINT_ID) {
-            vector<double> thisVar;
-            for (unsigned int nh = 0; nh < HO.size(); nh++) {
-                map<string, double> theseRaws = HO[nh].getRaws();
-                thisVar.push_back(theseRaws[it->second]);
-            }
+// hipo item of a digitized bank column, resolved once per column
+// kind is the hipo type: 'b'yte, 's'hort, 'i'nt, 'f'loat, 'l'ong. 0 if the column is not in this bank
+struct hipoDgtItem {
+    int item = -1;
+    char kind = 0;
+};
+
+// sector, layer, component are common in adc/tdc so their names are w/o prefix
+// all other vars must begin with the bank prefix: "ADC_", "TDC_" or "WF136_"
+static hipoDgtItem resolveDgtItem(hipo::schema &schema, const gBankColumn &column, string prefix) {
+    hipoDgtItem hitem;
+    const string &bname = column.name;
+    string hipoName;
+
+    // sector, layers are "Bytes"
+    if (bname == "sector" || bname == "layer" || bname == "order") {
+        hipoName = bname;
+        hitem.kind = 'b';
+    } else if (bname == "component") {
+        hipoName = bname;
+        hitem.kind = 's';
+    } else if (prefix == "WF136_") {
+        if (bname == "WF136_timestamp") {
+            hipoName = "timestamp";
+            hitem.kind = 'l';
+        } else if (bname.find("WF136_s") == 0) {
+            // sample number is the string following "WF136_s" converted to int
+            int sample_value = stoi(bname.substr(7));
+            hipoName = "s" + to_string(sample_value);
+            hitem.kind = 's';
         }
+    } else if (bname.find(prefix) == 0) {
+        hipoName = bname.substr(prefix.size());
+        if (column.varType == "i") {
+            hitem.kind = 'i';
+        } else if (column.varType == "d") {
+            hitem.kind = 'f';
+        } else if (column.varType == "l") {
+            hitem.kind = 'l';
+        }
+    }
+
+    if (hitem.kind) {
+        hitem.item = schema.getEntryOrder(hipoName.c_str());
     }
+    return hitem;
 }
 
+static void putDgtValue(hipo::bank &bank, const hipoDgtItem &hitem, int index, double value) {
+    switch (hitem.kind) {
+        case 'b':
+            bank.putByte(hitem.item, index, value);
+            break;
+        case 's':
+            bank.putShort(hitem.item, index, value);
+            break;
+        case 'i':
+            bank.putInt(hitem.item, index, value);
+            break;
+        case 'f':
+            bank.putFloat(hitem.item, index, value);
+            break;
+        case 'l':
+            bank.putLong(hitem.item, index, value);
+            break;
+    }
+}
 
-void hipo_output::writeG4DgtIntegrated(outputContainer *output, vector <hitOutput> HO, string hitType, map <string, gBank> *banksMap) {
+void hipo_output::writeG4DgtIntegrated(outputContainer *output, const vector <hitOutput> &HO, string hitType, map <string, gBank> *banksMap) {
     if (HO.size() == 0) return;
     int verbosity = int(output->gemcOpt.optMap["BANK_VERBOSITY"].arg);
 
-    gBank thisHitBank = getBankFromMap(hitType, banksMap);
-    gBank dgtBank = getDgtBankFromMap(hitType, banksMap);
+    const gBank &thisHitBank = getBankFromMap(hitType, banksMap);
 
     // perform initializations if necessary
     initBank(output, thisHitBank, DGTINT_ID);
 
     // we only need the first hit to get the definitions
-    map<string, double> dgts = HO[0].getDgtz();
+    const hitColumns &dgts = HO[0].getDgtz();
 
     bool hasADCBank = false;
     bool hasTDCBank = false;
@@ -630,23 +772,26 @@ void hipo_output::writeG4DgtIntegrated(outputContainer *output, vector <hitOutpu
     hipo::schema detectorADCSchema = output->hipoSchema->getSchema(hitType, 0);
     hipo::schema detectorTDCSchema = output->hipoSchema->getSchema(hitType, 1);
     hipo::schema detectorWF136Schema = output->hipoSchema->getSchema(hitType, 2);
-    hipo::bank detectorADCBank(detectorADCSchema, HO.size());
-    hipo::bank detectorTDCBank(detectorTDCSchema, HO.size());
-    hipo::bank detectorWF136Bank(detectorWF136Schema, HO.size());
+    hipo::bank &detectorADCBank = reusableBank(detectorADCSchema, HO.size(), 0);
+    hipo::bank &detectorTDCBank = reusableBank(detectorTDCSchema, HO.size(), 1);
+    hipo::bank &detectorWF136Bank = reusableBank(detectorWF136Schema, HO.size(), 2);
 
     // check if there is at least one adc or tdc var
     // and if the schema is valid
-    for (auto &bankName: dgtBank.orderedNames) {
+    // the detector bank may have definitions other than DGT: only the DGT columns are written
+    for (auto &column: thisHitBank.columns) {
+
+        if (column.bankType != DGTINT_ID) continue;
 
         // flag ADC content if any variable has ADC_ prefix AND detectorADCSchema exists
-        if (bankName.second.find("ADC_") != string::npos) {
+        if (column.name.find("ADC_") != string::npos) {
             if (detectorADCSchema.getEntryName(0) != "empty") {
                 hasADCBank = true;
             }
         }
 
         // flag TDC content if any variable has TDC_ prefix detectorTDCSchema schema exists
-        if (bankName.second.find("TDC_") != string::npos) {
+        if (column.name.find("TDC_") != string::npos) {
 
             if (detectorTDCSchema.getEntryName(0) != "empty") {
                 hasTDCBank = true;
@@ -654,7 +799,7 @@ void hipo_output::writeG4DgtIntegrated(outputContainer *output, vector <hitOutpu
         }
 
         // flag WF136 content if any variable has WF136_ prefix detectorWF136Schema schema exists
-        if (bankName.second.find("WF136_") != string::npos) {
+        if (column.name.find("WF136_") != string::npos) {
 
             if (detectorWF136Schema.getEntryName(0) != "empty") {
                 hasWF136Bank = true;
@@ -674,142 +819,35 @@ void hipo_output::writeG4DgtIntegrated(outputContainer *output, vector <hitOutpu
         }
     }
 
+    // looping over the compiled bank columns: the hipo items are resolved once per column,
+    // then each hit value is read from the column slot
+    for (unsigned c = 0; c < thisHitBank.columns.size(); c++) {
+        const gBankColumn &column = thisHitBank.columns[c];
 
-    // looping over the loaded banknames (this to make sure we only publish the ones declared
-    // we actually never used this steps and it's actually cumbersome. To be removed in gemc3
-    for (auto &bankName: dgtBank.orderedNames) {
-
-        string bname = bankName.second;
-        int bankId = dgtBank.getVarId(bname);       // bankId is num
-        int bankType = dgtBank.getVarBankType(bname); // bankType: 1 = raw 2 = dgt
+        if (!dgts.has(c) || column.gid <= 0 || column.bankType != DGTINT_ID) continue;
 
-        if (dgts.find(bname) != dgts.end() && bankId > 0 && bankType == DGTINT_ID) {
+        hipoDgtItem adcItem, tdcItem, wf136Item;
+        if (hasADCBank) adcItem = resolveDgtItem(detectorADCSchema, column, "ADC_");
+        if (hasTDCBank) tdcItem = resolveDgtItem(detectorTDCSchema, column, "TDC_");
+        if (hasWF136Bank) wf136Item = resolveDgtItem(detectorWF136Schema, column, "WF136_");
 
-            if (hasADCBank) {
+        // looping over the hits
+        for (unsigned int nh = 0; nh < HO.size(); nh++) {
 
-                // looping over the hits
-                for (unsigned int nh = 0; nh < HO.size(); nh++) {
+            const hitColumns &theseDgts = HO[nh].getDgtz();
+            if (!theseDgts.has(c)) continue;
 
-                    map<string, double> theseDgts = HO[nh].getDgtz();
-                    for (auto &thisVar: theseDgts) {
+            double value = theseDgts.get(c);
+            putDgtValue(detectorADCBank, adcItem, nh, value);
+            putDgtValue(detectorTDCBank, tdcItem, nh, value);
+            putDgtValue(detectorWF136Bank, wf136Item, nh, value);
 
-                        // found data match to bank definition
-                        if (thisVar.first == bname) {
-
-                            string varType = dgtBank.getVarType(thisVar.first);
-
-                            // sector, layer, component are common in adc/tdc so their names are w/o prefix
-                            // sector, layers are "Bytes"
-                            if (bname == "sector" || bname == "layer" || bname == "order") {
-                                detectorADCBank.putByte(bname.c_str(), nh, thisVar.second);
-                            } else if (bname == "component") {
-                                detectorADCBank.putShort(bname.c_str(), nh, thisVar.second);
-                            } else {
-                                // all other ADC vars must begin with "ADC_"
-                                if (bname.find("ADC_") == 0) {
-                                    string adcName = bname.substr(4);
-                                    if (varType == "i") {
-                                        detectorADCBank.putInt(adcName.c_str(), nh, thisVar.second);
-                                    } else if (varType == "d") {
-                                        detectorADCBank.putFloat(adcName.c_str(), nh, thisVar.second);
-                                    } else if (varType == "l") {
-                                        detectorADCBank.putLong(adcName.c_str(), nh, thisVar.second);
-                                    }
-                                }
-                            }
-
-                            if (verbosity > 2) {
-                                cout << "hit index " << nh << ", name " << bname << ", value: " << thisVar.second << ", raw/dgt: " << bankType << ", type: " << varType << endl;
-                            }
-                        }
-                    }
-                }
-
-            }
-
-            if (hasTDCBank) {
-
-                // looping over the hits
-                for (unsigned int nh = 0; nh < HO.size(); nh++) {
-                    map<string, double> theseDgts = HO[nh].getDgtz();
-                    for (auto &thisVar: theseDgts) {
-
-                        // found data match to bank definition
-                        if (thisVar.first == bname) {
-
-                            string varType = dgtBank.getVarType(thisVar.first);
-
-                            // sector, layer, component are common in adc/tdc so their names are w/o prefix
-                            // sector, layers are "Bytes"
-                            if (bname == "sector" || bname == "layer" || bname == "order") {
-                                detectorTDCBank.putByte(bname.c_str(), nh, thisVar.second);
-                            } else if (bname == "component") {
-                                detectorTDCBank.putShort(bname.c_str(), nh, thisVar.second);
-                            } else {
-                                // all other TDC vars must begin with "ADC_"
-                                if (bname.find("TDC_") == 0) {
-                                    string adcName = bname.substr(4);
-                                    if (varType == "i") {
-                                        detectorTDCBank.putInt(adcName.c_str(), nh, thisVar.second);
-                                    } else if (varType == "d") {
-                                        detectorTDCBank.putFloat(adcName.c_str(), nh, thisVar.second);
-                                    } else if (varType == "l") {
-                                        detectorTDCBank.putLong(adcName.c_str(), nh, thisVar.second);
-                                    }
-                                }
-
-                            }
-
-                            // do not repeat message logged above if hasADCBank was true
-                            if (verbosity > 2 && !hasADCBank) {
-                                cout << "hit index " << nh << ", name " << thisVar.first << ", value: " << thisVar.second << ", raw/dgt: " << bankType << ", type: " << varType << endl;
-                            }
-                        }
-                    }
-                }
+            if (verbosity > 2) {
+                cout << "hit index " << nh << ", name " << column.name << ", value: " << value << ", raw/dgt: " << column.bankType << ", type: " << column.varType << endl;
             }
-
-
-            if (hasWF136Bank) {
-                // looping over the hits
-                for (unsigned int nh = 0; nh < HO.size(); nh++) {
-
-                    map<string, double> theseDgts = HO[nh].getDgtz();
-                    for (auto &thisVar: theseDgts) {
-
-                        // found data match to bank definition
-                        if (thisVar.first == bname) {
-
-                            string varType = dgtBank.getVarType(thisVar.first);
-
-                            // sector, layer, component are common in adc/tdc so their names are w/o prefix
-                            // sector, layers are "Bytes"
-                            if (bname == "sector" || bname == "layer" || bname == "order") {
-                                detectorWF136Bank.putByte(bname.c_str(), nh, thisVar.second);
-                            } else if (bname == "component") {
-                                detectorWF136Bank.putShort(bname.c_str(), nh, thisVar.second);
-                            } else if (bname == "WF136_timestamp") {
-                                detectorWF136Bank.putLong("timestamp", nh, thisVar.second);
-                            } else {
-                                // all other ADC vars must begin with "ADC_"
-                                if (bname.find("WF136_s") == 0) {
-                                    // sample number is the string following "WF136_s" converted to int
-                                    int sample_value = stoi(bname.substr(7));
-                                    string wfname = "s" + to_string(sample_value);
-                                    detectorWF136Bank.putShort(wfname.c_str(), nh, thisVar.second);
-                                }
-                            }
-
-                            if (verbosity > 2) {
-                                cout << "hit index " << nh << ", name " << bname << ", value: " << thisVar.second << ", raw/dgt: " << bankType << ", type: " << varType << endl;
-                            }
-                        }
-                    }
-                }
-            }
-
         }
     }
+
     if (hasADCBank) {
         if (verbosity > 2) {
             detectorADCBank.show();
@@ -883,7 +921,7 @@ void hipo_output::writeChargeTime(outputContainer *output, vector <hitOutput> HO
 void hipo_output::writeG4RawAll(outputContainer *output, vector <hitOutput> HO, string hitType, map <string, gBank> *banksMap) {
 }
 
-void hipo_output::writeFADCMode1(map<int, vector<hitOutput> > HO, int ev_number) {
+void hipo_output::writeFADCMode1(const map<int, vector<hitOutput> > &HO, int ev_number) {
 }
 
 
@@ -898,6 +936,12 @@ void hipo_output::writeFADCMode7(outputContainer *output, vector <hitOutput> HO,
 void hipo_output::writeEvent(outputContainer *output) {
     outEvent->addStructure(*trueInfoBank);
 
-    output->hipoWriter->addEvent(*outEvent);
+    // compression and file I/O happen on the writer thread
+    if (eventWriter) {
+        eventWriter->queueEvent(outEvent);
+        outEvent = nullptr;
+    } else {
+        output->hipoWriter->addEvent(*outEvent);
+    }
 
 }
@@ -30,14 +30,10 @@ private:
 
 public:
 	~hipo_output(){
-		if(outEvent) {
+		if(outEvent && eventWriter == nullptr) {
 			delete outEvent;
 		}
-		if(trueInfoBank) {
-			delete trueInfoBank;
-		}
-
-	}  ///< event is deleted in WriteEvent routine
+	}  ///< the output factory lives for the whole run: the event buffer is reset in writeHeader
 	static outputFactory *createOutput() {return new hipo_output;}
 	
 	// prepare event
@@ -52,6 +48,12 @@ public:
 	// write user infos header
 	void writeUserInfoseHeader(outputContainer*, map<string, double>);
 	
+	// write the process dictionary
+	void writeProcessDictionary(outputContainer*, const map<int, string>&);
+	
+	// write the event profile
+	void writeProfile(outputContainer*, const map<string, detectorProfile>&, long peakRSS);
+	
 	// format output and set insideBank
 	void initBank(outputContainer*, gBank, int what);
 	
@@ -65,10 +67,10 @@ public:
 	virtual void writeRFSignal(outputContainer*, FrequencySyncSignal, gBank);
 	
 	// write geant4 raw integrated info
-	void writeG4RawIntegrated(outputContainer*, vector<hitOutput>,  string, map<string, gBank>*);
+	void writeG4RawIntegrated(outputContainer*, const vector<hitOutput>&,  string, map<string, gBank>*);
 	
 	// write geant4 digitized integrated info
-	void writeG4DgtIntegrated(outputContainer*, vector<hitOutput>,  string, map<string, gBank>*);
+	void writeG4DgtIntegrated(outputContainer*, const vector<hitOutput>&,  string, map<string, gBank>*);
 	
 	// write geant4 charge / time (as seen by electronic) info
 	virtual void writeChargeTime(outputContainer*, vector<hitOutput>, string, map<string, gBank>*);
@@ -82,7 +84,7 @@ public:
 	// write fadc mode 1 (full signal shape) - jlab hybrid banks. This uses the translation table to write the crate/slot/channel
 	// This method should be called once at the end of event action, and the 1st argument 
 	// is a map<int crate_id, vector<hitoutput> (vector of all hits from that crate) >
-	virtual void writeFADCMode1( map<int, vector<hitOutput> >, int);
+	virtual void writeFADCMode1(const map<int, vector<hitOutput> >&, int);
 	
 	// write fadc mode 7 (integrated mode) - jlab hybrid banks. This uses the translation table to write the crate/slot/channel
 	virtual void writeFADCMode7(outputContainer*, vector<hitOutput>, int);
@@ -91,7 +93,16 @@ public:
 	void writeEvent(outputContainer*) ;
 
 	hipo::event *outEvent = nullptr;
-	hipo::bank *trueInfoBank = nullptr;
+	hipoEventWriter *eventWriter = nullptr;  ///< owns outEvent when output is written by the writer thread
+	hipo::bank *trueInfoBank = nullptr;   ///< points to the reusable true info bank
+
+	// banks reused from the previous events, key is the schema name and the bank type.
+	// getSchema returns the same schema for different types (ft_cal, ft_hodo, ft_trk, the empty schema):
+	// each type has its own bank
+	map<pair<string, int>, hipo::bank> reusableBanks;
+
+	// returns the reusable bank for the schema and type (0 = adc, 1 = tdc, 2 = wf:136), with rows set and zeroed
+	hipo::bank &reusableBank(hipo::schema &schema, int rows, int type = 0);
 
 	// needed to correctly index
 	int lastHipoTrueInfoBankIndex  = 0;
@@ -33,6 +33,7 @@ outputContainer::outputContainer(goptions Opts)
 	
 
 	gemcOpt = Opts;
+	eventWriter = nullptr;
 	string hd_msg  = gemcOpt.optMap["LOG_MSG"].args + " Output File: >> ";
 
 	string optf = gemcOpt.optMap["OUTPUT"].args;
@@ -69,6 +70,8 @@ outputContainer::~outputContainer()
 	}
 	if(outType == "hipo") {
 		cout << hd_msg << " Closing Hipo file \"" << trimSpacesFromString(outFile) << "\"." << endl;
+		// the queued events are written before closing the file
+		if(eventWriter) delete eventWriter;
 		hipoWriter->close();
 	}
 
@@ -13,6 +13,7 @@
 #include "gbank.h"
 #include "gemcOptions.h"
 #include "MPrimaryGeneratorAction.h"
+#include "detectorProfile.h"
 
 // mlibrary
 #include "frequencySyncSignal.h"
@@ -29,6 +30,7 @@
 // Hipo
 #include "hipo4/writer.h"
 #include "hipoSchemas.h"
+#include "hipoEventWriter.h"
 
 // geant4
 #include "G4ThreeVector.hh"
@@ -50,13 +52,13 @@ private:
 
 	// geant4 integrated (over the hit) information.
 	// DISABLED by default
-	// key is variable name
-	map<string, double> raws;
+	// indexed by the "raws" bank column slot
+	hitColumns raws;
 
 	// digitized information coming from raws
 	// ENABLED by default
-	// key is variable name
-	map<string, double> dgtz;
+	// indexed by the detector bank column slot
+	hitColumns dgtz;
 
 	// geant4 step by step information.
 	// DISABLED by default
@@ -70,8 +72,8 @@ private:
 
 	// quantized signal as a function of time bunch
 	// DISABLED by default
-	// the first three entries are crate/slot/channel
-	map< int, int >  quantumS;
+	// the first three entries are crate/slot/channel, followed by the samples
+	vector<int>  quantumS;
 
 	// charge ([0]), time([1] info at every step
 	// DISABLED by default
@@ -85,43 +87,45 @@ private:
 
 public:
 
-	void setRaws       (map<string, double> r)            {raws = r;}
-	void setDgtz       (map<string, double> d)            {dgtz = d;}
-	void setAllRaws    (map< string, vector <double> > r) {allRaws  = r;}
-	void setMultiDgt   (map< string, vector <int> > d)    {multiDgt = d;}
-	void setChargeTime (map< int, vector <double> > d)    {chargeTime = d;}
-
-	void setOneRaw    (string s, double d)              {raws[s] = d;}
-	void setOneRaw    (string s, int i)                 {raws[s] = (double) i;}
+	void setRaws       (hitColumns r)                     {raws = std::move(r);}
+	void setDgtz       (hitColumns d)                     {dgtz = std::move(d);}
+	void setAllRaws    (map< string, vector <double> > r) {allRaws  = std::move(r);}
+	void setMultiDgt   (map< string, vector <int> > d)    {multiDgt = std::move(d);}
+	void setChargeTime (map< int, vector <double> > d)    {chargeTime = std::move(d);}
 
-	void setOneDgt    (string s, double d)              {dgtz[s] = d;}
-	void setOneDgt    (string s, int i)                 {dgtz[s] = (double) i;}
-
-	void createQuantumS(map< int, int > qs) {quantumS = qs;}
+	void createQuantumS(vector<int> qs) {quantumS = std::move(qs);}
 
 
 	// may want to insert verbosity here?
-	map<string, double>            getRaws()       {return raws;}
-	map<string, double>            getDgtz()       {return dgtz;}
-	map< string, vector <double> > getAllRaws()    {return allRaws;}
-	map< string, vector <int> >    getMultiDgt()   {return multiDgt;}
-	map< int, vector <double> >    getChargeTime() {return chargeTime;}
-	map< int, int >         	   getQuantumS()   {return quantumS;}
-
-	double getIntRawVar(string s)
+	const hitColumns&                     getRaws()       const {return raws;}
+	const hitColumns&                     getDgtz()       const {return dgtz;}
+	const map< string, vector <double> >& getAllRaws()    const {return allRaws;}
+	const map< string, vector <int> >&    getMultiDgt()   const {return multiDgt;}
+	map< int, vector <double> >           getChargeTime()       {return chargeTime;}
+	const vector<int>&                    getQuantumS()   const {return quantumS;}
+
+	// slots are resolved with gBank::slot, -99 if the hit did not set the variable
+	double getIntRawVar(int slot) const
 	{
-		if(raws.find(s) != raws.end()) return raws[s];
+		if(raws.has(slot)) return raws.get(slot);
 		return -99;
 	}
-	double getIntDgtVar(string s)
+	double getIntDgtVar(int slot) const
 	{
-		if(dgtz.find(s) != dgtz.end()) return dgtz[s];
+		if(dgtz.has(slot)) return dgtz.get(slot);
 		return -99;
 	}
+	// charge/time entry, empty if not set
+	const vector<double>& getChargeTimeVar(int index) const
+	{
+		static const vector<double> noValues;
+		auto var = chargeTime.find(index);
+		if(var != chargeTime.end()) return var->second;
+		return noValues;
+	}
 };
 
 
-
 /// \class summaryForParticle
 /// <b> summaryForParticle </b>\n\n
 /// Contains a summary information for each detector, caused
@@ -241,6 +245,9 @@ public:
 
 	ofstream        *txtoutput;
 	
+	// names of the profiled detectors, "event" first, then the sensitive detectors in alphabetical order.
+	// Their index is the detector column of the hipo profile bank
+	vector<string>   profileDetectors;
 
 	// hipo schema and writer
 	// The schemas have to be added to the writer before openning
@@ -250,6 +257,10 @@ public:
 	hipo::writer    *hipoWriter;
 	HipoSchema      *hipoSchema;
 
+	// writer thread for the hipo events, nullptr if OUTPUT_QUEUE is 0
+	// and the events are written by the event threads
+	hipoEventWriter *eventWriter;
+
 };
 
 /// \class outputFactory
@@ -276,6 +287,13 @@ public:
 	// write user infos header
 	virtual void writeUserInfoseHeader(outputContainer*, map<string, double>)  = 0;
 
+	// record the process dictionary on the file: process IDs not catalogued by gemc and their names.
+	// Written once, before the simulation conditions
+	virtual void writeProcessDictionary(outputContainer*, const map<int, string>&) = 0;
+
+	// write the event profile: time spent by each sensitive detector in each stage, and the peak resident memory in kB
+	virtual void writeProfile(outputContainer*, const map<string, detectorProfile>&, long peakRSS) = 0;
+
 	// write generated particles
 	virtual void writeGenerated(outputContainer*, vector<generatedParticle>, map<string, gBank> *banksMap, vector<userInforForParticle> userInfo) = 0;
 
@@ -283,13 +301,13 @@ public:
 	virtual void writeAncestors (outputContainer*, vector<ancestorInfo>, gBank) = 0;
 
 	// write geant4 true integrated info
-	virtual void writeG4RawIntegrated(outputContainer*, vector<hitOutput>, string, map<string, gBank>*) = 0;
+	virtual void writeG4RawIntegrated(outputContainer*, const vector<hitOutput>&, string, map<string, gBank>*) = 0;
 
 	// write geant4 true info for every step
 	virtual void writeG4RawAll(outputContainer*, vector<hitOutput>, string, map<string, gBank>*) = 0;
 
 	// write geant4 raw integrated info
-	virtual void writeG4DgtIntegrated(outputContainer*, vector<hitOutput>, string, map<string, gBank>*) = 0;
+	virtual void writeG4DgtIntegrated(outputContainer*, const vector<hitOutput>&, string, map<string, gBank>*) = 0;
 
 	// write geant4 charge / time (as seen by electronic) info
 	virtual void writeChargeTime(outputContainer*, vector<hitOutput>, string, map<string, gBank>*) = 0;
@@ -300,7 +318,7 @@ public:
 	// write fadc mode 1 (full signal shape) - jlab hybrid banks. This uses the translation table to write the crate/slot/channel
 	// This method should be called once at the end of event action, and the 1st argument
 	// is a map<int crate_id, vector<hitoutput> (vector of all hits from that crate) >
-	virtual void writeFADCMode1( map<int, vector<hitOutput> >, int)  = 0;
+	virtual void writeFADCMode1(const map<int, vector<hitOutput> >&, int)  = 0;
 
 	// write fadc mode 7 (integrated mode) - jlab hybrid banks. This uses the translation table to write the crate/slot/channel
 	virtual void writeFADCMode7(outputContainer*, vector<hitOutput>, int) = 0;
@@ -78,6 +78,33 @@ void txt_output :: writeUserInfoseHeader(outputContainer* output, map<string, do
 
 
 
+void txt_output :: writeProcessDictionary(outputContainer* output, const map<int, string>& processes)
+{
+	ofstream *txtout = output->txtoutput ;
+
+	*txtout << "   Process Dictionary, TAG " << PROCESS_DICTIONARY_BANK_TAG << ":" << endl;
+	for(auto &process : processes) {
+		*txtout << "   > " << process.first << " " << process.second << endl;
+	}
+	*txtout << endl;
+}
+
+void txt_output :: writeProfile(outputContainer* output, const map<string, detectorProfile>& profiles, long peakRSS)
+{
+	ofstream *txtout = output->txtoutput ;
+
+	*txtout << " --- Profile Bank, TAG " << PROFILE_BANK_TAG << ", CPU / wall times in ms -- " << endl;
+	for(auto &profile : profiles) {
+		*txtout << "    - " << profile.first << ":\tsteps: " << profile.second.steps << "\thits: " << profile.second.hits;
+		for(int s=0; s<PROFILE_NSTAGES; s++) {
+			*txtout << "\t" << detectorProfile::stageName(s) << ": " << 1000*profile.second.cpu[s] << " / " << 1000*profile.second.wall[s];
+		}
+		*txtout << endl;
+	}
+	*txtout << "    - peak resident memory: " << peakRSS << " kB" << endl;
+	*txtout << " --- End of Profile Bank -- " << endl;
+}
+
 
 void txt_output :: writeRFSignal(outputContainer* output, FrequencySyncSignal rfsignals, gBank bank)
 {
@@ -202,33 +229,30 @@ void txt_output ::  initBank(outputContainer* output, gBank thisHitBank)
 
 // write out true information. This is common to all banks
 // and not contained in the banks definitions
-void txt_output ::  writeG4RawIntegrated(outputContainer* output, vector<hitOutput> HO, string hitType, map<string, gBank> *banksMap)
+void txt_output ::  writeG4RawIntegrated(outputContainer* output, const vector<hitOutput>& HO, string hitType, map<string, gBank> *banksMap)
 {
 	if(HO.size() == 0) return;
 
-	gBank thisHitBank = getBankFromMap(hitType, banksMap);
-	gBank rawBank = getBankFromMap("raws", banksMap);
+	const gBank &thisHitBank = getBankFromMap(hitType, banksMap);
+	const gBank &rawBank = getBankFromMap("raws", banksMap);
 
 	initBank(output, thisHitBank);
 	ofstream *txtout = output->txtoutput ;
-		
+
+	// we only need the first hit to get the definitions
+	const hitColumns &raws = HO[0].getRaws();
+
 	*txtout << "   -- integrated true infos bank  (" << thisHitBank.idtag + RAWINT_ID << ", 0) -- " << endl;
-	for(map<int, string>::iterator it =  rawBank.orderedNames.begin(); it != rawBank.orderedNames.end(); it++)
+	for(unsigned c=0; c<rawBank.columns.size(); c++)
 	{
-		int bankId   = rawBank.getVarId(it->second);
-		int bankType = rawBank.getVarBankType(it->second);
-		
-		// we only need the first hit to get the definitions
-		map<string, double> raws = HO[0].getRaws();
-
+		const gBankColumn &column = rawBank.columns[c];
 		// bankID 0 is hit index
-		if(raws.find(it->second) != raws.end() && bankId >= 0 && bankType == RAWINT_ID)
+		if(raws.has(c) && column.gid >= 0 && column.bankType == RAWINT_ID)
 		{
-			*txtout << "    - (" << rawBank.idtag + thisHitBank.idtag << ", " << bankId << ") " << it->second << ":\t" ;
+			*txtout << "    - (" << rawBank.idtag + thisHitBank.idtag << ", " << column.gid << ") " << column.name << ":\t" ;
 			for(unsigned int nh=0; nh<HO.size(); nh++)
 			{
-				map<string, double> theseRaws = HO[nh].getRaws();
-				*txtout <<  std::setprecision(12) << theseRaws[it->second] << "\t" ;
+				*txtout <<  std::setprecision(12) << HO[nh].getRaws().get(c) << "\t" ;
 			}
 			*txtout << endl;
 		}
@@ -238,7 +262,6 @@ void txt_output ::  writeG4RawIntegrated(outputContainer* output, vector<hitOutp
 
 
 
-
 // write out true information step by step. This is common to all banks
 // and not contained in the banks definitions
 void txt_output ::  writeG4RawAll(outputContainer* output, vector<hitOutput> HO, string hitType, map<string, gBank> *banksMap)
@@ -280,35 +303,32 @@ void txt_output ::  writeG4RawAll(outputContainer* output, vector<hitOutput> HO,
 }
 
 
-void txt_output ::  writeG4DgtIntegrated(outputContainer* output, vector<hitOutput> HO,  string hitType, map<string, gBank> *banksMap)
+void txt_output ::  writeG4DgtIntegrated(outputContainer* output, const vector<hitOutput>& HO,  string hitType, map<string, gBank> *banksMap)
 {
 	if(HO.size() == 0) return;
 
-	gBank thisHitBank = getBankFromMap(hitType, banksMap);
-	gBank dgtBank = getDgtBankFromMap(hitType, banksMap);
-	
+	const gBank &thisHitBank = getBankFromMap(hitType, banksMap);
+
 	initBank(output, thisHitBank);
 	ofstream *txtout = output->txtoutput ;
-	
+
+	// we only need the first hit to get the definitions
+	const hitColumns &dgts = HO[0].getDgtz();
+
 	*txtout << "   -- integrated digitized bank  (" << thisHitBank.idtag + DGTINT_ID << ", 0) -- " << endl;
 
-	for(map<int, string>::iterator it =  dgtBank.orderedNames.begin(); it != dgtBank.orderedNames.end(); it++)
+	// the detector bank may have definitions other than DGT: only the DGT columns are written
+	for(unsigned c=0; c<thisHitBank.columns.size(); c++)
 	{
-		int bankId   = dgtBank.getVarId(it->second);
-		int bankType = dgtBank.getVarBankType(it->second);
-		
-		// we only need the first hit to get the definitions
-		map<string, double> dgts = HO[0].getDgtz();
-
+		const gBankColumn &column = thisHitBank.columns[c];
 		// bankID 0 is hit index
-		if(dgts.find(it->second) != dgts.end() && bankId > 0 && bankType == DGTINT_ID)
+		if(dgts.has(c) && column.gid > 0 && column.bankType == DGTINT_ID)
 		{
-			*txtout << "    - (" << dgtBank.idtag + thisHitBank.idtag << ", " << bankId << ") " << it->second << ":\t";
-			
+			*txtout << "    - (" << DGTINT_ID + thisHitBank.idtag << ", " << column.gid << ") " << column.name << ":\t";
+
 			for(unsigned int nh=0; nh<HO.size(); nh++)
 			{
-				map<string, double> theseDgts = HO[nh].getDgtz();
-				*txtout << theseDgts[it->second] << "\t" ;
+				*txtout << HO[nh].getDgtz().get(c) << "\t" ;
 			}
 			*txtout << endl;
 		}
@@ -385,7 +405,7 @@ void txt_output :: writeFADCMode1(outputContainer* output, vector<hitOutput> HO,
 }
 
 
-void txt_output :: writeFADCMode1( map<int, vector<hitOutput> >, int)
+void txt_output :: writeFADCMode1(const map<int, vector<hitOutput> >&, int)
 {
 }
 
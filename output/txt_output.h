@@ -25,6 +25,12 @@ class txt_output : public outputFactory
 
 	// write user infos header
 	void writeUserInfoseHeader(outputContainer*, map<string, double>);
+	
+	// write the process dictionary
+	void writeProcessDictionary(outputContainer*, const map<int, string>&);
+
+	// write the event profile
+	void writeProfile(outputContainer*, const map<string, detectorProfile>&, long peakRSS);
 
 	// write RF Signal
 	virtual void writeRFSignal(outputContainer*, FrequencySyncSignal, gBank);
@@ -39,10 +45,10 @@ class txt_output : public outputFactory
 	void initBank(outputContainer*, gBank);
 	
 	// write geant4 raw integrated info
-	void writeG4RawIntegrated(outputContainer*, vector<hitOutput>,  string, map<string, gBank>*);
+	void writeG4RawIntegrated(outputContainer*, const vector<hitOutput>&,  string, map<string, gBank>*);
 		
 	// write geant4 digitized integrated info
-	void writeG4DgtIntegrated(outputContainer*, vector<hitOutput>,  string, map<string, gBank>*);
+	void writeG4DgtIntegrated(outputContainer*, const vector<hitOutput>&,  string, map<string, gBank>*);
 
 	// write geant4 charge / time (as seen by electronic) info
 	virtual void writeChargeTime(outputContainer*, vector<hitOutput>, string, map<string, gBank>*);
@@ -54,7 +60,7 @@ class txt_output : public outputFactory
 	virtual void writeFADCMode1(outputContainer*, vector<hitOutput>, int);
 
         // write fadc mode 1 (full signal shape) - jlab hybrid banks. This uses the translation table to write the crate/slot/channel
-        virtual void writeFADCMode1( map<int, vector<hitOutput> >, int);
+        virtual void writeFADCMode1(const map<int, vector<hitOutput> >&, int);
         
 	// write fadc mode 7 (integrated mode) - jlab hybrid banks. This uses the translation table to write the crate/slot/channel
 	virtual void writeFADCMode7(outputContainer*, vector<hitOutput>, int);
@@ -77,6 +77,35 @@ void txt_simple_output :: writeUserInfoseHeader(outputContainer* output, map<str
 
 
 
+void txt_simple_output :: writeProcessDictionary(outputContainer* output, const map<int, string>& processes)
+{
+	ofstream *txtout = output->txtoutput ;
+
+	*txtout << "Process Dictionary, TAG " << PROCESS_DICTIONARY_BANK_TAG << " {" << endl;
+	for(auto &process : processes) {
+		*txtout << indent(1) << process.first << " " << process.second << endl;
+	}
+	*txtout << "}" << endl;
+}
+
+void txt_simple_output :: writeProfile(outputContainer* output, const map<string, detectorProfile>& profiles, long peakRSS)
+{
+	ofstream *txtout = output->txtoutput ;
+
+	*txtout << indent(1) << "Profile Bank, TAG " << PROFILE_BANK_TAG << " {" << endl;
+	for(auto &profile : profiles) {
+		*txtout << indent(2) << profile.first << " {" << endl;
+		*txtout << indent(3) << "steps " << profile.second.steps << endl;
+		*txtout << indent(3) << "hits "  << profile.second.hits  << endl;
+		for(int s=0; s<PROFILE_NSTAGES; s++) {
+			*txtout << indent(3) << detectorProfile::stageName(s) << " " << 1000*profile.second.cpu[s] << " " << 1000*profile.second.wall[s] << endl;
+		}
+		*txtout << indent(2) << "}" << endl;
+	}
+	*txtout << indent(2) << "peakRSS " << peakRSS << endl;
+	*txtout << indent(1) << "}" << endl;
+}
+
 
 void txt_simple_output :: writeRFSignal(outputContainer* output, FrequencySyncSignal rfsignals, gBank bank)
 {
@@ -234,32 +263,29 @@ void txt_simple_output ::  initBank(outputContainer* output, gBank thisHitBank)
 
 // write out true information. This is common to all banks
 // and not contained in the banks definitions
-void txt_simple_output ::  writeG4RawIntegrated(outputContainer* output, vector<hitOutput> HO, string hitType, map<string, gBank> *banksMap)
+void txt_simple_output ::  writeG4RawIntegrated(outputContainer* output, const vector<hitOutput>& HO, string hitType, map<string, gBank> *banksMap)
 {
 	if(HO.size() == 0) return;
 
-	gBank thisHitBank = getBankFromMap(hitType, banksMap);
-	gBank rawBank = getBankFromMap("raws", banksMap);
+	const gBank &thisHitBank = getBankFromMap(hitType, banksMap);
+	const gBank &rawBank = getBankFromMap("raws", banksMap);
 
 	ofstream *txtout = output->txtoutput ;
 	*txtout << indent(1) << thisHitBank.bankName << " (" << thisHitBank.idtag << ", " << DETECTOR_BANK_ID << ") integrated true infos bank (" << thisHitBank.idtag + RAWINT_ID << ", 0) {" << endl;
 
-	for(map<int, string>::iterator it =  rawBank.orderedNames.begin(); it != rawBank.orderedNames.end(); it++)
-	{
-		int bankId   = rawBank.getVarId(it->second);
-		int bankType = rawBank.getVarBankType(it->second);
-
-		// we only need the first hit to get the definitions
-		map<string, double> raws = HO[0].getRaws();
+	// we only need the first hit to get the definitions
+	const hitColumns &raws = HO[0].getRaws();
 
+	for(unsigned c=0; c<rawBank.columns.size(); c++)
+	{
+		const gBankColumn &column = rawBank.columns[c];
 		// bankID 0 is hit index
-		if(raws.find(it->second) != raws.end() && bankId >= 0 && bankType == RAWINT_ID)
+		if(raws.has(c) && column.gid >= 0 && column.bankType == RAWINT_ID)
 		{
-			*txtout << indent(2) << "(" << rawBank.idtag + thisHitBank.idtag << ", " << bankId << ") " << it->second << ":\t" ;
+			*txtout << indent(2) << "(" << rawBank.idtag + thisHitBank.idtag << ", " << column.gid << ") " << column.name << ":\t" ;
 			for(unsigned int nh=0; nh<HO.size(); nh++)
 			{
-				map<string, double> theseRaws = HO[nh].getRaws();
-				*txtout <<  std::setprecision(12) << theseRaws[it->second] << "\t" ;
+				*txtout <<  std::setprecision(12) << HO[nh].getRaws().get(c) << "\t" ;
 			}
 			*txtout << endl;
 		}
@@ -311,33 +337,30 @@ void txt_simple_output ::  writeG4RawAll(outputContainer* output, vector<hitOutp
 }
 
 
-void txt_simple_output ::  writeG4DgtIntegrated(outputContainer* output, vector<hitOutput> HO,  string hitType, map<string, gBank> *banksMap)
+void txt_simple_output ::  writeG4DgtIntegrated(outputContainer* output, const vector<hitOutput>& HO,  string hitType, map<string, gBank> *banksMap)
 {
 	if(HO.size() == 0) return;
 
-	gBank thisHitBank = getBankFromMap(hitType, banksMap);
-	gBank dgtBank = getDgtBankFromMap(hitType, banksMap);
+	const gBank &thisHitBank = getBankFromMap(hitType, banksMap);
 
 	ofstream *txtout = output->txtoutput ;
 	*txtout << indent(1) << thisHitBank.bankName << " (" << thisHitBank.idtag << ", " << DETECTOR_BANK_ID << ") integrated digitized bank (" << thisHitBank.idtag + DGTINT_ID << ", 0) {" << endl;
 
-	for(map<int, string>::iterator it =  dgtBank.orderedNames.begin(); it != dgtBank.orderedNames.end(); it++)
-	{
-		int bankId   = dgtBank.getVarId(it->second);
-		int bankType = dgtBank.getVarBankType(it->second);
-
-		// we only need the first hit to get the definitions
-		map<string, double> dgts = HO[0].getDgtz();
+	// we only need the first hit to get the definitions
+	const hitColumns &dgts = HO[0].getDgtz();
 
+	// the detector bank may have definitions other than DGT: only the DGT columns are written
+	for(unsigned c=0; c<thisHitBank.columns.size(); c++)
+	{
+		const gBankColumn &column = thisHitBank.columns[c];
 		// bankID 0 is hit index
-		if(dgts.find(it->second) != dgts.end() && bankId > 0 && bankType == DGTINT_ID)
+		if(dgts.has(c) && column.gid > 0 && column.bankType == DGTINT_ID)
 		{
-			*txtout << indent(2) << "(" << dgtBank.idtag + thisHitBank.idtag << ", " << bankId << ") " << it->second << ":\t";
+			*txtout << indent(2) << "(" << DGTINT_ID + thisHitBank.idtag << ", " << column.gid << ") " << column.name << ":\t";
 
 			for(unsigned int nh=0; nh<HO.size(); nh++)
 			{
-				map<string, double> theseDgts = HO[nh].getDgtz();
-				*txtout << theseDgts[it->second] << "\t" ;
+				*txtout << HO[nh].getDgtz().get(c) << "\t" ;
 			}
 			*txtout << endl;
 		}
@@ -414,7 +437,7 @@ void txt_simple_output :: writeFADCMode1(outputContainer* output, vector<hitOutp
 }
 
 
-void txt_simple_output :: writeFADCMode1( map<int, vector<hitOutput> >, int)
+void txt_simple_output :: writeFADCMode1(const map<int, vector<hitOutput> >&, int)
 {
 }
 
@@ -20,6 +20,7 @@ MHit::MHit() : G4VHit()
 	hasTrigger = 0;
 	isElectronicNoise = 0;
 	isBackgroundHit = 0;
+	isPileupHit = 0;
 
 }
 
@@ -59,6 +60,9 @@ void MHit::Draw()
 MHit::MHit(double energy, double tim, vector<identifier> vid, int pid)
 {
 	isElectronicNoise = 1;
+	isBackgroundHit = 0;
+	isPileupHit = 0;
+	hasTrigger = 0;
 
 	pos.push_back(G4ThreeVector(0,0,0));
 	Lpos.push_back(G4ThreeVector(0,0,0));
@@ -75,7 +79,7 @@ MHit::MHit(double energy, double tim, vector<identifier> vid, int pid)
 	mtrackID.push_back(-1);
 	otrackID.push_back(-1);
 	mvert.push_back(G4ThreeVector(0,0,0));
-	materialName.push_back("noise");
+	materials.push_back(nullptr);
 	processID.push_back(999);
 	mgnf.push_back(0);
 
@@ -87,7 +91,10 @@ MHit::MHit(double energy, double tim, vector<identifier> vid, int pid)
 // background hit constructor
 MHit::MHit(double energy, double tim, int nphe, vector<identifier> vid)
 {
+	isElectronicNoise = 0;
 	isBackgroundHit = 1;
+	isPileupHit = 0;
+	hasTrigger = 0;
 
 	pos.push_back(G4ThreeVector(0,0,0));
 	Lpos.push_back(G4ThreeVector(0,0,0));
@@ -104,7 +111,7 @@ MHit::MHit(double energy, double tim, int nphe, vector<identifier> vid)
 	mtrackID.push_back(-1);
 	otrackID.push_back(-1);
 	mvert.push_back(G4ThreeVector(0,0,0));
-	materialName.push_back("backgroundHit");
+	materials.push_back(nullptr);
 	processID.push_back(999);
 	mgnf.push_back(0);
 
@@ -119,3 +126,25 @@ MHit::MHit(double energy, double tim, int nphe, vector<identifier> vid)
 
 
 
+
+// materials are not defined for electronic noise and background hits
+string MHit::GetMatName(unsigned int step) const
+{
+	if(step < materials.size() && materials[step] != nullptr) {
+		return materials[step]->GetName();
+	}
+
+	if(isElectronicNoise) return "noise";
+	if(isBackgroundHit)   return "backgroundHit";
+
+	return "na";
+}
+
+vector<string> MHit::GetMatNames() const
+{
+	vector<string> names;
+	for(unsigned int s=0; s<materials.size(); s++) {
+		names.push_back(GetMatName(s));
+	}
+	return names;
+}
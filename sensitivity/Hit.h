@@ -9,6 +9,7 @@
 // G4 headers
 #include "G4ThreeVector.hh"
 #include "G4VHit.hh"
+#include "G4Material.hh"
 
 // gemc headers
 #include "detector.h"
@@ -62,11 +63,11 @@ private:
 	vector<int>        mtrackID;    ///< Mother G4Track ID in each step
 	vector<int>        otrackID;    ///< Original G4Track ID in each step
 	vector<G4ThreeVector> mvert;    ///< Primary Vertex of the track's mother
-	vector<string> materialName;    ///< Material name
+	vector<const G4Material*> materials; ///< Material of each step: interned by geant4. nullptr for electronic noise and background hits
 	vector<int>       processID;    ///< Process that originated this step
 	vector<double>         mgnf;    ///< magnetic field
 
-	vector<detector>  Detectors;    ///< Detectors Hit. It might be a vector if multiple detectors have the same identifier
+	vector<const detector*> Detectors; ///< Detectors Hit, pointing to the hall map entry. It might be a vector if multiple detectors have the same identifier
 
 	vector<identifier> identity;    ///< Identity
 	sensitiveID SID;                ///< Sensitive ID has detector information like  signalThreshold, timeWindow, prodThreshold, maxStep, riseTime, fallTime, mvToMeV
@@ -82,89 +83,91 @@ private:
 
 public:
 	// infos filled in Sensitive Detector
-	inline void SetPos(G4ThreeVector xyz)       { pos.push_back(xyz); }
-	inline vector<G4ThreeVector> GetPos()       { return pos; }
-	inline G4ThreeVector GetLastPos()           { if(pos.size()) return pos[pos.size()-1]; else return G4ThreeVector(0,0,0); }
+	// the step vectors are returned by const reference: no copies of the step history
+	inline void SetPos(G4ThreeVector xyz)                    { pos.push_back(xyz); }
+	inline const vector<G4ThreeVector>& GetPos() const       { return pos; }
+	inline G4ThreeVector GetLastPos() const                  { if(pos.size()) return pos[pos.size()-1]; else return G4ThreeVector(0,0,0); }
 
-	inline void SetLPos(G4ThreeVector xyz)      { Lpos.push_back(xyz); }
-	inline vector<G4ThreeVector> GetLPos()      { return Lpos; }
+	inline void SetLPos(G4ThreeVector xyz)                   { Lpos.push_back(xyz); }
+	inline const vector<G4ThreeVector>& GetLPos() const      { return Lpos; }
 
-	inline void SetVert(G4ThreeVector ver)      { vert.push_back(ver); }
-	inline G4ThreeVector GetVert()              { return  vert[0]; }
-	inline vector<G4ThreeVector> GetVerts()     { return  vert; }
+	inline void SetVert(G4ThreeVector ver)                   { vert.push_back(ver); }
+	inline const G4ThreeVector& GetVert() const              { return  vert[0]; }
+	inline const vector<G4ThreeVector>& GetVerts() const     { return  vert; }
 
-	inline void SetEdep(double depe)            { edep.push_back(depe); }
-	inline vector<double> GetEdep()             { return edep; }
+	inline void SetEdep(double depe)                         { edep.push_back(depe); }
+	inline const vector<double>& GetEdep() const             { return edep; }
 
-	inline void SetDx(double Dx)                { dx.push_back(Dx); }
-	inline vector<double> GetDx()               { return dx; }
+	inline void SetDx(double Dx)                             { dx.push_back(Dx); }
+	inline const vector<double>& GetDx() const               { return dx; }
 
-	inline void SetMgnf(double m)               { mgnf.push_back(m); }
-	inline vector<double> GetMgnf()             { return  mgnf; }
+	inline void SetMgnf(double m)                            { mgnf.push_back(m); }
+	inline const vector<double>& GetMgnf() const             { return  mgnf; }
 
-	inline void SetTime(double ctime)           { time.push_back(ctime); }
-	inline vector<double> GetTime()             { return  time; }
+	inline void SetTime(double ctime)                        { time.push_back(ctime); }
+	inline const vector<double>& GetTime() const             { return  time; }
 
-	inline void SetMom(G4ThreeVector pxyz)      { mom.push_back(pxyz); }
-	inline G4ThreeVector GetMom()               { return mom[0]; }
-	inline vector<G4ThreeVector> GetMoms()      { return mom; }
+	inline void SetMom(G4ThreeVector pxyz)                   { mom.push_back(pxyz); }
+	inline const G4ThreeVector& GetMom() const               { return mom[0]; }
+	inline const vector<G4ThreeVector>& GetMoms() const      { return mom; }
 
-	inline void SetE(double ene)                { E.push_back(ene); }
-	inline double GetE()                        { return E[0]; }
-	inline vector<double> GetEs()               { return E; }
+	inline void SetE(double ene)                             { E.push_back(ene); }
+	inline double GetE() const                               { return E[0]; }
+	inline const vector<double>& GetEs() const               { return E; }
 
-	inline void SetTrackId(int tid)             { trackID.push_back(tid); }
-	inline int GetTId()                         { return trackID[0]; }
-	inline vector<int> GetTIds()                { return trackID; }
+	inline void SetTrackId(int tid)                          { trackID.push_back(tid); }
+	inline int GetTId() const                                { return trackID[0]; }
+	inline const vector<int>& GetTIds() const                { return trackID; }
 
-	inline vector<identifier> GetId()           { return identity; }
-	inline void SetId(vector<identifier> iden)  { identity = iden; }
+	inline const vector<identifier>& GetId() const           { return identity; }
+	inline void SetId(const vector<identifier>& iden)        { identity = iden; }
 
-	inline void SetDetector(detector det)       {Detectors.push_back(det);}
-	inline vector<detector> GetDetectors()      {return Detectors;}
-	inline detector GetDetector()               {return Detectors[0];}
+	// the detector is not copied: the hit keeps a pointer to the (stable) hall map entry
+	inline void SetDetector(const detector& det)             { Detectors.push_back(&det); }
+	inline const vector<const detector*>& GetDetectors() const { return Detectors; }
+	inline const detector& GetDetector() const               { return *Detectors[0]; }
 
-	inline void SetPID(int pid)                 { PID.push_back(pid); }
-	inline int GetPID()                         { return PID[0]; }
-	inline vector<int> GetPIDs()                { return PID; }
+	inline void SetPID(int pid)                              { PID.push_back(pid); }
+	inline int GetPID() const                                { return PID[0]; }
+	inline const vector<int>& GetPIDs() const                { return PID; }
 
-	inline void SetCharge(int Q)                { q.push_back(Q); }
-	inline int GetCharge()                      { return q[0]; }
-	inline vector<int> GetCharges()             { return q; }
+	inline void SetCharge(int Q)                             { q.push_back(Q); }
+	inline int GetCharge() const                             { return q[0]; }
+	inline const vector<int>& GetCharges() const             { return q; }
 
 	// infos filled in MEvent Action
-	inline void SetmTrackId(int tid)            { mtrackID.push_back(tid); }
-	inline void SetmTrackIds(vector<int> tid)   { mtrackID = tid; }
-	inline int GetmTrackId()                    { return mtrackID[0]; }
-	inline vector<int> GetmTrackIds()           { return mtrackID; }
+	inline void SetmTrackId(int tid)                         { mtrackID.push_back(tid); }
+	inline void SetmTrackIds(vector<int> tid)                { mtrackID = tid; }
+	inline int GetmTrackId() const                           { return mtrackID[0]; }
+	inline const vector<int>& GetmTrackIds() const           { return mtrackID; }
 
-	inline void SetoTrackId(int tid)            { otrackID.push_back(tid); }
-	inline void SetoTrackIds(vector<int> tid)   { otrackID = tid; }
-	inline int GetoTrackId()                    { return otrackID[0]; }
-	inline vector<int> GetoTrackIds()           { return otrackID; }
+	inline void SetoTrackId(int tid)                         { otrackID.push_back(tid); }
+	inline void SetoTrackIds(vector<int> tid)                { otrackID = tid; }
+	inline int GetoTrackId() const                           { return otrackID[0]; }
+	inline const vector<int>& GetoTrackIds() const           { return otrackID; }
 
-	inline void SetmPID(int mpid)               { mPID.push_back(mpid); }
-	inline void SetmPIDs(vector<int> mpid)      { mPID = mpid; }
-	inline int GetmPID()                        { return mPID[0]; }
-	inline vector<int> GetmPIDs()               { return mPID; }
+	inline void SetmPID(int mpid)                            { mPID.push_back(mpid); }
+	inline void SetmPIDs(vector<int> mpid)                   { mPID = mpid; }
+	inline int GetmPID() const                               { return mPID[0]; }
+	inline const vector<int>& GetmPIDs() const               { return mPID; }
 
-	inline void SetmVert(G4ThreeVector ver)          { mvert.push_back(ver); }
-	inline void SetmVerts(vector<G4ThreeVector> ver) { mvert = ver; }
-	inline G4ThreeVector GetmVert()                  { return  mvert[0]; }
-	inline vector<G4ThreeVector> GetmVerts()         { return  mvert; }
+	inline void SetmVert(G4ThreeVector ver)                  { mvert.push_back(ver); }
+	inline void SetmVerts(vector<G4ThreeVector> ver)         { mvert = ver; }
+	inline const G4ThreeVector& GetmVert() const             { return  mvert[0]; }
+	inline const vector<G4ThreeVector>& GetmVerts() const    { return  mvert; }
 
-	inline void SetMatName(string mname)           { materialName.push_back(mname); }
-	inline void SetMatNames(vector<string> mnames) { materialName = mnames; }
-	inline string GetMatName()                     { return  materialName[0]; }
-	inline vector<string> GetMatNames()            { return  materialName; }
+	inline void SetMaterial(const G4Material *mat)           { materials.push_back(mat); }
+	inline const vector<const G4Material*>& GetMaterials() const { return materials; }
+	string GetMatName(unsigned int step = 0) const;          ///< material name of the step, or the noise / background label
+	vector<string> GetMatNames() const;
 
-	inline void SetProcID(int procID)          { processID.push_back(procID); }
-	inline void SetProcID(vector<int> procIDs) { processID = procIDs; }
-	inline int GetProcID()                     { return  processID[0]; }
-	inline vector<int> GetProcIDs()            { return  processID; }
+	inline void SetProcID(int procID)                        { processID.push_back(procID); }
+	inline void SetProcID(vector<int> procIDs)               { processID = procIDs; }
+	inline int GetProcID() const                             { return  processID[0]; }
+	inline const vector<int>& GetProcIDs() const             { return  processID; }
 
-	inline void SetSDID(sensitiveID s)   { SID = s; }
-	inline sensitiveID GetSDID()         { return SID; }
+	inline void SetSDID(const sensitiveID& s)                { SID = s; }
+	inline const sensitiveID& GetSDID() const                { return SID; }
 
 
 	inline void setSignal(map< double, double > VT) {
@@ -178,8 +181,8 @@ public:
 		}
 	}
 
-	inline vector<double> getSignalT(){return signalT;}
-	inline vector<double> getSignalV(){return signalV;}
+	inline const vector<double>& getSignalT() const {return signalT;}
+	inline const vector<double>& getSignalV() const {return signalV;}
 
 	inline void setQuantum(map< int, int > QS)
 	{
@@ -193,9 +196,9 @@ public:
 		}
 	}
 
-	inline vector<int> getQuantumT() {return quantumT;}
-	inline vector<int> getQuantumQ() {return quantumQ;}
-	inline vector<int> getQuantumTR(){return quantumTR;}
+	inline const vector<int>& getQuantumT() const  {return quantumT;}
+	inline const vector<int>& getQuantumQ() const  {return quantumQ;}
+	inline const vector<int>& getQuantumTR() const {return quantumTR;}
 	inline void setQuantumTR(vector<int> t)   { quantumTR = t; }
 
 	// trigger
@@ -204,6 +207,7 @@ public:
 
 	int isElectronicNoise;          ///< 1 if this is an electronic noise hit
 	int isBackgroundHit;            ///< 1 if this hit a background hit
+	int isPileupHit;                ///< 1 if this hit comes from the pileup library
 
 };
 
@@ -1,3 +1,6 @@
+// G4 headers
+#include "G4MaterialPropertiesTable.hh"
+
 // gemc headers
 #include "HitProcess.h"
 
@@ -30,74 +33,124 @@ set<string> getListOfHitProcessHit(map<string, HitProcess_Factory> hitProcessMap
 }
 
 
+// the routines are deleted after loading the constants: the constants themselves are
+// static members, and each initWithRunNumber reloads them for the new run
+void prefetchHitProcessConstants(map<string, HitProcess_Factory> *hitProcessMap, set<string> hitTypes, vector<int> runs, goptions gemcOpt, map<string, double> gpars)
+{
+	for(auto runno: runs) {
+		cout << "  > Loading the digitization constants for run " << runno << endl;
+		for(auto &hitType: hitTypes) {
+			HitProcess *hitProcessRoutine = getHitProcess(hitProcessMap, hitType);
+			if(hitProcessRoutine == nullptr) continue;
+
+			hitProcessRoutine->init(hitType, gemcOpt, gpars);
+			hitProcessRoutine->initWithRunNumber(runno);
+			delete hitProcessRoutine;
+		}
+	}
+}
+
+
+// - voltageSamples: adds the voltage of all steps to the samples
+void HitProcess::voltageSamples(const vector<double> &charges, const vector<double> &times, double tsampling, unsigned nsamplings, double *samples)
+{
+	if(pulseShapePars != nullptr) {
+		PulseShapeSamples(pulseShapePars, charges, times, tsampling, nsamplings, samples);
+		return;
+	}
+
+	for(unsigned s=0; s<times.size(); s++) {
+		for(unsigned ts=0; ts<nsamplings; ts++) {
+			samples[ts] += voltage(charges[s], times[s], ts*tsampling);
+		}
+	}
+}
+
+
+// - photonEfficiency: EFFICIENCY of the hit material at the photon energy
+double HitProcess::photonEfficiency(MHit* aHit, unsigned step)
+{
+	G4MaterialPropertiesTable *MPT = aHit->GetDetector().GetLogical()->GetMaterial()->GetMaterialPropertiesTable();
+	if(MPT == nullptr) return 1;
+
+	G4MaterialPropertyVector *efficiency = MPT->GetProperty("EFFICIENCY");
+	if(efficiency == nullptr) return 1;
+
+	bool outofrange = false;
+	return efficiency->GetValue(aHit->GetEs()[step], outofrange);
+}
+
+
 // - integrateRaw: returns geant4 raw information integrated over the hit
-map<string, double> HitProcess::integrateRaw(MHit* aHit, int hitn, bool WRITEBANK)
+// the values are stored in the "raws" bank column slots
+hitColumns HitProcess::integrateRaw(MHit* aHit, int hitn, bool WRITEBANK)
 {
-	map<string, double> raws;
+	hitColumns raws;
 
 	if(WRITEBANK) {
+		raws = hitColumns(RAW_NSLOTS);
 
 		if(aHit->isBackgroundHit == 1) {
-			raws["hitn"]    = hitn;
-			raws["totEdep"] = aHit->GetEdep().front();
-			raws["avg_t"]   = aHit->GetTime().front();
-			raws["procID"]  = -1;
-			raws["nsteps"]  = 1;
+			raws.set(RAW_HITN,    hitn);
+			raws.set(RAW_TOTEDEP, aHit->GetEdep().front());
+			raws.set(RAW_AVG_T,   aHit->GetTime().front());
+			raws.set(RAW_PROCID,  -1);
+			raws.set(RAW_NSTEPS,  1);
 
 			if(filterDummyBanks == false) {
-				raws["pid"]     = -1;
-				raws["mpid"]    = -1;
-				raws["tid"]     = -1;
-				raws["mtid"]    = -1;
-				raws["otid"]    = -1;
-				raws["trackE"]  = -1;
-				raws["avg_x"]   = 0;
-				raws["avg_y"]   = 0;
-				raws["avg_z"]   = 0;
-				raws["avg_lx"]  = 0;
-				raws["avg_ly"]  = 0;
-				raws["avg_lz"]  = 0;
-				raws["px"]      = 0;
-				raws["py"]      = 0;
-				raws["pz"]      = 0;
-				raws["vx"]      = 0;
-				raws["vy"]      = 0;
-				raws["vz"]      = 0;
-				raws["mvx"]     = 0;
-				raws["mvy"]     = 0;
-				raws["mvz"]     = 0;
+				raws.set(RAW_PID,     -1);
+				raws.set(RAW_MPID,    -1);
+				raws.set(RAW_TID,     -1);
+				raws.set(RAW_MTID,    -1);
+				raws.set(RAW_OTID,    -1);
+				raws.set(RAW_TRACKE,  -1);
+				raws.set(RAW_AVG_X,   0);
+				raws.set(RAW_AVG_Y,   0);
+				raws.set(RAW_AVG_Z,   0);
+				raws.set(RAW_AVG_LX,  0);
+				raws.set(RAW_AVG_LY,  0);
+				raws.set(RAW_AVG_LZ,  0);
+				raws.set(RAW_PX,      0);
+				raws.set(RAW_PY,      0);
+				raws.set(RAW_PZ,      0);
+				raws.set(RAW_VX,      0);
+				raws.set(RAW_VY,      0);
+				raws.set(RAW_VZ,      0);
+				raws.set(RAW_MVX,     0);
+				raws.set(RAW_MVY,     0);
+				raws.set(RAW_MVZ,     0);
 			}
 
 		} else {
 
 			trueInfos tInfos(aHit);
 
-			raws["hitn"]    = hitn;
-			raws["pid"]     = (double) aHit->GetPID();
-			raws["mpid"]    = (double) aHit->GetmPID();
-			raws["tid"]     = (double) aHit->GetTId();
-			raws["mtid"]    = (double) aHit->GetmTrackId();
-			raws["otid"]    = (double) aHit->GetoTrackId();
-			raws["trackE"]  = aHit->GetE();
-			raws["totEdep"] = tInfos.eTot;
-			raws["avg_x"]   = tInfos.x;
-			raws["avg_y"]   = tInfos.y;
-			raws["avg_z"]   = tInfos.z;
-			raws["avg_lx"]  = tInfos.lx;
-			raws["avg_ly"]  = tInfos.ly;
-			raws["avg_lz"]  = tInfos.lz;
-			raws["px"]      = aHit->GetMom().getX();
-			raws["py"]      = aHit->GetMom().getY();
-			raws["pz"]      = aHit->GetMom().getZ();
-			raws["vx"]      = aHit->GetVert().getX();
-			raws["vy"]      = aHit->GetVert().getY();
-			raws["vz"]      = aHit->GetVert().getZ();
-			raws["mvx"]     = aHit->GetmVert().getX();
-			raws["mvy"]     = aHit->GetmVert().getY();
-			raws["mvz"]     = aHit->GetmVert().getZ();
-			raws["avg_t"]   = tInfos.time;
-			raws["procID"]  = aHit->GetProcID();
-			raws["nsteps"]  = aHit->GetPIDs().size();
+			raws.set(RAW_HITN,    hitn);
+			raws.set(RAW_PID,     (double) aHit->GetPID());
+			raws.set(RAW_MPID,    (double) aHit->GetmPID());
+			raws.set(RAW_TID,     (double) aHit->GetTId());
+			raws.set(RAW_MTID,    (double) aHit->GetmTrackId());
+			raws.set(RAW_OTID,    (double) aHit->GetoTrackId());
+			raws.set(RAW_TRACKE,  aHit->GetE());
+			raws.set(RAW_TOTEDEP, tInfos.eTot);
+			raws.set(RAW_AVG_X,   tInfos.x);
+			raws.set(RAW_AVG_Y,   tInfos.y);
+			raws.set(RAW_AVG_Z,   tInfos.z);
+			raws.set(RAW_AVG_LX,  tInfos.lx);
+			raws.set(RAW_AVG_LY,  tInfos.ly);
+			raws.set(RAW_AVG_LZ,  tInfos.lz);
+			raws.set(RAW_PX,      aHit->GetMom().getX());
+			raws.set(RAW_PY,      aHit->GetMom().getY());
+			raws.set(RAW_PZ,      aHit->GetMom().getZ());
+			raws.set(RAW_VX,      aHit->GetVert().getX());
+			raws.set(RAW_VY,      aHit->GetVert().getY());
+			raws.set(RAW_VZ,      aHit->GetVert().getZ());
+			raws.set(RAW_MVX,     aHit->GetmVert().getX());
+			raws.set(RAW_MVY,     aHit->GetmVert().getY());
+			raws.set(RAW_MVZ,     aHit->GetmVert().getZ());
+			raws.set(RAW_AVG_T,   tInfos.time);
+			raws.set(RAW_PROCID,  aHit->GetProcID());
+			raws.set(RAW_NSTEPS,  aHit->GetPIDs().size());
 		}
 	}
 	return raws;
@@ -109,29 +162,29 @@ map< string, vector <double> > HitProcess::allRaws(MHit* aHit, int hitn)
 {
 	map< string, vector <double> > allRaws;
 	
-	vector<int>    pids = aHit->GetPIDs();
+	const vector<int>& pids = aHit->GetPIDs();
 	vector<double> pids_d(pids.begin(), pids.end());
 
-	vector<int>    mpids = aHit->GetmPIDs();
+	const vector<int>& mpids = aHit->GetmPIDs();
 	vector<double> mpids_d(mpids.begin(), mpids.end());
 
-	vector<int>    tids = aHit->GetTIds();
+	const vector<int>& tids = aHit->GetTIds();
 	vector<double> tids_d(tids.begin(), tids.end());
 
-	vector<int>    mtids = aHit->GetmTrackIds();
+	const vector<int>& mtids = aHit->GetmTrackIds();
 	vector<double> mtids_d(mtids.begin(), mtids.end());
 
-	vector<int>    otids = aHit->GetoTrackIds();
+	const vector<int>& otids = aHit->GetoTrackIds();
 	vector<double> otids_d(otids.begin(), otids.end());
 
 
 	vector<double> hitnd(pids.size(), (double) hitn);
 	
-	vector<G4ThreeVector>  gpos = aHit->GetPos();
-	vector<G4ThreeVector>  lpos = aHit->GetLPos();
-	vector<G4ThreeVector>  mome = aHit->GetMoms();
-	vector<G4ThreeVector>  vert = aHit->GetVerts();
-	vector<G4ThreeVector>  mver = aHit->GetmVerts();
+	const vector<G4ThreeVector>& gpos = aHit->GetPos();
+	const vector<G4ThreeVector>& lpos = aHit->GetLPos();
+	const vector<G4ThreeVector>& mome = aHit->GetMoms();
+	const vector<G4ThreeVector>& vert = aHit->GetVerts();
+	const vector<G4ThreeVector>& mver = aHit->GetmVerts();
 
 
 	vector<double> x, y, z;
@@ -209,10 +262,10 @@ trueInfos::trueInfos(MHit* aHit)
 	// getting vectors of energy deposited, positions and times
 	// nsteps is the size
 
-	vector<G4double> Edep       = aHit->GetEdep();
-	vector<G4ThreeVector> pos   = aHit->GetPos();
-	vector<G4ThreeVector> Lpos  = aHit->GetLPos();
-	vector<G4double>      times = aHit->GetTime();
+	const vector<G4double>&      Edep  = aHit->GetEdep();
+	const vector<G4ThreeVector>& pos   = aHit->GetPos();
+	const vector<G4ThreeVector>& Lpos  = aHit->GetLPos();
+	const vector<G4double>&      times = aHit->GetTime();
 
 	nsteps = Edep.size();
 	for(unsigned int s=0; s<nsteps; s++)
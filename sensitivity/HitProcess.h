@@ -84,6 +84,12 @@ public:
 		}
 	}
 	bool writeHit;           ///< MUST BE INITIALIZED FOR EACH HIT, not each event like above
+
+	// the routine is kept for the whole run: the hit conditions are reset at the start of each event
+	void resetHitConditions() {
+		rejectHitConditions = false;
+		writeHit = true;
+	}
 	bool filterDummyBanks;   ///< do not write out variables that has no valuable information
 
 
@@ -94,15 +100,16 @@ public:
 	// Variables in the processID of the sensitive detector
 	// should be initialized in the CONSTRUCTOR of the class
 
-	// notice, this is executed for each class instantiation (each event basically)
-	// we don't want to connect to DB for each event but it can be skipped using runno
-	// use static members insted as in FTOF template
+	// notice, the routine instance is kept for the whole run and this is executed
+	// only when the run number changes
+	// the constants are thread_local static structs as in the FTOF template;
+	// routines with a PulseShape voltage also point pulseShapePars to their parameters here
 
 	virtual void initWithRunNumber(int runno) {;}
 
 	// - integrateRaw: returns geant4 raw information integrated over the hit
 	// - add the info in the bank if INTEGRATEDRAW is TRUE
-	map<string, double> integrateRaw(MHit*, int, bool);
+	hitColumns integrateRaw(MHit*, int, bool);
 
 	// - allRaws: returns all geant4 raw information step by step\n\n
 	// this is not virtual, its declared in hitProcess.cc and common to all
@@ -125,7 +132,7 @@ public:
 
 	// The pure virtual method processID returns a (new) identifier
 	// containing hit sharing information
-	virtual vector<identifier> processID(vector<identifier>, G4Step*, detector) = 0;
+	virtual vector<identifier> processID(vector<identifier>, G4Step*, const detector&) = 0;
 
 	// - electronicNoise: returns a vector of hits generated by electronics.
 	virtual vector<MHit*> electronicNoise() = 0;
@@ -133,9 +140,18 @@ public:
 	// - voltage: returns a voltage value for a given time. The input are charge value, time
 	virtual double voltage(double, double, double) = 0;
 
+	// - voltageSamples: adds the voltage of all steps to the nsamplings samples, taken every tsampling.
+	// The input are the charges and times at electronics of the steps.
+	// With pulseShapePars it adds the PulseShape of each step, otherwise it calls voltage for every step and sample.
+	virtual void voltageSamples(const vector<double> &charges, const vector<double> &times, double tsampling, unsigned nsamplings, double *samples);
+
 	// - smearing momentum
 	virtual G4ThreeVector psmear(G4ThreeVector p) { return p;}
 
+	// - photonEfficiency: detection probability of the optical photon of the step, used as weight by the optical photon map calibration.
+	// By default it is the EFFICIENCY property of the hit material at the photon energy, or 1 if the material does not define it.
+	virtual double photonEfficiency(MHit*, unsigned step);
+
 	
 protected:
 
@@ -150,6 +166,9 @@ protected:
 	bool applyInefficiencies;
 	bool applyThresholds;
 
+	// PulseShape parameters of the detectors whose voltage is PulseShape, set in initWithRunNumber
+	double *pulseShapePars = nullptr;
+
 	inline double DGauss(double x, double *par, double Edep, double stepTime)
 	{
 		double t0   = par[0] + stepTime;     // delay + start time of signal so that peak is t0 + rise.
@@ -192,6 +211,28 @@ protected:
 		
 	}
 
+	// PulseShape of all steps added to the samples, see voltageSamples.
+	// The samples before the start of each step are skipped
+	inline void PulseShapeSamples(double *par, const vector<double> &charges, const vector<double> &times, double tsampling, unsigned nsamplings, double *samples)
+	{
+		double b = par[1];
+		double ampl = par[3];
+
+		for(unsigned s=0; s<times.size(); s++) {
+			double a = par[0] + times[s];
+			double stepAmpl = ampl*(1./(2*b*b*b))*charges[s];
+
+			double first = a > 0 ? floor(a/tsampling) : 0;
+			if( first >= nsamplings ) continue;
+
+			for(unsigned ts=(unsigned) first; ts<nsamplings; ts++) {
+				double x = ts*tsampling;
+				if( x < a ) continue;
+				samples[ts] += stepAmpl*(x-a)*(x-a)*exp( -(x-a)/b );
+			}
+		}
+	}
+
 
 };
 
@@ -204,6 +245,9 @@ HitProcess *getHitProcess(map<string, HitProcess_Factory> *hitProcessMap, string
 // returns the list of Hit Factories registered
 set<string> getListOfHitProcessHit(map<string, HitProcess_Factory>);
 
+// initializes the hit process routines of the hit types for each run, so their constants are loaded (and cached)
+void prefetchHitProcessConstants(map<string, HitProcess_Factory> *hitProcessMap, set<string> hitTypes, vector<int> runs, goptions gemcOpt, map<string, double> gpars);
+
 
 
 
@@ -64,8 +64,6 @@ ostream &operator<<(ostream &stream, BackgroundHit bgh)
 // initialize map from filename
 GBackgroundHits::GBackgroundHits(string filename, long int nevents, int verbosity)
 {
-	backgroundHitMap = new map<string, vector<BackgroundHit*> >;
-
 	ifstream bgif(filename.c_str());
 
 	if(bgif.good()) {
@@ -79,6 +77,9 @@ GBackgroundHits::GBackgroundHits(string filename, long int nevents, int verbosit
 
 	// file is good, loading hits
 	int hitNumber = 0;
+	long int nSystemEvents = 0;
+	vector<BackgroundHit*> *eventHits = nullptr;
+	string oldSystem = "";
 	string oldEventNumber = "";
 	while(!bgif.eof()) {
 		string bgline;
@@ -89,51 +90,51 @@ GBackgroundHits::GBackgroundHits(string filename, long int nevents, int verbosit
 
 		vector<string> hitsData = getStringVectorFromString(bgline);
 
-		string systemEventNumber = hitsData[0] + "____" + hitsData[1];
-
 		// keeping track of hit number for thie event:
-		if(systemEventNumber != oldEventNumber) {
+		// the hits of one system and event are consecutive in the file
+		if(hitsData[0] != oldSystem || hitsData[1] != oldEventNumber) {
 			hitNumber = 1;
-			oldEventNumber = systemEventNumber;
+			oldSystem = hitsData[0];
+			oldEventNumber = hitsData[1];
+
+			// load hits up to the number of requested events
+			eventHits = nullptr;
+			if(nSystemEvents <= nevents) {
+				map<int, vector<BackgroundHit*> > &systemHits = backgroundHitMap[hitsData[0]];
+				int eventN = stoi(hitsData[1]);
+				if(systemHits.find(eventN) == systemHits.end()) nSystemEvents++;
+				eventHits = &systemHits[eventN];
+			}
 		} else {
 			hitNumber++;
 		}
 
-
 		// load hit from string
-		long int backgroundHitMapSize = backgroundHitMap->size();
-		if(backgroundHitMapSize <= nevents) {
-			(*backgroundHitMap)[systemEventNumber].push_back(new BackgroundHit(hitsData, hitNumber, verbosity));
+		if(eventHits != nullptr) {
+			eventHits->push_back(new BackgroundHit(hitsData, hitNumber, verbosity));
 		}
 	}
 }
 
-
-map<int, vector<BackgroundHit*> >* GBackgroundHits::getBackgroundForSystem(string system)
+GBackgroundHits::~GBackgroundHits()
 {
-	map<int, vector<BackgroundHit*> > *systemBGHits = new map<int, vector<BackgroundHit*> >;
-
-	for(auto allHits: (*backgroundHitMap)) {
-
-		vector<string> systemAndEvents = getStringVectorFromStringWithDelimiter(allHits.first, "____");
-
-		// found system
-		if(systemAndEvents[0] == system) {
-			int eventN = stoi(systemAndEvents[1]);
-			for(auto bghit: allHits.second) {
-				(*systemBGHits)[eventN].push_back(bghit);
+	for(auto &systemHits: backgroundHitMap) {
+		for(auto &eventHits: systemHits.second) {
+			for(auto bghit: eventHits.second) {
+				delete bghit;
 			}
 		}
 	}
+}
 
-	if(systemBGHits->size() > 0) {
-		return systemBGHits;
+
+const map<int, vector<BackgroundHit*> >* GBackgroundHits::getBackgroundForSystem(const string &system) const
+{
+	auto systemHits = backgroundHitMap.find(system);
+
+	if(systemHits != backgroundHitMap.end() && systemHits->second.size() > 0) {
+		return &systemHits->second;
 	} else {
 		return nullptr;
 	}
 }
-
-
-
-
-
@@ -32,14 +32,17 @@ class GBackgroundHits {
 public:
 	GBackgroundHits() = default;
 	GBackgroundHits(string filename, long int nevents, int verbosity = 0);
+	~GBackgroundHits();
 
 	// returns all events for a system, key is bg event number
-	map<int, vector<BackgroundHit*> > *getBackgroundForSystem(string system);
+	// nullptr if the system has no background hits
+	const map<int, vector<BackgroundHit*> > *getBackgroundForSystem(const string &system) const;
 
 
 private:
-	// events for all system, key is detectorName____eventNumber
-	map<string, vector<BackgroundHit*> > *backgroundHitMap;
+	// events for all systems, indexed when the file is loaded
+	// first key is the detector name, second key is the event number
+	map<string, map<int, vector<BackgroundHit*> > > backgroundHitMap;
 	
 };
 
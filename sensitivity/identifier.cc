@@ -7,6 +7,7 @@
 
 // C++ headers
 #include <iostream>
+#include <functional>
 using namespace std;
 
 // CLHEP units
@@ -85,7 +86,7 @@ ostream &operator<<(ostream &stream, vector<identifier> Iden)
 
 
 // Sets the ncopy ID accordingly to Geant4 Volumes copy number
-vector<identifier> SetId(vector<identifier> Iden, G4VTouchable* TH, double time, double TimeWindow, int TrackId)
+vector<identifier> SetId(const vector<identifier> &Iden, G4VTouchable* TH, double time, double TimeWindow, int TrackId)
 {
 	vector<identifier> identity = Iden;
 
@@ -97,7 +98,7 @@ vector<identifier> SetId(vector<identifier> Iden, G4VTouchable* TH, double time,
 			// h=1 don't need to check volume itself
 			for(int h=0; h<TH->GetHistoryDepth(); h++)
 			{
-				string pname = TH->GetVolume(h)->GetName();
+				const string &pname = TH->GetVolume(h)->GetName();
 				int    pcopy = TH->GetVolume(h)->GetCopyNo();
 				if(pname.find(identity[i].name) != string::npos) identity[i].id = pcopy;
 			}
@@ -120,6 +121,26 @@ vector<identifier> SetId(vector<identifier> Iden, G4VTouchable* TH, double time,
 }
 
 
+// combine the hashes in the boost hash_combine fashion
+static inline void hashCombine(size_t &key, size_t h)
+{
+	key ^= h + 0x9e3779b9 + (key << 6) + (key >> 2);
+}
+
+size_t hitIndexKey(const vector<identifier>& Iden)
+{
+	size_t key = Iden.size();
+
+	for(const auto &iden : Iden) {
+		hashCombine(key, hash<string>()(iden.name));
+		hashCombine(key, hash<string>()(iden.rule));
+		hashCombine(key, hash<int>()(iden.id));
+		if(iden.TimeWindow == 0) hashCombine(key, hash<int>()(iden.TrackId));
+	}
+
+	return key;
+}
+
 vector<identifier> get_identifiers(string var)
 {
 	vector<identifier> identity; 
@@ -61,10 +61,15 @@ public:
 
 
 // move this somewhere?
-vector<identifier> SetId(vector<identifier>, G4VTouchable*, double, double, int);  ///< Sets the ncopy ID accordingly to Geant4 Volumes copy number. Sets time, TimeWindow, TrackId
+vector<identifier> SetId(const vector<identifier>&, G4VTouchable*, double, double, int);  ///< Sets the ncopy ID accordingly to Geant4 Volumes copy number. Sets time, TimeWindow, TrackId
 
 // returns vector of identifier from stringstream
 vector<identifier> get_identifiers(string var);
 
+// hash key of an identity, consistent with the overloaded "==": identities that compare equal have the same key.
+// Built from name, rule and id of each identifier, and TrackId for flux detectors (TimeWindow = 0).
+// Time is not part of the key: hits of the same element in different time windows share the key.
+size_t hitIndexKey(const vector<identifier>&);
+
 #endif
 
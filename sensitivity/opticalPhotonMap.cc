@@ -0,0 +1,298 @@
+// gemc headers
+#include "opticalPhotonMap.h"
+
+// C++ headers
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+using namespace std;
+
+// CLHEP units
+#include "CLHEP/Units/PhysicalConstants.h"
+using namespace CLHEP;
+
+namespace {
+	mutex sharedMapMutex;
+	map<string, opticalPhotonMap*> sharedMaps;
+
+	mutex calibrationMutex;
+	opticalPhotonMap *calibrationMap = nullptr;
+
+	// cell index: 17 bits for each position coordinate, 13 bits for the direction
+	const long positionOffset = 1 << 16;
+	const long positionMax    = (1 << 17) - 1;
+	const int  directionMax   = 1 << 13;
+
+	long positionBin(double x, double cellSize)
+	{
+		long b = (long) floor(x/cellSize) + positionOffset;
+		if(b < 0) return 0;
+		if(b > positionMax) return positionMax;
+		return b;
+	}
+}
+
+opticalPhotonMap::opticalPhotonMap(double cs, int nc, int np)
+{
+	cellSize  = cs;
+	nCosTheta = nc;
+	nPhi      = np;
+
+	if(nCosTheta*nPhi > directionMax) {
+		cout << "  !!! Error: the optical photon map can have at most " << directionMax << " direction bins. Exiting." << endl;
+		exit(1);
+	}
+}
+
+uint64_t opticalPhotonMap::cell(const G4ThreeVector &pos, const G4ThreeVector &dir) const
+{
+	uint64_t ix = positionBin(pos.x(), cellSize);
+	uint64_t iy = positionBin(pos.y(), cellSize);
+	uint64_t iz = positionBin(pos.z(), cellSize);
+
+	int ic = (int) ((dir.cosTheta() + 1)/2*nCosTheta);
+	int ip = (int) ((dir.phi() + pi)/twopi*nPhi);
+	if(ic >= nCosTheta) ic = nCosTheta - 1;
+	if(ip >= nPhi)      ip = nPhi - 1;
+
+	return (ix << 47) | (iy << 30) | (iz << 13) | (uint64_t) (ic*nPhi + ip);
+}
+
+int opticalPhotonMap::channelIndex(const string &sensitivity, const vector<identifier> &identity)
+{
+	stringstream key;
+	key << sensitivity;
+	for(auto &id : identity) {
+		key << " " << id.name << " " << id.rule << " " << id.id;
+	}
+
+	auto it = channelKeys.find(key.str());
+	if(it != channelKeys.end()) return it->second;
+
+	// only the name, rule and id are kept: the hit process only needs those
+	vector<identifier> channelIdentity;
+	for(auto &id : identity) {
+		identifier cid;
+		cid.name = id.name;
+		cid.rule = id.rule;
+		cid.id   = id.id;
+		cid.TrackId = 0;
+		channelIdentity.push_back(cid);
+	}
+
+	int index = (int) sensitivities.size();
+	sensitivities.push_back(sensitivity);
+	identities.push_back(channelIdentity);
+	channelKeys[key.str()] = index;
+
+	return index;
+}
+
+const vector<opticalPhotonMap::response> *opticalPhotonMap::responses(uint64_t c) const
+{
+	auto it = table.find(c);
+	if(it == table.end()) return nullptr;
+	return &it->second;
+}
+
+void opticalPhotonMap::addDetected(uint64_t c, int channel, double weight, double delay)
+{
+	detected &d = tallies[c].channels[channel];
+	d.weight   += weight;
+	d.delaySum += delay;
+	d.n++;
+}
+
+void opticalPhotonMap::merge(const opticalPhotonMap &other)
+{
+	// the channels of other are indexed in this map
+	vector<int> channelMap(other.sensitivities.size());
+	for(unsigned c=0; c<other.sensitivities.size(); c++) {
+		channelMap[c] = channelIndex(other.sensitivities[c], other.identities[c]);
+	}
+
+	for(auto &t : other.tallies) {
+		tally &thisTally = tallies[t.first];
+		thisTally.produced += t.second.produced;
+		for(auto &d : t.second.channels) {
+			detected &thisDetected = thisTally.channels[channelMap[d.first]];
+			thisDetected.weight   += d.second.weight;
+			thisDetected.delaySum += d.second.delaySum;
+			thisDetected.n        += d.second.n;
+		}
+	}
+}
+
+// text format:
+// binning cellSize nCosTheta nPhi
+// channel index sensitivity nidentifiers name rule id ...
+// cell key nproduced nchannels channel weight delaySum n ...
+bool opticalPhotonMap::write(string filename) const
+{
+	ofstream out(filename.c_str());
+	if(!out) {
+		cout << "  !!! Warning: optical photon map " << filename << " can't be written." << endl;
+		return false;
+	}
+
+	out.precision(10);
+	out << "# gemc optical photon map" << endl;
+	out << "binning " << cellSize << " " << nCosTheta << " " << nPhi << endl;
+
+	for(unsigned c=0; c<sensitivities.size(); c++) {
+		out << "channel " << c << " " << sensitivities[c] << " " << identities[c].size();
+		for(auto &id : identities[c]) {
+			out << " " << id.name << " " << id.rule << " " << id.id;
+		}
+		out << endl;
+	}
+
+	for(auto &t : tallies) {
+		out << "cell " << t.first << " " << t.second.produced << " " << t.second.channels.size();
+		for(auto &d : t.second.channels) {
+			out << " " << d.first << " " << d.second.weight << " " << d.second.delaySum << " " << d.second.n;
+		}
+		out << endl;
+	}
+
+	cout << "  > Optical photon map written to " << filename << ": " << tallies.size() << " cells, "
+	<< sensitivities.size() << " channels." << endl;
+
+	return true;
+}
+
+bool opticalPhotonMap::read(string filename)
+{
+	ifstream in(filename.c_str());
+	if(!in) {
+		cout << "  !!! Error: optical photon map " << filename << " not found." << endl;
+		return false;
+	}
+
+	string line;
+	while(getline(in, line)) {
+		stringstream ls(line);
+		string what;
+		if(!(ls >> what) || what[0] == '#') continue;
+
+		if(what == "binning") {
+			ls >> cellSize >> nCosTheta >> nPhi;
+		} else if(what == "channel") {
+			int index;
+			unsigned nids;
+			string sensitivity;
+			ls >> index >> sensitivity >> nids;
+
+			vector<identifier> identity(nids);
+			for(auto &id : identity) {
+				ls >> id.name >> id.rule >> id.id;
+			}
+			if(channelIndex(sensitivity, identity) != index) {
+				cout << "  !!! Error: optical photon map " << filename << " channels are not in order." << endl;
+				return false;
+			}
+		} else if(what == "cell") {
+			uint64_t key;
+			long produced;
+			unsigned nchannels;
+			ls >> key >> produced >> nchannels;
+
+			vector<response> &cellResponses = table[key];
+			for(unsigned c=0; c<nchannels; c++) {
+				detected d;
+				response r;
+				ls >> r.channel >> d.weight >> d.delaySum >> d.n;
+				if(produced == 0 || d.n == 0) continue;
+
+				r.probability = d.weight/produced;
+				r.delay       = d.delaySum/d.n;
+				cellResponses.push_back(r);
+			}
+		}
+
+		if(ls.fail()) {
+			cout << "  !!! Error: optical photon map " << filename << " has a wrong line: " << line << endl;
+			return false;
+		}
+	}
+
+	cout << "  > Optical photon map " << filename << " loaded: " << table.size() << " cells, "
+	<< sensitivities.size() << " channels." << endl;
+
+	return true;
+}
+
+const opticalPhotonMap *opticalPhotonMap::shared(string filename)
+{
+	lock_guard<mutex> lock(sharedMapMutex);
+
+	auto it = sharedMaps.find(filename);
+	if(it != sharedMaps.end()) return it->second;
+
+	opticalPhotonMap *m = new opticalPhotonMap();
+	if(!m->read(filename)) {
+		exit(1);
+	}
+	sharedMaps[filename] = m;
+
+	return m;
+}
+
+void opticalPhotonMap::mergeCalibration(const opticalPhotonMap &t)
+{
+	lock_guard<mutex> lock(calibrationMutex);
+
+	if(calibrationMap == nullptr) {
+		calibrationMap = new opticalPhotonMap(t.cellSize, t.nCosTheta, t.nPhi);
+	}
+	calibrationMap->merge(t);
+}
+
+void opticalPhotonMap::writeCalibration(string filename)
+{
+	lock_guard<mutex> lock(calibrationMutex);
+
+	if(calibrationMap == nullptr) {
+		cout << "  !!! Warning: no optical photon was recorded. The optical photon map " << filename << " is not written." << endl;
+		return;
+	}
+	calibrationMap->write(filename);
+}
+
+
+opticalPhotonEvent::opticalPhotonEvent(const opticalPhotonMap *fm, bool cal, const opticalPhotonMap &calibrationBinning) :
+fastMap(fm),
+calibration(cal),
+tally(calibrationBinning)
+{
+}
+
+void opticalPhotonEvent::addPhoton(const G4ThreeVector &pos, const G4ThreeVector &dir, double time)
+{
+	const vector<opticalPhotonMap::response> *cellResponses = fastMap->responses(fastMap->cell(pos, dir));
+	if(cellResponses == nullptr) return;
+
+	for(auto &r : *cellResponses) {
+		double arrival = time + r.delay;
+		channelSignal &s = signals[r.channel];
+		if(s.expected == 0 || arrival < s.time) s.time = arrival;
+		s.expected += r.probability;
+	}
+}
+
+void opticalPhotonEvent::recordPhoton(int tid, const G4ThreeVector &pos, const G4ThreeVector &dir, double time)
+{
+	uint64_t c = tally.cell(pos, dir);
+	photons[tid] = {c, time};
+	tally.addProduced(c);
+}
+
+void opticalPhotonEvent::clear()
+{
+	signals.clear();
+	photons.clear();
+	detected.clear();
+	tally.clear();
+}
@@ -0,0 +1,137 @@
+/// \file opticalPhotonMap.h
+/// Defines the optical photon map used by the optical photons fast simulation.\n
+/// A calibration run (OPTICAL_MAP_CALIBRATION) tracks the optical photons and records,
+/// for each cell of creation position and direction, the probability that a photon
+/// is detected by each readout channel and its average arrival delay.\n
+/// A fast run (OPTICAL_MAP) kills the optical photons at creation and adds
+/// to each channel a hit with the number of photoelectrons drawn from the expected value.
+/// These hits have the same form as the background hits: the photoelectrons are in the charge.\n
+
+#ifndef OPTICAL_PHOTON_MAP_H
+#define OPTICAL_PHOTON_MAP_H 1
+
+// G4 headers
+#include "G4ThreeVector.hh"
+
+// gemc headers
+#include "identifier.h"
+
+// C++ headers
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+using namespace std;
+
+
+/// \class opticalPhotonMap
+/// <b> opticalPhotonMap </b>\n\n
+/// The position is binned in cubes of cellSize, the direction in nCosTheta bins
+/// of cos(theta) and nPhi bins of phi.\n
+/// A channel is a sensitive detector name and the identity of a hit.
+/// The detection weight of a photon is given by the hit process routine photonEfficiency:
+/// the EFFICIENCY of the sensitive volume material at the photon energy, or 1 if the material
+/// does not define it. The RICH weight is its PMT quantum efficiency.
+class opticalPhotonMap
+{
+public:
+	opticalPhotonMap(double cellSize = 10, int nCosTheta = 20, int nPhi = 36);
+
+	/// response of a channel to a photon created in a cell
+	struct response {
+		int    channel;
+		double probability;   ///< expected photoelectrons per photon
+		double delay;         ///< average time between creation and detection
+	};
+
+	uint64_t cell(const G4ThreeVector &pos, const G4ThreeVector &dir) const;
+
+	/// index of the channel, added if not present yet
+	int channelIndex(const string &sensitivity, const vector<identifier> &identity);
+	const string &channelSensitivity(int c) const {return sensitivities[c];}
+	const vector<identifier> &channelIdentity(int c) const {return identities[c];}
+
+	/// responses to a photon created in this cell. nullptr if the cell was not calibrated
+	const vector<response> *responses(uint64_t cell) const;
+
+	// calibration
+	void addProduced(uint64_t cell) {tallies[cell].produced++;}
+	void addDetected(uint64_t cell, int channel, double weight, double delay);
+	void merge(const opticalPhotonMap &other);
+	void clear() {tallies.clear();}
+
+	bool write(string filename) const;
+	bool read(string filename);
+
+	/// map read once from filename and shared by all threads
+	static const opticalPhotonMap *shared(string filename);
+
+	/// adds a thread tally to the calibration map shared by all threads
+	static void mergeCalibration(const opticalPhotonMap &tally);
+
+	/// writes the calibration map shared by all threads
+	static void writeCalibration(string filename);
+
+private:
+	double cellSize;
+	int    nCosTheta;
+	int    nPhi;
+
+	vector<string>             sensitivities;
+	vector<vector<identifier>> identities;
+	map<string, int>           channelKeys;
+
+	struct detected {
+		double weight   = 0;
+		double delaySum = 0;
+		long   n        = 0;
+	};
+	struct tally {
+		long produced = 0;
+		map<int, detected> channels;
+	};
+	unordered_map<uint64_t, tally>            tallies;     ///< calibration counts
+	unordered_map<uint64_t, vector<response>> table;       ///< responses computed by read
+};
+
+
+/// \class opticalPhotonEvent
+/// <b> opticalPhotonEvent </b>\n\n
+/// Optical photons created in the current event, one instance per thread.\n
+/// Filled by the stacking action, used and cleared by the event action.
+class opticalPhotonEvent
+{
+public:
+	/// in calibration mode the photons are counted in cells of calibrationBinning
+	opticalPhotonEvent(const opticalPhotonMap *fastMap, bool calibration, const opticalPhotonMap &calibrationBinning);
+
+	const opticalPhotonMap *fastMap;   ///< fast simulation map. nullptr in calibration mode
+	bool calibration;
+
+	/// fast mode: adds the expected photoelectrons of a photon to the channels
+	void addPhoton(const G4ThreeVector &pos, const G4ThreeVector &dir, double time);
+
+	/// calibration mode: remembers the creation cell of a tracked photon
+	void recordPhoton(int tid, const G4ThreeVector &pos, const G4ThreeVector &dir, double time);
+
+	struct channelSignal {
+		double expected = 0;
+		double time     = 0;   ///< earliest expected arrival time
+	};
+	map<int, channelSignal> signals;   ///< fast mode: channel > expected signal
+
+	struct createdPhoton {
+		uint64_t cell;
+		double   time;
+	};
+	unordered_map<int, createdPhoton> photons;   ///< calibration: track id > creation
+	set<pair<int, int> >              detected;  ///< calibration: (track id, channel) already counted
+	opticalPhotonMap                  tally;     ///< calibration: this event counts
+
+	void clear();
+};
+
+
+#endif
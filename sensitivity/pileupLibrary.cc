@@ -0,0 +1,368 @@
+// gemc headers
+#include "pileupLibrary.h"
+#include "sensitiveDetector.h"
+
+// C++ headers
+#include <fstream>
+#include <iostream>
+#include <sstream>
+using namespace std;
+
+// the library is a header followed by one record per bunch:
+// materials names, then for each sensitive detector its hits with their identity and steps
+namespace {
+	const string libraryHeader = "GEMC_PILEUP_LIBRARY";
+
+	// to be increased every time the record content changes
+	const int libraryVersion = 1;
+
+	mutex sharedLibraryMutex;
+	map<string, pileupLibrary*> sharedLibraries;
+
+	mutex outputMutex;
+	ofstream *output = nullptr;
+	long nWrittenBunches = 0;
+
+	void put(ostream &out, int v)    { out.write((const char*) &v, sizeof(v)); }
+	void put(ostream &out, double v) { out.write((const char*) &v, sizeof(v)); }
+	void put(ostream &out, const string &s) {
+		put(out, (int) s.size());
+		out.write(s.data(), s.size());
+	}
+	void put(ostream &out, const G4ThreeVector &v) {
+		put(out, v.x());
+		put(out, v.y());
+		put(out, v.z());
+	}
+
+	bool get(istream &in, int &v)    { return (bool) in.read((char*) &v, sizeof(v)); }
+	bool get(istream &in, double &v) { return (bool) in.read((char*) &v, sizeof(v)); }
+	bool get(istream &in, string &s) {
+		int size = 0;
+		if(!get(in, size) || size < 0) return false;
+		s.resize(size);
+		return size == 0 || (bool) in.read(&s[0], size);
+	}
+	bool get(istream &in, G4ThreeVector &v) {
+		double x, y, z;
+		if(!(get(in, x) && get(in, y) && get(in, z))) return false;
+		v.set(x, y, z);
+		return true;
+	}
+
+	// the identity is what the digitization routines read: the user infos are included
+	void put(ostream &out, const identifier &i) {
+		put(out, i.name);
+		put(out, i.rule);
+		put(out, i.id);
+		put(out, i.time);
+		put(out, i.TimeWindow);
+		put(out, i.TrackId);
+		put(out, i.id_sharing);
+		put(out, (int) i.userInfos.size());
+		for(auto u : i.userInfos) put(out, u);
+	}
+
+	bool get(istream &in, identifier &i) {
+		int nInfos = 0;
+		if(!(get(in, i.name) && get(in, i.rule) && get(in, i.id) && get(in, i.time) && get(in, i.TimeWindow)
+			  && get(in, i.TrackId) && get(in, i.id_sharing) && get(in, nInfos)) || nInfos < 0) return false;
+		i.userInfos.resize(nInfos);
+		for(auto &u : i.userInfos) {
+			if(!get(in, u)) return false;
+		}
+		return true;
+	}
+
+	void put(ostream &out, const pileupLibrary::step &s) {
+		put(out, s.pos);
+		put(out, s.Lpos);
+		put(out, s.vert);
+		put(out, s.mom);
+		put(out, s.edep);
+		put(out, s.dx);
+		put(out, s.time);
+		put(out, s.E);
+		put(out, s.mgnf);
+		put(out, s.q);
+		put(out, s.PID);
+		put(out, s.trackID);
+		put(out, s.procID);
+		put(out, s.material);
+	}
+
+	bool get(istream &in, pileupLibrary::step &s) {
+		return get(in, s.pos) && get(in, s.Lpos) && get(in, s.vert) && get(in, s.mom)
+		&& get(in, s.edep) && get(in, s.dx) && get(in, s.time) && get(in, s.E) && get(in, s.mgnf)
+		&& get(in, s.q) && get(in, s.PID) && get(in, s.trackID) && get(in, s.procID) && get(in, s.material);
+	}
+}
+
+
+void pileupLibrary::overlay(unsigned bunchIndex, unsigned drawn, double shift, const string &system, sensitiveDetector *sd, MHitCollection *MHC) const
+{
+	call_once(materialsResolved, [this] {
+		for(auto &name : materialNames) {
+			materials.push_back(G4Material::GetMaterial(name, false));
+		}
+	});
+
+	auto systemHits = bunches[bunchIndex].find(system);
+	if(systemHits == bunches[bunchIndex].end()) return;
+
+	for(auto &h : systemHits->second) {
+		auto det = sd->hallMap->find(h.detector);
+		if(det == sd->hallMap->end()) continue;
+
+		vector<identifier> identity = h.identity;
+		for(auto &id : identity) {
+			id.time += shift;
+			id.TrackId = pileupTrackID(drawn, id.TrackId);
+		}
+
+		// the steps are added to the hit of the same element and time window, as in ProcessHits.
+		// With the pileup track IDs a flux hit, identified by its track, is never merged with another track
+		MHit *thisHit = sd->find_existing_hit(identity);
+		if(thisHit == nullptr) {
+			thisHit = new MHit();
+			thisHit->isPileupHit = 1;
+			thisHit->SetId(identity);
+			thisHit->SetSDID(sd->SDID);
+			MHC->insert(thisHit);
+			sd->hitIndex[hitIndexKey(identity)].push_back(thisHit);
+		}
+
+		for(auto &s : h.steps) {
+			thisHit->SetPos(s.pos);
+			thisHit->SetLPos(s.Lpos);
+			thisHit->SetVert(s.vert);
+			thisHit->SetTime(s.time + shift);
+			thisHit->SetEdep(s.edep);
+			thisHit->SetDx(s.dx);
+			thisHit->SetMom(s.mom);
+			thisHit->SetE(s.E);
+			thisHit->SetTrackId(pileupTrackID(drawn, s.trackID));
+			thisHit->SetDetector(det->second);
+			thisHit->SetPID(s.PID);
+			thisHit->SetCharge(s.q);
+			thisHit->SetMaterial(s.material >= 0 ? materials[s.material] : nullptr);
+			thisHit->SetProcID(s.procID);
+			thisHit->SetMgnf(s.mgnf);
+		}
+
+		// the mother infos belong to the library event: they are not set.
+		// The signal hits mother infos are set with the event ones, zero for the pileup tracks
+		if(thisHit->isPileupHit == 1) {
+			unsigned nsteps = thisHit->GetPos().size();
+			thisHit->SetmTrackIds(vector<int>(nsteps, 0));
+			thisHit->SetoTrackIds(vector<int>(nsteps, 0));
+			thisHit->SetmPIDs(vector<int>(nsteps, 0));
+			thisHit->SetmVerts(vector<G4ThreeVector>(nsteps, G4ThreeVector(0, 0, 0)));
+		}
+	}
+}
+
+bool pileupLibrary::read(string filename)
+{
+	ifstream in(filename.c_str(), ios::binary);
+	if(!in) {
+		cout << "  !!! Error: pileup library " << filename << " not found." << endl;
+		return false;
+	}
+
+	string header;
+	int version = 0;
+	if(!get(in, header) || header != libraryHeader || !get(in, version) || version != libraryVersion) {
+		cout << "  !!! Error: " << filename << " is not a pileup library of version " << libraryVersion << "." << endl;
+		return false;
+	}
+
+	map<string, int> materialIndex;
+
+	// a bunch cut by the end of the file (job killed while writing) is dropped
+	int nMaterials;
+	while(get(in, nMaterials)) {
+		vector<int> bunchMaterials;
+		bool complete = nMaterials >= 0;
+		for(int m=0; complete && m<nMaterials; m++) {
+			string name;
+			complete = get(in, name);
+			auto index = materialIndex.find(name);
+			if(index == materialIndex.end()) {
+				index = materialIndex.insert(make_pair(name, (int) materialNames.size())).first;
+				materialNames.push_back(name);
+			}
+			bunchMaterials.push_back(index->second);
+		}
+
+		bunch thisBunch;
+		int nSystems = 0;
+		complete = complete && get(in, nSystems);
+		for(int sys=0; complete && sys<nSystems; sys++) {
+			string system;
+			int nHits = 0;
+			complete = get(in, system) && get(in, nHits) && nHits >= 0;
+
+			vector<hit> &systemHits = thisBunch[system];
+			systemHits.resize(complete ? nHits : 0);
+			for(auto &h : systemHits) {
+				int nIds = 0, nSteps = 0;
+				complete = complete && get(in, h.detector) && get(in, nIds) && nIds >= 0;
+				if(complete) h.identity.resize(nIds);
+				for(auto &id : h.identity) complete = complete && get(in, id);
+
+				complete = complete && get(in, nSteps) && nSteps >= 0;
+				if(complete) h.steps.resize(nSteps);
+				for(auto &s : h.steps) {
+					complete = complete && get(in, s);
+					if(complete && s.material >= 0) {
+						if(s.material < (int) bunchMaterials.size()) s.material = bunchMaterials[s.material];
+						else complete = false;
+					}
+				}
+			}
+		}
+
+		if(!complete) {
+			cout << "  !!! Warning: pileup library " << filename << " is truncated after " << bunches.size() << " bunches." << endl;
+			break;
+		}
+		bunches.push_back(thisBunch);
+	}
+
+	cout << "  > Pileup library " << filename << " loaded: " << bunches.size() << " bunches." << endl;
+
+	return true;
+}
+
+const pileupLibrary *pileupLibrary::shared(string filename)
+{
+	lock_guard<mutex> lock(sharedLibraryMutex);
+
+	auto it = sharedLibraries.find(filename);
+	if(it != sharedLibraries.end()) return it->second;
+
+	pileupLibrary *l = new pileupLibrary();
+	if(!l->read(filename)) {
+		exit(1);
+	}
+	if(l->size() == 0) {
+		cout << "  !!! Error: pileup library " << filename << " has no bunches. Exiting." << endl;
+		exit(1);
+	}
+	sharedLibraries[filename] = l;
+
+	return l;
+}
+
+void pileupLibrary::writeBunch(string filename, const map<string, sensitiveDetector*> &SeDe_Map)
+{
+	// the record is built outside the lock
+	map<const G4Material*, int> materialIndex;
+	vector<string> bunchMaterials;
+	ostringstream hits;
+
+	int nSystems = 0;
+	for(auto &sd : SeDe_Map) {
+		MHitCollection *MHC = sd.second->GetMHitCollection();
+		if(MHC) nSystems++;
+	}
+	put(hits, nSystems);
+
+	for(auto &sd : SeDe_Map) {
+		MHitCollection *MHC = sd.second->GetMHitCollection();
+		if(!MHC) continue;
+
+		vector<MHit*> systemHits;
+		for(unsigned h=0; h<MHC->GetSize(); h++) {
+			MHit *aHit = (*MHC)[h];
+			if(aHit->isElectronicNoise == 1 || aHit->isBackgroundHit == 1 || aHit->isPileupHit == 1) continue;
+			systemHits.push_back(aHit);
+		}
+
+		put(hits, sd.first);
+		put(hits, (int) systemHits.size());
+		for(auto aHit : systemHits) {
+			put(hits, aHit->GetDetector().name);
+			put(hits, (int) aHit->GetId().size());
+			for(auto &id : aHit->GetId()) put(hits, id);
+
+			const vector<G4ThreeVector> &pos  = aHit->GetPos();
+			const vector<G4ThreeVector> &Lpos = aHit->GetLPos();
+			const vector<G4ThreeVector> &vert = aHit->GetVerts();
+			const vector<G4ThreeVector> &mom  = aHit->GetMoms();
+			const vector<double> &edep        = aHit->GetEdep();
+			const vector<double> &dx          = aHit->GetDx();
+			const vector<double> &time        = aHit->GetTime();
+			const vector<double> &E           = aHit->GetEs();
+			const vector<double> &mgnf        = aHit->GetMgnf();
+			const vector<int> &q              = aHit->GetCharges();
+			const vector<int> &PID            = aHit->GetPIDs();
+			const vector<int> &trackID        = aHit->GetTIds();
+			const vector<int> &procID         = aHit->GetProcIDs();
+			const vector<const G4Material*> &mats = aHit->GetMaterials();
+
+			put(hits, (int) pos.size());
+			for(unsigned s=0; s<pos.size(); s++) {
+				pileupLibrary::step st;
+				st.pos     = pos[s];
+				st.Lpos    = Lpos[s];
+				st.vert    = vert[s];
+				st.mom     = mom[s];
+				st.edep    = edep[s];
+				st.dx      = dx[s];
+				st.time    = time[s];
+				st.E       = E[s];
+				st.mgnf    = mgnf[s];
+				st.q       = q[s];
+				st.PID     = PID[s];
+				st.trackID = trackID[s];
+				st.procID  = procID[s];
+				st.material = -1;
+				if(mats[s] != nullptr) {
+					auto index = materialIndex.find(mats[s]);
+					if(index == materialIndex.end()) {
+						index = materialIndex.insert(make_pair(mats[s], (int) bunchMaterials.size())).first;
+						bunchMaterials.push_back(mats[s]->GetName());
+					}
+					st.material = index->second;
+				}
+				put(hits, st);
+			}
+		}
+	}
+
+	ostringstream record;
+	put(record, (int) bunchMaterials.size());
+	for(auto &name : bunchMaterials) put(record, name);
+	record << hits.str();
+
+	lock_guard<mutex> lock(outputMutex);
+
+	if(output == nullptr) {
+		output = new ofstream(filename.c_str(), ios::binary);
+		if(!*output) {
+			cout << "  !!! Error: pileup library " << filename << " can't be written. Exiting." << endl;
+			exit(1);
+		}
+		put(*output, libraryHeader);
+		put(*output, libraryVersion);
+	}
+
+	const string &r = record.str();
+	output->write(r.data(), r.size());
+	nWrittenBunches++;
+}
+
+void pileupLibrary::closeOutput()
+{
+	lock_guard<mutex> lock(outputMutex);
+
+	if(output == nullptr) return;
+
+	output->close();
+	delete output;
+	output = nullptr;
+
+	cout << "  > Pileup library written: " << nWrittenBunches << " bunches." << endl;
+}
@@ -0,0 +1,93 @@
+/// \file pileupLibrary.h
+/// Defines the luminosity pileup library.\n
+/// A library run (PILEUP_LIBRARY_OUTPUT) simulates luminosity bunches only and writes
+/// the raw hits of each event, with all their steps, as one library bunch.\n
+/// A signal run (PILEUP_LIBRARY) loads the library and, at the end of each event,
+/// adds to the hit collections the hits of randomly drawn bunches, each shifted to
+/// one bunch time of the LUMI_EVENT time window, with 0 LUMI_EVENT particles.
+/// The library hits are merged with the hits of the same element and time window,
+/// and are digitized with the signal hits as if the luminosity particles were tracked in the same event.
+/// Their track IDs are negative and different for each bunch, with zero mother infos.\n
+
+#ifndef PILEUP_LIBRARY_H
+#define PILEUP_LIBRARY_H 1
+
+// G4 headers
+#include "G4ThreeVector.hh"
+#include "G4Material.hh"
+
+// gemc headers
+#include "identifier.h"
+#include "Hit.h"
+
+// C++ headers
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+using namespace std;
+
+class sensitiveDetector;
+
+
+/// \class pileupLibrary
+/// <b> pileupLibrary </b>\n\n
+/// The library is written in the machine byte order: it is meant to be reused on the same farm architecture.
+/// Materials are stored by name and resolved at the first overlay, once the geometry is built.
+class pileupLibrary
+{
+public:
+	pileupLibrary() = default;
+
+	struct step {
+		G4ThreeVector pos, Lpos, vert, mom;
+		double edep, dx, time, E, mgnf;
+		int    q, PID, trackID, procID;
+		int    material;   ///< index in materialNames, -1 if not defined
+	};
+
+	struct hit {
+		string             detector;   ///< volume name in the hall map
+		vector<identifier> identity;
+		vector<step>       steps;
+	};
+
+	/// hits of one bunch, key is the sensitive detector name
+	typedef map<string, vector<hit> > bunch;
+
+	unsigned size() const {return bunches.size();}
+
+	/// track IDs reserved to each drawn bunch
+	static const unsigned bunchTrackIDs = 10000000;
+
+	/// adds to the hit collection of a sensitive detector the hits of a bunch, shifted by shift.
+	/// The steps of a hit are added to the existing hit with the same identity, found in the sensitive detector hit index.
+	/// drawn is the index of the bunch among the event bunches: the library track IDs are replaced by pileupTrackID
+	void overlay(unsigned bunchIndex, unsigned drawn, double shift, const string &system, sensitiveDetector *sd, MHitCollection *MHC) const;
+
+	/// negative track ID of a library track in the drawn bunch of the event: it never matches an event
+	/// track or a track of another bunch, in the hit identity (flux detectors) as in the steps
+	static int pileupTrackID(unsigned drawn, int trackID) { return -(int) (drawn*bunchTrackIDs + trackID); }
+
+	bool read(string filename);
+
+	/// library read once from filename and shared by all threads. Exits if the file can't be read
+	static const pileupLibrary *shared(string filename);
+
+	/// appends the hits of the current event to the library file shared by all threads.
+	/// Noise, background and pileup hits are not written
+	static void writeBunch(string filename, const map<string, sensitiveDetector*> &SeDe_Map);
+
+	/// closes the library file shared by all threads
+	static void closeOutput();
+
+private:
+	vector<bunch>  bunches;
+	vector<string> materialNames;
+
+	mutable once_flag                 materialsResolved;
+	mutable vector<const G4Material*> materials;
+};
+
+
+#endif
@@ -0,0 +1,72 @@
+// gemc headers
+#include "pulseShape.h"
+
+// C++ headers
+#include <cmath>
+using namespace std;
+
+// row p, sample m holds f(tlow + p*fineStep + m*samplingTime)
+// the last row (p = oversampling) is the first row shifted by one sample,
+// so that the interpolation between row p and p+1 never wraps
+pulseShape::pulseShape(function<double(double)> shape, double tl, double thigh, double st, int os)
+{
+	tlow         = tl;
+	samplingTime = st;
+	oversampling = os;
+	fineStep     = samplingTime / oversampling;
+	nPerPhase    = (int) ceil((thigh - tlow)/samplingTime) + 1;
+
+	table.resize((oversampling + 1)*nPerPhase);
+
+	for(int p=0; p<=oversampling; p++) {
+		for(int m=0; m<nPerPhase; m++) {
+			double t = tlow + p*fineStep + m*samplingTime;
+			table[p*nPerPhase + m] = t <= thigh ? shape(t) : 0;
+		}
+	}
+}
+
+double pulseShape::operator()(double t) const
+{
+	double u = (t - tlow)/fineStep;
+	if(u < 0) return 0;
+
+	long q = (long) floor(u);
+	double f = u - q;
+	int p = q % oversampling;
+	long m = q / oversampling;
+	if(m >= nPerPhase) return 0;
+
+	const double *row = &table[p*nPerPhase];
+	return (1 - f)*row[m] + f*row[m + nPerPhase];
+}
+
+void pulseShape::accumulate(double amplitude, double t0, double *samples, int nsamples, double tstart) const
+{
+	// position of the first sample in units of the fine step
+	double u = (tstart - t0 - tlow)/fineStep;
+	long q = (long) floor(u);
+	double f = u - q;
+
+	// floor division: q can be negative
+	long m0 = q / oversampling;
+	long p  = q % oversampling;
+	if(p < 0) {
+		p += oversampling;
+		m0--;
+	}
+
+	// samples[i] reads table sample m0 + i
+	long first = m0 < 0 ? -m0 : 0;
+	long last  = min((long) nsamples, nPerPhase - m0);
+	if(first >= last) return;
+
+	const double *row  = &table[p*nPerPhase + m0 + first];
+	const double *next = row + nPerPhase;
+	double *out = samples + first;
+	double a0 = amplitude*(1 - f);
+	double a1 = amplitude*f;
+
+	for(long i=0; i<last-first; i++)
+		out[i] += a0*row[i] + a1*next[i];
+}
@@ -0,0 +1,44 @@
+/// \file pulseShape.h
+/// Defines the tabulated pulse shape used to synthesize sampled waveforms.\n
+
+#ifndef PULSE_SHAPE_H
+#define PULSE_SHAPE_H 1
+
+// C++ headers
+#include <functional>
+#include <vector>
+using namespace std;
+
+
+/// \class pulseShape
+/// <b> pulseShape </b>\n\n
+/// A pulse shape f(t), tabulated once between tlow and thigh for a fixed
+/// sampling time. The signal of a step with amplitude A starting at t0 is A*f(t - t0).\n
+/// The table is stored by phase: each of the oversampling phases holds f at
+/// the sampling time spacing, so adding a step to a waveform is a linear
+/// interpolation between two contiguous rows, a loop the compiler vectorizes.\n
+/// f is zero outside [tlow, thigh].
+class pulseShape
+{
+public:
+	pulseShape(function<double(double)> shape, double tlow, double thigh, double samplingTime, int oversampling = 64);
+
+	double getSamplingTime() const {return samplingTime;}
+
+	/// f(t), interpolated from the table
+	double operator()(double t) const;
+
+	/// adds amplitude*f(t - t0) to samples[i], the waveform sampled at tstart + i*samplingTime
+	void accumulate(double amplitude, double t0, double *samples, int nsamples, double tstart) const;
+
+private:
+	double tlow;
+	double samplingTime;
+	double fineStep;          ///< samplingTime / oversampling
+	int    oversampling;
+	int    nPerPhase;         ///< number of samples in each phase row
+	vector<double> table;     ///< (oversampling+1) rows of nPerPhase samples
+};
+
+
+#endif
@@ -3,6 +3,7 @@
 #include "G4UnitsTable.hh"
 #include "G4ParticleTypes.hh"
 #include "G4VProcess.hh"
+#include "G4ProcessTable.hh"
 #include "G4FieldManager.hh"
 #include "G4Field.hh"
 
@@ -14,9 +15,62 @@
 #include "CLHEP/Units/PhysicalConstants.h"
 using namespace CLHEP;
 
+// C++ headers
+#include <mutex>
+#include <set>
+
+// process names not in the catalog get their ID in catalogueProcesses, in name order.
+// Shared by all threads: the IDs are consistent in the output and between jobs
+namespace {
+	mutex uncataloguedMutex;
+	map<int, string> uncataloguedNames;
+	map<string, int> uncataloguedIDs;
+	const int firstUncataloguedID = 1000;
+}
+
+static int cataloguedProcessID(const string &procName);
+
+map<int, string> uncataloguedProcesses()
+{
+	lock_guard<mutex> lock(uncataloguedMutex);
+	return uncataloguedNames;
+}
+
+// the process table of the calling thread has all the processes of the physics list
+void catalogueProcesses()
+{
+	set<string> names;
+	G4ProcNameVector *processNames = G4ProcessTable::GetProcessTable()->GetNameList();
+	for(auto &name : *processNames) {
+		if(cataloguedProcessID(name) == 0) names.insert(name);
+	}
+
+	lock_guard<mutex> lock(uncataloguedMutex);
+	for(auto &name : names) {
+		if(uncataloguedIDs.find(name) != uncataloguedIDs.end()) continue;
+
+		int procID = firstUncataloguedID + (int) uncataloguedIDs.size();
+		uncataloguedIDs[name]     = procID;
+		uncataloguedNames[procID] = name;
+	}
+}
+
 sensitiveDetector::sensitiveDetector(G4String name, goptions opt, string factory, int run, string variation, string system):G4VSensitiveDetector(name), gemcOpt(opt), HCID(-1)
 {
 	HCname = name;
+	setOptions();
+
+	SDID = sensitiveID(HCname, gemcOpt, factory, variation, system, run);
+}
+
+sensitiveDetector::sensitiveDetector(G4String name, goptions opt, sensitiveID sdid):G4VSensitiveDetector(name), gemcOpt(opt), SDID(sdid), HCID(-1)
+{
+	HCname = name;
+	setOptions();
+}
+
+void sensitiveDetector::setOptions()
+{
 	collectionName.insert(HCname);
 	hitCollection = nullptr;
 	
@@ -37,23 +91,62 @@ sensitiveDetector::sensitiveDetector(G4String name, goptions opt, string factory
 	if(gemcOpt.optMap["SAVE_ALL_MOTHERS"].arg == 3 || fastMCMode == 2)
 		RECORD_PASSBY = 1;
 
+	// the optical photon map calibration needs the optical photons hits
+	if(gemcOpt.optMap["OPTICAL_MAP_CALIBRATION"].args != "no")
+		RECORD_OPTICALPHOTONS = 1;
+
 	// skip sensitive detector if it's a mirror and RECORD_MIRRORS is set to zero
 	skipSensitivity = false;
 	if(RECORD_MIRRORS == 0 && collectionName[0] == "mirror") {
 		skipSensitivity = true;
 	}
-	
-	SDID = sensitiveID(HCname, gemcOpt, factory, variation, system, run);
-	
+
+	profiling = gemcOpt.optMap["PROFILE"].arg > 0;
+}
+
+sensitiveDetector::~sensitiveDetector()
+{
+	for(auto &hpr: hitProcessRoutines)
+		delete hpr.second;
+}
+
+// called when the volume sensitivity is set to this sensitive detector
+void sensitiveDetector::addSensitiveVolume(const detector &volume)
+{
+	sensitiveVolume &sVolume = sensitiveVolumes[volume.name];
+	sVolume.volume  = &volume;
+	sVolume.hitType = volume.hitType;
 }
 
-sensitiveDetector::~sensitiveDetector(){}
+// the physical volume name is the detector name
+// after the first step in a volume, its record is found by pointer
+sensitiveVolume *sensitiveDetector::findSensitiveVolume(const G4VPhysicalVolume *physical)
+{
+	auto indexed = volumeIndex.find(physical);
+	if(indexed != volumeIndex.end()) return indexed->second;
+
+	const string &name = physical->GetName();
+	if(sensitiveVolumes.find(name) == sensitiveVolumes.end()) {
+		addSensitiveVolume((*hallMap)[name]);
+	}
+	sensitiveVolume *sVolume = &sensitiveVolumes[name];
+
+	if(sVolume->hitProcess == nullptr) {
+		if(hitProcessRoutines.find(sVolume->hitType) == hitProcessRoutines.end()) {
+			hitProcessRoutines[sVolume->hitType] = getHitProcess(hitProcessMap, sVolume->hitType);
+		}
+		sVolume->hitProcess = hitProcessRoutines[sVolume->hitType];
+	}
+
+	volumeIndex[physical] = sVolume;
+	return sVolume;
+}
 
 
 void sensitiveDetector::Initialize(G4HCofThisEvent* HCE)
 {
 	
-	Id_Set.clear();
+	hitIndex.clear();
 	hitCollection = new MHitCollection(HCname, collectionName[0]);
 	if(HCID < 0)  {
 		HCID = G4SDManager::GetSDMpointer()->GetCollectionID(collectionName[0]);
@@ -69,6 +162,9 @@ void sensitiveDetector::Initialize(G4HCofThisEvent* HCE)
 
 G4bool sensitiveDetector::ProcessHits(G4Step* aStep, G4TouchableHistory*)
 {
+	stepTimer timer(profiling ? &profile : nullptr);
+	if(profiling) profile.steps++;
+
 	if (skipSensitivity) {
 		if(verbosity > 5) {
 			cout << "   > skipSensitivity is true. ";
@@ -105,8 +201,13 @@ G4bool sensitiveDetector::ProcessHits(G4Step* aStep, G4TouchableHistory*)
 	}
 
 
-	// this is expensive should we really check?
-	if(trk->GetDefinition()->GetParticleName().find("unknown") != string::npos) {
+	// the particle name is checked once per particle definition
+	const G4ParticleDefinition *particle = trk->GetDefinition();
+	auto unknown = unknownParticles.find(particle);
+	if(unknown == unknownParticles.end()) {
+		unknown = unknownParticles.emplace(particle, particle->GetParticleName().find("unknown") != string::npos).first;
+	}
+	if(unknown->second) {
 		if(verbosity > 5) {
 			cout << "   > skipSensitivity is true. ";
 			cout << " sensitiveDetector::ProcessHits returning false " << endl;
@@ -116,15 +217,17 @@ G4bool sensitiveDetector::ProcessHits(G4Step* aStep, G4TouchableHistory*)
 
 	G4VTouchable* TH =  (G4VTouchable*) aStep->GetPreStepPoint()->GetTouchable();
 
+	// volume informations, resolved once per volume
+	sensitiveVolume *sVolume = findSensitiveVolume(TH->GetVolume(0));
+
 	G4StepPoint   *prestep     = aStep->GetPreStepPoint();
 	G4StepPoint   *poststep    = aStep->GetPostStepPoint();
-	string         processName = "na";
 
 	///< Hit informations
 	///< The hit position is taken from PostStepPoint (inside the sensitive volume)
 	///< Transformation to local coordinates has to be done with prestep
 	double         Dx      = aStep->GetStepLength();
-	string         name    = TH->GetVolume(0)->GetName();                                     ///< Volume name
+	const string  &name    = sVolume->volume->name;                                           ///< Volume name
 	G4ThreeVector   xyz    = poststep->GetPosition();                                         ///< Global Coordinates of interaction
 	G4ThreeVector  Lxyz    = prestep->GetTouchableHandle()->GetHistory()                      ///< Local Coordinates of interaction
 	->GetTopTransform().TransformPoint(xyz);
@@ -135,21 +238,18 @@ G4bool sensitiveDetector::ProcessHits(G4Step* aStep, G4TouchableHistory*)
 	int            tid     = trk->GetTrackID();                                               ///< Track ID
 	int            pid     = trk->GetDefinition()->GetPDGEncoding();                          ///< Track PID
 	int            q       = (int) trk->GetDefinition()->GetPDGCharge();                      ///< Track Charge
-	if(trk->GetCreatorProcess()) {
-		processName     = trk->GetCreatorProcess()->GetProcessName();                      ///< Process that originated the track
-	}
-	string materialName    = poststep->GetMaterial()->GetName();                              ///< Material name in this step
-	vector<identifier> VID = SetId(GetDetectorIdentifier(name), TH, ctime, SDID.timeWindow, tid);                              ///< Identifier at the geant4 level, using the G4 hierarchy to set the copies
+	int            procID  = processID(trk->GetCreatorProcess());                             ///< Process that originated the track
+	const G4Material *material = poststep->GetMaterial();                                     ///< Material in this step
+	vector<identifier> VID = SetId(sVolume->volume->identity, TH, ctime, SDID.timeWindow, tid);                              ///< Identifier at the geant4 level, using the G4 hierarchy to set the copies
 	
-	// Get the ProcessHitRoutine to calculate the new vector<identifier>
-	if(ProcessHitRoutine == nullptr) {
-		ProcessHitRoutine = getHitProcess(hitProcessMap, GetDetectorHitType(name));
-	}
+	// The ProcessHitRoutine calculates the new vector<identifier>
+	// The routine is instantiated only once per hit type
+	ProcessHitRoutine = sVolume->hitProcess;
 	
 	// if not existing, exit
 	// this should never happen though
 	if(ProcessHitRoutine == nullptr) {
-		cout << endl << "  !!! Error: >" <<  GetDetectorHitType(name) << "< NOT FOUND IN  ProcessHit Map for volume: " << name << " - exiting." << endl;
+		cout << endl << "  !!! Error: >" <<  sVolume->hitType << "< NOT FOUND IN  ProcessHit Map for volume: " << name << " - exiting." << endl;
 		return false;
 	}
 	
@@ -168,7 +268,7 @@ G4bool sensitiveDetector::ProcessHits(G4Step* aStep, G4TouchableHistory*)
 	
 	///< Process VID: getting Identifier at the ProcessHitRoutine level
 	///< A process routine can generate hit sharing
-	vector<identifier> PID = ProcessHitRoutine->processID(VID, aStep, (*hallMap)[name]);
+	vector<identifier> PID = ProcessHitRoutine->processID(VID, aStep, *sVolume->volume);
 	int singl_hit_size = VID.size();
 	int multi_hit_size = PID.size()/singl_hit_size;
 
@@ -204,20 +304,13 @@ G4bool sensitiveDetector::ProcessHits(G4Step* aStep, G4TouchableHistory*)
 
 		///< Checking if it's new hit or existing hit. Use the overloaded "=="
 		if(verbosity > 9) {
-			cout << endl << endl << " BEGIN SEARCH for same hit in Identifier Set..." << endl;
+			cout << endl << endl << " BEGIN SEARCH for same hit in Hit Index..." << endl;
 		}
 
-		set<vector<identifier> > :: iterator itid;
-		int hit_found = 0;
-		
-		for(itid = Id_Set.begin(); itid!= Id_Set.end() && !hit_found; itid++) {
-			if(*itid == mhPID)  hit_found=1;
-			if(verbosity > 9 )
-				cout << "   >> Current Step:  " << mhPID
-				<< "   >> Set Hit Index: " << *itid
-				<< (hit_found ? "   >> FOUND at this Set Entry. " : "   >> Not found yet. ") << endl;
-		}
-		if(verbosity > 10) cout << " SEARCH ENDED." << (hit_found ? " 1 " : " No ") << "hit found in the Set." << endl << endl;
+		MHit *existingHit = find_existing_hit(mhPID);
+		int hit_found = existingHit ? 1 : 0;
+
+		if(verbosity > 10) cout << " SEARCH ENDED." << (hit_found ? " 1 " : " No ") << "hit found in the Index." << endl << endl;
 		
 		
 		
@@ -233,16 +326,16 @@ G4bool sensitiveDetector::ProcessHits(G4Step* aStep, G4TouchableHistory*)
 			thisHit->SetMom(pxyz);
 			thisHit->SetE(ene);
 			thisHit->SetTrackId(tid);
-			thisHit->SetDetector((*hallMap)[name]);
+			thisHit->SetDetector(*sVolume->volume);
 			thisHit->SetId(mhPID);
 			thisHit->SetPID(pid);
 			thisHit->SetCharge(q);
-			thisHit->SetMatName(materialName);
-			thisHit->SetProcID(processID(processName));
+			thisHit->SetMaterial(material);
+			thisHit->SetProcID(procID);
 			thisHit->SetSDID(SDID);
 			thisHit->SetMgnf(hitFieldValue);
 			hitCollection->insert(thisHit);
-			Id_Set.insert(mhPID);
+			hitIndex[hitIndexKey(mhPID)].push_back(thisHit);
 			
 			if(verbosity > 6 || name.find(catch_v) != string::npos) {
 				string pid    = aStep->GetTrack()->GetDefinition()->GetParticleName();
@@ -259,11 +352,8 @@ G4bool sensitiveDetector::ProcessHits(G4Step* aStep, G4TouchableHistory*)
 			// Adding hit info only if the poststeppint remains in the volume?
 			// if( aStep->GetPreStepPoint()->GetTouchable()->GetVolume(0) == aStep->GetPostStepPoint()->GetTouchable()->GetVolume(0))
 			{
-				MHit *thisHit = find_existing_hit(mhPID);
-				if(!thisHit) {
-					cout << " Hit not found in collection but found in PID. This should never happen. Exiting." << endl;
-					exit(1);
-				} else {
+				MHit *thisHit = existingHit;
+				{
 					thisHit->SetPos(xyz);
 					thisHit->SetLPos(Lxyz);
 					thisHit->SetVert(vert);
@@ -275,9 +365,9 @@ G4bool sensitiveDetector::ProcessHits(G4Step* aStep, G4TouchableHistory*)
 					thisHit->SetTrackId(tid);
 					thisHit->SetPID(pid);
 					thisHit->SetCharge(q);
-					thisHit->SetMatName(materialName);
-					thisHit->SetProcID(processID(processName));
-					thisHit->SetDetector((*hallMap)[name]);
+					thisHit->SetMaterial(material);
+					thisHit->SetProcID(procID);
+					thisHit->SetDetector(*sVolume->volume);
 					thisHit->SetMgnf(hitFieldValue);
 					
 					if(verbosity > 6 || name.find(catch_v) != string::npos) {
@@ -351,24 +441,43 @@ void sensitiveDetector::EndOfEvent(G4HCofThisEvent *HCE)
 			}
 		}
 	}
-	
-	
-	if(ProcessHitRoutine) delete ProcessHitRoutine; // not needed anymore
 }
 
 
-MHit*  sensitiveDetector::find_existing_hit(vector<identifier> PID)  ///< returns hit collection hit inside identifer
+// the index bucket only holds hits of the same element: the overloaded "==" then
+// resolves the time window (or track id) in collection order
+MHit*  sensitiveDetector::find_existing_hit(const vector<identifier>& PID)  ///< returns hit collection hit inside identifer
 {
-	for(unsigned int i=0; i<hitCollection->GetSize(); i++) {
-		if((*hitCollection)[i]->GetId() == PID) return (*hitCollection)[i];
+	auto bucket = hitIndex.find(hitIndexKey(PID));
+	if(bucket == hitIndex.end()) return nullptr;
+
+	for(auto hit : bucket->second) {
+		bool found = hit->GetId() == PID;
+		if(verbosity > 9)
+			cout << "   >> Current Step:  " << PID
+			<< "   >> Index Hit: " << hit->GetId()
+			<< (found ? "   >> FOUND at this Index Entry. " : "   >> Not found yet. ") << endl;
+		if(found) return hit;
 	}
 	return nullptr;
 }
 
+// the process name is resolved once per process
+int sensitiveDetector::processID(const G4VProcess *process)
+{
+	auto indexed = processIDs.find(process);
+	if(indexed != processIDs.end()) return indexed->second;
+
+	int procID = processID(process ? process->GetProcessName() : string("na"));
+	processIDs[process] = procID;
+	return procID;
+}
+
 // to check process name go to $G4ROOT/$GEANT4_VERSION/source/geant$GEANT4_VERSION/source/processes/
 // mgrep "const G4String&" | grep process
-// notice: this map should be written out in the output stream
-int sensitiveDetector::processID(string procName)
+// the names not catalogued here are written in the output process dictionary.
+// Returns 0 for the names not catalogued
+static int cataloguedProcessID(const string &procName)
 {
 	if(procName == "eIoni")                 return 1;
 	if(procName == "compt")                 return 2;
@@ -419,9 +528,25 @@ int sensitiveDetector::processID(string procName)
 	if(procName == "omega-Inelastic")       return 150;
 
 	if(procName == "na")                    return 999;
+
+	return 0;
+}
+
+// names not in the catalog nor in the process table at the run start get an ID at their first step
+int sensitiveDetector::processID(string procName)
+{
+	int procID = cataloguedProcessID(procName);
+	if(procID) return procID;
+
+	lock_guard<mutex> lock(uncataloguedMutex);
+	auto catalogued = uncataloguedIDs.find(procName);
+	if(catalogued != uncataloguedIDs.end()) return catalogued->second;
+
+	procID = firstUncataloguedID + (int) uncataloguedIDs.size();
+	uncataloguedIDs[procName] = procID;
+	uncataloguedNames[procID]  = procName;
+
+	cout << " Process name " << procName << " not in the process table: assigned ID " << procID << ", not in the output process dictionary." << endl;
 	
-	if(verbosity > 0)
-		cout << " Warning: process name " << procName << " not catalogued." << endl;
-	
-	return 999;
+	return procID;
 }
@@ -10,6 +10,7 @@
 #include "G4Step.hh"
 #include "G4HCofThisEvent.hh"
 #include "G4TouchableHistory.hh"
+#include "G4VProcess.hh"
 
 // gemc headers
 #include "sensitiveID.h"
@@ -17,14 +18,34 @@
 #include "Hit.h"
 #include "HitProcess.h"
 #include "backgroundHits.h"
+#include "detectorProfile.h"
 
 // C++ headers
 #include <iostream>
 #include <string>
 #include <set>
+#include <unordered_map>
 using namespace std;
 
 
+/// \class sensitiveVolume
+/// <b> sensitiveVolume </b>\n\n
+/// Volume informations used by ProcessHits at every step,
+/// resolved once when the volume is associated with the sensitive detector:
+/// - detector in the hall map (identity template, dimensions)
+/// - hit type
+/// - hit process routine, resolved at the first step in the volume
+class sensitiveVolume
+{
+public:
+	sensitiveVolume() : volume(nullptr), hitProcess(nullptr) {;}
+
+	const detector *volume;
+	string          hitType;
+	HitProcess     *hitProcess;
+};
+
+
 /// \class sensitiveDetector
 /// <b> sensitiveDetector </b>\n\n
 /// This is the gemc Sensitive Detector.\n
@@ -37,6 +58,7 @@ class sensitiveDetector : public G4VSensitiveDetector
 {
 public:
 	sensitiveDetector(G4String, goptions, string factory, int run, string variation, string system);       ///< Constructor
+	sensitiveDetector(G4String, goptions, sensitiveID);                                                     ///< Constructor from an existing sensitiveID (worker threads)
 	virtual ~sensitiveDetector();
 
 	virtual void Initialize(G4HCofThisEvent*);                   ///< Virtual Method called at the beginning of each hit event
@@ -46,7 +68,7 @@ public:
 	G4String HCname;                                             ///< Sensitive Detector/Hit Collection Name
 	map<string, detector>           *hallMap;                    ///< detector map
 	map<string, HitProcess_Factory> *hitProcessMap;              ///< Hit Process Routine Factory Map
-	set<vector<identifier> >        Id_Set;                      ///< Identifier Set. Used to determine if a step is inside a new/existing element.
+	unordered_map<size_t, vector<MHit*> > hitIndex;              ///< Hits of this event indexed by hitIndexKey. Each bucket holds the hits of one element, in collection order (one per time window).
 
 	goptions    gemcOpt;   ///< gemc option class
 	sensitiveID SDID;      ///< sensitiveID used for identification, hit properties and digitization
@@ -57,7 +79,12 @@ public:
 private:
 	MHitCollection *hitCollection;                               ///< G4THitsCollection<MHit>
 	HitProcess     *ProcessHitRoutine;                           ///< To call PID
+	map<string, HitProcess*> hitProcessRoutines;                 ///< Hit Process Routines, one per hit type, kept for the whole run
+	map<string, sensitiveVolume> sensitiveVolumes;               ///< Volumes associated with this sensitive detector, key is the volume name
+	unordered_map<const G4VPhysicalVolume*, sensitiveVolume*> volumeIndex;  ///< Volumes indexed by the touchable physical volume
 	int             HCID;                                        ///< HCID increases every new hit collection.
+	unordered_map<const G4VProcess*, int> processIDs;            ///< Process IDs by creator process, resolved at the first step
+	unordered_map<const G4ParticleDefinition*, bool> unknownParticles;  ///< true if the particle name contains "unknown"
 
 	string hd_msg1;                ///< New Hit message
 	string hd_msg2;                ///< Normal Message
@@ -70,16 +97,32 @@ private:
 	string ELECTRONICNOISE;        ///< List of detectors for which electronic noise routines will be called
 	int fastMCMode;                ///< In fast MC mode, the particle smeared/unsmeared momenta are saved
 	bool  skipSensitivity;         ///< skip sensitive detector condition
+	bool  profiling;               ///< PROFILE is set: the steps and end of event stages are timed
+
+	void setOptions();             ///< sets the hit collection name and the options above
+
+	sensitiveVolume *findSensitiveVolume(const G4VPhysicalVolume*);  ///< returns the volume record, resolving it at the first step in the volume
 
 public:
-	vector<identifier> GetDetectorIdentifier(string name) {return (*hallMap)[name].identity;} ///< returns detector identity
-	string GetDetectorHitType(string name)                {return (*hallMap)[name].hitType;}  ///< returns detector hitType
+	void addSensitiveVolume(const detector&);                                                  ///< associates the volume with this sensitive detector
 	MHitCollection* GetMHitCollection()                   {if(hitCollection) return hitCollection; else return nullptr;}              ///< returns hit collection
-	MHit* find_existing_hit(vector<identifier>);                                               ///< returns hit collection hit inside identifer
+	MHit* find_existing_hit(const vector<identifier>&);                                        ///< returns hit collection hit inside identifer
+
+	detectorProfile profile;   ///< time spent by this detector in the current event. Filled when profiling is set
 
-	int processID(string procName);   // return an ID from a process name.
+	int processID(const G4VProcess*);   // return the ID of a process, resolving its name once.
+	int processID(string procName);     // return an ID from a process name.
 };
 
+/// process names not in the sensitiveDetector::processID catalog, by ID.
+/// These IDs start at 1000 and are assigned by catalogueProcesses.
+map<int, string> uncataloguedProcesses();
+
+/// assigns the IDs of the process table names not in the catalog, in alphabetical order.
+/// Called once the physics list is built, before the output process dictionary is written:
+/// the IDs do not depend on the order the processes are met in the threads
+void catalogueProcesses();
+
 
 #endif
 
@@ -3,12 +3,16 @@
 
 // gemc
 #include "ActionInitialization.h"
+#include "string_utilities.h"
 
 ActionInitialization::ActionInitialization(goptions* go, map<string, double> *gPars) : G4VUserActionInitialization()
 {
-	genAction = new MPrimaryGeneratorAction(go);
-	evtAction = new MEventAction(*go, *gPars);
-	stpAction = new MSteppingAction(*go);
+	gemcOpt          = go;
+	gParameters      = gPars;
+	outContainer     = nullptr;
+	outputFactoryMap = nullptr;
+	hitProcessMap    = nullptr;
+	banksMap         = nullptr;
 }
 
 
@@ -16,16 +20,52 @@ ActionInitialization::~ActionInitialization()
 {}
 
 
+// the master run action counts the events of each run
+// for the event numbers of the worker threads
 void ActionInitialization::BuildForMaster() const
 {
-	// SetUserAction(new RunAction);
+	SetUserAction(new MRunAction);
 }
 
 
+// the sensitive detectors map is passed to the event action
+// by MDetectorConstruction::ConstructSDandField
 void ActionInitialization::Build() const
 {
+	MPrimaryGeneratorAction *genAction = new MPrimaryGeneratorAction(gemcOpt);
+	MEventAction            *evtAction = new MEventAction(*gemcOpt, *gParameters);
+	MSteppingAction         *stpAction = new MSteppingAction(*gemcOpt);
+
+	evtAction->outContainer     = outContainer;
+	evtAction->outputFactoryMap = outputFactoryMap;
+	evtAction->hitProcessMap    = hitProcessMap;
+	evtAction->banksMap         = banksMap;
+	evtAction->gen_action       = genAction;
+
 	SetUserAction(genAction);
 	SetUserAction(evtAction);
 	SetUserAction(stpAction);
+
+	// optical photons fast simulation: the map is read once and shared by the threads,
+	// each thread has its own optical photons event, deleted by the stacking action
+	string opticalMap            = gemcOpt->optMap["OPTICAL_MAP"].args;
+	string opticalMapCalibration = gemcOpt->optMap["OPTICAL_MAP_CALIBRATION"].args;
+
+	if(opticalMap != "no" || opticalMapCalibration != "no") {
+		bool calibration = opticalMapCalibration != "no";
+
+		vector<string> binning = get_info(gemcOpt->optMap["OPTICAL_MAP_BINNING"].args);
+		if(binning.size() != 3) {
+			cout << "  !!! Error: OPTICAL_MAP_BINNING must have three values: cell size, cos(theta) bins, phi bins. Exiting." << endl;
+			exit(1);
+		}
+		opticalPhotonMap calibrationBinning(get_number(binning[0]), (int) get_number(binning[1]), (int) get_number(binning[2]));
+
+		const opticalPhotonMap *fastMap = calibration ? nullptr : opticalPhotonMap::shared(opticalMap);
+
+		opticalPhotonEvent *opticalPhotons = new opticalPhotonEvent(fastMap, calibration, calibrationBinning);
+		evtAction->opticalPhotons = opticalPhotons;
+		SetUserAction(new MStackingAction(opticalPhotons));
+	}
 }
 
@@ -5,6 +5,8 @@
 #include "MPrimaryGeneratorAction.h"
 #include "MEventAction.h"
 #include "MSteppingAction.h"
+#include "MStackingAction.h"
+#include "MRunAction.h"
 #include "gemcOptions.h"
 
 
@@ -13,6 +15,10 @@
 
 
 /// Action initialization class.
+/// Build() is called once in sequential mode and once per worker thread
+/// in multithreaded mode: each call creates its own generator, event and stepping actions.
+/// The stacking action is created only when the optical photon map is used or calibrated.
+/// The maps below are shared by all threads and must be set before the run manager initialization.
 class ActionInitialization : public G4VUserActionInitialization
 {
 public:
@@ -22,10 +28,12 @@ public:
 	virtual void BuildForMaster() const;
 	virtual void Build() const;
 	
-	
-	MPrimaryGeneratorAction *genAction;
-	MEventAction            *evtAction;
-	MSteppingAction         *stpAction;
+	goptions                           *gemcOpt;
+	map<string, double>                *gParameters;
+	outputContainer                    *outContainer;      ///< outputContainer class - contains the output format.
+	map<string, outputFactoryInMap>    *outputFactoryMap;  ///< outputFactory map
+	map<string, HitProcess_Factory>    *hitProcessMap;     ///< Hit Process Routine Factory Map
+	map<string, gBank>                 *banksMap;          ///< Bank Map
 };
 
 
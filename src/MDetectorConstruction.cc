@@ -16,12 +16,16 @@
 #include "G4NistManager.hh"
 #include "G4LogicalSkinSurface.hh"
 #include "G4LogicalBorderSurface.hh"
+#include "G4TransportationManager.hh"
+#include "G4PropagatorInField.hh"
+#include "G4Threading.hh"
 
 // cadmesh
 #include "CADMesh.hh"
 
 // gemc headers
 #include "MDetectorConstruction.h"
+#include "MEventAction.h"
 
 // mlibrary
 #include "gstring.h"
@@ -29,12 +33,14 @@
 using namespace gstring;
 
 // C++ headers
+#include <chrono>
 #include <sstream>
 
 using namespace std;
 
 MDetectorConstruction::MDetectorConstruction(goptions Opts) {
     gemcOpt = Opts;
+    hitProcessMap = nullptr;
 }
 
 MDetectorConstruction::~MDetectorConstruction() {
@@ -47,6 +53,7 @@ G4VPhysicalVolume *MDetectorConstruction::Construct() {
     double VERB = gemcOpt.optMap["G4P_VERBOSITY"].arg;
     double geo_verb = gemcOpt.optMap["GEO_VERBOSITY"].arg;
     string catch_v = gemcOpt.optMap["CATCH"].args;
+    chrono::steady_clock::time_point constructionStart = chrono::steady_clock::now();
 
     // Clean old geometry, if any
     G4GeometryManager::GetInstance()->OpenGeometry();
@@ -73,21 +80,21 @@ G4VPhysicalVolume *MDetectorConstruction::Construct() {
     // ########################################################################
     if (VERB > 2) cout << hd_msg << " Mapping Physical Detector..." << endl << endl;
 
+    // each volume lineage is resolved once and shared by all its descendants
+    map<const detector *, bool> lineage;
+
     for (map<string, detector>::iterator i = hallMap->begin(); i != hallMap->end(); i++) {
         if (VERB > 3) cout << hd_msg << " Native Scanning Detector " << i->first << " - existance: " << i->second.exist << endl;
 
-        // Find the mother up to "root" - disable kid if ancestor does not exist
-        detector mother = findDetector(i->second.mother);
+        // disable kid if an ancestor up to "root" does not exist
+        const detector &mother = findDetector(i->second.mother);
 
-        while (mother.name != "akasha" && mother.name != "notfound") {
-            if (mother.exist == 0) {
-                if (VERB > 2) {
-                    cout << hd_msg << "\t" << i->second.mother << " is not activated. Its child " << i->second.name
-                         << " will be disactivated as well." << endl;
-                }
-                i->second.exist = 0;
+        if (mother.name != "notfound" && !lineageExists(mother, lineage)) {
+            if (VERB > 2) {
+                cout << hd_msg << "\t" << i->second.mother << " is not activated. Its child " << i->second.name
+                     << " will be disactivated as well." << endl;
             }
-            mother = findDetector(mother.mother);
+            i->second.exist = 0;
         }
         if (i->first != "root") i->second.scanned = 0;
 
@@ -224,9 +231,52 @@ G4VPhysicalVolume *MDetectorConstruction::Construct() {
             cout << dd.second;
     }
 
+    chrono::duration<double> constructionTime = chrono::steady_clock::now() - constructionStart;
+    cout << hd_msg << " Geometry of " << hallMap->size() << " volumes built in " << constructionTime.count() << " seconds." << endl;
+
     return (*hallMap)["root"].GetPhysical();
 }
 
+// In sequential mode the sensitive detectors and field managers are assigned in Construct().
+// Logical volumes are shared among threads but their sensitive detector and field manager are not:
+// each worker thread builds its own copies, using the master sensitiveID to avoid database access.
+void MDetectorConstruction::ConstructSDandField() {
+    map<string, sensitiveDetector *> threadSeDe_Map = SeDe_Map;
+
+    if (G4Threading::IsWorkerThread()) {
+        G4SDManager *SDman = G4SDManager::GetSDMpointer();
+        threadSeDe_Map.clear();
+
+        for (auto &sv: sensitiveVolumes) {
+            string sensi = sv.second;
+            if (threadSeDe_Map.find(sensi) == threadSeDe_Map.end()) {
+                threadSeDe_Map[sensi] = new sensitiveDetector(sensi, gemcOpt, SeDe_Map[sensi]->SDID);
+                threadSeDe_Map[sensi]->hallMap = hallMap;
+                threadSeDe_Map[sensi]->hitProcessMap = hitProcessMap;
+                SDman->AddNewDetector(threadSeDe_Map[sensi]);
+            }
+            (*hallMap)[sv.first].setSensitivity(threadSeDe_Map[sensi]);
+            threadSeDe_Map[sensi]->addSensitiveVolume((*hallMap)[sv.first]);
+        }
+
+        for (auto &fv: fieldVolumes) {
+            (*hallMap)[fv.first].AssignMFM((*fieldsMap)[fv.second].get_MFM());
+        }
+
+        // the transportation manager is thread local
+        double max_step = gemcOpt.optMap["MAX_FIELD_STEP"].arg;
+        if (max_step != 0) {
+            G4TransportationManager::GetTransportationManager()->GetPropagatorInField()->SetLargestAcceptableStep(max_step);
+        }
+    }
+
+    // passing this thread sensitive detectors to this thread event action
+    MEventAction *evtAction = (MEventAction *) G4RunManager::GetRunManager()->GetUserEventAction();
+    if (evtAction != nullptr) {
+        evtAction->SeDe_Map = threadSeDe_Map;
+    }
+}
+
 #include "G4UserLimits.hh"
 
 void MDetectorConstruction::isSensitive(detector detect) {
@@ -256,12 +306,17 @@ void MDetectorConstruction::isSensitive(detector detect) {
             // passing detector infos to access factory, runMin, runMax and variation
             SeDe_Map[sensi] = new sensitiveDetector(sensi, gemcOpt, detect.factory, detect.run, detect.variation, detect.system);
 
-            // Pass Detector Map Pointer to Sensitive Detector
+            // Pass Detector Map and Hit Process Map Pointers to Sensitive Detector
             SeDe_Map[sensi]->hallMap = hallMap;
+            SeDe_Map[sensi]->hitProcessMap = hitProcessMap;
 
             SDman->AddNewDetector(SeDe_Map[sensi]);
         }
         detect.setSensitivity(SeDe_Map[sensi]);
+        sensitiveVolumes[detect.name] = sensi;
+
+        // per volume record used at every step: the hall map entry, not this copy
+        SeDe_Map[sensi]->addSensitiveVolume((*hallMap)[detect.name]);
 
         // Setting Max Acceptable Step for this SD
         detect.SetUserLimits(new G4UserLimits(SeDe_Map[sensi]->SDID.maxStep, SeDe_Map[sensi]->SDID.maxStep));
@@ -340,6 +395,7 @@ void MDetectorConstruction::hasMagfield(detector detect) {
 
         activeFields.insert(magf);
         detect.AssignMFM(itr->second.get_MFM());
+        fieldVolumes[detect.name] = magf;
 
         if ((verbosity > 1 && verbosity != 99) || detect.name.find(catch_v) != string::npos)
             cout << hd_msg << " Field <" << magf << "> is built and assigned to " << detect.name << "." << endl;
@@ -352,20 +408,42 @@ void MDetectorConstruction::updateGeometry() {
     G4RunManager::GetRunManager()->GeometryHasBeenModified();
 }
 
-detector MDetectorConstruction::findDetector(string name) {
+// returns a reference to the map entry: the detector is not copied
+const detector &MDetectorConstruction::findDetector(const string &name) {
     map<string, detector>::iterator it = hallMap->find(name);
     if (it != hallMap->end())
         return it->second;
 
-    detector notfound;
-    notfound.name = "notfound";
+    static const detector notfound = [] {
+        detector nf;
+        nf.name = "notfound";
+        return nf;
+    }();
 
     return notfound;
 }
 
+// a volume exists if its exist flag is set and its mother exists, up to "root".
+// each result is stored so that every mother chain is walked only once
+bool MDetectorConstruction::lineageExists(const detector &det, map<const detector *, bool> &lineage) {
+    map<const detector *, bool>::iterator it = lineage.find(&det);
+    if (it != lineage.end())
+        return it->second;
+
+    bool exists = det.exist != 0;
+    if (exists) {
+        const detector &mother = findDetector(det.mother);
+        if (mother.name != "notfound")
+            exists = lineageExists(mother, lineage);
+    }
+
+    lineage[&det] = exists;
+    return exists;
+}
+
 void MDetectorConstruction::buildDetector(string name) {
-    detector kid = findDetector(name);
-    detector mom = findDetector(kid.mother);
+    const detector &kid = findDetector(name);
+    const detector &mom = findDetector(kid.mother);
 
     if (kid.name != "notfound" || mom.name != "notfound") {
         // handling replicas
@@ -377,7 +455,7 @@ void MDetectorConstruction::buildDetector(string name) {
             string repName;
             ops >> repName;
 
-            detector rep = findDetector(repName);
+            const detector &rep = findDetector(repName);
 
             if (rep.name != "notfound") {
                 // creating the replicas volume
@@ -592,9 +670,10 @@ void MDetectorConstruction::assignProductionCuts(vector <string> volumes) {
     int fastmcMode = gemcOpt.optMap["FASTMCMODE"].arg;
 
     for (unsigned int i = 0; i < volumes.size(); i++) {
+        const detector &regionDet = findDetector(volumes[i]);
+
         // looking in the sensitive detector map for the SD with matching system
         for (map<string, sensitiveDetector *>::iterator itr = SeDe_Map.begin(); itr != SeDe_Map.end(); itr++) {
-            detector regionDet = findDetector(volumes[i]);
 
             if (regionDet.system == itr->second->SDID.system) {
 
@@ -654,7 +733,7 @@ void MDetectorConstruction::assignProductionCuts(vector <string> volumes) {
 
         // the last element is the actual volume cut
         for (unsigned v = 0; v < volsProdCuts.size() - 1; v++) {
-            detector volumeWithCut = findDetector(volsProdCuts[v]);
+            const detector &volumeWithCut = findDetector(volsProdCuts[v]);
             if (volumeWithCut.name != "notfound" && volumeWithCut.GetLogical() != nullptr) {
                 volumesForThisRegion += volumeWithCut.name + " ";
                 SeRe_Map[regionName]->AddRootLogicalVolume(volumeWithCut.GetLogical());
@@ -693,8 +772,9 @@ void MDetectorConstruction::scanDetectors(int VERB, string catch_v) {
         if (i->first != "root") relatives.push_back(i->second.name);
 
         while (relatives.size() > 0) {
-            detector kid = findDetector(relatives.back());
-            detector mom = findDetector(kid.mother);
+            const detector &kid = findDetector(relatives.back());
+            const detector &mom = findDetector(kid.mother);
+            int kidScanned = kid.scanned;
             // cout << kid.name << " " << kid.mother <<  " " << kid.scanned << " " << mom.scanned << " " << mom.factory << " mom system: " << mom.system << endl;
 
             // production cut affects all volumes in a system rather than just the sensitive volumes
@@ -720,7 +800,7 @@ void MDetectorConstruction::scanDetectors(int VERB, string catch_v) {
             }
 
             // Mom is built, kid not built yet.
-            if (kid.scanned == 0 && mom.scanned == 1) {
+            if (kidScanned == 0 && mom.scanned == 1) {
                 if (VERB > 3 || kid.name.find(catch_v) != string::npos) {
                     for (unsigned int ir = 0; ir < relatives.size() - 1; ir++) cout << "\t";
                     cout << hd_msg << "  Found:  " << kid.name
@@ -737,7 +817,7 @@ void MDetectorConstruction::scanDetectors(int VERB, string catch_v) {
                     string original;
                     ops >> original;
 
-                    detector dorig = findDetector(original);
+                    const detector &dorig = findDetector(original);
                     // if dependency is not built yet, then
                     // add it to the relative list
                     if (dorig.scanned == 0) {
@@ -758,7 +838,7 @@ void MDetectorConstruction::scanDetectors(int VERB, string catch_v) {
                         // otherwise can build the kid
                     else {
                         buildDetector(kid.name);
-                        kid.scanned = 1;
+                        kidScanned = 1;
                     }
                 } else if (kid.type.find("ReplicaOf:") == 0) // Check kid dependency on replicas
                 {
@@ -768,7 +848,7 @@ void MDetectorConstruction::scanDetectors(int VERB, string catch_v) {
                     string original;
                     ops >> original;
 
-                    detector dorig = findDetector(original);
+                    const detector &dorig = findDetector(original);
                     // if dependency is not built yet, then
                     // add it to the relative list
                     if (dorig.scanned == 0) {
@@ -783,7 +863,7 @@ void MDetectorConstruction::scanDetectors(int VERB, string catch_v) {
                         // otherwise can build the kid
                     else {
                         buildDetector(kid.name);
-                        kid.scanned = 1;
+                        kidScanned = 1;
                     }
                 } else if (kid.type.find("Operation:") == 0)  // Check kid dependency on operations
                 {
@@ -797,7 +877,7 @@ void MDetectorConstruction::scanDetectors(int VERB, string catch_v) {
 
                     // if dependency is not built yet, then
                     // add it to the relative list
-                    detector dsecondop = findDetector(secondop);
+                    const detector &dsecondop = findDetector(secondop);
                     if (dsecondop.scanned == 0) {
                         relatives.push_back(secondop);
                         if (VERB > 3 || kid.name.find(catch_v) != string::npos) {
@@ -806,7 +886,7 @@ void MDetectorConstruction::scanDetectors(int VERB, string catch_v) {
                                  << " Must build: " << secondop << " first " << endl;
                         }
                     }
-                    detector dfirstop = findDetector(firstop);
+                    const detector &dfirstop = findDetector(firstop);
                     if (dfirstop.scanned == 0) {
                         relatives.push_back(firstop);
                         if (VERB > 3 || kid.name.find(catch_v) != string::npos) {
@@ -818,19 +898,19 @@ void MDetectorConstruction::scanDetectors(int VERB, string catch_v) {
                         // otherwise can build the kid
                     else if (dsecondop.scanned == 1 && dfirstop.scanned == 1) {
                         buildDetector(kid.name);
-                        kid.scanned = 1;
+                        kidScanned = 1;
                     }
                 }
                     // no dependencies found, build the kid
                 else {
                     buildDetector(kid.name);
-                    kid.scanned = 1;
+                    kidScanned = 1;
                 }
             }
 
                 // if the kid still doesn't exists and its mom doesn't exist.
                 // adding mom to the relatives list
-            else if (kid.scanned == 0 && mom.scanned == 0) {
+            else if (kidScanned == 0 && mom.scanned == 0) {
                 if (mom.factory == "TEXT" || mom.factory == "SQLITE") {
                     // we can still build this unless the mother is inside remainingNative
                     if (find(remainingNative.begin(), remainingNative.end(), kid.mother) == remainingNative.end()) {
@@ -849,7 +929,7 @@ void MDetectorConstruction::scanDetectors(int VERB, string catch_v) {
             }
 
             // the kid has been built. Can go down one step in geneaology
-            if (kid.scanned == 1) {
+            if (kidScanned == 1) {
                 if (VERB > 3 || kid.name.find(catch_v) != string::npos)
                     cout << hd_msg << " " << kid.name << " is built." << endl << endl;
 
@@ -896,8 +976,9 @@ void MDetectorConstruction::scanCadDetectors(int VERB, string catch_v) {
         if (thisDetName != "root") relatives.push_back(dd.second.name);
 
         while (relatives.size() > 0) {
-            detector kid = findDetector(relatives.back());
-            detector mom = findDetector(kid.mother);
+            const detector &kid = findDetector(relatives.back());
+            const detector &mom = findDetector(kid.mother);
+            int kidScanned = kid.scanned;
             // cout << kid.name << " " << kid.mother <<  " " << kid.scanned << " " << mom.scanned << " " << mom.factory << endl;
 
             // Mom doesn't exists in the hallMap. Stopping everything.
@@ -908,12 +989,12 @@ void MDetectorConstruction::scanCadDetectors(int VERB, string catch_v) {
             }
 
             // Mom is built, kid not built yet. Build kid
-            if (kid.scanned == 0 && mom.scanned == 1) {
+            if (kidScanned == 0 && mom.scanned == 1) {
                 string filename = dd.second.variation;
                 buildCADDetector(thisDetName, filename, VERB);
-                kid.scanned = 1;
+                kidScanned = 1;
 
-            } else if (kid.scanned == 0 && mom.scanned == 0) {
+            } else if (kidScanned == 0 && mom.scanned == 0) {
                 if (mom.factory == "CAD") {
                     // we can still build this unless the mother is inside remainingCad
                     if (find(remainingCad.begin(), remainingCad.end(), kid.mother) == remainingCad.end()) {
@@ -930,7 +1011,7 @@ void MDetectorConstruction::scanCadDetectors(int VERB, string catch_v) {
                     relatives.pop_back();
                 }
                 // the kid has been built. Can go down one step in geneaology
-            } else if (kid.scanned == 1 && relatives.size()) {
+            } else if (kidScanned == 1 && relatives.size()) {
 
                 if (VERB > 3 || kid.name.find(catch_v) != string::npos) { cout << hd_msg << " " << kid.name << " is built." << endl << endl; }
 
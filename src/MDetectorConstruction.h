@@ -43,6 +43,7 @@ public:
 	map<string, sensitiveDetector*>  SeDe_Map;
 	map<string, detector>           *hallMap;
 	map<string, gfield>             *fieldsMap;
+	map<string, HitProcess_Factory> *hitProcessMap;
 	map<string, G4Region*>           SeRe_Map;
 	map<string, G4ProductionCuts*>   SePC_Map;
 	set<string>                      activeFields;
@@ -50,7 +51,8 @@ public:
 	
 	
 private:		
-	detector findDetector(string);   // returns map detector
+	const detector &findDetector(const string &name);   // returns map detector, or a detector named "notfound"
+	bool lineageExists(const detector &det, map<const detector*, bool> &lineage);   // det and all its ancestors exist
 	void buildDetector(string);      // build detector
 	void buildCADDetector(string, string, int);   // build CAD detector
 	
@@ -64,6 +66,11 @@ private:
 	
 	vector<string> regions;  // all volumes for which mom is "root"
 
+	// volume name > sensitive detector / field name
+	// used to assign the thread-local sensitive detectors and field managers of the worker threads
+	map<string, string> sensitiveVolumes;
+	map<string, string> fieldVolumes;
+
 
 
 	
@@ -75,6 +82,7 @@ public:
 	void assignRegions();
 	void updateGeometry();
 	G4VPhysicalVolume* Construct();
+	void ConstructSDandField();
 	
 };
 
@@ -3,16 +3,24 @@
 #include "G4RunManager.hh"
 #include "G4Trajectory.hh"
 #include "G4UImanager.hh"
+#include "G4AutoLock.hh"
+#include "G4Poisson.hh"
 
 // gemc headers
 #include "MEventAction.h"
 #include "Hit.h"
+#include "MRunAction.h"
 
 // mlibrary
 #include "frequencySyncSignal.h"
 
 // c++
+#include <algorithm>
+#include <chrono>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 using namespace std;
 
 // CLHEP units
@@ -23,8 +31,24 @@ using namespace CLHEP;
 #include <CCDB/Calibration.h>
 #include <CCDB/Model/Assignment.h>
 #include <CCDB/CalibrationGenerator.h>
+#include "ccdbCache.h"
 using namespace ccdb;
 
+// in multithreaded mode the output streams, the output factories static data and
+// the CCDB connections are shared: worker threads access them one at a time
+namespace {
+	G4Mutex eventOutputMutex = G4MUTEX_INITIALIZER;
+
+	// the background hits file is loaded by the first event action and shared.
+	// Deleted at exit, after all the event actions
+	G4Mutex backgroundHitsMutex = G4MUTEX_INITIALIZER;
+	unique_ptr<GBackgroundHits> sharedBackgroundHits;
+
+	// static initialization happens at program start: reference for the time to first event
+	const chrono::steady_clock::time_point programStart = chrono::steady_clock::now();
+	once_flag firstEventFlag;
+}
+
 // return original track id of a vector of tid
 vector<int> MEventAction::vector_otids(vector<int> tids)
 {
@@ -59,29 +83,39 @@ vector<G4ThreeVector> vector_zthre(int size)
 	return zthre;
 }
 
-vector<int> vector_mtids(map<int, TInfos> tinfos, vector<int> tids)
+// the pileup tracks, with negative IDs, are not in the event tracks infos: their mother infos are zero
+vector<int> vector_mtids(map<int, TInfos> &tinfos, const vector<int> &tids)
 {
 	vector<int> mtids;
 	for(unsigned int t=0; t<tids.size(); t++)
-		mtids.push_back(tinfos[tids[t]].mtid);
+	{
+		auto tinfo = tinfos.find(tids[t]);
+		mtids.push_back(tinfo != tinfos.end() ? tinfo->second.mtid : 0);
+	}
 	
 	return mtids;
 }
 
-vector<int> vector_mpids(map<int, TInfos> tinfos, vector<int> tids)
+vector<int> vector_mpids(map<int, TInfos> &tinfos, const vector<int> &tids)
 {
 	vector<int> mpids;
 	for(unsigned int t=0; t<tids.size(); t++)
-		mpids.push_back(tinfos[tids[t]].mpid);
+	{
+		auto tinfo = tinfos.find(tids[t]);
+		mpids.push_back(tinfo != tinfos.end() ? tinfo->second.mpid : 0);
+	}
 	
 	return mpids;
 }
 
-vector<G4ThreeVector> vector_mvert(map<int, TInfos> tinfos, vector<int> tids)
+vector<G4ThreeVector> vector_mvert(map<int, TInfos> &tinfos, const vector<int> &tids)
 {
 	vector<G4ThreeVector> mvert;
 	for(unsigned int t=0; t<tids.size(); t++)
-		mvert.push_back(tinfos[tids[t]].mv);
+	{
+		auto tinfo = tinfos.find(tids[t]);
+		mvert.push_back(tinfo != tinfos.end() ? tinfo->second.mv : G4ThreeVector(0, 0, 0));
+	}
 	
 	return mvert;
 }
@@ -96,6 +130,7 @@ MEventAction::MEventAction(goptions opts, map<string, double> gpars)
 	SAVE_ALL_MOTHERS = (int) gemcOpt.optMap["SAVE_ALL_MOTHERS"].arg ;
 	SAVE_ALL_ANCESTORS = (int) gemcOpt.optMap["SAVE_ALL_ANCESTORS"].arg ;
 	gPars            = gpars;
+	processOutputFactory = nullptr;
 	MAXP             = (int) gemcOpt.optMap["NGENP"].arg;
 	FILTER_HITS      = (int) gemcOpt.optMap["FILTER_HITS"].arg;
 	FILTER_HADRONS   = (int) gemcOpt.optMap["FILTER_HADRONS"].arg;
@@ -134,18 +169,46 @@ MEventAction::MEventAction(goptions opts, map<string, double> gpars)
 		cout << " > Opening background.dat file to save background particles in LUND format." << endl;
 	}
 	
-	evtN = gemcOpt.optMap["EVTN"].arg;
+	evtN  = gemcOpt.optMap["EVTN"].arg;
+	evtN0 = evtN;
 	
+	opticalPhotons = nullptr;
+
 	// background hits
 	backgroundHits = nullptr;
 	BGFILE = gemcOpt.optMap["MERGE_BGHITS"].args;
 	
 	// there's no check that the map is built correctly
 	if(BGFILE != "no") {
-		backgroundHits = new GBackgroundHits(BGFILE, requestedNevents, VERB);
+		G4AutoLock lock(&backgroundHitsMutex);
+		if(sharedBackgroundHits == nullptr) {
+			sharedBackgroundHits.reset(new GBackgroundHits(BGFILE, requestedNevents, VERB));
+		}
+		backgroundHits = sharedBackgroundHits.get();
+	}
+
+	// pileup library: written by luminosity only jobs, overlaid to signal jobs.
+	// The overlaid bunches fill the LUMI_EVENT time window, one every bunch time
+	PILEUP_OUTPUT = gemcOpt.optMap["PILEUP_LIBRARY_OUTPUT"].args;
+	pileup = nullptr;
+	pileupBunches = 0;
+	pileupBunchTime = 0;
+	if(gemcOpt.optMap["PILEUP_LIBRARY"].args != "no") {
+		vector<string> pvalues = get_info(gemcOpt.optMap["PILEUP_LIBRARY"].args, string(",\""));
+		vector<string> lvalues = get_info(gemcOpt.optMap["LUMI_EVENT"].args);
+		pileupBunchTime = get_number(lvalues[2]);
+		if(pvalues.size() > 1) {
+			pileupBunches = (int) get_number(pvalues[1]);
+		} else if(pileupBunchTime > 0) {
+			pileupBunches = (int) floor(get_number(lvalues[1]) / pileupBunchTime);
+		}
+		pileup = pileupLibrary::shared(trimSpacesFromString(pvalues[0]));
+		cout << hd_msg << " Pileup library: " << pileupBunches << " bunches overlaid to each event, every " << pileupBunchTime/ns << " ns." << endl;
 	}
 	
-	backgroundEventNumber.clear();
+	PROFILE = (int) gemcOpt.optMap["PROFILE"].arg;
+	eventStartWall = 0;
+	eventStartCpu  = 0;
 	
 	// SAVE_SELECTED parameters
 	string arg = gemcOpt.optMap["SAVE_SELECTED"].args;
@@ -180,6 +243,7 @@ MEventAction::MEventAction(goptions opts, map<string, double> gpars)
 	
 	
 	if(RFSETUP == "clas12_ccdb") {
+		G4AutoLock lock(&eventOutputMutex);
 		setup_clas12_RF(rw.getRunNumber(evtN));
 
 	} else if(RFSETUP != "no")  {
@@ -193,10 +257,74 @@ MEventAction::~MEventAction()
 {
 	if(SAVE_ALL_MOTHERS>1)
 		lundOutput->close();
+
+	for(auto &hpr: hitProcessRoutines)
+		delete hpr.second;
+
+	if(processOutputFactory)
+		delete processOutputFactory;
+}
+
+map<string, detectorProfile> MEventAction::eventProfiles()
+{
+	map<string, detectorProfile> profiles;
+	for(auto &sd: SeDe_Map) {
+		profiles[sd.first] = sd.second->profile;
+	}
+	profiles["event"] = eventProfile;
+	
+	return profiles;
+}
+
+void MEventAction::collectProfiles()
+{
+	detectorProfile::addToRun(eventProfiles());
+	
+	for(auto &sd: SeDe_Map) {
+		sd.second->profile.clear();
+	}
+	eventProfile.clear();
+}
+
+// the hit process routines are instantiated once per hit type.
+// init and initWithRunNumber copy the options and load the constants:
+// they are only called again when the run number changes.
+// The database access is serialized, the digitization is not
+HitProcess* MEventAction::getHitProcessRoutine(string hitType)
+{
+	auto hpr = hitProcessRoutines.find(hitType);
+	if(hpr == hitProcessRoutines.end()) {
+		hpr = hitProcessRoutines.insert(make_pair(hitType, getHitProcess(hitProcessMap, hitType))).first;
+	}
+
+	HitProcess *hitProcessRoutine = hpr->second;
+	if(!hitProcessRoutine)
+		return nullptr;
+
+	auto runno = hitProcessRunNo.find(hitType);
+	if(runno == hitProcessRunNo.end() || runno->second != rw.runNo) {
+		if(fastMCMode == 0 || fastMCMode > 9) {
+			G4AutoLock lock(&eventOutputMutex);
+			hitProcessRoutine->init(hitType, gemcOpt, gPars);
+			if(WRITE_INTDGT.find(hitType) == string::npos)
+				hitProcessRoutine->initWithRunNumber(rw.runNo);
+		}
+		hitProcessRunNo[hitType] = rw.runNo;
+	}
+
+	// the hit conditions were reset with each new instance
+	hitProcessRoutine->resetHitConditions();
+
+	return hitProcessRoutine;
 }
 
 void MEventAction::BeginOfEventAction(const G4Event* evt)
 {
+	if(PROFILE) {
+		eventStartWall = profileTimer::wallTime();
+		eventStartCpu  = profileTimer::cpuTime();
+	}
+	
 	G4RunManager *runManager = G4RunManager::GetRunManager();;
 	if(gen_action->isFileOpen() == false) {
 		runManager->AbortRun();
@@ -210,10 +338,21 @@ void MEventAction::BeginOfEventAction(const G4Event* evt)
 	if (pga->isRerun())
 		evtN = pga->rerunEvent();
 	
+	// worker threads process events out of order: the event number follows the G4 event ID,
+	// counted from the events of the previous runs
+	if (G4Threading::IsWorkerThread())
+		evtN = evtN0 + MRunAction::eventOffset() + evt->GetEventID();
+	
+	call_once(firstEventFlag, [] {
+		chrono::duration<double> startup = chrono::steady_clock::now() - programStart;
+		cout << "  > Time to first event: " << startup.count() << " seconds." << endl;
+	});
+
 	rw.getRunNumber(evtN);
 	bgMap.clear();
+	if(opticalPhotons != nullptr) opticalPhotons->clear();
 		
-	static int lastEvtN = -1;
+	static thread_local int lastEvtN = -1;
 	if(evtN > lastEvtN && evtN%Modulo == 0 ) {
 		cout << hd_msg << " Begin of event " << evtN << "  Run Number: " << rw.runNo;
 		if(rw.isNewRun) {
@@ -233,9 +372,9 @@ void MEventAction::BeginOfEventAction(const G4Event* evt)
 	if(VERB > 4) {
 		if(backgroundHits != nullptr) {
 			for(auto sDet: SeDe_Map) {
-				map<int, vector<BackgroundHit*> > *backgroundHitsEventMap = backgroundHits->getBackgroundForSystem(sDet.first);
+				const map<int, vector<BackgroundHit*> > *backgroundHitsEventMap = backgroundHits->getBackgroundForSystem(sDet.first);
 				if(backgroundHitsEventMap != nullptr) {
-					for(auto bgHits: (*backgroundHitsEventMap)) {
+					for(auto &bgHits: (*backgroundHitsEventMap)) {
 						if(bgHits.first == evtN) {
 							cout << " >>> Background hits for detector " << sDet.first << ", event number: " << bgHits.first <<  endl;
 							for(auto bgh: bgHits.second) {
@@ -253,6 +392,17 @@ void MEventAction::BeginOfEventAction(const G4Event* evt)
 
 void MEventAction::EndOfEventAction(const G4Event* evt)
 {
+	// the time spent in this routine is added to the run profile at any return
+	struct profileCollector {
+		MEventAction *action;
+		~profileCollector() { if(action->PROFILE) action->collectProfiles(); }
+	} collector = {this};
+	
+	if(PROFILE) {
+		eventProfile.wall[PROFILE_TRACKING] += profileTimer::wallTime() - eventStartWall;
+		eventProfile.cpu[PROFILE_TRACKING]  += profileTimer::cpuTime()  - eventStartCpu;
+	}
+	profileTimer eventTimer(PROFILE ? &eventProfile : nullptr, PROFILE_NSTAGES);
 
 	if ((gen_action->isFileOpen() == false) ||
 		 (gen_action->doneRerun() == true))
@@ -268,6 +418,12 @@ void MEventAction::EndOfEventAction(const G4Event* evt)
 	MHitCollection* MHC;
 	int nhits;
 	
+	if(opticalPhotons != nullptr) processOpticalPhotons();
+	
+	// pileup library job: all events are written, with or without hits
+	if(PILEUP_OUTPUT != "no") {
+		pileupLibrary::writeBunch(PILEUP_OUTPUT, SeDe_Map);
+	}
 	
 	// if FILTER_HITS is set, checking if there are any hits
 	if(FILTER_HITS) {
@@ -377,7 +533,10 @@ void MEventAction::EndOfEventAction(const G4Event* evt)
 	// the container is full only if /tracking/storeTrajectory 2
 	G4TrajectoryContainer *trajectoryContainer = nullptr;
 	
-	set<int> track_db2 = track_db;
+	// trajectories indexed by track ID, built once from the container.
+	// track IDs are unique in an event
+	unordered_map<int, G4Trajectory*> trajectories;
+
 	if(SAVE_ALL_MOTHERS) {
 		trajectoryContainer = evt->GetTrajectoryContainer();
 		momDaughter.clear();
@@ -386,57 +545,65 @@ void MEventAction::EndOfEventAction(const G4Event* evt)
 			cout << " >> Total number of tracks " << trajectoryContainer->size() << endl;
 		}
 		
-		while(trajectoryContainer && track_db.size()) {
+		if(trajectoryContainer) {
+			trajectories.reserve(trajectoryContainer->size());
+			
 			// looping over all tracks
 			for(unsigned int i=0; i< trajectoryContainer->size(); i++)
 			{
-				// cout << " index track " << i << endl;
-				G4Trajectory* trj = (G4Trajectory*)(*(evt->GetTrajectoryContainer()))[i];
+				G4Trajectory* trj = (G4Trajectory*)(*trajectoryContainer)[i];
 				int tid = trj->GetTrackID();
 				
 				// adding track in mom daughter relationship
 				// for all tracks
-				if(momDaughter.find(tid) == momDaughter.end())
+				if(trajectories.emplace(tid, trj).second)
 					momDaughter[tid] = trj->GetParentID();
-				
-				// is this track involved in a hit?
-				// if yes, add it to the track map db
-				it = track_db.find(tid);
-				if(it != track_db.end())
-				{
-					int           mtid = trj->GetParentID();
-					tinfos[tid]        = TInfos(mtid);
-					// cout << " At map level: " << tid << " " <<mtid << " " << pid << "   charge: " << q << endl;
-					// remove the track from the database so we don't have to loop over it next time
-					track_db.erase(it);
-				}
 			}
 		}
 		
-		// building the hierarchy map
-		// for all secondary tracks
+		// tracks involved in a hit
+		for(auto tid: track_db) {
+			auto trj = trajectories.find(tid);
+			if(trj != trajectories.end()) {
+				tinfos[tid] = TInfos(trj->second->GetParentID());
+			}
+		}
+		
+		// building the hierarchy map: each track points to its primary,
+		// or to the first ancestor without a trajectory.
+		// Each chain is walked once: the tracks met are resolved with it
+		unordered_map<int, int> primaries;
 		for(map<int, int>::iterator itm = momDaughter.begin(); itm != momDaughter.end(); itm++) {
+			vector<int> chain;
 			int ancestor = itm->first;
-			if(momDaughter[ancestor] == 0)
-				hierarchy[itm->first] = itm->first;
-			
-			while (momDaughter[ancestor] != 0) {
-				hierarchy[itm->first] = momDaughter[ancestor];
-				ancestor = momDaughter[ancestor];
+			int primary;
+			while(true) {
+				auto resolved = primaries.find(ancestor);
+				if(resolved != primaries.end()) {
+					primary = resolved->second;
+					break;
+				}
+				chain.push_back(ancestor);
+				auto mom = momDaughter.find(ancestor);
+				if(mom == momDaughter.end() || mom->second == 0) {
+					primary = ancestor;
+					break;
+				}
+				ancestor = mom->second;
+			}
+			for(auto tid: chain) {
+				primaries[tid] = primary;
 			}
+			hierarchy[itm->first] = primary;
 		}
 		
 		// now accessing the mother particle infos
 		for(map<int, TInfos>::iterator itm = tinfos.begin(); itm != tinfos.end(); itm++) {
 			int mtid = (*itm).second.mtid;
-			// looking for mtid infos in the trajectoryContainer
-			for(unsigned int i=0; i< trajectoryContainer->size() && mtid != 0; i++) {
-				G4Trajectory* trj = (G4Trajectory*)(*(evt->GetTrajectoryContainer()))[i];
-				int tid = trj->GetTrackID();
-				if(tid == mtid) {
-					tinfos[(*itm).first].mpid   = trj->GetPDGEncoding();
-					tinfos[(*itm).first].mv     = trj->GetPoint(0)->GetPosition();
-				}
+			auto trj = trajectories.find(mtid);
+			if(mtid != 0 && trj != trajectories.end()) {
+				(*itm).second.mpid = trj->second->GetPDGEncoding();
+				(*itm).second.mv   = trj->second->GetPoint(0)->GetPosition();
 			}
 		}
 		
@@ -484,7 +651,11 @@ void MEventAction::EndOfEventAction(const G4Event* evt)
 		evtN++;
 		return;
 	}
-	outputFactory *processOutputFactory = getOutputFactory(outputFactoryMap, outContainer->outType);
+
+	// the output factory is kept for the whole run so that its buffers are reused
+	if(processOutputFactory == nullptr) {
+		processOutputFactory = getOutputFactory(outputFactoryMap, outContainer->outType);
+	}
 
 	// configuration contains:
 	// number of hits in the hit collection for each sensitive detector
@@ -503,9 +674,6 @@ void MEventAction::EndOfEventAction(const G4Event* evt)
 		}
 	}
 
-
-	processOutputFactory->prepareEvent(outContainer, &configuration);
-	
 	// Header Bank contains event number
 	// Need to change this to read DB header bank
 	map<string, double> header;
@@ -514,9 +682,6 @@ void MEventAction::EndOfEventAction(const G4Event* evt)
 	header["evn_type"] = -1;  // physics event. Negative is MonteCarlo event
 	header["beamPol"]  = gen_action->getBeamPol();
 	
-	// write event header bank
-	processOutputFactory->writeHeader(outContainer, header, getBankFromMap("header", banksMap));
-	
 	// user header should be in a different tag than the normal header
 	// for now, we're ok
 	// assuming 100 user vars max
@@ -531,12 +696,11 @@ void MEventAction::EndOfEventAction(const G4Event* evt)
 		userHeader[tmp] = gen_action->headerUserDefined[i];
 	}
 	
-	// write event header bank
-	processOutputFactory->writeUserInfoseHeader(outContainer, userHeader);
-	
-	// write RF bank if present
+	// RF bank parameters, the bank is written with the event
 	// do not write in FASTMC mode
-	if(RFSETUP!= "no" && fastMCMode == 0) {
+	bool WRITE_RF = RFSETUP!= "no" && fastMCMode == 0;
+	string rfsetup_string;
+	if(WRITE_RF) {
 		
 		double additionalTime = 0;
 		
@@ -565,27 +729,24 @@ void MEventAction::EndOfEventAction(const G4Event* evt)
         }
 
 		// getting time window
-		string rfsetup_string = to_string(g4rseed) + " " + to_string(gen_action->getTimeWindow()) + " " ;
+		rfsetup_string = to_string(g4rseed) + " " + to_string(gen_action->getTimeWindow()) + " " ;
 		
 		// getting start time of the event
 		rfsetup_string += to_string(gen_action->getStartTime() + additionalTime) + " " ;
 		
+		// the RF constants are read from CCDB when the run number changes
 		if(RFSETUP == "clas12_ccdb"){
+			G4AutoLock lock(&eventOutputMutex);
 			setup_clas12_RF(rw.runNo);
 		}
 
 		for(unsigned i=0; i<rfvalue_strings.size(); i++) {
 			rfsetup_string += rfvalue_strings[i] + " " ;
 		}
-		
-		FrequencySyncSignal rfs(rfsetup_string);
-		processOutputFactory->writeRFSignal(outContainer, rfs, getBankFromMap("rf", banksMap));
-		
-		if(VERB > 1) {
-			cout << rfs << endl;
-		}
 	}
 	
+	eventTimer.next(PROFILE_NSTAGES);
+	
 	// Getting Generated Particles info
 	// Are these loops necessary, revisit later1
 	vector<generatedParticle> MPrimaries;
@@ -626,15 +787,35 @@ void MEventAction::EndOfEventAction(const G4Event* evt)
 	
 	map<int, vector<hitOutput> > hit_outputs_from_AllSD;
 	
+	// the digitized outputs of each detector are kept by this thread
+	// and written under the output lock once the whole event is processed
+	struct detectorOutput {
+		string hitType;
+		sensitiveDetector *sd;
+		bool writeDgt, writeRawIntegrated, writeRawAll, writeVT;
+		vector<hitOutput> dgt, raw, vt;
+	};
+	vector<detectorOutput> detectorOutputs;
+	
+	// pileup bunches overlaid to this event: the same bunches for all the detectors
+	vector<unsigned> eventBunches;
+	if(pileup != nullptr) {
+		for(int b=0; b<pileupBunches; b++) {
+			eventBunches.push_back((unsigned) (G4UniformRand()*pileup->size()) % pileup->size());
+		}
+	}
+	
 	// loop over sensitive detectors
 	// if there are hits, process them and/or write true infos out
 	for(map<string, sensitiveDetector*>::iterator it = SeDe_Map.begin(); it!= SeDe_Map.end(); it++) {
 
+		profileTimer sdTimer(PROFILE ? &it->second->profile : nullptr, PROFILE_MERGE);
+		
 		MHC = it->second->GetMHitCollection();
 		
 		// adding background if existing
 		// adding background noise to hits
-		vector<BackgroundHit*> currentBackground = getNextBackgroundEvent(it->first);
+		const vector<BackgroundHit*> &currentBackground = getNextBackgroundEvent(it->first);
 		for(auto bgh: currentBackground) {
 			if(bgh != nullptr) {
 				if(MHC)
@@ -642,9 +823,19 @@ void MEventAction::EndOfEventAction(const G4Event* evt)
 			}
 		}
 		
+		// adding the pileup hits, shifted to their bunch time
+		if(MHC) {
+			for(unsigned b=0; b<eventBunches.size(); b++) {
+				pileup->overlay(eventBunches[b], b, b*pileupBunchTime, it->first, it->second, MHC);
+			}
+		}
+		
 		if (MHC) nhits = MHC->GetSize();
 		else nhits = 0;
 		
+		it->second->profile.hits += nhits;
+		sdTimer.next(PROFILE_RAW);
+		
 		// The same ProcessHit Routine must apply to all the hits  in this HitCollection.
 		// Instantiating the ProcessHitRoutine only once for the first hit.
 		// this conditions applies to digitization and true information processing
@@ -652,13 +843,9 @@ void MEventAction::EndOfEventAction(const G4Event* evt)
 
 			string hitType = it->first;
 			
-			HitProcess *hitProcessRoutine = getHitProcess(hitProcessMap, hitType);
+			HitProcess *hitProcessRoutine = getHitProcessRoutine(hitType);
 			if(!hitProcessRoutine)
 				return;
-			
-			if(fastMCMode == 0 || fastMCMode > 9) {
-				hitProcessRoutine->init(hitType, gemcOpt, gPars);
-			}
 
 			// geant4 integrated digitized information
 			// by default they are all ENABLED
@@ -666,6 +853,7 @@ void MEventAction::EndOfEventAction(const G4Event* evt)
 			// using the INTEGRATEDDGT option
 			// for FASTMC mode, do not digitize the info
 			vector<hitOutput> allDgtOutput;
+			bool WRITE_DGT_INTEGRATED = WRITE_INTDGT.find(hitType) == string::npos && (fastMCMode == 0 ||fastMCMode > 9);
 
 			// the digitization routine may decide to skip writing events.
 			// keeping the hit number in a vector so we can skip the event writing for the true information as well
@@ -683,6 +871,9 @@ void MEventAction::EndOfEventAction(const G4Event* evt)
 			for(int h=0; h<nhits; h++) {
 				MHit* aHit = (*MHC)[h];
 
+				// the pileup hits mother infos are set when they are overlaid
+				if(aHit->isPileupHit == 1) continue;
+
 				// mother particle infos
 				if(SAVE_ALL_MOTHERS) {
 
@@ -707,8 +898,8 @@ void MEventAction::EndOfEventAction(const G4Event* evt)
 
 					// all these vector have the same length.
 					for(unsigned pi = 0; pi<MPrimaries.size(); pi++) {
-						vector<double> edeps = aHit->GetEdep();
-						vector<double> times = aHit->GetTime();
+						const vector<double>& edeps = aHit->GetEdep();
+						const vector<double>& times = aHit->GetTime();
 						MPrimaries[pi].pSum.back().nphe = aHit->GetTIds().size();
 						if(fastMCMode > 0) {
 							MPrimaries[pi].fastMC.back().pOrig  = aHit->GetMom();
@@ -742,9 +933,12 @@ void MEventAction::EndOfEventAction(const G4Event* evt)
 				}
 			}
 
-			if(WRITE_INTDGT.find(hitType) == string::npos && (fastMCMode == 0 ||fastMCMode > 9)) {
+			if(WRITE_DGT_INTEGRATED) {
 
-				hitProcessRoutine->initWithRunNumber(rw.runNo);
+				sdTimer.next(PROFILE_DGT);
+				
+				// the digitized values are stored in the detector bank column slots
+				const gBank &hitBank = getBankFromMap(hitType, banksMap);
 				
 				for(int h=0; h<nhits; h++) {
 
@@ -752,7 +946,7 @@ void MEventAction::EndOfEventAction(const G4Event* evt)
 					MHit* aHit = (*MHC)[h];
 					
 					// calling integrateDgt will also set writeHit
-					thisHitOutput.setDgtz(hitProcessRoutine->integrateDgt(aHit, h+1));
+					thisHitOutput.setDgtz(hitBank.compile(hitProcessRoutine->integrateDgt(aHit, h+1)));
 					
 					// include this hit. Users can set writeHit to false to avoid writing the hit
 					// the hitProcessRoutine variable detectorThreshold could be used in integrateDgt
@@ -775,10 +969,11 @@ void MEventAction::EndOfEventAction(const G4Event* evt)
 						cout << "   Total energy deposited: " << Etot/MeV << " MeV" << endl;
 					}
 				}
-				processOutputFactory->writeG4DgtIntegrated(outContainer, allDgtOutput, hitType, banksMap);
 				
 			} // end of geant4 integrated digitized information
 			
+			sdTimer.next(PROFILE_RAW);
+			
 			// geant4 integrated raw information
 			// by default they are all DISABLED
 			// user can enable them one by one
@@ -835,28 +1030,22 @@ void MEventAction::EndOfEventAction(const G4Event* evt)
 				}
 			}
 
-
-
-
-			if(WRITE_TRUE_INTEGRATED) {
-				processOutputFactory->writeG4RawIntegrated(outContainer, allRawOutput, hitType, banksMap);
-			}
-
-			// geant4 all raw information
-			// by default they are all DISABLED
-			// user can enable them one by one
-			// using the ALLRAWS option
-			if(WRITE_TRUE_ALL) {
-				processOutputFactory->writeG4RawAll(outContainer, allRawOutput, hitType, banksMap);
-			}
-
 			// geant4 voltage versus time
 			// by default they are all DISABLED
 			// user can enable them one by one
 			// using the SIGNALVT option
-			if(SIGNALVT.find(hitType) != string::npos) {
-				vector<hitOutput> allVTOutput;
+			bool WRITE_VT = SIGNALVT.find(hitType) != string::npos;
+			vector<hitOutput> allVTOutput;
+			
+			if(WRITE_VT) {
+				sdTimer.next(PROFILE_VOLTAGE);
+				
+				allVTOutput.reserve(nhits);
 				
+				// sample buffers, reused for all hits
+				unsigned nsamples = (unsigned) nsamplings;
+				vector<double> voltages(nsamples);
+				vector<double> pedestals(nsamples);
 				
 				for(int h=0; h<nhits; h++) {
 					
@@ -865,13 +1054,14 @@ void MEventAction::EndOfEventAction(const G4Event* evt)
 					MHit* aHit = (*MHC)[h];
 					
 					// process each step to produce a charge/time digitized information / step
-					thisHitOutput.setChargeTime(hitProcessRoutine->chargeTime(aHit, h));
+					map< int, vector <double> > chargeTime = hitProcessRoutine->chargeTime(aHit, h);
 					
-					vector<double> stepTimes   = thisHitOutput.getChargeTime()[3]; // time at electronics
-					vector<double> stepCharges = thisHitOutput.getChargeTime()[2]; // charge at electronics
-					vector<double> hardware    = thisHitOutput.getChargeTime()[5]; // crate/slot/channel
+					const vector<double> &stepTimes   = chargeTime[3]; // time at electronics
+					const vector<double> &stepCharges = chargeTime[2]; // charge at electronics
+					const vector<double> &hardware    = chargeTime[5]; // crate/slot/channel
 					
-					map<int, int> vSignal;
+					// the first 3 entries are crate/slot/channels, followed by the samples
+					vector<int> vSignal(nsamples + 3);
 					
 					// crate, slot, channels as from translation table
 					vSignal[0] = hardware[0];           // crate
@@ -882,43 +1072,26 @@ void MEventAction::EndOfEventAction(const G4Event* evt)
 					double pedestal_mean = hardware[3];
 					double pedestal_sigm = hardware[4];
 					
-					for(unsigned ts = 0; ts<nsamplings; ts++) {
-						double forTime = ts*tsampling;
-						double voltage = 0;
-						
-						// create the voltage output based on the hit process
-						// routine voltage(double charge, double time, double forTime)
-						for(unsigned s=0; s<stepTimes.size(); s++) {
-							
-							double stepTime   = stepTimes[s];
-							double stepCharge = stepCharges[s];
-							
-							// cout<<"StepTime = "<<stepTime<<endl;
-							// cout<<"StepCharge =  = "<<stepCharge<<endl;
-							
-							voltage += hitProcessRoutine->voltage(stepCharge, stepTime, forTime);
-							
-							//cout<<"setpCharge = "<<stepCharge<<endl;
-							
-							// cout << " hit " << h <<    "step " << s << "  time: " << stepTime
-							// << "   charge " << stepCharge << "  voltage " << voltage << "  for time bunch " << ts << endl;
-						}
-						
-						
-						// Now pedestal should be calculated, Assume it is a Gaussian
-						double pedestal = G4RandGauss::shoot(pedestal_mean, pedestal_sigm);
-						
-						// need conversion factor from double to int
-						// the first 3 entries are crate/slot/channels above
-						// the total signal is the pedestal + voltage (from actuall hit), here voltage is actually represents
-						// FADC counts
-						vSignal[ts+3] = int(pedestal) + (int) voltage;
+					// create the voltage output of all steps at once, based on the hit process
+					// routine voltageSamples(charges, times, tsampling, nsamplings, samples)
+					fill(voltages.begin(), voltages.end(), 0);
+					hitProcessRoutine->voltageSamples(stepCharges, stepTimes, tsampling, nsamples, voltages.data());
+					
+					// Now pedestal should be calculated, Assume it is a Gaussian
+					G4RandGauss::shootArray(nsamples, pedestals.data(), pedestal_mean, pedestal_sigm);
+					
+					// need conversion factor from double to int
+					// the total signal is the pedestal + voltage (from actuall hit), here voltage is actually represents
+					// FADC counts
+					for(unsigned ts = 0; ts<nsamples; ts++) {
+						vSignal[ts+3] = int(pedestals[ts]) + (int) voltages[ts];
 					}
-
-					thisHitOutput.createQuantumS(vSignal);
 					
-					hit_outputs_from_AllSD[vSignal[0]].push_back(thisHitOutput);
-					allVTOutput.push_back(thisHitOutput);
+					thisHitOutput.setChargeTime(std::move(chargeTime));
+					thisHitOutput.createQuantumS(std::move(vSignal));
+					
+					hit_outputs_from_AllSD[thisHitOutput.getQuantumS()[0]].push_back(thisHitOutput);
+					allVTOutput.push_back(std::move(thisHitOutput));
 					
 					// this is not written out yet
 					
@@ -933,20 +1106,24 @@ void MEventAction::EndOfEventAction(const G4Event* evt)
 						cout << "   Total energy deposited: " << Etot/MeV << " MeV" << endl;
 					}
 				}
-				processOutputFactory->writeChargeTime(outContainer, allVTOutput, hitType, banksMap);
-				
-				// Event number (evtN) is needed in FADCMode1, therefore this is also passed as an argument
-				//processOutputFactory->writeFADCMode1(outContainer, allVTOutput, evtN);
-				
 			}
 			
 			
+			sdTimer.next(PROFILE_NSTAGES);
+			
 			// Check whether to save RNG
 			if (ssp.enabled && ssp.decision == false)
+			{
+				const gBank &hitBank = getBankFromMap(hitType, banksMap);
+				const gBank &rawBank = getBankFromMap("raws", banksMap);
+				int idSlot     = hitBank.slot("id");
+				int varRawSlot = rawBank.slot(ssp.variable);
+				int varDgtSlot = hitBank.slot(ssp.variable);
+
 				for (int h = 0; h < nhits; ++h)
 				{
 					// Check if masked ID matches targetId
-					int id = allDgtOutput[h].getIntDgtVar ("id");
+					int id = allDgtOutput[h].getIntDgtVar (idSlot);
 					int id2 = id;
 					int j = ssp.tIdsize-1;
 
@@ -960,14 +1137,14 @@ void MEventAction::EndOfEventAction(const G4Event* evt)
 						continue;
 
 					// Check pid
-					int pid = allRawOutput[h].getIntRawVar ("pid");
+					int pid = allRawOutput[h].getIntRawVar (RAW_PID);
 					if (pid != ssp.targetPid)
 						continue;
 
 					// Check given variable
-					double varval = allRawOutput[h].getIntRawVar (ssp.variable);
+					double varval = allRawOutput[h].getIntRawVar (varRawSlot);
 					if (varval == -99)
-						varval = allDgtOutput[h].getIntDgtVar (ssp.variable);
+						varval = allDgtOutput[h].getIntDgtVar (varDgtSlot);
 					if (varval == -99)
 					{
 						cout << "Unknown variable " << ssp.variable << " for SAVE_SELECTED, exiting" << endl;
@@ -980,28 +1157,24 @@ void MEventAction::EndOfEventAction(const G4Event* evt)
 						break;
 					}
 				}
+			}
 			
-			delete hitProcessRoutine;
+			detectorOutputs.push_back({hitType, it->second, WRITE_DGT_INTEGRATED, WRITE_TRUE_INTEGRATED, WRITE_TRUE_ALL, WRITE_VT,
+				std::move(allDgtOutput), std::move(allRawOutput), std::move(allVTOutput)});
 		}
 	}
 	
-	processOutputFactory->writeFADCMode1( hit_outputs_from_AllSD, evtN);
-	
-	// writing out generated particle infos
-	processOutputFactory->writeGenerated(outContainer, MPrimaries, banksMap, gen_action->userInfo);
-	
 	// For hits, store all ancestors
-	
+	vector<ancestorInfo> ainfo;
 	if (SAVE_ALL_ANCESTORS)
 	{
-		vector<ancestorInfo> ainfo;
 		set<int> storedTraj;
 		for (unsigned int i = 0; i < trajectoryContainer->size(); i++)
 		{
 			G4Trajectory* trj = (G4Trajectory*)(*(evt->GetTrajectoryContainer()))[i];
 			int tid = trj->GetTrackID();
-			it = track_db2.find (tid);
-			if (it != track_db2.end())
+			it = track_db.find (tid);
+			if (it != track_db.end())
 			{
 				// This trajectory tid is involved in a hit, store it and its ancestors
 				while (tid > 0 && storedTraj.find (tid) == storedTraj.end())
@@ -1021,26 +1194,94 @@ void MEventAction::EndOfEventAction(const G4Event* evt)
 					tid = 0;
 					if (mtid > 0)
 					{
-						for (unsigned int ii = 0; ii < trajectoryContainer->size(); ii++)
+						auto mtrj = trajectories.find(mtid);
+						if (mtrj != trajectories.end())
 						{
-							trj = (G4Trajectory*)(*(evt->GetTrajectoryContainer()))[ii];
-							if (trj->GetTrackID() == mtid)
-							{
-								tid = mtid;
-								break;
-							}
+							trj = mtrj->second;
+							tid = mtid;
 						}
 					}
 				}
 			}
 		}
-		// write out ancestral trajectories
-		processOutputFactory->writeAncestors (outContainer, ainfo, getBankFromMap("ancestors", banksMap));
 	}
 	
+	// the output time includes the wait for the other threads output
+	eventTimer.next(PROFILE_OUTPUT);
 	
-	processOutputFactory->writeEvent(outContainer);
-	delete processOutputFactory;
+	// the output container is shared by all threads: only the writing is serialized
+	{
+		G4AutoLock lock(&eventOutputMutex);
+		
+		processOutputFactory->prepareEvent(outContainer, &configuration);
+		
+		// write event header bank
+		processOutputFactory->writeHeader(outContainer, header, getBankFromMap("header", banksMap));
+		
+		// write event header bank
+		processOutputFactory->writeUserInfoseHeader(outContainer, userHeader);
+				
+		// write RF bank if present
+		if(WRITE_RF) {
+			FrequencySyncSignal rfs(rfsetup_string);
+			processOutputFactory->writeRFSignal(outContainer, rfs, getBankFromMap("rf", banksMap));
+			
+			if(VERB > 1) {
+				cout << rfs << endl;
+			}
+		}
+		
+		// the detectors banks time is in their own profile
+		eventTimer.next(PROFILE_NSTAGES);
+		
+		for(auto &output: detectorOutputs) {
+			profileTimer sdTimer(PROFILE ? &output.sd->profile : nullptr, PROFILE_OUTPUT);
+			
+			if(output.writeDgt) {
+				processOutputFactory->writeG4DgtIntegrated(outContainer, output.dgt, output.hitType, banksMap);
+			}
+			
+			if(output.writeRawIntegrated) {
+				processOutputFactory->writeG4RawIntegrated(outContainer, output.raw, output.hitType, banksMap);
+			}
+			
+			// geant4 all raw information
+			// by default they are all DISABLED
+			// user can enable them one by one
+			// using the ALLRAWS option
+			if(output.writeRawAll) {
+				processOutputFactory->writeG4RawAll(outContainer, output.raw, output.hitType, banksMap);
+			}
+			
+			if(output.writeVT) {
+				processOutputFactory->writeChargeTime(outContainer, output.vt, output.hitType, banksMap);
+				
+				// Event number (evtN) is needed in FADCMode1, therefore this is also passed as an argument
+				//processOutputFactory->writeFADCMode1(outContainer, allVTOutput, evtN);
+			}
+		}
+		
+		eventTimer.next(PROFILE_OUTPUT);
+		
+		processOutputFactory->writeFADCMode1( hit_outputs_from_AllSD, evtN);
+		
+		// writing out generated particle infos
+		processOutputFactory->writeGenerated(outContainer, MPrimaries, banksMap, gen_action->userInfo);
+		
+		// write out ancestral trajectories
+		if (SAVE_ALL_ANCESTORS) {
+			processOutputFactory->writeAncestors (outContainer, ainfo, getBankFromMap("ancestors", banksMap));
+		}
+		
+		// the profile bank has the times measured so far: the event write is only in the run profile
+		if(PROFILE > 1) {
+			eventTimer.next(PROFILE_NSTAGES);
+			processOutputFactory->writeProfile(outContainer, eventProfiles(), detectorProfile::peakRSS());
+			eventTimer.next(PROFILE_OUTPUT);
+		}
+		
+		processOutputFactory->writeEvent(outContainer);
+	}
 	
 	// Save RNG; can't use G4RunManager::GetRunManager()->rndmSaveThisEvent()
 	// because GEANT doesn't know about GEMC run/event numbers
@@ -1089,31 +1330,88 @@ void MEventAction::saveBGPartsToLund()
 
 
 
-vector<BackgroundHit*> MEventAction::getNextBackgroundEvent(string forSystem)
+// the background event follows from the event number, not from a per thread counter:
+// in multithreaded mode each event gets the background event it would get in sequential mode
+const vector<BackgroundHit*> &MEventAction::getNextBackgroundEvent(const string &forSystem)
 {
+	static const vector<BackgroundHit*> noBackground;
+
 	if(backgroundHits != nullptr) {
 		
-		if(backgroundEventNumber.find(forSystem) == backgroundEventNumber.end()) {
-			backgroundEventNumber[forSystem] = 1;
-		} else {
-			backgroundEventNumber[forSystem]++;
-		}
-		
-		map<int, vector<BackgroundHit*> > *backgroundHitsEventMap = backgroundHits->getBackgroundForSystem(forSystem);
+		const map<int, vector<BackgroundHit*> > *backgroundHitsEventMap = backgroundHits->getBackgroundForSystem(forSystem);
 		
 		if(backgroundHitsEventMap != nullptr) {
 			
-			// resetting numbering to first one if we reach end of map
-			if(backgroundEventNumber[forSystem] == (int) backgroundHitsEventMap->size()) {
-				backgroundEventNumber[forSystem] = 1;
-			}
+			// numbering goes back to the first one when reaching the end of map
+			int cycle = max((int) backgroundHitsEventMap->size() - 1, 1);
+			int eventIndex = (evtN - evtN0) % cycle;
+			if(eventIndex < 0) eventIndex += cycle;
+			int eventNumber = eventIndex + 1;
 			
-			if(backgroundHitsEventMap->find(backgroundEventNumber[forSystem]) != backgroundHitsEventMap->end()) {
-				return (*backgroundHitsEventMap)[backgroundEventNumber[forSystem]];
+			auto eventHits = backgroundHitsEventMap->find(eventNumber);
+			if(eventHits != backgroundHitsEventMap->end()) {
+				return eventHits->second;
+			}
+		}
+	}
+	return noBackground;
+}
+
+// fast mode: each channel gets a hit with the photoelectrons drawn from the expected value.
+// The hits have the background hits form, so the digitization routines handle them the same way.
+// calibration mode: each photon is counted once per channel, weighted with the
+// detection efficiency given by the hit process routine
+void MEventAction::processOpticalPhotons()
+{
+	for(auto &sd : SeDe_Map) {
+		MHitCollection *MHC = sd.second->GetMHitCollection();
+		if(!MHC) continue;
+
+		if(!opticalPhotons->calibration) {
+			const opticalPhotonMap *fastMap = opticalPhotons->fastMap;
+			for(auto &signal : opticalPhotons->signals) {
+				if(fastMap->channelSensitivity(signal.first) != sd.first) continue;
+
+				int nphe = (int) G4Poisson(signal.second.expected);
+				if(nphe > 0) {
+					MHC->insert(new MHit(0, signal.second.time, nphe, fastMap->channelIdentity(signal.first)));
+				}
 			}
+			continue;
 		}
+
+		HitProcess *hitProcessRoutine = MHC->GetSize() ? getHitProcessRoutine(sd.first) : nullptr;
+
+		for(unsigned h=0; h<MHC->GetSize(); h++) {
+			MHit *aHit = (*MHC)[h];
+			if(aHit->isBackgroundHit == 1 || aHit->isElectronicNoise == 1) continue;
+
+			const vector<int>    &tids  = aHit->GetTIds();
+			const vector<int>    &pids  = aHit->GetPIDs();
+			const vector<double> &times = aHit->GetTime();
+
+			int channel = -1;
+			for(unsigned s=0; s<tids.size(); s++) {
+				if(pids[s] != MHit::OPTICALPHOTONPID) continue;
+
+				auto photon = opticalPhotons->photons.find(tids[s]);
+				if(photon == opticalPhotons->photons.end()) continue;
+
+				if(channel == -1) {
+					channel = opticalPhotons->tally.channelIndex(sd.first, aHit->GetId());
+				}
+				if(!opticalPhotons->detected.insert(make_pair(tids[s], channel)).second) continue;
+
+				double weight = hitProcessRoutine ? hitProcessRoutine->photonEfficiency(aHit, s) : 1;
+				opticalPhotons->tally.addDetected(photon->second.cell, channel, weight, times[s] - photon->second.time);
+			}
+		}
+	}
+
+	if(opticalPhotons->calibration) {
+		opticalPhotonMap::mergeCalibration(opticalPhotons->tally);
+		opticalPhotons->tally.clear();
 	}
-	return {nullptr};
 }
 
 
@@ -1146,7 +1444,7 @@ void MEventAction::setup_clas12_RF(int runno) {
 			connection = (string) getenv("CCDB_CONNECTION");
 		}
 						
-		unique_ptr<Calibration> calib(CalibrationGenerator::CreateCalibration(connection));
+		unique_ptr<cachedCalibration> calib(new cachedCalibration(connection));
 		char   database[80];
 
 		snprintf(database, sizeof(database), "%s:%d:%s%s", "/calibration/eb/rf/config", runno, digiVariation.c_str(), timestamp.c_str());
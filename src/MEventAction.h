@@ -23,6 +23,9 @@
 #include "sensitiveDetector.h"
 #include "gemcOptions.h"
 #include "MPrimaryGeneratorAction.h"
+#include "opticalPhotonMap.h"
+#include "pileupLibrary.h"
+#include "detectorProfile.h"
 
 
 /// \class BGParts
@@ -86,11 +89,11 @@ public:
     G4ThreeVector mv;
 };
 
-vector<int> vector_mtids(map<int, TInfos> tinfos, vector<int> tids);
+vector<int> vector_mtids(map<int, TInfos> &tinfos, const vector<int> &tids);
 
-vector<int> vector_mpids(map<int, TInfos> tinfos, vector<int> tids);
+vector<int> vector_mpids(map<int, TInfos> &tinfos, const vector<int> &tids);
 
-vector <G4ThreeVector> vector_mvert(map<int, TInfos> tinfos, vector<int> tids);
+vector <G4ThreeVector> vector_mvert(map<int, TInfos> &tinfos, const vector<int> &tids);
 
 vector<int> vector_zint(int size);  ///< provides a vector of 0
 vector <G4ThreeVector> vector_zthre(int size);  ///< provides a vector of (0,0,0)
@@ -140,6 +143,7 @@ public:
     map <string, gBank> *banksMap;         ///< Bank Map
     map<string, double> gPars;            ///< Parameters Map
     MPrimaryGeneratorAction *gen_action;       ///< Generator Action
+    opticalPhotonEvent *opticalPhotons;        ///< Optical photons fast simulation. nullptr if not used
 
     map<int, int> hierarchy;                     ///< Hierarchy map
     map<int, int> momDaughter;                   ///< mom - daughter relationship
@@ -147,6 +151,7 @@ public:
 
 
     int evtN;            ///< Event Number
+    int evtN0;           ///< Starting Event Number. In multithreaded mode evtN is evtN0 + the previous runs events + G4 event ID
     string hd_msg;          ///< Event Action Message
     int Modulo;          ///< Print Log Event every Modulo
     double VERB;            ///< Event Verbosity
@@ -187,17 +192,38 @@ private:
     // background hits, key is event number
     // background hits
     string BGFILE;           ///< filename containing background hits
-    GBackgroundHits *backgroundHits;
+    const GBackgroundHits *backgroundHits;   ///< loaded once and shared by the threads
 
-    // bookkeeping of background events for each system
-    map<string, int> backgroundEventNumber;
+    const vector<BackgroundHit *> &getNextBackgroundEvent(const string &forSystem);
 
-    vector<BackgroundHit *> getNextBackgroundEvent(string forSystem);
+    // luminosity pileup library
+    string PILEUP_OUTPUT;                 ///< library written by this job, "no" if not used
+    const pileupLibrary *pileup;          ///< library overlaid to each event, loaded once and shared by the threads
+    int pileupBunches;                    ///< number of library bunches overlaid to each event
+    double pileupBunchTime;               ///< time between the overlaid bunches
+
+    // per-detector profile
+    int PROFILE;                          ///< 1: prints the run profile at the end of the run. 2: also writes the profile bank
+    detectorProfile eventProfile;         ///< tracking and output times of the current event
+    double eventStartWall, eventStartCpu; ///< begin of event times, to measure the tracking time
+
+    map<string, detectorProfile> eventProfiles();  ///< profiles of the current event, key is the sensitive detector name or "event"
+    void collectProfiles();                        ///< adds the current event profiles to the run profile and clears them
+
+    // optical photons fast simulation: adds the map hits, or counts the detected photons in calibration mode
+    void processOpticalPhotons();
 
     int last_runno;
 
     void setup_clas12_RF(int runno);
 
+    map<string, HitProcess *> hitProcessRoutines;  ///< Hit Process Routines, one per hit type, kept for the whole job
+    map<string, int> hitProcessRunNo;               ///< Run number used for the last init of each Hit Process Routine
+
+    HitProcess *getHitProcessRoutine(string hitType);  ///< Returns the Hit Process Routine, initialized for the current run number
+
+    outputFactory *processOutputFactory;  ///< Output Factory, kept for the whole run
+
     void set_and_show_rf_setup();
 
 public:
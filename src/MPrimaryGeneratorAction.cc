@@ -7,10 +7,12 @@
 #include "G4UnitsTable.hh"
 #include "Randomize.hh"
 #include "G4RunManager.hh"
+#include "G4Threading.hh"
 
 // gemc headers
 #include "MPrimaryGeneratorAction.h"
 #include "string_utilities.h"
+#include "MRunAction.h"
 
 // mlibrary
 #include "gstring.h"
@@ -42,6 +44,8 @@ MPrimaryGeneratorAction::MPrimaryGeneratorAction(goptions *opts) {
     particleTable = G4ParticleTable::GetParticleTable();
 
     beamPol = 0;
+    lund = nullptr;
+    bgLund = nullptr;
 
     setBeam();
 
@@ -168,6 +172,20 @@ MPrimaryGeneratorAction::MPrimaryGeneratorAction(goptions *opts) {
 }
 
 
+// skips events in the LUND file until eventIndex reaches toIndex
+// returns false if the end of the file is reached
+// the reader does not decode the skipped events
+bool MPrimaryGeneratorAction::skipLundEvents(int toIndex) {
+    if (eventIndex >= toIndex) {
+        return true;
+    }
+
+    int n = toIndex - eventIndex;
+    eventIndex = toIndex;
+
+    return lund->skip(n);
+}
+
 void MPrimaryGeneratorAction::GeneratePrimaries(G4Event *anEvent) {
     // Check first if event should be seeded
     if (rsp.enabled) {
@@ -479,47 +497,30 @@ void MPrimaryGeneratorAction::GeneratePrimaries(G4Event *anEvent) {
         // 1       2      3     4            5       6         7    8    9    10   11    12        13        14
         // index, charge, type, particle id, parent, daughter, p_x, p_y, p_z, p_t, mass, x vertex, y vertex, z vertex
         // type is 1 for particles in the detector
-        if ((gformat == "LUND" || gformat == "lund") && !gif.eof()) {
+        if ((gformat == "LUND" || gformat == "lund") && lund && !lund->eof()) {
 
             headerUserDefined.clear();
 
-            string theWholeLine;
-
             if (rsp.enabled && eventIndex < int(rsp.events[rsp.currentevent])) {
                 // Skip input file lines to find rerun event
-                for (; eventIndex < int(rsp.events[rsp.currentevent]); ++eventIndex) {
-                    // reading header
-                    getline(gif, theWholeLine);
-                    if (gif.eof()) {
-                        return;
-                    }
-                    vector <string> headerStrings = getStringVectorFromString(theWholeLine);
-                    headerUserDefined.clear();
-                    for (auto &s: headerStrings) {
-                        headerUserDefined.push_back(get_number(s));
-                    }
+                if (!skipLundEvents(rsp.events[rsp.currentevent])) {
+                    return;
+                }
+            }
 
-                    int nparticles = headerUserDefined[0];
-                    for (int p = 0; p < nparticles; p++) {
-                        string theWholeLine;
-                        getline(gif, theWholeLine);
-                        if (gif.eof() && p != nparticles - 1) {
-                            cout << " Input file " << gfilename << " appear to be truncated." << endl;
-                            return;
-                        }
-                    }
+            // each worker thread reads its own copy of the file:
+            // skip to the event matching the G4 event ID, counted from the events of the previous runs
+            int lundIndex = MRunAction::eventOffset() + anEvent->GetEventID() + 1;
+            if (G4Threading::IsWorkerThread() && eventIndex < lundIndex) {
+                if (!skipLundEvents(lundIndex)) {
+                    return;
                 }
             }
-            // reading header
-            getline(gif, theWholeLine);
-            if (gif.eof()) {
+            // reading the event, already decoded by the reader thread
+            if (!lund->next(lundEv)) {
                 return;
             }
-            vector <string> headerStrings = getStringVectorFromString(theWholeLine);
-            headerUserDefined.clear();
-            for (auto &s: headerStrings) {
-                headerUserDefined.push_back(get_number(s));
-            }
+            headerUserDefined = lundEv.header;
 
             int nparticles = headerUserDefined[0];
             beamPol = headerUserDefined[4];
@@ -529,19 +530,13 @@ void MPrimaryGeneratorAction::GeneratePrimaries(G4Event *anEvent) {
 
             userInfo.clear();
             for (int p = 0; p < nparticles; p++) {
-                string theWholeLine;
-                getline(gif, theWholeLine);
-                if (gif.eof() && p != nparticles - 1) {
+                if (lundEv.truncated && p == (int) lundEv.particles.size()) {
                     cout << " Input file " << gfilename << " appear to be truncated." << endl;
                     return;
                 }
 
-                vector <string> infoStrings = getStringVectorFromString(theWholeLine);
-
                 userInforForParticle thisParticleInfo;
-                for (auto &s: infoStrings) {
-                    thisParticleInfo.infos.push_back(get_number(s));
-                }
+                thisParticleInfo.infos.swap(lundEv.particles[p]);
                 userInfo.push_back(thisParticleInfo);
 
                 // necessary geant4 info. Lund specifics:
@@ -787,20 +782,24 @@ void MPrimaryGeneratorAction::GeneratePrimaries(G4Event *anEvent) {
     }
 
     // merging (background) events from LUND format
-    if (background_gen != "no") {
-        int nparticles;
-        double tmp;
-
-        bgif >> nparticles;
-        for (unsigned i = 0; i < 9; i++)
-            bgif >> tmp;
+    if (background_gen != "no" && bgLund->next(lundEv)) {
+        int nparticles = lundEv.particles.size();
 
         for (int p = 0; p < nparticles; p++) {
-            double px, py, pz;
-            int pdef, pindex;
-            double time;
-            double Vx, Vy, Vz;
-            bgif >> pindex >> tmp >> tmp >> pdef >> tmp >> tmp >> px >> py >> pz >> time >> tmp >> Vx >> Vy >> Vz;
+            vector<double> &infos = lundEv.particles[p];
+            if (infos.size() < 14) {
+                continue;
+            }
+            int pindex = infos[0];
+            int pdef = infos[3];
+            double px = infos[6];
+            double py = infos[7];
+            double pz = infos[8];
+            double time = infos[9];
+            double tmp = infos[10];
+            double Vx = infos[11];
+            double Vy = infos[12];
+            double Vz = infos[13];
             if (pindex == p + 1) {
                 // Primary Particle
                 Particle = particleTable->FindParticle(pdef);
@@ -1197,10 +1196,13 @@ void MPrimaryGeneratorAction::setBeam() {
         gformat.assign(input_gen, 0, input_gen.find(","));
         gfilename.assign(input_gen, input_gen.find(",") + 1, input_gen.size());
         cout << hd_msg << "LUND: Opening  " << gformat << " file: " << trimSpacesFromString(gfilename).c_str() << endl;
-        gif.open(trimSpacesFromString(gfilename).c_str());
-        if (!gif) {
-            cerr << hd_msg << " Can't open LUND input file " << trimSpacesFromString(gfilename).c_str() << ". Exiting. " << endl;
-            exit(201);
+        // reader may be already opened cause setBeam is called again in graphic mode
+        if (lund == nullptr) {
+            lund = new lundReader(trimSpacesFromString(gfilename), gemcOpt->optMap["LUND_CACHE"].args != "no");
+            if (!lund->good()) {
+                cerr << hd_msg << " Can't open LUND input file " << trimSpacesFromString(gfilename).c_str() << ". Exiting. " << endl;
+                exit(201);
+            }
         }
     } else if (input_gen.compare(0, 6, "BEAGLE") == 0 || input_gen.compare(0, 6, "beagle") == 0) {
         gformat.assign(input_gen, 0, input_gen.find(","));
@@ -1251,9 +1253,9 @@ void MPrimaryGeneratorAction::setBeam() {
     // merging (background) events from LUND format
     if (background_gen != "no") {
         // file may be already opened cause setBeam is called again in graphic mode
-        if (!bgif.is_open()) {
-            bgif.open(trimSpacesFromString(background_gen).c_str());
-            if (!bgif) {
+        if (bgLund == nullptr) {
+            bgLund = new lundReader(trimSpacesFromString(background_gen), gemcOpt->optMap["LUND_CACHE"].args != "no");
+            if (!bgLund->good()) {
                 cerr << hd_msg << " Can't open background input file >" << trimSpacesFromString(background_gen).c_str() << "<. Exiting. " << endl;
                 exit(204);
             }
@@ -1393,8 +1395,9 @@ vector<int> MPrimaryGeneratorAction::setBunches(int nparticle, int nbunch) {
 
 MPrimaryGeneratorAction::~MPrimaryGeneratorAction() {
     delete particleGun;
+    delete lund;
+    delete bgLund;
     gif.close();
-    bgif.close();
 }
 
 
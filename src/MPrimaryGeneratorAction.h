@@ -13,6 +13,7 @@ using namespace UTIL;
 
 // gemc
 #include "gemcOptions.h"
+#include "lundReader.h"
 
 // C++
 #include <fstream>
@@ -71,7 +72,7 @@ public:
 	double getStartTime(){return TSIGNAL;}
 
 
-	bool isFileOpen() {return !gif.eof();}
+	bool isFileOpen() {return lund ? !lund->eof() : !gif.eof();}
 
 	bool isRerun() { return rsp.enabled; }
 	int rerunEvent() { return rsp.currentevent >=0 ? rsp.events[rsp.currentevent] : 0; }
@@ -121,7 +122,9 @@ private:
 
 	// Generators Input Files
 	ifstream  gif;                    ///< Generator Input File
-	ifstream  bgif;                   ///< Background Generator Input File
+	lundReader *lund;                 ///< LUND Generator Input File reader
+	lundReader *bgLund;               ///< LUND Background Generator Input File reader
+	lundEvent   lundEv;               ///< last event decoded by the readers
 	string    gformat;                ///< Generator Format. Supported: LUND.
 	string    gfilename;              ///< Input Filename for main events
 	double    beamPol;                ///< Beam Polarization as from the LUND format, it
@@ -164,6 +167,8 @@ private:
 	void setParticleFromPars(int, int, int, int, double, double, double,  double, double, double, G4Event* anEvent, int A=0, int Z=0);
 	void setParticleFromParsPropagateTime(int, vector<userInforForParticle>, G4Event* anEvent, int A=0, int Z=0);  
 
+	bool skipLundEvents(int toIndex);
+
 };
 
 #endif
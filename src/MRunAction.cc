@@ -0,0 +1,15 @@
+// gemc headers
+#include "MRunAction.h"
+
+atomic<int> MRunAction::runEventOffset(0);
+
+MRunAction::MRunAction() {;}
+
+MRunAction::~MRunAction(){;}
+
+// the event IDs of a run go from 0 to the number of events to be processed,
+// including the events not processed if the run is aborted
+void MRunAction::EndOfRunAction(const G4Run* run)
+{
+	runEventOffset += run->GetNumberOfEventToBeProcessed();
+}
@@ -0,0 +1,33 @@
+/// \file MRunAction.h
+/// Defines the gemc Run Action class.\n
+/// Used by the master thread in multithreaded mode: the G4 event IDs restart
+/// from zero at each run, so the events of the previous runs are counted
+/// to keep the event numbers and the LUND input going across runs.
+
+#ifndef MRunAction_h
+#define MRunAction_h 1
+
+// G4 headers
+#include "G4UserRunAction.hh"
+#include "G4Run.hh"
+
+// C++ headers
+#include <atomic>
+using namespace std;
+
+class MRunAction : public G4UserRunAction
+{
+	public:
+		MRunAction();
+		virtual ~MRunAction();
+
+		void EndOfRunAction(const G4Run*);
+
+		/// events processed by the previous runs. Only changes between runs
+		static int eventOffset() { return runEventOffset; }
+
+	private:
+		static atomic<int> runEventOffset;
+};
+
+#endif
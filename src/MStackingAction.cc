@@ -0,0 +1,31 @@
+// G4 headers
+#include "G4OpticalPhoton.hh"
+
+// gemc headers
+#include "MStackingAction.h"
+
+MStackingAction::MStackingAction(opticalPhotonEvent *op)
+{
+	opticalPhotons = op;
+}
+
+MStackingAction::~MStackingAction()
+{
+	delete opticalPhotons;
+}
+
+
+G4ClassificationOfNewTrack MStackingAction::ClassifyNewTrack(const G4Track* track)
+{
+	if(track->GetDefinition() != G4OpticalPhoton::OpticalPhotonDefinition()) {
+		return fUrgent;
+	}
+
+	if(opticalPhotons->calibration) {
+		opticalPhotons->recordPhoton(track->GetTrackID(), track->GetPosition(), track->GetMomentumDirection(), track->GetGlobalTime());
+		return fUrgent;
+	}
+
+	opticalPhotons->addPhoton(track->GetPosition(), track->GetMomentumDirection(), track->GetGlobalTime());
+	return fKill;
+}
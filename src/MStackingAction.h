@@ -0,0 +1,28 @@
+/// \file MStackingAction.h
+/// Defines the gemc Stacking Action class.\n
+/// Used by the optical photons fast simulation: in fast mode the optical photons
+/// are added to the optical photon map signals and killed at creation.
+/// In calibration mode their creation cell is recorded and they are tracked.\n
+
+#ifndef MStackingAction_h
+#define MStackingAction_h 1
+
+// G4 headers
+#include "G4UserStackingAction.hh"
+#include "G4Track.hh"
+
+// gemc headers
+#include "opticalPhotonMap.h"
+
+class MStackingAction : public G4UserStackingAction
+{
+	public:
+		MStackingAction(opticalPhotonEvent *opticalPhotons);
+		virtual ~MStackingAction();
+
+		opticalPhotonEvent *opticalPhotons;   ///< this thread optical photons, owned here and shared with the event action
+
+		G4ClassificationOfNewTrack ClassifyNewTrack(const G4Track*);
+};
+
+#endif
@@ -1,8 +1,31 @@
 // G4 headers
 #include "G4ParticleTypes.hh"
+#include "G4LogicalVolumeStore.hh"
 
 // gemc headers
 #include "MSteppingAction.h"
+#include "string_utilities.h"
+
+namespace {
+	const long stepRateSampling = 1 << 16;
+
+	// adds the volume and all its daughters
+	void addVolumeTree(const G4LogicalVolume *lv, unordered_set<const G4LogicalVolume*> &volumes)
+	{
+		if(!volumes.insert(lv).second) return;
+		for(size_t d=0; d<lv->GetNoDaughters(); d++) {
+			addVolumeTree(lv->GetDaughter(d)->GetLogicalVolume(), volumes);
+		}
+	}
+
+	// adds all the materials with this name: several systems may define their own
+	void addMaterials(const G4String &name, unordered_set<const G4Material*> &materials)
+	{
+		for(auto material : *G4Material::GetMaterialTable()) {
+			if(material->GetName() == name) materials.insert(material);
+		}
+	}
+}
 
 MSteppingAction::MSteppingAction(goptions Opt)
 {
@@ -11,16 +34,59 @@ MSteppingAction::MSteppingAction(goptions Opt)
 	max_x_pos = gemcOpt.optMap["MAX_X_POS"].arg;
 	max_y_pos = gemcOpt.optMap["MAX_Y_POS"].arg;
 	max_z_pos = gemcOpt.optMap["MAX_Z_POS"].arg;
+	maxSteps        = gemcOpt.optMap["MAX_STEPS"].arg;
+	maxOpticalSteps = gemcOpt.optMap["MAX_OPTICAL_STEPS"].arg;
+
+	// materials are built before the actions
+	addMaterials("Kryptonite", kryptonite);
+	addMaterials("SemiMirror", semiMirror);
+
+	// the volumes are built after the actions in sequential mode: resolved at the first step
+	killVolumesOption   = gemcOpt.optMap["KILL_VOLUMES"].args;
+	killVolumesResolved = killVolumesOption == "no";
+
+	nsteps = 0;
 	
 //	oldpos = G4ThreeVector(0,0,0);
 //	nsame  = 0;
 }
 
-MSteppingAction::~MSteppingAction(){ cout << " > Closing Stepping Action." << endl;}
+MSteppingAction::~MSteppingAction()
+{
+	cout << " > Closing Stepping Action." ;
+	double seconds = chrono::duration<double>(lastStepTime - firstStepTime).count();
+	if(nsteps > stepRateSampling && seconds > 0) {
+		cout << " " << nsteps << " steps, " << (long) (nsteps/seconds) << " steps per second." ;
+	}
+	cout << endl;
+}
+
+void MSteppingAction::resolveKillVolumes()
+{
+	G4LogicalVolumeStore *lvStore = G4LogicalVolumeStore::GetInstance();
+
+	for(auto &name : get_info(killVolumesOption)) {
+		G4LogicalVolume *lv = lvStore->GetVolume(name, false);
+		if(lv == nullptr) {
+			cout << "  !!! Warning: KILL_VOLUMES volume " << name << " not found." << endl;
+			continue;
+		}
+		addVolumeTree(lv, killVolumes);
+	}
+	killVolumesResolved = true;
+}
 
 
 void MSteppingAction::UserSteppingAction(const G4Step* aStep)
 {
+	if(nsteps%stepRateSampling == 0) {
+		lastStepTime = chrono::steady_clock::now();
+		if(nsteps == 0) {
+			firstStepTime = lastStepTime;
+		}
+	}
+	nsteps++;
+
 	G4ThreeVector   pos   = aStep->GetPostStepPoint()->GetPosition();      ///< Global Coordinates of interaction
 	G4Track*        track = aStep->GetTrack();
 
@@ -35,6 +101,7 @@ void MSteppingAction::UserSteppingAction(const G4Step* aStep)
 //		cout << " Track killed" << endl;
 
 		track->SetTrackStatus(fStopAndKill);   ///< Killing track if outside of interest region
+		return;
 	}
 
 	if(track->GetKineticEnergy() < energyCut) {
@@ -42,31 +109,49 @@ void MSteppingAction::UserSteppingAction(const G4Step* aStep)
 //		cout << " Track killed" << endl;
 
 		track->SetTrackStatus(fStopAndKill);
+		return;
 	}
 
 	// Anything passing material "Kryptonite" is killed
-	if(track->GetMaterial()->GetName() == "Kryptonite") {
+	if(!kryptonite.empty() && kryptonite.count(track->GetMaterial())) {
 		cout << " In  Kryptonite" ;
 		cout << " Track killed" << endl;
 		track->SetTrackStatus(fStopAndKill);
+		return;
+	}
+
+	// Anything entering the KILL_VOLUMES is killed
+	if(!killVolumesResolved) {
+		resolveKillVolumes();
+	}
+	if(!killVolumes.empty()) {
+		G4VPhysicalVolume *postVolume = aStep->GetPostStepPoint()->GetPhysicalVolume();
+		if(postVolume != nullptr && killVolumes.count(postVolume->GetLogicalVolume())) {
+			track->SetTrackStatus(fStopAndKill);
+			return;
+		}
 	}
 
 	
 	if(track->GetDefinition() == G4OpticalPhoton::OpticalPhotonDefinition()) {
-        // killing photon if above 100 steps
+        // killing photon if above MAX_OPTICAL_STEPS steps
         // notice we rarely go above 20 steps for all normal CC detectors
-        if(track->GetCurrentStepNumber() > 100)
+        if(track->GetCurrentStepNumber() > maxOpticalSteps) {
             track->SetTrackStatus(fStopAndKill);
+            return;
+        }
        
-        if(track->GetLogicalVolumeAtVertex()->GetMaterial()->GetName() == "SemiMirror")
+        if(!semiMirror.empty() && semiMirror.count(track->GetLogicalVolumeAtVertex()->GetMaterial())) {
             track->SetTrackStatus(fStopAndKill);
+            return;
+        }
 	}
 	
-	// limiting steps in one volume to 10000
+	// limiting steps in one volume to MAX_STEPS
 	// it may be the new version of geant4, or
 	// accurate magnetic fields, but it does happen that sometimes
 	// a track get stuck into a magnetic field infinite loop
-	if(track->GetCurrentStepNumber() > 10000) {
+	if(track->GetCurrentStepNumber() > maxSteps) {
 		track->SetTrackStatus(fStopAndKill);
 	}
 	
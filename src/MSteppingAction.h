@@ -1,5 +1,8 @@
 /// \file MSteppingAction.h
 /// Defines the gemc Stepping Action class.\n
+/// The kill conditions are checked on every step: the material names
+/// are resolved once into sets of pointers, the KILL_VOLUMES into a set of logical volumes
+/// at the first step, when the geometry is built.\n
 /// \author \n Maurizio Ungaro
 /// \author mail: ungaro@jlab.org\n\n\n
 
@@ -9,10 +12,16 @@
 // G4 headers
 #include "G4UserSteppingAction.hh"
 #include "G4Step.hh"
+#include "G4Material.hh"
+#include "G4LogicalVolume.hh"
 
 // gemc headers
 #include "gemcOptions.h"
 
+// C++ headers
+#include <chrono>
+#include <unordered_set>
+
 class MSteppingAction : public G4UserSteppingAction
 {
 	public:
@@ -24,6 +33,8 @@ class MSteppingAction : public G4UserSteppingAction
 		double max_x_pos;            ///< Max X Position in millimeters.
 		double max_y_pos;            ///< Max Y Position in millimeters.
 		double max_z_pos;            ///< Max Z Position in millimeters.
+		int    maxSteps;             ///< Set to MAX_STEPS: tracks are killed above this number of steps
+		int    maxOpticalSteps;      ///< Set to MAX_OPTICAL_STEPS: optical photons are killed above this number of steps
 				
 		// checking if track get stuck.
 		// if after 10 times the oldpos is the same as new pos,
@@ -32,6 +43,20 @@ class MSteppingAction : public G4UserSteppingAction
 //		int            nsame;
 		
 		void UserSteppingAction(const G4Step*);
+
+	private:
+		unordered_set<const G4Material*> kryptonite;   ///< anything passing these materials is killed. Empty if not defined
+		unordered_set<const G4Material*> semiMirror;   ///< optical photons created in these materials are killed. Empty if not defined
+
+		string killVolumesOption;                           ///< KILL_VOLUMES option
+		bool   killVolumesResolved;                         ///< killVolumes is filled at the first step
+		unordered_set<const G4LogicalVolume*> killVolumes;  ///< KILL_VOLUMES and all their daughters
+		void resolveKillVolumes();
+
+		// step rate: the clock is read every stepRateSampling steps
+		long nsteps;
+		chrono::steady_clock::time_point firstStepTime;
+		chrono::steady_clock::time_point lastStepTime;
 };
 
 #endif
@@ -182,6 +182,17 @@ void goptions::setGoptions()
 	optMap["MERGE_LUND_BG"].argsJSONDescription  = "bgLundfilename";
 	optMap["MERGE_LUND_BG"].argsJSONTypes  = "S";
 
+	optMap["LUND_CACHE"].args = "no";
+	optMap["LUND_CACHE"].help = "Binary cache of the LUND input files. Default: no\n";
+	optMap["LUND_CACHE"].help += "      When set to yes, the decoded events are written to <file>.lundb the first time a file is read to the end.\n";
+	optMap["LUND_CACHE"].help += "      Following runs read the cache as long as the LUND file size and modification time do not change.\n";
+	optMap["LUND_CACHE"].help += "      example: -LUND_CACHE=yes \n";
+	optMap["LUND_CACHE"].name = "Binary cache of the LUND input files";
+	optMap["LUND_CACHE"].type = 1;
+	optMap["LUND_CACHE"].ctgr = "generator";
+	optMap["LUND_CACHE"].argsJSONDescription  = "LUND_CACHE";
+	optMap["LUND_CACHE"].argsJSONTypes  = "S";
+
 
 	optMap["MERGE_BGHITS"].args = "no";
 	optMap["MERGE_BGHITS"].help = "ASCII file to merge background hits\n";
@@ -192,6 +203,30 @@ void goptions::setGoptions()
 	optMap["MERGE_BGHITS"].argsJSONDescription  = "bgfilename";
 	optMap["MERGE_BGHITS"].argsJSONTypes  = "S";
 
+	optMap["PILEUP_LIBRARY_OUTPUT"].args = "no";
+	optMap["PILEUP_LIBRARY_OUTPUT"].help = "Writes the hits of each event to a luminosity pileup library\n";
+	optMap["PILEUP_LIBRARY_OUTPUT"].help += "      Each event is a library bunch: run with the luminosity beam only, and a LUMI_EVENT time window equal to the bunch time.\n";
+	optMap["PILEUP_LIBRARY_OUTPUT"].help += "      example: -PILEUP_LIBRARY_OUTPUT=\"pileup.lib\" \n";
+	optMap["PILEUP_LIBRARY_OUTPUT"].name = "Writes the hits of each event to a luminosity pileup library";
+	optMap["PILEUP_LIBRARY_OUTPUT"].type = 1;
+	optMap["PILEUP_LIBRARY_OUTPUT"].ctgr = "luminosity";
+	optMap["PILEUP_LIBRARY_OUTPUT"].argsJSONDescription  = "pileupLibraryFilename";
+	optMap["PILEUP_LIBRARY_OUTPUT"].argsJSONTypes  = "S";
+
+	optMap["PILEUP_LIBRARY"].args = "no";
+	optMap["PILEUP_LIBRARY"].help = "Overlays to each event the hits of bunches drawn from a luminosity pileup library\n";
+	optMap["PILEUP_LIBRARY"].help += "      The bunches are shifted by the LUMI_EVENT bunch time. By default they fill the LUMI_EVENT time window.\n";
+	optMap["PILEUP_LIBRARY"].help += "      The number of bunches can be given after the filename.\n";
+	optMap["PILEUP_LIBRARY"].help += "      LUMI_EVENT must have 0 particles, otherwise the luminosity beam is also tracked in each event.\n";
+	optMap["PILEUP_LIBRARY"].help += "      The library hits are merged with the event hits of the same element and time window.\n";
+	optMap["PILEUP_LIBRARY"].help += "      Their track IDs are negative: -(bunch index * 10000000 + library track ID).\n";
+	optMap["PILEUP_LIBRARY"].help += "      example: -PILEUP_LIBRARY=\"pileup.lib, 124\" \n";
+	optMap["PILEUP_LIBRARY"].name = "Overlays bunches from a luminosity pileup library";
+	optMap["PILEUP_LIBRARY"].type = 1;
+	optMap["PILEUP_LIBRARY"].ctgr = "luminosity";
+	optMap["PILEUP_LIBRARY"].argsJSONDescription  = "pileupLibraryFilename, nbunches";
+	optMap["PILEUP_LIBRARY"].argsJSONTypes  = "S F";
+
 	optMap["NGENP"].arg  = 10;
 	optMap["NGENP"].help = "Max Number of Generated Particles to save in the Output.";
 	optMap["NGENP"].name = "Max Number of Generated Particles to save in the Output";
@@ -651,6 +686,25 @@ void goptions::setGoptions()
 	optMap["MAX_Z_POS"].type = 0;
 	optMap["MAX_Z_POS"].ctgr = "control";
 	
+	optMap["MAX_STEPS"].arg  = 10000;
+	optMap["MAX_STEPS"].help = "Max number of steps of a track. Beyond this the track will be killed. Default is 10000.";
+	optMap["MAX_STEPS"].name = "Max number of steps of a track. Beyond this the track will be killed.";
+	optMap["MAX_STEPS"].type = 0;
+	optMap["MAX_STEPS"].ctgr = "control";
+	
+	optMap["MAX_OPTICAL_STEPS"].arg  = 100;
+	optMap["MAX_OPTICAL_STEPS"].help = "Max number of steps of an optical photon. Beyond this the photon will be killed. Default is 100.";
+	optMap["MAX_OPTICAL_STEPS"].name = "Max number of steps of an optical photon. Beyond this the photon will be killed.";
+	optMap["MAX_OPTICAL_STEPS"].type = 0;
+	optMap["MAX_OPTICAL_STEPS"].ctgr = "control";
+	
+	optMap["KILL_VOLUMES"].args = "no";
+	optMap["KILL_VOLUMES"].help = "Comma separated list of volumes: tracks entering these volumes or their daughters are killed.\n";
+	optMap["KILL_VOLUMES"].help += "      Example: -KILL_VOLUMES=\"beamDump, shieldWall\"\n";
+	optMap["KILL_VOLUMES"].name = "Tracks entering these volumes are killed";
+	optMap["KILL_VOLUMES"].type = 1;
+	optMap["KILL_VOLUMES"].ctgr = "control";
+	
 	optMap["DAWN_N"].arg = 0;
 	optMap["DAWN_N"].name = "Number of events to be displayed with the DAWN driver (also activate the DAWN driver)";
 	optMap["DAWN_N"].help = "Number of events to be displayed with the DAWN driver (also activate the DAWN driver).";
@@ -698,6 +752,31 @@ void goptions::setGoptions()
 	optMap["RECORD_OPTICALPHOTONS"].type = 0;
 	optMap["RECORD_OPTICALPHOTONS"].ctgr = "control";
 
+	optMap["OPTICAL_MAP"].args = "no";
+	optMap["OPTICAL_MAP"].name = "Optical photons fast simulation map";
+	optMap["OPTICAL_MAP"].help = "Optical photon map file written by an OPTICAL_MAP_CALIBRATION run.\n";
+	optMap["OPTICAL_MAP"].help += "      The optical photons are killed at creation and each readout channel gets a hit with\n";
+	optMap["OPTICAL_MAP"].help += "      a number of photoelectrons drawn from the map expected value. Default is \"no\".\n";
+	optMap["OPTICAL_MAP"].help += "      Example: -OPTICAL_MAP=\"htcc.opticalmap\"\n";
+	optMap["OPTICAL_MAP"].type = 1;
+	optMap["OPTICAL_MAP"].ctgr = "control";
+
+	optMap["OPTICAL_MAP_CALIBRATION"].args = "no";
+	optMap["OPTICAL_MAP_CALIBRATION"].name = "Writes the optical photons fast simulation map";
+	optMap["OPTICAL_MAP_CALIBRATION"].help = "The optical photons are tracked and, at the end of the run, the probability of each\n";
+	optMap["OPTICAL_MAP_CALIBRATION"].help += "      readout channel to detect a photon created in each position and direction cell\n";
+	optMap["OPTICAL_MAP_CALIBRATION"].help += "      is written to this file. Sets RECORD_OPTICALPHOTONS to 1. Default is \"no\".\n";
+	optMap["OPTICAL_MAP_CALIBRATION"].help += "      Example: -OPTICAL_MAP_CALIBRATION=\"htcc.opticalmap\"\n";
+	optMap["OPTICAL_MAP_CALIBRATION"].type = 1;
+	optMap["OPTICAL_MAP_CALIBRATION"].ctgr = "control";
+
+	optMap["OPTICAL_MAP_BINNING"].args = "10*mm, 20, 36";
+	optMap["OPTICAL_MAP_BINNING"].name = "Optical photon map binning";
+	optMap["OPTICAL_MAP_BINNING"].help = "Cell size, number of cos(theta) bins and number of phi bins of the optical photon map\n";
+	optMap["OPTICAL_MAP_BINNING"].help += "      written by OPTICAL_MAP_CALIBRATION. Default is \"10*mm, 20, 36\".\n";
+	optMap["OPTICAL_MAP_BINNING"].type = 1;
+	optMap["OPTICAL_MAP_BINNING"].ctgr = "control";
+
 	optMap["RECORD_MIRRORS"].arg = 0;
 	optMap["RECORD_MIRRORS"].name = "Set to one if you want to save mirror hits in the output";
 	optMap["RECORD_MIRRORS"].help = "Set to one if you want to save mirror hits in the output. Default is 0.\n";
@@ -755,6 +834,43 @@ void goptions::setGoptions()
 	optMap["DIGITIZATION_TIMESTAMP"].type = 1;
 	optMap["DIGITIZATION_TIMESTAMP"].ctgr = "control";
 
+	optMap["CCDB_CACHE"].args = "no";
+	optMap["CCDB_CACHE"].name = "Local cache of the CCDB constants";
+	optMap["CCDB_CACHE"].help = "Local cache of the CCDB constants used in the digitization routines.\n";
+	optMap["CCDB_CACHE"].help += "Each table is stored in this directory, keyed by connection, table, run number, variation and timestamp.\n";
+	optMap["CCDB_CACHE"].help += "Jobs finding all their tables in the cache do not connect to the database.\n";
+	optMap["CCDB_CACHE"].help += "  no: the tables are only shared in memory by the threads of the job (default)\n";
+	optMap["CCDB_CACHE"].help += "  <directory>: the tables are read from and written to this directory\n";
+	optMap["CCDB_CACHE"].help += "Without DIGITIZATION_TIMESTAMP the cached tables are not refreshed when the database changes: remove the directory to update them.\n";
+	optMap["CCDB_CACHE"].type = 1;
+	optMap["CCDB_CACHE"].ctgr = "control";
+
+	optMap["CCDB_PREFETCH"].args = "no";
+	optMap["CCDB_PREFETCH"].name = "Fill the CCDB cache for a list of runs and exit";
+	optMap["CCDB_PREFETCH"].help = "Fill the CCDB cache for a list of runs and exit.\n";
+	optMap["CCDB_PREFETCH"].help += "The digitization routines of the sensitive detectors are initialized for each run, and their constants written to CCDB_CACHE.\n";
+	optMap["CCDB_PREFETCH"].help += "Example: -CCDB_CACHE=ccdbCache -CCDB_PREFETCH=\"11, 5038, 6150\"\n";
+	optMap["CCDB_PREFETCH"].type = 1;
+	optMap["CCDB_PREFETCH"].ctgr = "control";
+
+	optMap["SAVE_GEOMETRY_SNAPSHOT"].args = "no";
+	optMap["SAVE_GEOMETRY_SNAPSHOT"].name = "Write the detectors, materials, mirrors, parameters and banks to a snapshot file";
+	optMap["SAVE_GEOMETRY_SNAPSHOT"].help = "Write the detectors, materials, mirrors, parameters and banks built by the factories to a binary snapshot file.\n";
+	optMap["SAVE_GEOMETRY_SNAPSHOT"].help += "Jobs with the same configuration can load it with LOAD_GEOMETRY_SNAPSHOT.\n";
+	optMap["SAVE_GEOMETRY_SNAPSHOT"].help += "Example: -SAVE_GEOMETRY_SNAPSHOT=clas12.gsnap\n";
+	optMap["SAVE_GEOMETRY_SNAPSHOT"].type = 1;
+	optMap["SAVE_GEOMETRY_SNAPSHOT"].ctgr = "control";
+
+	optMap["LOAD_GEOMETRY_SNAPSHOT"].args = "no";
+	optMap["LOAD_GEOMETRY_SNAPSHOT"].name = "Load the detectors, materials, mirrors, parameters and banks from a snapshot file";
+	optMap["LOAD_GEOMETRY_SNAPSHOT"].help = "Load the detectors, materials, mirrors, parameters and banks from a snapshot file written by SAVE_GEOMETRY_SNAPSHOT.\n";
+	optMap["LOAD_GEOMETRY_SNAPSHOT"].help += "The factories are not run. CAD and GDML files are still read when the geometry is built.\n";
+	optMap["LOAD_GEOMETRY_SNAPSHOT"].help += "If the snapshot is missing or was built with a different gcard configuration, the factories are used.\n";
+	optMap["LOAD_GEOMETRY_SNAPSHOT"].help += "The snapshot is not checked against changes in the TEXT files or databases: it must be written again when they change.\n";
+	optMap["LOAD_GEOMETRY_SNAPSHOT"].help += "Example: -LOAD_GEOMETRY_SNAPSHOT=clas12.gsnap\n";
+	optMap["LOAD_GEOMETRY_SNAPSHOT"].type = 1;
+	optMap["LOAD_GEOMETRY_SNAPSHOT"].ctgr = "control";
+
 	optMap["HARDWARESTATUS"].arg  = 0;
 	optMap["HARDWARESTATUS"].name = "Accounts for hardware status";
 	optMap["HARDWARESTATUS"].help = "Accounts for hardware status\n";
@@ -785,6 +901,14 @@ void goptions::setGoptions()
 	optMap["OUTPUT"].name = "Type of output, output filename. ";
 	optMap["OUTPUT"].type = 1;
 	optMap["OUTPUT"].ctgr = "output";
+
+	optMap["OUTPUT_QUEUE"].arg  = 2;
+	optMap["OUTPUT_QUEUE"].help = "Number of hipo event buffers handed to the output writer thread. Default: 2 (double buffering)\n";
+	optMap["OUTPUT_QUEUE"].help += "The writer thread compresses and writes the events while the event threads keep tracking.\n";
+	optMap["OUTPUT_QUEUE"].help += "The event threads wait when all buffers are in flight. 0: events are written by the event threads.\n";
+	optMap["OUTPUT_QUEUE"].name = "Number of hipo event buffers handed to the output writer thread";
+	optMap["OUTPUT_QUEUE"].type = 0;
+	optMap["OUTPUT_QUEUE"].ctgr = "output";
 	
 	optMap["INTEGRATEDRAW"].args = "no";
 	optMap["INTEGRATEDRAW"].help = "Activates integrated geant4 true info output for system(s). Example: -INTEGRATEDRAW=\"dc, ftof\"";
@@ -857,6 +981,15 @@ void goptions::setGoptions()
 	optMap["FILTER_HIGHMOM"].name = "If set to non-0 (or >1), do not write output if there are no  high mom hit";
 	optMap["FILTER_HIGHMOM"].type = 0;
 	optMap["FILTER_HIGHMOM"].ctgr = "output";
+
+	optMap["PROFILE"].arg = 0;
+	optMap["PROFILE"].help = "Profiles the CPU and wall time spent by each sensitive detector in each event processing stage:\n";
+	optMap["PROFILE"].help += "      steps, background merging, true info, digitization, voltage signals and output.\n";
+	optMap["PROFILE"].help += "      1: prints the per-detector table at the end of the run.\n";
+	optMap["PROFILE"].help += "      2: also writes the per-event profile bank, with the peak resident memory.\n";
+	optMap["PROFILE"].name = "Per-detector CPU and wall time profile. 1: end of run table. 2: also the per-event bank";
+	optMap["PROFILE"].type = 0;
+	optMap["PROFILE"].ctgr = "output";
 	
 	// sampling time of electronics (typically FADC), and number of sampling / event
 	// the VT output is sampled every TSAMPLING nanoseconds to produce a ADC
@@ -883,7 +1016,16 @@ void goptions::setGoptions()
 	optMap["RERUN_SELECTED"].name  = "Rerun saved events";
 	optMap["RERUN_SELECTED"].type  = 1;
 	optMap["RERUN_SELECTED"].ctgr  = "control";
-	
+
+	optMap["NTHREADS"].arg   = 1;
+	optMap["NTHREADS"].help  = "Number of event processing threads. Requires a multithreaded Geant4 build and USE_GUI=0.\n";
+	optMap["NTHREADS"].help += "      1: sequential mode (default)\n";
+	optMap["NTHREADS"].help += "      N: N worker threads. Events are numbered by their Geant4 event ID.\n";
+	optMap["NTHREADS"].help += "      Falls back to sequential mode for BEAGLE/StdHep input, MERGE_LUND_BG, SAVE_SELECTED, RERUN_SELECTED and SAVE_ALL_MOTHERS > 1\n";
+	optMap["NTHREADS"].name  = "Number of event processing threads";
+	optMap["NTHREADS"].type  = 0;
+	optMap["NTHREADS"].ctgr  = "control";
+
 
 
 
@@ -994,11 +1136,24 @@ void goptions::setGoptions()
 
 	optMap["G4FIELDCACHESIZE"].arg  = 3;
 	optMap["G4FIELDCACHESIZE"].help = "Sets Geant4 Magnetic Field Cache Size (in mm) \n";
+	optMap["G4FIELDCACHESIZE"].help += "The field manager of each mapped field reuses the last value of its thread for points closer than this distance. \n";
+	optMap["G4FIELDCACHESIZE"].help += "The cache hit rate is printed at the end of the run. 0 disables the cache. \n";
 	optMap["G4FIELDCACHESIZE"].name = "Sets Geant4 Magnetic Field Cache Size (in mm). ";
 	optMap["G4FIELDCACHESIZE"].type = 1;
 	optMap["G4FIELDCACHESIZE"].ctgr = "fields";
 	optMap["G4FIELDCACHESIZE"].repe  = 0;
 
+	optMap["FIELD_MAP_CACHE"].args = "no";
+	optMap["FIELD_MAP_CACHE"].help = "Binary cache of the ascii field maps. \n";
+	optMap["FIELD_MAP_CACHE"].help += "The map is parsed once and written to a binary cache, which is memory mapped by the following runs.\n";
+	optMap["FIELD_MAP_CACHE"].help += "  no: the map is parsed at every run (default)\n";
+	optMap["FIELD_MAP_CACHE"].help += "  yes: the cache is written next to the map, as <map>.gcache. The map directory must be writable\n";
+	optMap["FIELD_MAP_CACHE"].help += "  <directory>: the cache is written in this directory, for example a user cache directory\n";
+	optMap["FIELD_MAP_CACHE"].name = "Binary cache of the ascii field maps";
+	optMap["FIELD_MAP_CACHE"].type = 1;
+	optMap["FIELD_MAP_CACHE"].ctgr = "fields";
+	optMap["FIELD_MAP_CACHE"].repe  = 0;
+
 	optMap["PHYS_VERBOSITY"].arg = 0;
 	optMap["PHYS_VERBOSITY"].help = "Physics List Verbosity";
 	optMap["PHYS_VERBOSITY"].name = "Physics List Verbosity";
@@ -0,0 +1,409 @@
+// gemc headers
+#include "geometrySnapshot.h"
+
+// C++ headers
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+using namespace std;
+
+// the snapshot is a sequence of fixed size numbers and length prefixed strings and containers,
+// written in the machine byte order: it is meant to be reused on the same farm architecture
+namespace {
+	const string snapshotHeader = "GEMC_GEOMETRY_SNAPSHOT";
+
+	// to be increased every time the content of the classes stored changes
+	const int snapshotVersion = 1;
+
+	void put(ostream &out, int v)    { out.write((const char*) &v, sizeof(v)); }
+	void put(ostream &out, double v) { out.write((const char*) &v, sizeof(v)); }
+	void put(ostream &out, bool v)   { put(out, (int) v); }
+	void put(ostream &out, const string &s) {
+		put(out, (int) s.size());
+		out.write(s.data(), s.size());
+	}
+
+	bool get(istream &in, int &v)    { return (bool) in.read((char*) &v, sizeof(v)); }
+	bool get(istream &in, double &v) { return (bool) in.read((char*) &v, sizeof(v)); }
+	bool get(istream &in, bool &v) {
+		int i = 0;
+		if(!get(in, i)) return false;
+		v = i != 0;
+		return true;
+	}
+	bool get(istream &in, string &s) {
+		int size = 0;
+		if(!get(in, size) || size < 0) return false;
+		s.resize(size);
+		return size == 0 || (bool) in.read(&s[0], size);
+	}
+
+	// classes stored in the snapshot
+	void put(ostream &out, const G4ThreeVector &v);
+	void put(ostream &out, const G4RotationMatrix &r);
+	void put(ostream &out, const G4VisAttributes &v);
+	void put(ostream &out, const identifier &i);
+	void put(ostream &out, const detector &d);
+	void put(ostream &out, const material &m);
+	void put(ostream &out, const mirror &m);
+	void put(ostream &out, const gBankColumn &c);
+	void put(ostream &out, const gBank &b);
+
+	bool get(istream &in, G4ThreeVector &v);
+	bool get(istream &in, G4RotationMatrix &r);
+	bool get(istream &in, G4VisAttributes &v);
+	bool get(istream &in, identifier &i);
+	bool get(istream &in, detector &d);
+	bool get(istream &in, material &m);
+	bool get(istream &in, mirror &m);
+	bool get(istream &in, gBankColumn &c);
+	bool get(istream &in, gBank &b);
+
+	template <class T> void put(ostream &out, const vector<T> &v) {
+		put(out, (int) v.size());
+		for(auto &e : v) put(out, e);
+	}
+
+	template <class K, class T> void put(ostream &out, const map<K, T> &m) {
+		put(out, (int) m.size());
+		for(auto &e : m) {
+			put(out, e.first);
+			put(out, e.second);
+		}
+	}
+
+	template <class T> bool get(istream &in, vector<T> &v) {
+		int size = 0;
+		if(!get(in, size) || size < 0) return false;
+		v.clear();
+		v.reserve(size);
+		for(int i=0; i<size; i++) {
+			T e;
+			if(!get(in, e)) return false;
+			v.push_back(std::move(e));
+		}
+		return true;
+	}
+
+	template <class K, class T> bool get(istream &in, map<K, T> &m) {
+		int size = 0;
+		if(!get(in, size) || size < 0) return false;
+		m.clear();
+		for(int i=0; i<size; i++) {
+			K key;
+			if(!get(in, key) || !get(in, m[key])) return false;
+		}
+		return true;
+	}
+
+	void put(ostream &out, const G4ThreeVector &v) {
+		put(out, v.x());
+		put(out, v.y());
+		put(out, v.z());
+	}
+
+	bool get(istream &in, G4ThreeVector &v) {
+		double x, y, z;
+		if(!get(in, x) || !get(in, y) || !get(in, z)) return false;
+		v.set(x, y, z);
+		return true;
+	}
+
+	// the nine elements are restored as they are, without orthonormalization
+	void put(ostream &out, const G4RotationMatrix &r) {
+		put(out, r.xx()); put(out, r.xy()); put(out, r.xz());
+		put(out, r.yx()); put(out, r.yy()); put(out, r.yz());
+		put(out, r.zx()); put(out, r.zy()); put(out, r.zz());
+	}
+
+	bool get(istream &in, G4RotationMatrix &r) {
+		double e[9];
+		for(int i=0; i<9; i++)
+			if(!get(in, e[i])) return false;
+
+		r.set(CLHEP::HepRep3x3(e));
+		return true;
+	}
+
+	void put(ostream &out, const G4VisAttributes &v) {
+		const G4Colour &c = v.GetColour();
+		put(out, c.GetRed());
+		put(out, c.GetGreen());
+		put(out, c.GetBlue());
+		put(out, c.GetAlpha());
+		put(out, v.IsVisible());
+		put(out, v.IsForceDrawingStyle());
+		put(out, (int) v.GetForcedDrawingStyle());
+	}
+
+	bool get(istream &in, G4VisAttributes &v) {
+		double r, g, b, a;
+		bool visible, forced;
+		int style;
+		if(!get(in, r) || !get(in, g) || !get(in, b) || !get(in, a)) return false;
+		if(!get(in, visible) || !get(in, forced) || !get(in, style)) return false;
+
+		v = G4VisAttributes(G4Colour(r, g, b, a));
+		v.SetVisibility(visible);
+		if(forced)
+			style == G4VisAttributes::solid ? v.SetForceSolid(true) : v.SetForceWireframe(true);
+
+		return true;
+	}
+
+	void put(ostream &out, const identifier &i) {
+		put(out, i.name);
+		put(out, i.rule);
+		put(out, i.id);
+		put(out, i.time);
+		put(out, i.TimeWindow);
+		put(out, i.TrackId);
+		put(out, i.id_sharing);
+		put(out, i.geantinoDepe);
+		put(out, i.userInfos);
+	}
+
+	bool get(istream &in, identifier &i) {
+		return get(in, i.name) && get(in, i.rule) && get(in, i.id) && get(in, i.time) && get(in, i.TimeWindow)
+		&& get(in, i.TrackId) && get(in, i.id_sharing) && get(in, i.geantinoDepe) && get(in, i.userInfos);
+	}
+
+	// the G4 volumes pointers are not stored: they are built by MDetectorConstruction
+	void put(ostream &out, const detector &d) {
+		put(out, d.name);
+		put(out, d.mother);
+		put(out, d.description);
+		put(out, d.pos);
+		put(out, d.rot);
+		put(out, d.VAtts);
+		put(out, d.type);
+		put(out, d.dimensions);
+		put(out, d.material);
+		put(out, d.magfield);
+		put(out, d.ncopy);
+		put(out, d.pMany);
+		put(out, d.exist);
+		put(out, d.visible);
+		put(out, d.style);
+		put(out, d.sensitivity);
+		put(out, d.hitType);
+		put(out, d.identity);
+		put(out, d.scanned);
+		put(out, d.system);
+		put(out, d.factory);
+		put(out, d.variation);
+		put(out, d.run);
+	}
+
+	bool get(istream &in, detector &d) {
+		return get(in, d.name) && get(in, d.mother) && get(in, d.description) && get(in, d.pos) && get(in, d.rot)
+		&& get(in, d.VAtts) && get(in, d.type) && get(in, d.dimensions) && get(in, d.material) && get(in, d.magfield)
+		&& get(in, d.ncopy) && get(in, d.pMany) && get(in, d.exist) && get(in, d.visible) && get(in, d.style)
+		&& get(in, d.sensitivity) && get(in, d.hitType) && get(in, d.identity) && get(in, d.scanned)
+		&& get(in, d.system) && get(in, d.factory) && get(in, d.variation) && get(in, d.run);
+	}
+
+	void put(ostream &out, const material &m) {
+		put(out, m.name);
+		put(out, m.desc);
+		put(out, m.density);
+		put(out, m.ncomponents);
+		put(out, m.components);
+		put(out, m.fracs);
+		put(out, m.photonEnergy);
+		put(out, m.indexOfRefraction);
+		put(out, m.absorptionLength);
+		put(out, m.reflectivity);
+		put(out, m.efficiency);
+		put(out, m.mie);
+		put(out, m.mieforward);
+		put(out, m.miebackward);
+		put(out, m.mieratio);
+		put(out, m.fastcomponent);
+		put(out, m.slowcomponent);
+		put(out, m.scintillationyield);
+		put(out, m.resolutionscale);
+		put(out, m.fasttimeconstant);
+		put(out, m.slowtimeconstant);
+		put(out, m.yieldratio);
+		put(out, m.rayleigh);
+		put(out, m.birkConstant);
+	}
+
+	bool get(istream &in, material &m) {
+		return get(in, m.name) && get(in, m.desc) && get(in, m.density) && get(in, m.ncomponents)
+		&& get(in, m.components) && get(in, m.fracs) && get(in, m.photonEnergy) && get(in, m.indexOfRefraction)
+		&& get(in, m.absorptionLength) && get(in, m.reflectivity) && get(in, m.efficiency) && get(in, m.mie)
+		&& get(in, m.mieforward) && get(in, m.miebackward) && get(in, m.mieratio)
+		&& get(in, m.fastcomponent) && get(in, m.slowcomponent) && get(in, m.scintillationyield)
+		&& get(in, m.resolutionscale) && get(in, m.fasttimeconstant) && get(in, m.slowtimeconstant)
+		&& get(in, m.yieldratio) && get(in, m.rayleigh) && get(in, m.birkConstant);
+	}
+
+	void put(ostream &out, const mirror &m) {
+		put(out, m.name);
+		put(out, m.desc);
+		put(out, m.type);
+		put(out, m.finish);
+		put(out, m.model);
+		put(out, m.border);
+		put(out, m.sigmaAlpha);
+		put(out, m.maptOptProps);
+		put(out, m.photonEnergy);
+		put(out, m.indexOfRefraction);
+		put(out, m.reflectivity);
+		put(out, m.efficiency);
+		put(out, m.specularlobe);
+		put(out, m.specularspike);
+		put(out, m.backscatter);
+	}
+
+	bool get(istream &in, mirror &m) {
+		return get(in, m.name) && get(in, m.desc) && get(in, m.type) && get(in, m.finish) && get(in, m.model)
+		&& get(in, m.border) && get(in, m.sigmaAlpha) && get(in, m.maptOptProps) && get(in, m.photonEnergy)
+		&& get(in, m.indexOfRefraction) && get(in, m.reflectivity) && get(in, m.efficiency)
+		&& get(in, m.specularlobe) && get(in, m.specularspike) && get(in, m.backscatter);
+	}
+
+	void put(ostream &out, const gBankColumn &c) {
+		put(out, c.name);
+		put(out, c.gid);
+		put(out, c.varType);
+		put(out, c.bankType);
+	}
+
+	bool get(istream &in, gBankColumn &c) {
+		return get(in, c.name) && get(in, c.gid) && get(in, c.varType) && get(in, c.bankType);
+	}
+
+	void put(ostream &out, const gBank &b) {
+		put(out, b.idtag);
+		put(out, b.bdescription);
+		put(out, b.bankName);
+		put(out, b.name);
+		put(out, b.gid);
+		put(out, b.type);
+		put(out, b.description);
+		put(out, b.orderedNames);
+		put(out, b.columns);
+	}
+
+	bool get(istream &in, gBank &b) {
+		return get(in, b.idtag) && get(in, b.bdescription) && get(in, b.bankName) && get(in, b.name) && get(in, b.gid)
+		&& get(in, b.type) && get(in, b.description) && get(in, b.orderedNames) && get(in, b.columns);
+	}
+}
+
+geometrySnapshot::geometrySnapshot(goptions gemcOpt, runConditions rc)
+{
+	stringstream conf;
+
+	// gcard detectors
+	for(auto &dc : rc.detectorConditionsMap) {
+		conf << dc.first << " " << dc.second.get_factory() << " " << dc.second.get_variation() << " "
+		<< dc.second.get_run_number() << " " << dc.second.get_existance() << " "
+		<< dc.second.get_position() << " " << dc.second.get_vrotation() << endl;
+	}
+
+	// options used by the factories
+	vector<string> factoryOptions = {"HALL_MATERIAL", "HALL_FIELD", "HALL_DIMENSIONS", "NO_FIELD", "REMOVESENSITIVITY", "DATABASE", "RUNNO"};
+	for(auto &opt : factoryOptions) {
+		conf << opt << " " << gemcOpt.optMap[opt].args << " " << gemcOpt.optMap[opt].arg << endl;
+	}
+	for(auto &opt : gemcOpt.getArgs("CHANGEVOLUMEMATERIALTO")) {
+		conf << "CHANGEVOLUMEMATERIALTO " << opt.args << endl;
+	}
+
+	// the TEXT factories look for files in GEMC_DATA_DIR
+	if(getenv("GEMC_DATA_DIR") != nullptr) {
+		conf << "GEMC_DATA_DIR " << getenv("GEMC_DATA_DIR") << endl;
+	}
+
+	configuration = conf.str();
+}
+
+bool geometrySnapshot::save(string filename)
+{
+	ofstream out(filename.c_str(), ios::binary);
+	if(!out) {
+		cout << "  !!! Warning: geometry snapshot " << filename << " can't be written." << endl;
+		return false;
+	}
+
+	put(out, snapshotHeader);
+	put(out, snapshotVersion);
+	put(out, configuration);
+	put(out, hallMap);
+	put(out, materialRecords);
+
+	put(out, (int) mirrors.size());
+	for(auto &m : mirrors) {
+		put(out, m.first);
+		put(out, *m.second);
+	}
+
+	put(out, parameters);
+	put(out, banks);
+
+	out.close();
+	if(!out) {
+		cout << "  !!! Warning: geometry snapshot " << filename << " can't be written." << endl;
+		return false;
+	}
+
+	cout << "  > Geometry snapshot written to " << filename << ": " << hallMap.size() << " volumes, "
+	<< mirrors.size() << " mirrors, " << parameters.size() << " parameters, " << banks.size() << " banks." << endl;
+
+	return true;
+}
+
+bool geometrySnapshot::load(string filename)
+{
+	ifstream in(filename.c_str(), ios::binary);
+	if(!in) {
+		cout << "  !!! Warning: geometry snapshot " << filename << " not found. Running the factories." << endl;
+		return false;
+	}
+
+	string header, fileConfiguration;
+	int version = 0;
+	if(!get(in, header) || header != snapshotHeader || !get(in, version) || version != snapshotVersion) {
+		cout << "  !!! Warning: " << filename << " is not a geometry snapshot of version " << snapshotVersion << ". Running the factories." << endl;
+		return false;
+	}
+
+	if(!get(in, fileConfiguration) || fileConfiguration != configuration) {
+		cout << "  !!! Warning: geometry snapshot " << filename << " was built with a different configuration. Running the factories." << endl;
+		return false;
+	}
+
+	bool loaded = get(in, hallMap) && get(in, materialRecords);
+
+	int nmirrors = 0;
+	loaded = loaded && get(in, nmirrors) && nmirrors >= 0;
+	for(int i=0; loaded && i<nmirrors; i++) {
+		string name;
+		mirror *m = new mirror();
+		loaded = get(in, name) && get(in, *m);
+		mirrors[name] = m;
+	}
+
+	loaded = loaded && get(in, parameters) && get(in, banks);
+
+	if(!loaded) {
+		cout << "  !!! Warning: geometry snapshot " << filename << " is incomplete. Running the factories." << endl;
+		for(auto &m : mirrors) delete m.second;
+		hallMap.clear();
+		materialRecords.clear();
+		mirrors.clear();
+		parameters.clear();
+		banks.clear();
+		return false;
+	}
+
+	cout << "  > Geometry loaded from snapshot " << filename << ": " << hallMap.size() << " volumes, "
+	<< mirrors.size() << " mirrors, " << parameters.size() << " parameters, " << banks.size() << " banks." << endl;
+
+	return true;
+}
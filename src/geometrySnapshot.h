@@ -0,0 +1,56 @@
+/// \file geometrySnapshot.h
+/// Defines the geometry snapshot.\n
+/// The snapshot is the output of the detector, material, mirror,
+/// parameter factories and of the banks definitions, written to a binary file
+/// with SAVE_GEOMETRY_SNAPSHOT. Jobs with the same configuration load it with
+/// LOAD_GEOMETRY_SNAPSHOT instead of parsing the TEXT files and querying the databases.\n
+/// The snapshot stores the configuration it was built with (gcard detectors,
+/// variations, run numbers, displacements and the options modifying the volumes):
+/// a snapshot built with a different configuration is ignored.\n
+/// CAD and GDML files are still read when the geometry is constructed.\n
+
+#ifndef GEOMETRY_SNAPSHOT_H
+#define GEOMETRY_SNAPSHOT_H 1
+
+// gemc headers
+#include "detector.h"
+#include "material_factory.h"
+#include "mirrors_factory.h"
+#include "gbank.h"
+#include "gemcOptions.h"
+#include "run_conditions.h"
+
+// C++ headers
+#include <map>
+#include <string>
+using namespace std;
+
+
+/// \class geometrySnapshot
+/// <b> geometrySnapshot </b>\n\n
+/// Materials are stored as the records read by the MYSQL, TEXT and SQLITE
+/// material factories: the G4 materials are built from them at load time.
+class geometrySnapshot
+{
+public:
+	geometrySnapshot(goptions, runConditions);
+
+	map<string, detector>                  hallMap;          ///< detectors built by all factories, including "root"
+	map<string, map<string, material> >    materialRecords;  ///< factory > material records
+	map<string, mirror*>                   mirrors;
+	map<string, double>                    parameters;
+	map<string, gBank>                     banks;
+
+	/// writes the snapshot. Returns false if the file can't be written
+	bool save(string filename);
+
+	/// loads the snapshot. Returns false if the file can't be read,
+	/// has a different version or was built with a different configuration
+	bool load(string filename);
+
+private:
+	string configuration;   ///< configuration the snapshot is built with
+};
+
+
+#endif
@@ -0,0 +1,490 @@
+// gemc headers
+#include "lundReader.h"
+#include "string_utilities.h"
+
+// C++ headers
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <set>
+using namespace std;
+
+// system headers
+#include <sys/stat.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#else
+#include <process.h>
+#define getpid _getpid
+#endif
+
+// the cache is a header, the events and their index, written in the machine byte order:
+// header:  magic, version, text file size and modification time
+// event:   flags, nheader, header, nparticles, for each particle: ncolumns, columns
+// footer:  index (offset of each event), number of events, index offset, end magic
+namespace {
+	const char cacheMagic[8]    = {'G', 'E', 'M', 'C', 'L', 'U', 'N', 'D'};
+	const char cacheEndMagic[8] = {'L', 'U', 'N', 'D', 'E', 'N', 'D', '.'};
+
+	// to be increased every time the cache format changes
+	const uint32_t cacheVersion = 1;
+
+	const size_t cacheHeaderSize = 8 + sizeof(uint32_t) + 2*sizeof(uint64_t);
+	const size_t cacheFooterSize = 2*sizeof(uint64_t) + 8;
+
+	const uint8_t truncatedFlag = 1;
+	const uint8_t endOfFileFlag = 2;
+
+	// only one reader per process writes the cache of a file
+	mutex cacheWritersMutex;
+	set<string> cacheWriters;
+
+	bool fileStat(const string &filename, uint64_t &size, uint64_t &mtime)
+	{
+		struct stat st;
+		if(stat(filename.c_str(), &st) != 0) return false;
+		size  = (uint64_t) st.st_size;
+		mtime = (uint64_t) st.st_mtime;
+		return true;
+	}
+
+	template <class T> void put(FILE *out, const T &v) { fwrite(&v, sizeof(T), 1, out); }
+
+	template <class T> T get(const char *&p)
+	{
+		T v;
+		memcpy(&v, p, sizeof(T));
+		p += sizeof(T);
+		return v;
+	}
+
+	inline bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f'; }
+
+	// same characters accepted by scan_number
+	inline bool isNumberChar(char c) { return (c >= '0' && c <= '9') || c == '.' || c == '+' || c == '-' || c == 'e' || c == 'E'; }
+
+	// plain numbers are converted directly. Anything else goes through get_number,
+	// which also handles the incomplete numbers the same way stringstream does
+	double decodeToken(const char *begin, const char *end)
+	{
+		bool plain = true;
+		for(const char *c = begin; c < end; c++) {
+			if(!isNumberChar(*c)) {
+				plain = false;
+				break;
+			}
+		}
+
+		if(plain && end - begin < 64) {
+			char token[64];
+			memcpy(token, begin, end - begin);
+			token[end - begin] = 0;
+			char *tokenEnd;
+			double value = strtod(token, &tokenEnd);
+			if(tokenEnd == token + (end - begin)) return value;
+		}
+
+		return get_number(string(begin, end));
+	}
+
+	// decodes the whitespace separated tokens of a line. If first is set only the first token is decoded
+	void decodeLine(const char *begin, const char *end, vector<double> &values, bool first = false)
+	{
+		values.clear();
+		const char *c = begin;
+		while(c < end) {
+			while(c < end && isSpace(*c)) c++;
+			if(c == end) break;
+			const char *tokenBegin = c;
+			while(c < end && !isSpace(*c)) c++;
+			values.push_back(decodeToken(tokenBegin, c));
+			if(first) break;
+		}
+	}
+}
+
+
+lundReader::lundReader(string file, bool useCache, unsigned ringSize) :
+filename(file),
+opened(false),
+atEnd(false),
+data(nullptr),
+size(0),
+fromCache(false),
+textPosition(0),
+textEnded(false),
+cacheEvent(0),
+cacheOut(nullptr),
+ring(ringSize > 0 ? ringSize : 1),
+ringValid(ring.size(), 0),
+produced(0),
+consumed(0),
+skipUntil(0),
+stopHelper(false)
+{
+	uint64_t textSize, textTime;
+	if(!fileStat(filename, textSize, textTime)) return;
+	opened = true;
+
+	if(useCache) {
+		cacheName    = filename + ".lundb";
+		// jobs sharing the input directory write their own temporary cache: the first complete one is renamed
+		cacheTmpName = cacheName + "." + to_string(getpid()) + ".tmp";
+
+		if(openCache()) {
+			fromCache = true;
+			cout << "  > LUND cache " << cacheName << " used for " << filename << ": " << cacheIndex.size() << " events." << endl;
+		} else {
+			lock_guard<mutex> lock(cacheWritersMutex);
+			if(cacheWriters.find(cacheName) == cacheWriters.end()) {
+				cacheOut = fopen(cacheTmpName.c_str(), "wb");
+				if(cacheOut == nullptr) {
+					cout << "  !!! Warning: LUND cache " << cacheTmpName << " can't be written." << endl;
+				} else {
+					cacheWriters.insert(cacheName);
+					fwrite(cacheMagic, 1, 8, cacheOut);
+					put(cacheOut, cacheVersion);
+					put(cacheOut, textSize);
+					put(cacheOut, textTime);
+				}
+			}
+		}
+	}
+
+	if(!fromCache) map(filename);
+
+	helper = thread(&lundReader::produce, this);
+}
+
+lundReader::~lundReader()
+{
+	{
+		lock_guard<mutex> lock(ringMutex);
+		stopHelper = true;
+	}
+	ringNotFull.notify_all();
+	if(helper.joinable()) helper.join();
+
+	// the file was not read until the end
+	if(cacheOut != nullptr) closeCache(false);
+
+	unmap();
+}
+
+void lundReader::map(const string &file)
+{
+	unmap();
+
+#ifndef _WIN32
+	int fd = open(file.c_str(), O_RDONLY);
+	if(fd >= 0) {
+		struct stat st;
+		if(fstat(fd, &st) == 0 && st.st_size > 0) {
+			void *mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if(mapped != MAP_FAILED) {
+				madvise(mapped, st.st_size, MADV_SEQUENTIAL);
+				data = (const char*) mapped;
+				size = st.st_size;
+			}
+		}
+		close(fd);
+		if(data != nullptr) return;
+	}
+#endif
+
+	ifstream in(file.c_str(), ios::binary);
+	fallbackBuffer.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+	data = fallbackBuffer.data();
+	size = fallbackBuffer.size();
+}
+
+void lundReader::unmap()
+{
+#ifndef _WIN32
+	if(data != nullptr && fallbackBuffer.empty()) munmap((void*) data, size);
+#endif
+	fallbackBuffer.clear();
+	data = nullptr;
+	size = 0;
+}
+
+
+// text input
+
+bool lundReader::readLine(const char *&begin, const char *&end, bool &hitEnd)
+{
+	if(textPosition >= size) {
+		textEnded = true;
+		return false;
+	}
+
+	begin = data + textPosition;
+	const char *newLine = (const char*) memchr(begin, '\n', size - textPosition);
+	if(newLine != nullptr) {
+		end = newLine;
+		textPosition = newLine - data + 1;
+		hitEnd = false;
+	} else {
+		end = data + size;
+		textPosition = size;
+		hitEnd = true;
+	}
+	return true;
+}
+
+// same logic as the getline reader: a header without end of line is not an event,
+// a particle line without end of line before the last one makes the event truncated
+bool lundReader::decodeText(lundEvent &event, bool skipOnly)
+{
+	event.particles.clear();
+	event.truncated = false;
+	event.endOfFile = false;
+	event.skipped   = skipOnly;
+
+	const char *begin, *end;
+	bool hitEnd;
+	if(!readLine(begin, end, hitEnd) || hitEnd) return false;
+
+	decodeLine(begin, end, event.header, skipOnly);
+	int nparticles = event.header.size() ? (int) event.header[0] : 0;
+
+	for(int p = 0; p < nparticles; p++) {
+		if(!readLine(begin, end, hitEnd) || (hitEnd && p != nparticles - 1)) {
+			event.truncated = true;
+			return true;
+		}
+		if(!skipOnly) {
+			event.particles.emplace_back();
+			decodeLine(begin, end, event.particles.back());
+		}
+		if(hitEnd) event.endOfFile = true;
+	}
+
+	return true;
+}
+
+
+// cache input
+
+bool lundReader::openCache()
+{
+	uint64_t textSize, textTime;
+	uint64_t cacheSize, cacheTime;
+	if(!fileStat(filename, textSize, textTime) || !fileStat(cacheName, cacheSize, cacheTime)) return false;
+	if(cacheSize < cacheHeaderSize + cacheFooterSize) return false;
+
+	map(cacheName);
+
+	const char *p = data;
+	bool valid = size == cacheSize && memcmp(p, cacheMagic, 8) == 0;
+	p += 8;
+	if(valid) valid = get<uint32_t>(p) == cacheVersion && get<uint64_t>(p) == textSize && get<uint64_t>(p) == textTime;
+
+	if(valid) {
+		const char *f = data + size - cacheFooterSize;
+		uint64_t nevents     = get<uint64_t>(f);
+		uint64_t indexOffset = get<uint64_t>(f);
+		valid = memcmp(f, cacheEndMagic, 8) == 0 && indexOffset >= cacheHeaderSize
+		&& indexOffset + nevents*sizeof(uint64_t) + cacheFooterSize == size;
+
+		if(valid) {
+			cacheIndex.resize(nevents);
+			if(nevents) memcpy(cacheIndex.data(), data + indexOffset, nevents*sizeof(uint64_t));
+		}
+	}
+
+	if(!valid) {
+		cout << "  > LUND cache " << cacheName << " does not match " << filename << " and will be rebuilt." << endl;
+		unmap();
+		cacheIndex.clear();
+	}
+
+	return valid;
+}
+
+bool lundReader::decodeCache(lundEvent &event, bool skipOnly)
+{
+	event.particles.clear();
+	event.skipped = skipOnly;
+
+	if(cacheEvent >= cacheIndex.size()) return false;
+
+	const char *p = data + cacheIndex[cacheEvent++];
+	uint8_t flags   = get<uint8_t>(p);
+	event.truncated = flags & truncatedFlag;
+	event.endOfFile = flags & endOfFileFlag;
+
+	if(skipOnly) return true;
+
+	event.header.resize(get<uint32_t>(p));
+	memcpy(event.header.data(), p, event.header.size()*sizeof(double));
+	p += event.header.size()*sizeof(double);
+
+	event.particles.resize(get<uint32_t>(p));
+	for(auto &particle : event.particles) {
+		particle.resize(get<uint32_t>(p));
+		memcpy(particle.data(), p, particle.size()*sizeof(double));
+		p += particle.size()*sizeof(double);
+	}
+
+	return true;
+}
+
+
+// cache output
+
+void lundReader::writeCacheEvent(const lundEvent &event)
+{
+	cacheOutIndex.push_back((uint64_t) ftell(cacheOut));
+
+	uint8_t flags = (event.truncated ? truncatedFlag : 0) | (event.endOfFile ? endOfFileFlag : 0);
+	put(cacheOut, flags);
+
+	put(cacheOut, (uint32_t) event.header.size());
+	fwrite(event.header.data(), sizeof(double), event.header.size(), cacheOut);
+
+	put(cacheOut, (uint32_t) event.particles.size());
+	for(auto &particle : event.particles) {
+		put(cacheOut, (uint32_t) particle.size());
+		fwrite(particle.data(), sizeof(double), particle.size(), cacheOut);
+	}
+}
+
+void lundReader::closeCache(bool complete)
+{
+	if(complete) {
+		uint64_t indexOffset = (uint64_t) ftell(cacheOut);
+		fwrite(cacheOutIndex.data(), sizeof(uint64_t), cacheOutIndex.size(), cacheOut);
+		put(cacheOut, (uint64_t) cacheOutIndex.size());
+		put(cacheOut, indexOffset);
+		fwrite(cacheEndMagic, 1, 8, cacheOut);
+	}
+
+	bool written = fclose(cacheOut) == 0 && complete;
+	cacheOut = nullptr;
+	cacheOutIndex.clear();
+
+	if(written && rename(cacheTmpName.c_str(), cacheName.c_str()) == 0) {
+		cout << "  > LUND cache " << cacheName << " written." << endl;
+	} else {
+		remove(cacheTmpName.c_str());
+	}
+
+	lock_guard<mutex> lock(cacheWritersMutex);
+	cacheWriters.erase(cacheName);
+}
+
+
+// helper thread
+
+void lundReader::produce()
+{
+	const long ringSize = (long) ring.size();
+	lundEvent event;
+
+	while(true) {
+		{
+			unique_lock<mutex> lock(ringMutex);
+			ringNotFull.wait(lock, [&]{ return stopHelper || (produced - consumed < ringSize && !cacheSkipPending()); });
+			if(stopHelper) return;
+
+			// the ring is empty: the cache events to skip are jumped over, up to the last one,
+			// which is read as usual by skip. The last cache event is always read: it has the end of file flags
+			if(fromCache && produced < skipUntil.load()) {
+				long jump = min(skipUntil.load() - 1 - produced, (long) (cacheIndex.size() - cacheEvent) - 1);
+				if(jump > 0) {
+					cacheEvent += jump;
+					produced   += jump;
+					consumed   += jump;
+				}
+			}
+		}
+
+		// the events to skip are not decoded, unless the cache is being written
+		bool skipOnly = cacheOut == nullptr && produced < skipUntil.load();
+		bool valid = fromCache ? decodeCache(event, skipOnly) : decodeText(event, skipOnly);
+
+		if(cacheOut != nullptr) {
+			if(valid) writeCacheEvent(event);
+			if(!valid || event.truncated) closeCache(true);
+		}
+
+		bool last = !valid || event.truncated;
+
+		{
+			lock_guard<mutex> lock(ringMutex);
+			long slot = produced % ringSize;
+			swap(ring[slot], event);
+			ringValid[slot] = valid;
+			produced++;
+		}
+		ringNotEmpty.notify_one();
+
+		if(last) return;
+	}
+}
+
+bool lundReader::next(lundEvent &event)
+{
+	// nothing is read after the end of the file or a truncated event
+	if(!opened || atEnd) {
+		atEnd = true;
+		return false;
+	}
+
+	unique_lock<mutex> lock(ringMutex);
+	ringNotEmpty.wait(lock, [&]{ return produced > consumed; });
+
+	long slot = consumed % (long) ring.size();
+
+	// the end marker stays in the ring: following calls also return false
+	if(!ringValid[slot]) {
+		atEnd = true;
+		return false;
+	}
+
+	swap(event, ring[slot]);
+	consumed++;
+	lock.unlock();
+	ringNotFull.notify_one();
+
+	if(event.truncated || event.endOfFile) atEnd = true;
+
+	return true;
+}
+
+// with the cache the helper jumps over the skipped events once the ring is empty,
+// moving consumed forward: the events are counted with consumed
+bool lundReader::skip(int n)
+{
+	if(n <= 0) return true;
+
+	long until;
+	{
+		lock_guard<mutex> lock(ringMutex);
+		until = consumed + n;
+		if(until > skipUntil.load()) skipUntil = until;
+	}
+	ringNotFull.notify_one();
+
+	lundEvent event;
+	while(true) {
+		{
+			lock_guard<mutex> lock(ringMutex);
+			if(consumed >= until) break;
+		}
+		if(!next(event)) return false;
+		if(event.truncated) {
+			cout << " Input file " << filename << " appear to be truncated." << endl;
+			return false;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,113 @@
+/// \file lundReader.h
+/// Defines the LUND input reader.\n
+/// The file is memory mapped and decoded by a helper thread into a ring of events:
+/// the generator action only copies the decoded numbers.\n
+/// Each token is decoded as the line by line reader did: numbers made only of digits,
+/// dots, signs and exponents are converted directly, any other token goes through get_number.\n
+/// With LUND_CACHE the decoded events are written to a binary <i>file.lundb</i> cache at the first
+/// complete read. The cache is used instead of the text file while the text file size and
+/// modification time match. Its event index makes skipping events a jump.\n
+
+#ifndef LUND_READER_H
+#define LUND_READER_H 1
+
+// C++ headers
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+using namespace std;
+
+
+/// \class lundEvent
+/// <b> lundEvent </b>\n\n
+/// One decoded LUND event.\n
+/// If the file ends before the last particle line the event is truncated: particles holds the complete lines.\n
+/// endOfFile is set if the last line of the event is also the last line of the file, without end of line.
+class lundEvent
+{
+public:
+	vector<double>          header;
+	vector<vector<double> > particles;
+	bool truncated = false;
+	bool endOfFile = false;
+	bool skipped   = false;   ///< only the event boundaries were read
+};
+
+
+/// \class lundReader
+/// <b> lundReader </b>\n\n
+/// One instance per generator action: worker threads read their own copy of the file.
+class lundReader
+{
+public:
+	lundReader(string filename, bool useCache, unsigned ringSize = 64);
+	~lundReader();
+
+	/// next event. Returns false at the end of the file
+	bool next(lundEvent &event);
+
+	/// skips n events. Returns false if the file ends or is truncated
+	bool skip(int n);
+
+	/// true once the file end was reached, as ifstream::eof after getline
+	bool eof() const {return atEnd;}
+
+	/// false if the file can't be read
+	bool good() const {return opened;}
+
+private:
+	string filename;
+	bool   opened;
+	bool   atEnd;
+
+	// input: the mapped text file or cache
+	const char *data;
+	size_t      size;
+	bool        fromCache;
+	void map(const string &file);
+	void unmap();
+	vector<char> fallbackBuffer;   ///< used when the file can't be mapped
+
+	// text input
+	size_t textPosition;
+	bool   textEnded;
+	bool   readLine(const char *&begin, const char *&end, bool &hitEnd);
+	bool   decodeText(lundEvent &event, bool skipOnly);
+
+	// cache input
+	vector<uint64_t> cacheIndex;
+	size_t           cacheEvent;
+	bool             openCache();
+	bool             decodeCache(lundEvent &event, bool skipOnly);
+
+	// cache output, written by one reader per file
+	string   cacheName;
+	string   cacheTmpName;
+	FILE    *cacheOut;
+	vector<uint64_t> cacheOutIndex;
+	void writeCacheEvent(const lundEvent &event);
+	void closeCache(bool complete);
+
+	// helper thread and ring of decoded events
+	thread                 helper;
+	mutex                  ringMutex;
+	condition_variable     ringNotFull;
+	condition_variable     ringNotEmpty;
+	vector<lundEvent>      ring;
+	vector<char>           ringValid;       ///< 0: the file ended before this slot
+	long                   produced;
+	long                   consumed;
+	atomic<long>           skipUntil;       ///< events before this index are skipped without decoding
+	bool                   stopHelper;
+	void produce();
+
+	// the helper waits for the ring to be empty before jumping over the cache events to skip
+	bool cacheSkipPending() const { return fromCache && produced < skipUntil.load() && produced > consumed; }
+};
+
+
+#endif
@@ -0,0 +1,188 @@
+// gemc headers
+#include "ccdbCache.h"
+
+// ccdb
+#include <CCDB/CalibrationGenerator.h>
+using namespace ccdb;
+
+// C++ headers
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+using namespace std;
+
+// system headers
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+	string cacheDirectory = "no";
+
+	// tables already read by this process, shared by all threads
+	mutex memoryCacheMutex;
+	map<string, vector<vector<double> > > memoryCache;
+
+	atomic<long> nMemoryHits(0);
+	atomic<long> nFileHits(0);
+	atomic<long> nDatabaseReads(0);
+
+	const string cacheFileHeader = "GEMC_CCDB_CACHE 1";
+}
+
+void cachedCalibration::setCacheDirectory(string directory)
+{
+	cacheDirectory = directory;
+
+	if(cacheDirectory == "no") return;
+
+	if(mkdir(cacheDirectory.c_str(), 0755) != 0 && errno != EEXIST) {
+		cout << "  !! Warning: CCDB cache directory " << cacheDirectory << " can't be created. Only the memory cache will be used." << endl;
+		cacheDirectory = "no";
+		return;
+	}
+	cout << "  > CCDB constants cached in " << cacheDirectory << endl;
+}
+
+void cachedCalibration::reportStatistics()
+{
+	long total = nMemoryHits + nFileHits + nDatabaseReads;
+	if(total == 0) return;
+
+	cout << "  > CCDB requests: " << total << ", from memory: " << nMemoryHits << ", from the cache directory: " << nFileHits
+	<< ", from the database: " << nDatabaseReads << endl;
+}
+
+void cachedCalibration::preload(const string &connection, const string &request, const vector<vector<double> > &values)
+{
+	lock_guard<mutex> lock(memoryCacheMutex);
+	memoryCache[connection + " " + request] = values;
+}
+
+bool cachedCalibration::GetCalib(vector<vector<double> > &values, const string &request)
+{
+	string key = connection + " " + request;
+
+	{
+		lock_guard<mutex> lock(memoryCacheMutex);
+		auto table = memoryCache.find(key);
+		if(table != memoryCache.end()) {
+			values = table->second;
+			nMemoryHits++;
+			return true;
+		}
+	}
+
+	if(readCacheFile(key, values)) {
+		nFileHits++;
+	} else {
+		// the connection is only opened when a table is not in the cache
+		if(calib == nullptr) {
+			calib.reset(CalibrationGenerator::CreateCalibration(connection));
+		}
+		if(!calib->GetCalib(values, request)) {
+			return false;
+		}
+		nDatabaseReads++;
+		writeCacheFile(key, values);
+	}
+
+	lock_guard<mutex> lock(memoryCacheMutex);
+	memoryCache[key] = values;
+
+	return true;
+}
+
+// the file name is the FNV-1a hash of the key. The key is stored in the file
+// and checked when reading, so a hash collision is just a cache miss
+string cachedCalibration::cacheFile(const string &key) const
+{
+	unsigned long long hash = 14695981039346656037ULL;
+	for(unsigned char c : key) {
+		hash ^= c;
+		hash *= 1099511628211ULL;
+	}
+
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.ccdb", hash);
+
+	return cacheDirectory + "/" + name;
+}
+
+bool cachedCalibration::readCacheFile(const string &key, vector<vector<double> > &values) const
+{
+	if(cacheDirectory == "no") return false;
+
+	ifstream in(cacheFile(key).c_str());
+	if(!in.good()) return false;
+
+	string header, fileKey, line;
+	getline(in, header);
+	getline(in, fileKey);
+	if(header != cacheFileHeader || fileKey != key) return false;
+
+	unsigned nrows = 0;
+	if(!getline(in, line)) return false;
+	nrows = strtoul(line.c_str(), nullptr, 10);
+
+	vector<vector<double> > fileValues(nrows);
+	for(unsigned r=0; r<nrows; r++) {
+		if(!getline(in, line)) return false;
+
+		// first entry: number of columns
+		const char *s = line.c_str();
+		char *end = nullptr;
+		unsigned ncols = strtoul(s, &end, 10);
+		s = end;
+
+		fileValues[r].resize(ncols);
+		for(unsigned c=0; c<ncols; c++) {
+			fileValues[r][c] = strtod(s, &end);
+			if(end == s) return false;
+			s = end;
+		}
+	}
+
+	values = std::move(fileValues);
+	return true;
+}
+
+// written to a temporary file and renamed, so concurrent jobs never see a partial table
+void cachedCalibration::writeCacheFile(const string &key, const vector<vector<double> > &values) const
+{
+	if(cacheDirectory == "no") return;
+
+	string path = cacheFile(key);
+	stringstream tmpPath;
+	tmpPath << path << ".tmp." << getpid() << "." << this_thread::get_id();
+
+	FILE *out = fopen(tmpPath.str().c_str(), "w");
+	if(out == nullptr) {
+		cout << "  !! Warning: CCDB cache file " << path << " can't be written." << endl;
+		return;
+	}
+
+	// 17 significant digits: the values are read back identical
+	fprintf(out, "%s\n%s\n%zu\n", cacheFileHeader.c_str(), key.c_str(), values.size());
+	for(auto &row : values) {
+		fprintf(out, "%zu", row.size());
+		for(double v : row) {
+			fprintf(out, " %.17g", v);
+		}
+		fprintf(out, "\n");
+	}
+
+	bool written = !ferror(out);
+	written = (fclose(out) == 0) && written;
+
+	if(!written || rename(tmpPath.str().c_str(), path.c_str()) != 0) {
+		cout << "  !! Warning: CCDB cache file " << path << " can't be written." << endl;
+		remove(tmpPath.str().c_str());
+	}
+}
@@ -0,0 +1,55 @@
+/// \file ccdbCache.h
+/// Defines the CCDB constants cache.\n
+/// The digitization routines read the CCDB tables through cachedCalibration:
+/// - each table is kept in memory, so all threads share one query per table
+/// - with the CCDB_CACHE option the tables are also stored in a local directory,
+///   one file per connection and request (table, run, variation, timestamp).
+///   Jobs finding all their tables there never connect to the database.\n
+
+#ifndef CCDB_CACHE_H
+#define CCDB_CACHE_H 1
+
+// ccdb
+#include <CCDB/Calibration.h>
+
+// C++ headers
+#include <memory>
+#include <string>
+#include <vector>
+using namespace std;
+
+
+/// \class cachedCalibration
+/// <b> cachedCalibration </b>\n\n
+/// Drop-in replacement of the ccdb::Calibration used by the digitization routines.
+/// The database connection is opened at the first request not found in the cache.
+class cachedCalibration
+{
+public:
+	cachedCalibration(string c) : connection(c) {;}
+
+	/// same as ccdb::Calibration::GetCalib, served from the cache when possible
+	bool GetCalib(vector<vector<double> > &values, const string &request);
+
+	/// "no": memory cache only. Otherwise the directory of the tables cache.
+	/// Set once from the options, before the digitization routines are initialized
+	static void setCacheDirectory(string directory);
+
+	/// number of requests served by the cache and by the database
+	static void reportStatistics();
+
+	/// stores a table in the memory cache, as if it was read from the connection.
+	/// Used by the benchmarks to serve the digitization routines without a database
+	static void preload(const string &connection, const string &request, const vector<vector<double> > &values);
+
+private:
+	string connection;
+	unique_ptr<ccdb::Calibration> calib;
+
+	string cacheFile(const string &key) const;
+	bool readCacheFile(const string &key, vector<vector<double> > &values) const;
+	void writeCacheFile(const string &key, const vector<vector<double> > &values) const;
+};
+
+
+#endif
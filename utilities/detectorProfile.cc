@@ -0,0 +1,113 @@
+// gemc headers
+#include "detectorProfile.h"
+
+// C++ headers
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+using namespace std;
+
+// system headers
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+namespace {
+	mutex runProfilesMutex;
+	map<string, detectorProfile> runProfiles;
+	long nProfiledEvents = 0;
+
+	const char *stageNames[PROFILE_NSTAGES] = {"tracking", "steps", "merge", "raw", "dgt", "voltage", "output"};
+}
+
+void detectorProfile::clear()
+{
+	for(int s=0; s<PROFILE_NSTAGES; s++) {
+		wall[s] = 0;
+		cpu[s]  = 0;
+	}
+	steps = 0;
+	hits  = 0;
+}
+
+void detectorProfile::add(const detectorProfile &other)
+{
+	for(int s=0; s<PROFILE_NSTAGES; s++) {
+		wall[s] += other.wall[s];
+		cpu[s]  += other.cpu[s];
+	}
+	steps += other.steps;
+	hits  += other.hits;
+}
+
+const char *detectorProfile::stageName(int stage)
+{
+	if(stage < 0 || stage >= PROFILE_NSTAGES) return "na";
+	return stageNames[stage];
+}
+
+void detectorProfile::addToRun(const map<string, detectorProfile> &eventProfiles)
+{
+	lock_guard<mutex> lock(runProfilesMutex);
+
+	for(auto &p : eventProfiles) {
+		runProfiles[p.first].add(p.second);
+	}
+	nProfiledEvents++;
+}
+
+// one line per detector: steps, hits and for each stage the CPU and wall time in ms per event.
+// The share is the fraction of the total wall time, as the steps CPU time is not measured.
+// The event tracking time includes the detectors steps: the event share is the time spent out of the sensitive detectors
+void detectorProfile::printRunSummary()
+{
+	lock_guard<mutex> lock(runProfilesMutex);
+
+	if(nProfiledEvents == 0) return;
+
+	double totalWall = 0;
+	double stepsWall = 0;
+	for(auto &p : runProfiles) {
+		for(int s=0; s<PROFILE_NSTAGES; s++) totalWall += p.second.wall[s];
+		stepsWall += p.second.wall[PROFILE_STEPS];
+	}
+	totalWall -= stepsWall;
+
+	cout << endl << "  > Profile of " << nProfiledEvents << " events, CPU / wall time in ms per event:" << endl;
+
+	char line[512];
+	int n = snprintf(line, sizeof(line), "  %-20s %12s %10s", "detector", "steps", "hits");
+	for(int s=0; s<PROFILE_NSTAGES && n < (int) sizeof(line); s++) {
+		n += snprintf(line + n, sizeof(line) - n, " %17s", stageNames[s]);
+	}
+	cout << line << "   share" << endl;
+
+	for(auto &p : runProfiles) {
+		double detectorWall = 0;
+		n = snprintf(line, sizeof(line), "  %-20s %12ld %10ld", p.first.c_str(), p.second.steps, p.second.hits);
+		for(int s=0; s<PROFILE_NSTAGES && n < (int) sizeof(line); s++) {
+			n += snprintf(line + n, sizeof(line) - n, " %8.3f/%8.3f",
+							  1000*p.second.cpu[s]/nProfiledEvents, 1000*p.second.wall[s]/nProfiledEvents);
+			detectorWall += p.second.wall[s];
+		}
+		if(p.first == "event") detectorWall -= stepsWall;
+		cout << line << "   " << (totalWall > 0 ? 100*detectorWall/totalWall : 0) << "%" << endl;
+	}
+
+	cout << "  > Peak resident memory: " << peakRSS()/1024 << " MB" << endl << endl;
+}
+
+long detectorProfile::peakRSS()
+{
+#ifndef _WIN32
+	rusage usage;
+	if(getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+		return usage.ru_maxrss/1024;
+#else
+		return usage.ru_maxrss;
+#endif
+	}
+#endif
+	return 0;
+}
@@ -0,0 +1,136 @@
+/// \file detectorProfile.h
+/// Defines the detectors profile used by the PROFILE option.\n
+/// Each sensitive detector accumulates the wall and CPU time spent in every stage
+/// of the event processing, and its number of steps and hits.
+/// The "event" profile has the tracking time (begin of event to end of event,
+/// including the sensitive detectors steps) and the event output time.\n
+/// The CPU time is the time of the calling thread. The steps are timed with the wall clock only:
+/// their CPU time is not measured.\n
+
+#ifndef DETECTOR_PROFILE_H
+#define DETECTOR_PROFILE_H 1
+
+// C++ headers
+#include <chrono>
+#include <ctime>
+#include <map>
+#include <string>
+using namespace std;
+
+
+enum profileStage {
+	PROFILE_TRACKING,   ///< event only: begin of event to end of event
+	PROFILE_STEPS,      ///< ProcessHits, wall time only
+	PROFILE_MERGE,      ///< background and pileup hits merging
+	PROFILE_RAW,        ///< mother infos and integrateRaw, allRaws
+	PROFILE_DGT,        ///< integrateDgt
+	PROFILE_VOLTAGE,    ///< chargeTime and voltage samples
+	PROFILE_OUTPUT,     ///< banks writing
+	PROFILE_NSTAGES     ///< number of stages. As a timer stage: not timed
+};
+
+
+/// \class detectorProfile
+/// <b> detectorProfile </b>\n\n
+/// Times are in seconds.
+class detectorProfile
+{
+public:
+	detectorProfile() { clear(); }
+
+	double wall[PROFILE_NSTAGES];
+	double cpu[PROFILE_NSTAGES];
+	long   steps;
+	long   hits;
+
+	void clear();
+	void add(const detectorProfile &other);
+
+	static const char *stageName(int stage);
+
+	/// adds the event profiles of a thread to the run profiles shared by all threads
+	static void addToRun(const map<string, detectorProfile> &eventProfiles);
+
+	/// prints the run profiles table
+	static void printRunSummary();
+
+	/// peak resident memory of the process, in kB
+	static long peakRSS();
+};
+
+
+/// \class profileTimer
+/// <b> profileTimer </b>\n\n
+/// Accumulates the time of consecutive stages into a profile.
+/// Nothing is timed if the profile is nullptr.
+class profileTimer
+{
+public:
+	profileTimer(detectorProfile *p, profileStage s) : profile(p), stage(PROFILE_NSTAGES) { next(s); }
+	~profileTimer() { next(PROFILE_NSTAGES); }
+
+	/// adds the time since the last call to the current stage, then times the new stage
+	inline void next(profileStage s)
+	{
+		if(profile == nullptr) return;
+
+		double w = wallTime();
+		double c = cpuTime();
+		if(stage != PROFILE_NSTAGES) {
+			profile->wall[stage] += w - startWall;
+			profile->cpu[stage]  += c - startCpu;
+		}
+		stage     = s;
+		startWall = w;
+		startCpu  = c;
+	}
+
+	static inline double wallTime()
+	{
+		return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	static inline double cpuTime()
+	{
+#ifdef CLOCK_THREAD_CPUTIME_ID
+		timespec ts;
+		clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+		return ts.tv_sec + 1e-9*ts.tv_nsec;
+#else
+		return (double) clock() / CLOCKS_PER_SEC;
+#endif
+	}
+
+private:
+	detectorProfile *profile;
+	profileStage     stage;
+	double startWall = 0;
+	double startCpu  = 0;
+};
+
+
+/// \class stepTimer
+/// <b> stepTimer </b>\n\n
+/// Adds the wall time of one ProcessHits call to the steps stage.
+/// A thread CPU time reading costs as much as a light detector step:
+/// only the steady clock is read.
+class stepTimer
+{
+public:
+	stepTimer(detectorProfile *p) : profile(p)
+	{
+		if(profile != nullptr) start = chrono::steady_clock::now();
+	}
+
+	~stepTimer()
+	{
+		if(profile != nullptr) profile->wall[PROFILE_STEPS] += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	}
+
+private:
+	detectorProfile *profile;
+	chrono::steady_clock::time_point start;
+};
+
+
+#endif